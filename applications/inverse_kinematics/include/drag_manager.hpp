@@ -33,6 +33,8 @@ class drag_manager : public hnll::game::actor
 
   private:
     void update_actor(float dt) override;
+    // reads the cursor and moves the dragged components of the other actors
+    void declare_actor_access(hnll::utils::access_list& access) const override { access.exclusive(); }
 
     void calc_cursor_projection_intersect();
     glm::vec2 calc_raw_click_point();
@@ -0,0 +1,110 @@
+// hnll
+#include <audio/convolver.hpp>
+#include <audio/hrtf_set.hpp>
+#include <audio/spatial_mixer.hpp>
+
+// std
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// cost of audio::spatial_mixer in real time voices per core : binaural hrtf voices on top of a shared
+// reverb of several seconds. also compares the partitioned convolver with a direct convolution
+
+namespace hnll {
+
+constexpr double SAMPLING_RATE = 48000.0;
+
+std::vector<float> create_reverb(double seconds)
+{
+  std::mt19937 engine(1);
+  std::uniform_real_distribution<float> dist(-1.f, 1.f);
+  std::vector<float> res(static_cast<size_t>(seconds * SAMPLING_RATE));
+  for (size_t i = 0; i < res.size(); i++)
+    res[i] = 0.01f * dist(engine) * std::exp(-3.f * float(i) / float(SAMPLING_RATE));
+  return res;
+}
+
+template <typename Func>
+double measure_seconds(Func&& func)
+{
+  const auto start = std::chrono::steady_clock::now();
+  func();
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+void run_mixer_benchmark(size_t block_size, double reverb_seconds)
+{
+  std::shared_ptr<audio::hrtf_set> hrtfs = audio::hrtf_set::create_spherical_head(SAMPLING_RATE, block_size);
+  auto reverb = create_reverb(reverb_seconds);
+  const size_t voice_count = 64;
+  audio::spatial_mixer mixer(hrtfs, reverb, voice_count);
+
+  std::vector<audio::spatial_voice_id> ids;
+  for (size_t i = 0; i < voice_count; i++) {
+    ids.push_back(mixer.add_voice());
+    const double angle = 2.0 * M_PI * double(i) / voice_count;
+    mixer.set_direction(ids.back(), { std::sin(angle), 0.0, -std::cos(angle) });
+    mixer.set_reverb_send(ids.back(), 0.3f);
+  }
+
+  std::vector<float> input(block_size, 0.1f), stereo(2 * block_size);
+  const size_t block_count = static_cast<size_t>(2.0 * SAMPLING_RATE) / block_size;
+
+  // the reverb alone, then the voices on top of it
+  const auto reverb_time = measure_seconds([&] {
+    for (size_t b = 0; b < block_count; b++) mixer.render(stereo);
+  });
+  const auto total_time = measure_seconds([&] {
+    for (size_t b = 0; b < block_count; b++) {
+      for (auto id : ids) mixer.process_voice(id, input);
+      mixer.render(stereo);
+    }
+  });
+
+  const double audio_seconds = double(block_count * block_size) / SAMPLING_RATE;
+  const double voice_load    = (total_time - reverb_time) / voice_count / audio_seconds;
+  const double reverb_load   = reverb_time / audio_seconds;
+  std::cout << "block " << block_size << " (" << 1e3 * block_size / SAMPLING_RATE << " ms), "
+            << reverb_seconds << " s reverb" << std::endl;
+  std::cout << "  reverb : " << 100.0 * reverb_load << " % of a core" << std::endl;
+  std::cout << "  voice  : " << 100.0 * voice_load << " % of a core, "
+            << (1.0 - reverb_load) / voice_load << " voices per core" << std::endl;
+}
+
+void run_direct_comparison(size_t block_size, double ir_seconds)
+{
+  auto impulse_response = create_reverb(ir_seconds);
+  auto filter = audio::partitioned_filter::create(impulse_response, block_size);
+  audio::convolver conv(block_size, filter->get_partition_count());
+
+  const size_t sample_count = block_size * 64;
+  std::vector<float> input(sample_count, 0.1f), output(sample_count);
+  const auto partitioned = measure_seconds([&] { conv.process(input, *filter, output); });
+
+  std::vector<float> history(impulse_response.size() + sample_count, 0.f);
+  std::copy(input.begin(), input.end(), history.begin() + impulse_response.size());
+  const auto direct = measure_seconds([&] {
+    for (size_t n = 0; n < sample_count; n++) {
+      float sum = 0.f;
+      const float* x = history.data() + impulse_response.size() + n;
+      for (size_t m = 0; m < impulse_response.size(); m++)
+        sum += impulse_response[m] * x[-static_cast<std::ptrdiff_t>(m)];
+      output[n] = sum;
+    }
+  });
+  std::cout << ir_seconds << " s impulse response, block " << block_size
+            << " : partitioned x" << direct / partitioned << " faster than direct" << std::endl;
+}
+
+} // namespace hnll
+
+int main()
+{
+  for (size_t block_size : { 128, 256, 512 })
+    hnll::run_mixer_benchmark(block_size, 3.0);
+  hnll::run_direct_comparison(256, 1.0);
+}
@@ -0,0 +1,107 @@
+// hnll
+#include <physics/fdtd_solver.hpp>
+#include <utils/job_system.hpp>
+
+// std
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// throughput of physics::fdtd_solver in cell updates per second (one velocity and one pressure update per cell)
+// compared with a straightforward triple loop of the same scheme
+
+namespace hnll {
+
+// scalar reference without blocking, padding or pml
+class naive_fdtd
+{
+  public:
+    naive_fdtd(int n, float velocity_coefficient, float pressure_coefficient)
+      : n_(n), cv_(velocity_coefficient), cp_(pressure_coefficient),
+        p_(size_t(n) * n * n, 0.f), vx_(p_.size(), 0.f), vy_(p_.size(), 0.f), vz_(p_.size(), 0.f) {}
+
+    void step()
+    {
+      for (int z = 0; z < n_; z++)
+        for (int y = 0; y < n_; y++)
+          for (int x = 0; x < n_; x++) {
+            const auto i = id(x, y, z);
+            if (x + 1 < n_) vx_[i] -= cv_ * (p_[id(x + 1, y, z)] - p_[i]);
+            if (y + 1 < n_) vy_[i] -= cv_ * (p_[id(x, y + 1, z)] - p_[i]);
+            if (z + 1 < n_) vz_[i] -= cv_ * (p_[id(x, y, z + 1)] - p_[i]);
+          }
+      for (int z = 0; z < n_; z++)
+        for (int y = 0; y < n_; y++)
+          for (int x = 0; x < n_; x++) {
+            const auto i = id(x, y, z);
+            float div = vx_[i] + vy_[i] + vz_[i];
+            if (x > 0) div -= vx_[id(x - 1, y, z)];
+            if (y > 0) div -= vy_[id(x, y - 1, z)];
+            if (z > 0) div -= vz_[id(x, y, z - 1)];
+            p_[i] -= cp_ * div;
+          }
+    }
+
+    void add_pressure(int x, int y, int z, float value) { p_[id(x, y, z)] += value; }
+
+  private:
+    size_t id(int x, int y, int z) const { return (size_t(z) * n_ + y) * n_ + x; }
+
+    int n_;
+    float cv_, cp_;
+    std::vector<float> p_, vx_, vy_, vz_;
+};
+
+template <typename Func>
+double measure_cells_per_second(size_t cell_count, uint32_t step_count, Func&& step)
+{
+  const auto start = std::chrono::steady_clock::now();
+  step(step_count);
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return double(cell_count) * step_count / elapsed.count();
+}
+
+void run_benchmark(uint32_t n, uint32_t step_count)
+{
+  auto solver = physics::fdtd_solver::create();
+  solver->set_dx(0.05)
+        ->set_phase_velocity(343.0)
+        ->set_min_stable_dt()
+        ->set_grid_size(n, n, n);
+
+  naive_fdtd naive(int(n),
+    float(solver->get_dt() / (solver->get_density_() * solver->get_dx())),
+    float(solver->get_density_() * 343.0 * 343.0 * solver->get_dt() / solver->get_dx()));
+  naive.add_pressure(n / 2, n / 2, n / 2, 1.f);
+
+  const auto cells = solver->get_cell_count();
+  const auto naive_rate = measure_cells_per_second(cells, step_count, [&](uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) naive.step();
+  });
+
+  std::cout << n << "^3 cells" << std::endl;
+  std::cout << "  naive              : " << naive_rate * 1e-6 << " Mcells/s" << std::endl;
+
+  const auto hardware_threads = std::max(std::thread::hardware_concurrency(), 1u);
+  auto jobs = utils::job_system::create(hardware_threads - 1);
+  for (unsigned threads : { 1u, hardware_threads }) {
+    for (uint32_t pml : { 0u, 8u }) {
+      solver->set_job_system(threads == 1 ? nullptr : jobs.get())->set_pml_thickness(pml)->reset();
+      solver->add_pressure(n / 2, n / 2, n / 2, 1.0);
+      const auto rate = measure_cells_per_second(cells, step_count, [&](uint32_t count) { solver->step(count); });
+      std::cout << "  solver " << threads << " thread(s)"
+                << (pml > 0 ? ", pml : " : "         : ") << rate * 1e-6 << " Mcells/s"
+                << " (x" << rate / naive_rate << ")" << std::endl;
+    }
+    if (hardware_threads == 1) break;
+  }
+}
+
+} // namespace hnll
+
+int main()
+{
+  for (uint32_t n : { 64u, 128u, 192u })
+    hnll::run_benchmark(n, n >= 128 ? 20 : 100);
+}
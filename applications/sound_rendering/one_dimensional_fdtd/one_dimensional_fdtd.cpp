@@ -2,46 +2,121 @@
 #include <game/engine.hpp>
 #include <physics/engine.hpp>
 #include <physics/fdtd_solver.hpp>
+#include <physics/fdtd_stream.hpp>
+#include <audio/engine.hpp>
+#include <audio/resampler.hpp>
+#include <audio/streaming_source.hpp>
+
+// std
+#include <cmath>
+#include <limits>
+#include <random>
 
 namespace hnll {
 
+// a rigid tube excited at one end. the pressure at the other end is simulated on a worker
+// thread, resampled to the output rate and streamed to openAL
 class app : public game::engine
 {
   public:
     app() : game::engine("one dimensional fdtd")
     {
+      audio::engine::start_hae_context();
       init_solver();
-      create_input();
-      solver_->solve(input_, 5.0f);
+      init_stream();
     }
 
-    ~app() = default;
+    ~app()
+    {
+      // the source has to be released before the context
+      source_.reset();
+      stream_->stop();
+      audio::engine::kill_hae_context();
+    }
 
   private:
     void init_solver()
     {
-      solver_ = physics::fdtd_solver::create();
-      solver_->set_dt(0.1)
-             ->set_phase_velocity(3.f)
-             ->set_max_stable_dx();
+      auto solver = physics::fdtd_solver::create();
+      solver->set_dt(1.0 / SIMULATION_RATE)
+            ->set_phase_velocity(343.f)
+            ->set_max_stable_dx()
+            ->set_grid_size(TUBE_CELL_COUNT, 1, 1)
+            ->set_source(2, 0, 0);
+      stream_ = physics::fdtd_stream::create(std::move(solver));
+      receiver_ = stream_->add_receiver(TUBE_CELL_COUNT - 3, 0, 0);
+      // 50 ms ahead of the playback
+      stream_->set_target_latency(static_cast<size_t>(SIMULATION_RATE * 0.05));
+      stream_->start();
     }
 
-    void create_input()
+    void init_stream()
     {
-      double dt        = solver_->get_dt();
-      double duration  = 3.f;
-      double frequency = 1.f;
-      double amplitude = 2.f;
+      resampler_ = audio::resampler::create(stream_->get_sampling_rate(), OUTPUT_RATE);
+      source_ = audio::streaming_source::create(
+        [this](std::span<ALshort> samples) { return fill(samples); },
+        static_cast<ALsizei>(OUTPUT_RATE));
+      source_->play();
+    }
+
+    // pulls the simulated samples through the resampler
+    size_t fill(std::span<ALshort> samples)
+    {
+      const auto required = static_cast<size_t>(std::ceil(samples.size() * resampler_->get_step()));
+      input_.resize(required);
+      while (resampler_->get_available_count() < samples.size()) {
+        auto count = stream_->pop_output(receiver_, input_);
+        if (count == 0) break;
+        resampler_->push(std::span<const float>(input_.data(), count));
+      }
 
-      input_.resize(duration / dt);
+      output_.resize(samples.size());
+      const auto count = resampler_->pull(output_);
+      for (size_t i = 0; i < count; i++) {
+        const auto value = std::clamp(output_[i] * GAIN, -1.f, 1.f);
+        samples[i] = static_cast<ALshort>(value * std::numeric_limits<ALshort>::max());
+      }
+      return count;
+    }
 
-      for (int i = 0; i < input_.size(); i++) {
-        input_[i] = amplitude * std::sin(frequency * dt * 2.0 * M_PI * i);
+    void update_game(float dt) override
+    {
+      // a short noise burst every second
+      elapsed_ += dt;
+      if (elapsed_ > 1.f) {
+        elapsed_ = 0.f;
+        std::uniform_real_distribution<float> dist(-1.f, 1.f);
+        std::vector<float> burst(static_cast<size_t>(SIMULATION_RATE * 0.005));
+        for (auto& sample : burst) sample = dist(random_engine_);
+        stream_->push_input(burst);
       }
+      source_->update();
     }
 
-    std::vector<double> input_;
-    u_ptr<physics::fdtd_solver> solver_;
+    void update_game_gui() override
+    {
+      ImGui::Begin("stream");
+      ImGui::Text("simulated steps : %llu", static_cast<unsigned long long>(stream_->get_step_count()));
+      ImGui::Text("buffered : %zu", stream_->get_buffered_count(receiver_));
+      ImGui::Text("late batches : %llu", static_cast<unsigned long long>(stream_->get_late_batch_count()));
+      ImGui::Text("starved buffers : %llu", static_cast<unsigned long long>(source_->get_starved_buffer_count()));
+      ImGui::Text("underruns : %llu", static_cast<unsigned long long>(source_->get_underrun_count()));
+      ImGui::End();
+    }
+
+    static constexpr double   SIMULATION_RATE = 32000.0;
+    static constexpr double   OUTPUT_RATE     = 44100.0;
+    static constexpr uint32_t TUBE_CELL_COUNT = 256;
+    static constexpr float    GAIN            = 0.5f;
+
+    u_ptr<physics::fdtd_stream>      stream_;
+    uint32_t                         receiver_;
+    u_ptr<audio::resampler>          resampler_;
+    u_ptr<audio::streaming_source>   source_;
+    std::vector<float>               input_;
+    std::vector<float>               output_;
+    float                            elapsed_ = 0.f;
+    std::mt19937                     random_engine_;
 };
 
 } // namespace hnll
@@ -54,4 +129,4 @@ int main()
   catch (const std::exception& e) {
     std::cerr << e.what() << std::endl;
   }
-}
\ No newline at end of file
+}
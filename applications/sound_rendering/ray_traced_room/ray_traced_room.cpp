@@ -0,0 +1,91 @@
+// hnll
+#include <physics/acoustic_ray_tracer.hpp>
+#include <geometry/bounding_volume.hpp>
+
+// std
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+// a listener walks around a pillar of a 12 x 4 x 9 m room
+// the first trace() shoots the rays, the following ones only re-collect the cached paths
+// prints the cost of both, the direct sound and the reverberation seen by the listener
+
+namespace hnll {
+
+void add_box(physics::acoustic_ray_tracer& tracer, const vec3d& min, const vec3d& max, uint32_t material)
+{
+  std::vector<float> positions;
+  for (int i = 0; i < 8; i++) {
+    positions.push_back(float(i & 1 ? max.x() : min.x()));
+    positions.push_back(float(i & 2 ? max.y() : min.y()));
+    positions.push_back(float(i & 4 ? max.z() : min.z()));
+  }
+  std::vector<uint32_t> indices = {
+    0, 1, 3,  0, 3, 2,  4, 5, 7,  4, 7, 6,
+    0, 1, 5,  0, 5, 4,  2, 3, 7,  2, 7, 6,
+    0, 2, 6,  0, 6, 4,  1, 3, 7,  1, 7, 5,
+  };
+  tracer.add_obstacle(geometry::position_span{ positions, 3 }, indices, material);
+}
+
+template <typename Func>
+double measure_milliseconds(Func&& func)
+{
+  const auto start = std::chrono::steady_clock::now();
+  func();
+  const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+// schroeder's backward integration, extrapolated from the decay between -5 dB and -35 dB
+double estimate_t60(const std::vector<double>& histogram, double bin_width)
+{
+  std::vector<double> decay(histogram.size() + 1, 0.0);
+  for (size_t i = histogram.size(); i-- > 0;)
+    decay[i] = decay[i + 1] + histogram[i];
+  if (decay[0] == 0.0) return 0.0;
+  auto time_of = [&](double db) {
+    size_t i = 0;
+    while (i < histogram.size() && 10.0 * std::log10(decay[i] / decay[0]) > db) i++;
+    return double(i) * bin_width;
+  };
+  return 2.0 * (time_of(-35.0) - time_of(-5.0));
+}
+
+} // namespace hnll
+
+int main()
+{
+  using namespace hnll;
+  auto tracer = physics::acoustic_ray_tracer::create();
+  auto plaster = tracer->add_material({ 0.1, 0.1 });
+  auto curtain = tracer->add_material({ 0.5, 0.7 });
+  add_box(*tracer, { 0.0, 0.0, 0.0 }, { 12.0, 4.0, 9.0 }, plaster);
+  add_box(*tracer, { 5.5, 0.0, 4.0 }, { 6.5, 4.0, 5.0 }, curtain);
+
+  auto source   = tracer->add_source({ 2.0, 1.5, 4.5 });
+  auto listener = tracer->add_receiver({ 10.0, 1.7, 1.0 }, 0.5);
+  tracer->set_ray_count(1 << 13);
+
+  const auto first = measure_milliseconds([&] { tracer->trace(); });
+  std::cout << tracer->get_triangle_count() << " triangles, " << tracer->get_ray_count() << " rays, "
+            << tracer->get_segment_count() << " cached segments" << std::endl;
+  std::cout << "first trace : " << first << " ms" << std::endl;
+
+  for (int step = 0; step <= 8; step++) {
+    const double z = 1.0 + 7.0 * step / 8.0;
+    tracer->set_receiver_position(listener, { 10.0, 1.7, z });
+    const auto update = measure_milliseconds([&] { tracer->trace(); });
+
+    const auto& histogram = tracer->get_histogram(source, listener);
+    const double reflected = std::accumulate(histogram.begin(), histogram.end(), 0.0);
+    const double direct = tracer->get_direct_energy(source, listener);
+    std::cout << "listener z " << z << " m : update " << update << " ms, direct "
+              << (direct > 0.0 ? 10.0 * std::log10(direct) : -INFINITY) << " dB, reflected "
+              << 10.0 * std::log10(reflected) << " dB, t60 "
+              << estimate_t60(histogram, tracer->get_bin_width()) << " s" << std::endl;
+  }
+}
@@ -1,5 +1,4 @@
 // hnll
-#include <game/components/audio_component.hpp>
 #include <game/actor.hpp>
 #include <game/engine.hpp>
 #include <game/modules/physics_engine.hpp>
@@ -11,6 +10,9 @@
 #include <game/shading_systems/grid_shading_system.hpp>
 #include <physics/collision_info.hpp>
 #include <physics/collision_detector.hpp>
+#include <audio/engine.hpp>
+#include <audio/modal_bank.hpp>
+#include <audio/streaming_source.hpp>
 
 using namespace hnll;
 
@@ -38,20 +40,10 @@ class rigid_ball : public hnll::game::actor
           return ball;
       };
 
-      void assign_audio(const float pitch = 440.f)
+      void assign_audio(audio::modal_bank& bank, audio::material_id material)
       {
-        audio_component_ = game::audio_component::create();
-
-        // raw audio creation
-        const unsigned int freq = 44100;
-        const float duration = 0.05f;
-        std::vector<ALshort> audio(static_cast<size_t>(freq * duration));
-        for (int i = 0; i < audio.size(); i++) {
-          audio[i] = std::sin(pitch * M_PI * 2.0 * i / freq) * std::numeric_limits<ALshort>::max();
-        }
-
-        audio_component_->set_raw_audio(std::move(audio));
-        audio_component_->get_ready_to_play();
+        modal_bank_ = &bank;
+        material_ = material;
       }
 
       void init(const Eigen::Vector3d& center_point, double radius)
@@ -77,7 +69,11 @@ class rigid_ball : public hnll::game::actor
           velocity_.y = -velocity_.y * rigid_component_->get_restitution();
           if (std::abs(velocity_.y) < velocity_thresh_) velocity_.y = 0;
           else {
-            audio_component_->play_sound();
+            // the detector doesn't know the ball's momentum
+            auto hit = info;
+            hit.mass = mass_;
+            hit.velocity = { velocity_.x, velocity_.y, velocity_.z };
+            modal_bank_->excite(material_, hit);
             this->set_translation(position_);
           }
       }
@@ -91,7 +87,8 @@ class rigid_ball : public hnll::game::actor
       double velocity_thresh_ = 1.3f;
       double gravity_ = 40.f;
       s_ptr<hnll::game::rigid_component> rigid_component_;
-      u_ptr<game::audio_component> audio_component_;
+      audio::modal_bank* modal_bank_;
+      audio::material_id material_;
 };
 
 // plate is bounding box of which thickness is 0.
@@ -140,6 +137,7 @@ class falling_ball_app : public hnll::game::engine
     falling_ball_app() : hnll::game::engine("falling ball")
     {
       audio::engine::start_hae_context();
+      init_audio();
 
       // set camera position
       camera_up_->set_translation(glm::vec3{0.f, -5.f, -20.f});
@@ -149,7 +147,7 @@ class falling_ball_app : public hnll::game::engine
         auto ball = rigid_ball::create();
         ball->init(position_list[i], 1.f);
         ball->set_restitution(restitution_list[i]);
-        ball->assign_audio(pitch_list[i]);
+        ball->assign_audio(*modal_bank_, materials_[i]);
         balls_.emplace_back(std::move(ball));
       }
 
@@ -158,7 +156,14 @@ class falling_ball_app : public hnll::game::engine
       game::engine::check_and_add_shading_system<game::grid_shading_system>(hnll::utils::shading_type::GRID);
     }
 
-    ~falling_ball_app() { audio::engine::kill_hae_context(); }
+    ~falling_ball_app()
+    {
+      // the source has to be released before the context
+      source_.reset();
+      audio::engine::kill_hae_context();
+    }
+
+    void update_game(float dt) override { source_->update(); }
 
     void update_game_gui() override
     {
@@ -173,7 +178,36 @@ class falling_ball_app : public hnll::game::engine
     }
 
   private:
+    // one material per ball, pitched by pitch_list. all the hits ring in one bank
+    void init_audio()
+    {
+      const float bar_ratios[] = { 1.f, 2.756f, 5.404f, 8.933f, 13.344f, 18.64f };
+      modal_bank_ = audio::modal_bank::create(SAMPLING_RATE);
+      for (auto pitch : pitch_list) {
+        auto modes = audio::modal_bank::create_rayleigh_modes(static_cast<float>(pitch), bar_ratios, 8.f, 2e-8f);
+        materials_.push_back(modal_bank_->add_material(modes));
+      }
+
+      source_ = audio::streaming_source::create([this](std::span<ALshort> samples) {
+        block_.assign(samples.size(), 0.f);
+        modal_bank_->render(block_);
+        for (size_t i = 0; i < samples.size(); i++) {
+          const auto value = std::clamp(block_[i] * GAIN, -1.f, 1.f);
+          samples[i] = static_cast<ALshort>(value * std::numeric_limits<ALshort>::max());
+        }
+        return samples.size();
+      }, static_cast<ALsizei>(SAMPLING_RATE), 512);
+      source_->play();
+    }
+
+    static constexpr double SAMPLING_RATE = 44100.0;
+    static constexpr float  GAIN = 0.005f;
+
     std::vector<s_ptr<rigid_ball>> balls_;
+    u_ptr<audio::modal_bank> modal_bank_;
+    std::vector<audio::material_id> materials_;
+    u_ptr<audio::streaming_source> source_;
+    std::vector<float> block_;
 };
 
 int main()
@@ -0,0 +1,162 @@
+#pragma once
+
+// hnll
+#include <audio/streaming_source.hpp>
+#include <utils/spsc_ring.hpp>
+
+// std
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+// openAL
+#include <AL/al.h>
+
+namespace hnll::audio {
+
+template<typename T> using u_ptr = std::unique_ptr<T>;
+
+// handles issued by the game thread, resolved to openAL ids on the audio thread
+using buffer_handle = uint32_t;
+using source_handle = uint32_t;
+using stream_handle = uint32_t;
+// completion handle of a command. every command before it is complete as well
+using command_ticket = uint64_t;
+
+enum class device_type { DEFAULT, LOOPBACK };
+
+// owns the openAL context on a dedicated thread
+// the game thread (the only producer) records commands into a lock-free ring, and the audio
+// thread executes them in order. nothing blocks the game thread unless the ring is full or it
+// waits on a ticket. while an audio_thread exists, audio::engine must not be used directly
+// the streams are refilled on the audio thread every STREAM_UPDATE_PERIOD
+class audio_thread
+{
+  public:
+    static constexpr size_t DEFAULT_COMMAND_CAPACITY = 1024;
+    static constexpr auto   STREAM_UPDATE_PERIOD = std::chrono::milliseconds(5);
+
+    static u_ptr<audio_thread> create(device_type type = device_type::DEFAULT, size_t command_capacity = DEFAULT_COMMAND_CAPACITY)
+    { return std::make_unique<audio_thread>(type, command_capacity); }
+
+    // throws if the device can't be opened
+    explicit audio_thread(device_type type = device_type::DEFAULT, size_t command_capacity = DEFAULT_COMMAND_CAPACITY);
+    ~audio_thread();
+
+    // producer ---------------------------------------------------------------------------
+    buffer_handle  create_buffer();
+    // alBufferData runs on the audio thread. the ticket completes when the data is in openAL
+    command_ticket upload(buffer_handle buffer, std::vector<ALshort>&& data, ALenum format = AL_FORMAT_MONO16, ALsizei sampling_rate = 44100);
+    command_ticket delete_buffer(buffer_handle buffer);
+
+    // a source which can't be acquired from the engine silently ignores its commands
+    source_handle  create_source();
+    command_ticket delete_source(source_handle source);
+    command_ticket bind(source_handle source, buffer_handle buffer);
+    command_ticket play(source_handle source);
+    command_ticket stop(source_handle source);
+    command_ticket set_gain(source_handle source, float gain);
+    command_ticket set_position(source_handle source, const std::array<float, 3>& position);
+    command_ticket set_looping(source_handle source, bool is_looping);
+
+    // the file is opened on the audio thread (see streaming_source::create_from_file)
+    stream_handle  create_stream(const std::string& path, bool is_looping = false);
+    // the fill function is called on the audio thread (a synthesizer, a spatial_mixer ...)
+    stream_handle  create_stream(streaming_source::fill_function fill, ALsizei sampling_rate, ALenum format = AL_FORMAT_MONO16);
+    command_ticket delete_stream(stream_handle stream);
+    command_ticket play_stream(stream_handle stream);
+    command_ticket stop_stream(stream_handle stream);
+
+    // loopback device only. mixes samples.size() / 2 stereo frames and waits for them
+    void render(std::span<float> samples);
+
+    bool is_complete(command_ticket ticket) const { return processed_count_.load(std::memory_order_acquire) >= ticket; }
+    void wait(command_ticket ticket) const;
+    // waits for every submitted command
+    void flush() const { wait(submitted_count_); }
+
+    // getter
+    device_type get_device_type() const { return device_type_; }
+    // submissions which found the ring full
+    uint64_t get_stall_count() const { return stall_count_; }
+    // sources which couldn't be acquired
+    uint64_t get_failed_source_count() const { return failed_source_count_; }
+    // streams whose file couldn't be opened or which got no source
+    uint64_t get_failed_stream_count() const { return failed_stream_count_; }
+
+  private:
+    enum class command_type : uint8_t
+    {
+      CREATE_BUFFER,
+      UPLOAD_BUFFER,
+      DELETE_BUFFER,
+      CREATE_SOURCE,
+      DELETE_SOURCE,
+      BIND,
+      PLAY,
+      STOP,
+      SET_GAIN,
+      SET_POSITION,
+      SET_LOOPING,
+      CREATE_STREAM,
+      DELETE_STREAM,
+      PLAY_STREAM,
+      STOP_STREAM,
+      RENDER,
+      QUIT
+    };
+
+    struct command
+    {
+      command_type type = command_type::QUIT;
+      uint32_t handle   = 0;
+      uint32_t argument = 0;
+      ALenum   format   = AL_FORMAT_MONO16;
+      ALsizei  sampling_rate = 0;
+      std::array<float, 3> values = {};
+      std::vector<ALshort> data;
+      std::string path;
+      streaming_source::fill_function fill;
+      float*   output = nullptr;
+      size_t   output_count = 0;
+    };
+
+    static command make_command(command_type type, uint32_t handle = 0, uint32_t argument = 0);
+    command_ticket submit(command&& c);
+    uint32_t allocate(std::vector<uint32_t>& free_handles, uint32_t& next_handle);
+    void work();
+    void execute(command& c);
+
+    device_type device_type_;
+    utils::spsc_ring<command> commands_;
+    std::thread worker_;
+
+    // producer side
+    command_ticket submitted_count_ = 0;
+    uint32_t next_buffer_handle_ = 0;
+    uint32_t next_source_handle_ = 0;
+    uint32_t next_stream_handle_ = 0;
+    std::vector<uint32_t> free_buffer_handles_;
+    std::vector<uint32_t> free_source_handles_;
+    std::vector<uint32_t> free_stream_handles_;
+    uint64_t stall_count_ = 0;
+
+    // wakes the audio thread
+    std::atomic<uint64_t> signal_ = 0;
+    std::atomic<command_ticket> processed_count_ = 0;
+    std::atomic<uint64_t> failed_source_count_ = 0;
+    std::atomic<uint64_t> failed_stream_count_ = 0;
+
+    // consumer side. indexed by the handles
+    std::vector<ALuint> buffers_;
+    std::vector<ALuint> sources_;
+    std::vector<u_ptr<streaming_source>> streams_;
+};
+
+} // namespace hnll::audio
@@ -0,0 +1,86 @@
+#pragma once
+
+// hnll
+#include <audio/fft.hpp>
+
+// std
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace hnll::audio {
+
+template<typename T> using u_ptr = std::unique_ptr<T>;
+template<typename T> using s_ptr = std::shared_ptr<T>;
+
+// an impulse response cut into block_size partitions, each transformed with a 2 * block_size fft
+// immutable, so one filter is shared by any number of convolvers
+class partitioned_filter
+{
+  public:
+    static s_ptr<partitioned_filter> create(std::span<const float> impulse_response, size_t block_size)
+    { return std::make_shared<partitioned_filter>(impulse_response, block_size); }
+
+    partitioned_filter(std::span<const float> impulse_response, size_t block_size);
+
+    // getter
+    size_t get_block_size()      const { return block_size_; }
+    size_t get_partition_count() const { return partition_count_; }
+    // bins per spectrum, padded to a multiple of 4
+    size_t get_stride()          const { return stride_; }
+    const float* get_re(size_t partition) const { return re_.data() + partition * stride_; }
+    const float* get_im(size_t partition) const { return im_.data() + partition * stride_; }
+
+  private:
+    size_t block_size_;
+    size_t partition_count_;
+    size_t stride_;
+    std::vector<float> re_;
+    std::vector<float> im_;
+};
+
+// uniformly partitioned overlap-save convolution (latency : one block)
+// push() transforms a block of the input into the frequency domain delay line, then convolve()
+// multiplies the delay line with any filter of the same block size. a voice pushes once and
+// convolves with several filters (the two ears, the old and new filters of a crossfade)
+class convolver
+{
+  public:
+    static u_ptr<convolver> create(size_t block_size, size_t max_partition_count)
+    { return std::make_unique<convolver>(block_size, max_partition_count); }
+
+    // block_size should be a power of two
+    convolver(size_t block_size, size_t max_partition_count);
+
+    // input : block_size samples
+    void push(std::span<const float> input);
+    // writes block_size samples of the last pushed block convolved with the filter
+    // the filter should have at most max_partition_count partitions
+    void convolve(const partitioned_filter& filter, std::span<float> output);
+    void reset();
+
+    // any multiple of block_size
+    void process(std::span<const float> input, const partitioned_filter& filter, std::span<float> output);
+
+    // getter
+    size_t get_block_size()          const { return block_size_; }
+    size_t get_max_partition_count() const { return partition_count_; }
+
+  private:
+    size_t block_size_;
+    size_t partition_count_;
+    size_t stride_;
+    fft fft_;
+    // the last two input blocks
+    std::vector<float> window_;
+    // ring of the input spectra, newest at head_
+    std::vector<float> delay_re_;
+    std::vector<float> delay_im_;
+    size_t head_ = 0;
+    // scratch
+    std::vector<float> acc_re_;
+    std::vector<float> acc_im_;
+    std::vector<float> time_;
+};
+
+} // namespace hnll::audio
@@ -3,10 +3,12 @@
 // std
 #include <queue>
 #include <memory>
+#include <span>
 
 // openAL
 #include <AL/al.h>
 #include <AL/alc.h>
+#include <AL/alext.h>
 
 // engine
 namespace hnll::audio {
@@ -17,7 +19,8 @@ class audio_data;
 using buffer_id = ALuint;
 using source_id = ALuint;
 
-constexpr size_t SOURCE_COUNT = 4;
+// real openAL sources. the voice_manager virtualizes any number of voices on top of them
+constexpr size_t SOURCE_COUNT = 32;
 
 // represents hae process's result state
 enum class result { SUCCESS, FAILURE };
@@ -25,25 +28,37 @@ enum class result { SUCCESS, FAILURE };
 class engine
 {
   public:
-    static void start_hae_context();
+    // does nothing if a context is already started
+    static result start_hae_context();
+    // renders into memory instead of a playback device (ALC_SOFT_loopback), for headless tests
+    static result start_loopback_context(ALCsizei sampling_rate = 44100);
     static void kill_hae_context();
+    // mixes the next samples.size() / 2 stereo frames of the loopback device
+    static result render_loopback(std::span<float> samples);
 
     // audio process functions
     static result bind_audio_to_buffer(audio_data& audio_data);
     static result bind_buffer_to_source(audio_data& audio_data);
     static result remove_audio_resources(audio_data& audio_data);
     static result remove_audio_from_source(audio_data& audio_data);
+    // for the sources which are not bound to an audio_data (streaming_source)
+    static result acquire_source(source_id& id);
+    static void   release_source(source_id id);
     inline static void play_audio_from_source(source_id id) { alSourcePlay(id); }
     inline static void stop_audio_from_source(source_id id) { alSourceStop(id); }
 
     // getter
     static size_t remaining_pending_sources_count() { return pending_source_ids_.size(); }
+    static bool   is_loopback() { return render_samples_ != nullptr; }
 
   private:
+    static void create_pending_sources();
+
     // openAL resources
     static std::queue<source_id> pending_source_ids_;
 
     static ALCdevice* device_;
     static ALCcontext* context_;
+    static LPALCRENDERSAMPLESSOFT render_samples_;
 };
 } // namespace hnll::audio
\ No newline at end of file
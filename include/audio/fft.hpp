@@ -0,0 +1,47 @@
+#pragma once
+
+// std
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace hnll::audio {
+
+template<typename T> using u_ptr = std::unique_ptr<T>;
+
+// real fft of a power of two size, through a complex fft of half the size
+// the spectra are split (real and imaginary arrays) with size / 2 + 1 bins
+// the scratch buffers are shared, so an instance is used by one thread at a time
+class fft
+{
+  public:
+    static u_ptr<fft> create(size_t size) { return std::make_unique<fft>(size); }
+    explicit fft(size_t size);
+
+    // input : size samples. re, im : get_bin_count() bins
+    void forward(const float* input, float* re, float* im);
+    // inverse(forward(x)) == x
+    void inverse(const float* re, const float* im, float* output);
+
+    // getter
+    size_t get_size()      const { return size_; }
+    size_t get_bin_count() const { return size_ / 2 + 1; }
+
+  private:
+    // in place complex fft of half_ points. the input is bit reversed by the caller
+    void transform(float* re, float* im) const;
+
+    size_t size_;
+    size_t half_;
+    std::vector<uint32_t> bit_reverse_;
+    // twiddles of every stage, stage by stage (1 + 2 + 4 + ... + half_ / 2)
+    std::vector<float> stage_cos_;
+    std::vector<float> stage_sin_;
+    // exp(-2 pi i k / size) for the real to complex split
+    std::vector<float> split_cos_;
+    std::vector<float> split_sin_;
+    std::vector<float> work_re_;
+    std::vector<float> work_im_;
+};
+
+} // namespace hnll::audio
@@ -0,0 +1,54 @@
+#pragma once
+
+// hnll
+#include <audio/convolver.hpp>
+
+// std
+#include <memory>
+#include <span>
+#include <vector>
+
+// lib
+#include <eigen3/Eigen/Dense>
+
+namespace hnll::audio {
+
+template<typename T> using u_ptr = std::unique_ptr<T>;
+template<typename T> using s_ptr = std::shared_ptr<T>;
+
+// head related impulse responses for a set of directions, partitioned for one block size
+// the directions are relative to the listener : x right, y up, -z forward (openAL's default)
+class hrtf_set
+{
+  public:
+    struct entry
+    {
+      Eigen::Vector3d direction; // normalized
+      s_ptr<partitioned_filter> left;
+      s_ptr<partitioned_filter> right;
+    };
+
+    static u_ptr<hrtf_set> create(size_t block_size) { return std::make_unique<hrtf_set>(block_size); }
+    // rigid spherical head model (woodworth delay and brown-duda head shadow), for when no measured set is loaded
+    static u_ptr<hrtf_set> create_spherical_head(double sampling_rate, size_t block_size, uint32_t azimuth_count = 24);
+
+    explicit hrtf_set(size_t block_size) : block_size_(block_size) {}
+
+    // returns the index of the entry
+    size_t add(const Eigen::Vector3d& direction, std::span<const float> left, std::span<const float> right);
+    // the entry closest to the direction
+    size_t find_nearest(const Eigen::Vector3d& direction) const;
+
+    // getter
+    const entry& get_entry(size_t index) const { return entries_[index]; }
+    size_t get_entry_count()             const { return entries_.size(); }
+    size_t get_block_size()              const { return block_size_; }
+    size_t get_max_partition_count()     const { return max_partition_count_; }
+
+  private:
+    size_t block_size_;
+    size_t max_partition_count_ = 1;
+    std::vector<entry> entries_;
+};
+
+} // namespace hnll::audio
@@ -0,0 +1,93 @@
+#pragma once
+
+// hnll
+#include <physics/collision_info.hpp>
+
+// std
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace hnll::audio {
+
+template<typename T> using u_ptr = std::unique_ptr<T>;
+
+using material_id = uint32_t;
+
+struct modal_mode
+{
+  float frequency; // Hz
+  float damping;   // 1/s, the envelope is exp(-damping * t)
+  float gain;
+};
+
+// modal synthesis of impact sounds
+// every excited mode is a decaying complex phasor, and all the active modes of every hit are
+// rendered by one SIMD oscillator bank into a shared block. an impact only writes a few
+// phasors into preallocated arrays, so hundreds of simultaneous hits allocate nothing
+class modal_bank
+{
+  public:
+    static constexpr size_t DEFAULT_MAX_MODE_COUNT = 4096;
+    // modes below this amplitude are retired
+    static constexpr float  SILENCE_THRESHOLD = 1e-5f;
+
+    static u_ptr<modal_bank> create(double sampling_rate, size_t max_mode_count = DEFAULT_MAX_MODE_COUNT)
+    { return std::make_unique<modal_bank>(sampling_rate, max_mode_count); }
+
+    modal_bank(double sampling_rate, size_t max_mode_count = DEFAULT_MAX_MODE_COUNT);
+
+    // modes above the nyquist frequency are discarded. returns the material id
+    material_id add_material(std::span<const modal_mode> modes);
+
+    // strikes a material with an impulse. the amplitude of each mode is impulse * gain
+    // modes which don't fit in the bank are dropped
+    void excite(material_id material, float impulse);
+    // the impulse is the momentum carried into the contact
+    void excite(material_id material, const physics::collision_info& info)
+    { excite(material, static_cast<float>(info.mass * info.velocity.norm())); }
+
+    // mixes (adds) the next output.size() samples into output
+    void render(std::span<float> output);
+    void clear();
+
+    // modes with rayleigh damping (alpha + beta * omega^2) and gains falling as 1 / ratio
+    static std::vector<modal_mode> create_rayleigh_modes(
+      float fundamental,
+      std::span<const float> ratios,
+      float alpha,
+      float beta);
+
+    // getter
+    double get_sampling_rate()      const { return sampling_rate_; }
+    size_t get_active_mode_count()  const { return active_count_; }
+    size_t get_max_mode_count()     const { return re_.size(); }
+    size_t get_material_count()     const { return materials_.size(); }
+    // modes lost because the bank was full
+    uint64_t get_dropped_mode_count() const { return dropped_mode_count_; }
+
+  private:
+    // precomputed per material
+    struct mode_table
+    {
+      std::vector<float> cos_coefficients; // r * cos(omega)
+      std::vector<float> sin_coefficients; // r * sin(omega)
+      std::vector<float> gains;
+    };
+
+    void retire_silent_modes();
+
+    double sampling_rate_;
+    std::vector<mode_table> materials_;
+
+    // active modes (SoA). the lanes after active_count_ are zero, so they render silence
+    std::vector<float> re_;
+    std::vector<float> im_;
+    std::vector<float> cos_;
+    std::vector<float> sin_;
+    size_t active_count_ = 0;
+    uint64_t dropped_mode_count_ = 0;
+};
+
+} // namespace hnll::audio
@@ -0,0 +1,57 @@
+#pragma once
+
+// std
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+// openAL
+#include <AL/al.h>
+
+namespace hnll::audio {
+
+template<typename T> using u_ptr = std::unique_ptr<T>;
+
+// decodes a WAV or raw PCM file chunk by chunk into interleaved 16 bit samples
+// only the current chunk lives in memory. 8 bit PCM is widened to 16 bit
+// the samples are read as little endian, like the files
+class pcm_reader
+{
+  public:
+    // throws if the file is not a PCM WAV file
+    static u_ptr<pcm_reader> create_from_wav(const std::string& path);
+    // headerless 16 bit little endian samples
+    static u_ptr<pcm_reader> create_from_raw(const std::string& path, uint32_t channel_count, ALsizei sampling_rate);
+
+    pcm_reader(const std::string& path, uint32_t channel_count, ALsizei sampling_rate, uint32_t bits_per_sample, size_t data_offset, size_t data_size);
+
+    // returns the number of written samples (frames * channels). 0 at the end of the data
+    size_t read(std::span<ALshort> samples);
+    void   seek(size_t frame);
+    void   rewind() { seek(0); }
+
+    // getter
+    ALenum   get_format()        const;
+    ALsizei  get_sampling_rate() const { return sampling_rate_; }
+    uint32_t get_channel_count() const { return channel_count_; }
+    size_t   get_frame_count()   const { return frame_count_; }
+    size_t   get_frame_position() const { return frame_position_; }
+    bool     is_end()            const { return frame_position_ >= frame_count_; }
+    double   get_duration()      const { return double(frame_count_) / sampling_rate_; }
+
+  private:
+    std::ifstream file_;
+    uint32_t channel_count_;
+    ALsizei  sampling_rate_;
+    uint32_t bytes_per_sample_;
+    size_t   data_offset_;
+    size_t   frame_count_;
+    size_t   frame_position_ = 0;
+    // 8 bit samples before widening
+    std::vector<uint8_t> narrow_samples_;
+};
+
+} // namespace hnll::audio
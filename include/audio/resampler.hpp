@@ -0,0 +1,55 @@
+#pragma once
+
+// std
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace hnll::audio {
+
+template<typename T> using u_ptr = std::unique_ptr<T>;
+
+// polyphase windowed-sinc sample rate converter for a mono stream of any rate ratio
+// the filter is tabulated for PHASE_COUNT fractional delays, and the two nearest phases are blended
+class resampler
+{
+  public:
+    static constexpr uint32_t DEFAULT_TAP_COUNT = 32;
+    static constexpr uint32_t PHASE_COUNT       = 256;
+
+    static u_ptr<resampler> create(double input_rate, double output_rate, uint32_t tap_count = DEFAULT_TAP_COUNT)
+    { return std::make_unique<resampler>(input_rate, output_rate, tap_count); }
+
+    // tap_count is rounded up to a multiple of 4
+    resampler(double input_rate, double output_rate, uint32_t tap_count = DEFAULT_TAP_COUNT);
+
+    // appends the input samples
+    void push(std::span<const float> input);
+    // writes as many output samples as the pushed input allows. returns the number of written samples
+    size_t pull(std::span<float> output);
+    void reset();
+
+    // getter
+    double   get_input_rate()  const { return input_rate_; }
+    double   get_output_rate() const { return output_rate_; }
+    uint32_t get_tap_count()   const { return tap_count_; }
+    // number of samples pull() can produce now
+    size_t   get_available_count() const;
+    // input samples per output sample
+    double   get_step() const { return step_; }
+
+  private:
+    double   input_rate_;
+    double   output_rate_;
+    double   step_;
+    uint32_t tap_count_;
+    // (PHASE_COUNT + 1) rows of tap_count_ coefficients
+    std::vector<float> table_;
+    // unconsumed input. starts with tap_count_ / 2 - 1 zeros so the first output is centered on the first input
+    std::vector<float> pending_;
+    // position of the next output in pending_
+    double   time_ = 0.0;
+};
+
+} // namespace hnll::audio
@@ -0,0 +1,98 @@
+#pragma once
+
+// hnll
+#include <audio/convolver.hpp>
+#include <audio/hrtf_set.hpp>
+
+// std
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+// lib
+#include <eigen3/Eigen/Dense>
+
+namespace hnll::audio {
+
+template<typename T> using u_ptr = std::unique_ptr<T>;
+template<typename T> using s_ptr = std::shared_ptr<T>;
+
+using spatial_voice_id = uint32_t;
+
+// binaural mix of mono voices : every voice is convolved with the hrtf of its direction, and
+// sends a part of its signal to one shared reverb convolver
+// works block by block : process_voice() for each playing voice, then render()
+// the filter of a voice is crossfaded over one block when its direction changes
+// the voice setters may be called from another thread than the mixing : the block which starts
+// after a call picks the new parameters up
+class spatial_mixer
+{
+  public:
+    static constexpr size_t DEFAULT_MAX_VOICE_COUNT = 64;
+
+    static u_ptr<spatial_mixer> create(s_ptr<hrtf_set> hrtfs, std::span<const float> reverb_impulse_response, size_t max_voice_count = DEFAULT_MAX_VOICE_COUNT)
+    { return std::make_unique<spatial_mixer>(std::move(hrtfs), reverb_impulse_response, max_voice_count); }
+
+    // the voices are allocated up front, so the ids stay valid while the mixing runs
+    spatial_mixer(s_ptr<hrtf_set> hrtfs, std::span<const float> reverb_impulse_response, size_t max_voice_count = DEFAULT_MAX_VOICE_COUNT);
+
+    // throws if every voice is used
+    spatial_voice_id add_voice();
+    void remove_voice(spatial_voice_id id);
+
+    // input : one block of the voice
+    void process_voice(spatial_voice_id id, std::span<const float> input);
+    // writes one block of interleaved stereo (2 * block_size samples) and starts the next block
+    void render(std::span<float> stereo);
+
+    // getter
+    size_t get_block_size()  const { return block_size_; }
+    size_t get_voice_count() const { return voice_count_; }
+
+    // setter
+    // the voice setters throw for an id out of range
+    // relative to the listener, see hrtf_set
+    void set_direction(spatial_voice_id id, const Eigen::Vector3d& direction);
+    void set_gain(spatial_voice_id id, float gain)
+    { get_voice(id).gain.store(gain, std::memory_order_relaxed); }
+    void set_reverb_send(spatial_voice_id id, float send)
+    { get_voice(id).reverb_send.store(send, std::memory_order_relaxed); }
+    void set_reverb_gain(float gain) { reverb_gain_.store(gain, std::memory_order_relaxed); }
+
+  private:
+    struct voice
+    {
+      u_ptr<convolver> input;
+      // written by the setters, read once per block
+      std::atomic<size_t> hrtf_index = 0;
+      std::atomic<float>  gain = 1.f;
+      std::atomic<float>  reverb_send = 0.f;
+      // the hrtf of the previous block, for the crossfade
+      size_t previous_hrtf_index = 0;
+      bool is_alive = false;
+    };
+
+    voice& get_voice(spatial_voice_id id);
+    void mix(const hrtf_set::entry& entry, voice& v, float voice_gain, float from_gain, float to_gain);
+
+    s_ptr<hrtf_set> hrtfs_;
+    size_t block_size_;
+    std::vector<voice> voices_;
+    std::vector<spatial_voice_id> free_ids_;
+    size_t voice_count_ = 0;
+
+    s_ptr<partitioned_filter> reverb_filter_;
+    u_ptr<convolver> reverb_;
+    std::atomic<float> reverb_gain_ = 1.f;
+
+    // the mix of the current block
+    std::vector<float> left_;
+    std::vector<float> right_;
+    std::vector<float> reverb_input_;
+    // scratch
+    std::vector<float> ear_;
+};
+
+} // namespace hnll::audio
@@ -0,0 +1,100 @@
+#pragma once
+
+// std
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+// openAL
+#include <AL/al.h>
+
+namespace hnll::audio {
+
+template<typename T> using u_ptr = std::unique_ptr<T>;
+
+// forward declaration
+class pcm_reader;
+
+using buffer_id = ALuint;
+using source_id = ALuint;
+
+// plays a stream through a few small buffers queued on one source
+// the processed buffers are refilled by update(), so only buffer_count * buffer_sample_count samples live in openAL
+// the samples are interleaved 16 bit (AL_FORMAT_MONO16 or AL_FORMAT_STEREO16)
+class streaming_source
+{
+  public:
+    // writes at most samples.size() samples and returns the number of written samples
+    // the rest of the buffer is padded with silence
+    using fill_function = std::function<size_t(std::span<ALshort> samples)>;
+
+    static constexpr size_t DEFAULT_BUFFER_SAMPLE_COUNT = 1024;
+    static constexpr size_t DEFAULT_BUFFER_COUNT        = 4;
+    // about 0.19 s of 44.1 kHz stereo per buffer
+    static constexpr size_t FILE_BUFFER_SAMPLE_COUNT    = 16384;
+
+    static u_ptr<streaming_source> create(
+      fill_function fill,
+      ALsizei sampling_rate,
+      size_t buffer_sample_count = DEFAULT_BUFFER_SAMPLE_COUNT,
+      size_t buffer_count = DEFAULT_BUFFER_COUNT,
+      ALenum format = AL_FORMAT_MONO16);
+
+    // streams a WAV file (or raw 16 bit PCM if the extension is .pcm or .raw, then mono 44.1 kHz)
+    // a non looping stream stops by itself at the end of the file
+    static u_ptr<streaming_source> create_from_file(
+      const std::string& path,
+      bool is_looping = false,
+      size_t buffer_sample_count = FILE_BUFFER_SAMPLE_COUNT,
+      size_t buffer_count = DEFAULT_BUFFER_COUNT);
+
+    streaming_source(fill_function fill, ALsizei sampling_rate, size_t buffer_sample_count, size_t buffer_count, ALenum format = AL_FORMAT_MONO16);
+    ~streaming_source();
+
+    // fills every buffer and starts the source
+    void play();
+    void stop();
+    // refills the processed buffers. should be called more often than a buffer lasts
+    void update();
+
+    // getter
+    source_id get_source_id()        const { return source_id_; }
+    ALsizei   get_sampling_rate()    const { return sampling_rate_; }
+    ALenum    get_format()           const { return format_; }
+    bool      is_playing()           const { return is_playing_; }
+    // a file stream reached its end
+    bool      is_finished()          const { return is_finished_; }
+    // times the source ran out of queued buffers and had to be restarted
+    uint64_t  get_underrun_count()   const { return underrun_count_; }
+    // buffers which fill() couldn't complete
+    uint64_t  get_starved_buffer_count() const { return starved_buffer_count_; }
+    // upper bound of the output latency in seconds
+    double    get_latency() const { return double(buffer_ids_.size() * samples_.size()) / (sampling_rate_ * get_channel_count()); }
+    // bytes held by the stream : the staging samples and the openAL buffers
+    size_t    get_memory_size() const { return (buffer_ids_.size() + 1) * samples_.size() * sizeof(ALshort); }
+
+    // setter
+    void set_looping(bool is_looping) { is_looping_ = is_looping; }
+
+  private:
+    void fill_and_queue(buffer_id id);
+    size_t read_file(std::span<ALshort> samples);
+    size_t get_channel_count() const { return format_ == AL_FORMAT_STEREO16 ? 2 : 1; }
+
+    fill_function fill_;
+    ALsizei sampling_rate_;
+    ALenum format_;
+    u_ptr<pcm_reader> reader_;
+    bool is_looping_  = false;
+    bool is_finished_ = false;
+    source_id source_id_;
+    std::vector<buffer_id> buffer_ids_;
+    std::vector<ALshort> samples_;
+    bool is_playing_ = false;
+    uint64_t underrun_count_       = 0;
+    uint64_t starved_buffer_count_ = 0;
+};
+
+} // namespace hnll::audio
@@ -0,0 +1,119 @@
+#pragma once
+
+// std
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// lib
+#include <eigen3/Eigen/Dense>
+
+// openAL
+#include <AL/al.h>
+
+namespace hnll::audio {
+
+template<typename T> using u_ptr = std::unique_ptr<T>;
+
+// forward declaration
+class audio_data;
+
+using buffer_id = ALuint;
+using source_id = ALuint;
+// index in the low 32 bits, generation in the high 32 bits
+using voice_id  = uint64_t;
+
+constexpr voice_id INVALID_VOICE_ID = ~voice_id(0);
+
+struct voice_params
+{
+  Eigen::Vector3d position = Eigen::Vector3d::Zero();
+  float gain       = 1.f;
+  // scales the audibility when the voices compete for the real sources
+  float priority   = 1.f;
+  float pitch      = 1.f;
+  bool  is_looping = false;
+  // inverse distance attenuation, clamped to [min_distance, max_distance]
+  float min_distance = 1.f;
+  float max_distance = 100.f;
+  float rolloff      = 1.f;
+};
+
+// maps any number of logical voices onto a bounded pool of openAL sources
+// every voice keeps a playback cursor. each update, the most audible voices (audibility * priority)
+// are bound to the real sources, the others are only advanced in time (virtual). a virtual voice
+// which becomes audible again resumes from its cursor, and finished one-shots are freed
+class voice_manager
+{
+  public:
+    // below this gain a voice is never bound
+    static constexpr float AUDIBILITY_THRESHOLD = 1e-3f;
+    // a real voice keeps its source unless a virtual one is this much louder
+    static constexpr float REAL_VOICE_BONUS = 1.2f;
+
+    // acquires at most max_real_count sources from the engine
+    static u_ptr<voice_manager> create(size_t max_real_count)
+    { return std::make_unique<voice_manager>(max_real_count); }
+
+    explicit voice_manager(size_t max_real_count);
+    ~voice_manager();
+
+    // the audio_data should be bound to a buffer. the voice starts on the next update
+    voice_id play(const audio_data& data, const voice_params& params = {});
+    void stop(voice_id id);
+    void stop_all();
+
+    // advances every voice by dt and rebinds the real sources
+    void update(float dt, const Eigen::Vector3d& listener_position);
+
+    // getter
+    bool   is_alive(voice_id id) const { return find(id) != nullptr; }
+    bool   is_real(voice_id id)  const;
+    float  get_audibility(voice_id id) const;
+    size_t get_voice_count()         const { return voice_count_; }
+    size_t get_real_voice_count()    const { return max_real_count_ - free_sources_.size(); }
+    size_t get_virtual_voice_count() const { return voice_count_ - get_real_voice_count(); }
+    size_t get_max_real_count()      const { return max_real_count_; }
+    // real voices which lost their source to a more audible one
+    uint64_t get_stolen_count()      const { return stolen_count_; }
+
+    // setter
+    void set_position(voice_id id, const Eigen::Vector3d& position);
+    void set_gain(voice_id id, float gain);
+    void set_priority(voice_id id, float priority);
+
+  private:
+    struct voice
+    {
+      voice_params params;
+      buffer_id buffer;
+      float duration;   // seconds
+      float cursor = 0.f;
+      float audibility = 0.f;
+      uint32_t generation = 0;
+      bool is_alive = false;
+      bool is_real  = false;
+      source_id source = 0;
+    };
+
+    voice*       find(voice_id id);
+    const voice* find(voice_id id) const;
+    void free_voice(uint32_t index);
+    void bind(voice& v, const Eigen::Vector3d& listener_position);
+    void unbind(voice& v);
+    void apply_params(const voice& v, const Eigen::Vector3d& listener_position);
+
+    size_t max_real_count_;
+    std::vector<source_id> free_sources_;
+    std::vector<source_id> owned_sources_;
+
+    std::vector<voice>    voices_;
+    std::vector<uint32_t> free_indices_;
+    size_t voice_count_ = 0;
+    uint64_t stolen_count_ = 0;
+
+    // scratch of update()
+    std::vector<uint32_t> candidates_;
+};
+
+} // namespace hnll::audio
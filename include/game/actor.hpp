@@ -3,6 +3,8 @@
 // hnll
 #include <game/component.hpp>
 #include <utils/utils.hpp>
+#include <utils/ecs_world.hpp>
+#include <utils/slot_map.hpp>
 
 // std
 #include <vector>
@@ -20,6 +22,8 @@ template <class T> using s_ptr = std::shared_ptr<T>;
 template <class T> using u_ptr = std::unique_ptr<T>;
 
 using actor_id = unsigned int;
+// slot of an active actor in the engine
+using actor_handle = utils::slot_handle;
 // forward declaration
 class renderable_component;
 class rigid_component;
@@ -43,6 +47,11 @@ class actor
     void update_components(float dt);
     // for specific update
     virtual void update_actor(float dt) {}
+    // the data update_actor() touches. see component::declare_access
+    // declares the actor's own members, the subclasses which touch shared data add it (or are exclusive)
+    virtual void declare_actor_access(utils::access_list& access) const;
+    // accesses of update() : the actor and all its components
+    void declare_access(utils::access_list& access) const;
     // for collision detection
     virtual void re_update(const physics::collision_info& info);
 
@@ -52,8 +61,25 @@ void update_gui();
       virtual void update_actor_imgui(){}
 #endif
 
+    // plain data of the actor in the engine's ecs world, packed with the same data of the other actors
+    // the systems (engine::add_ecs_system) iterate them. the components are not migrated : the world
+    // holds only the data added here, beside the components
+    // adding and removing are structural changes, which throw during the actor updates (update_actor, components)
+    template <class T, class... Args>
+    T& add_data(Args&&... args) { return get_ecs_world().add<T>(get_entity(), std::forward<Args>(args)...); }
+    template <class T>
+    void remove_data() { if (!entity_.is_null()) get_ecs_world().remove<T>(entity_.get()); }
+    template <class T>
+    T* get_data() { return entity_.is_null() ? nullptr : get_ecs_world().get<T>(entity_.get()); }
+    template <class T>
+    bool has_data() const { return !entity_.is_null() && get_ecs_world().has<T>(entity_.get()); }
+    // created on the first call
+    utils::entity get_entity();
+
     // getter
     inline actor_id    get_id()          const { return id_; }
+    // null until the engine activates the actor
+    inline actor_handle get_handle()     const { return handle_; }
     inline const state get_actor_state() const { return state_; }
     inline bool        is_renderable()   const { return renderable_component_ != nullptr; }
     inline renderable_component&  get_renderable_component_r() { return *renderable_component_; }
@@ -70,9 +96,15 @@ void update_gui();
     void set_rotation(const glm::vec3& rotation)         { transform_sp_->rotation = rotation; }
     void set_scale(const glm::vec3& scale)               { transform_sp_->scale = scale; }
     inline void set_actor_state(state st)                { state_ = st; }
+    // called by the engine
+    inline void set_handle(actor_handle handle)          { handle_ = handle; }
 
   private:
+    static utils::ecs_world& get_ecs_world();
+
     actor_id id_;
+    actor_handle handle_;
+    utils::scoped_entity entity_;
     state state_ = state::ACTIVE;
 
     std::vector<u_ptr<component>> unique_components_;
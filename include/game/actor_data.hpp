@@ -0,0 +1,47 @@
+#pragma once
+
+// hnll
+#include <utils/common_using.hpp>
+#include <utils/utils.hpp>
+
+// std
+#include <cstdint>
+#include <vector>
+
+namespace hnll::game {
+
+// forward declaration
+class renderable_component;
+class rigid_component;
+
+// the per frame state of the actors the update and the render loops read. kept in the ecs world by the engine
+
+// the matrices of a render target, refreshed once per frame after the physics
+// the transform itself is shared with the components and the bounding volumes, so it stays out of the rows
+struct world_transform
+{
+  const utils::transform* source = nullptr;
+  mat4 model_matrix  = mat4::Identity();
+  mat4 normal_matrix = mat4::Identity();
+
+  void refresh()
+  {
+    model_matrix  = source->mat4().cast<float>();
+    normal_matrix = source->normal_matrix().cast<float>();
+  }
+};
+
+// the shading system which captures the target
+struct render_state
+{
+  renderable_component* target = nullptr;
+  uint32_t              shading_type = 0;
+};
+
+// the rigid components of an active actor, for the body sync of the physics
+struct rigid_state
+{
+  std::vector<rigid_component*> components;
+};
+
+} // namespace hnll::game
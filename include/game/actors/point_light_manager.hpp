@@ -24,6 +24,9 @@ class point_light_manager : public actor
     template <class SP> void add_light_comp(SP&& light_comp_sp)
     { component_id id = light_comp_sp->get_id(); light_comp_map_.emplace(id, std::forward<SP>(light_comp_sp)); }
     void remove_light_comp(component_id id) { light_comp_map_.erase(id); }
+    // nullptr if it is not managed
+    s_ptr<point_light_component> get_light_comp(component_id id) const
+    { auto it = light_comp_map_.find(id); return it != light_comp_map_.end() ? it->second : nullptr; }
 
     void update_actor(float dt) override;
 
@@ -1,5 +1,8 @@
 #pragma once
 
+// hnll
+#include <utils/update_batches.hpp>
+
 // std
 #include <memory>
 
@@ -20,6 +23,10 @@ public:
   virtual ~component(){}
 
   inline void update(float dt) { update_component(dt); }
+  // the shared data update_component() touches besides the members of the component and its owner
+  // the engine updates the actors in parallel when their accesses don't conflict
+  // undeclared components are exclusive : their actor is updated alone
+  virtual void declare_access(utils::access_list& access) const { access.exclusive(); }
 
 #ifndef IMGUI_DISABLED
   virtual void update_gui(){}
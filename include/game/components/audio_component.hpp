@@ -2,42 +2,47 @@
 
 // hnll
 #include <game/component.hpp>
-#include <audio/audio_data.hpp>
-#include <audio/engine.hpp>
+#include <game/engine.hpp>
+#include <audio/audio_thread.hpp>
 
 namespace hnll::game {
 
+// openAL is driven from the audio thread. the calls below only enqueue commands
 class audio_component : public game::component
 {
   public:
     static u_ptr<audio_component> create()
-    {
-      auto audio_comp = std::make_unique<audio_component>();
-      return audio_comp;
-    }
-    audio_component() : game::component()
-    { audio_data_ = std::make_unique<audio::audio_data>(); }
+    { return std::make_unique<audio_component>(engine::get_audio_thread()); }
 
-    void play_sound()
+    explicit audio_component(audio::audio_thread& audio) : game::component(), audio_(audio)
     {
-      auto id = audio_data_->get_source_id();
-      audio::engine::play_audio_from_source(id);
+      buffer_ = audio_.create_buffer();
+      source_ = audio_.create_source();
     }
-    void get_ready_to_play()
+    ~audio_component() override
     {
-      if (!audio_data_->is_bound_to_buffer())
-        audio::engine::bind_audio_to_buffer(*audio_data_);
-      if (!audio_data_->is_bound_to_source())
-        audio::engine::bind_buffer_to_source(*audio_data_);
+      audio_.delete_source(source_);
+      audio_.delete_buffer(buffer_);
     }
+
+    void play_sound() { audio_.play(source_); }
+    void stop_sound() { audio_.stop(source_); }
+    // no per frame update
+    void declare_access(utils::access_list&) const override {}
+
     // setter
     void set_raw_audio(const std::vector<ALshort>& raw_audio)
-    { audio_data_->set_data(raw_audio); audio::engine::bind_audio_to_buffer(*audio_data_); }
+    { set_raw_audio(std::vector<ALshort>(raw_audio)); }
     void set_raw_audio(std::vector<ALshort>&& raw_audio)
-    { audio_data_->set_data(std::move(raw_audio)); audio::engine::bind_audio_to_buffer(*audio_data_); }
+    {
+      audio_.upload(buffer_, std::move(raw_audio));
+      audio_.bind(source_, buffer_);
+    }
 
   private:
-    u_ptr<audio::audio_data> audio_data_;
+    audio::audio_thread& audio_;
+    audio::buffer_handle buffer_;
+    audio::source_handle source_;
 };
 
-} // namespace hnll::game
\ No newline at end of file
+} // namespace hnll::game
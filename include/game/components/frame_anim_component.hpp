@@ -30,8 +30,13 @@ class frame_anim_component : public renderable_component
 
     template <class... Args>
     void bind_and_draw(VkCommandBuffer command_buffer, Args... args)
+    { bind_and_draw_frame(animation_index_, frame_index_, command_buffer, args...); }
+
+    // draws a frame captured by the game thread
+    template <class... Args>
+    void bind_and_draw_frame(uint32_t animation_index, uint32_t frame_index, VkCommandBuffer command_buffer, Args... args)
     {
-      model_.bind(animation_index_, frame_index_, command_buffer, args...);
+      model_.bind(animation_index, frame_index, command_buffer, args...);
       model_.draw(command_buffer);
     }
 
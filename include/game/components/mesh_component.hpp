@@ -21,8 +21,7 @@ class mesh_component : public renderable_component
     template <Actor A>
     static s_ptr<mesh_component> create(s_ptr<A>& owner_sp, const std::string& model_name)
     {
-      auto& mesh_model = engine::get_mesh_model(model_name);
-      auto mesh = std::make_shared<mesh_component>(owner_sp, mesh_model);
+      auto mesh = std::make_shared<mesh_component>(owner_sp, engine::acquire_mesh_model(model_name));
       owner_sp->set_renderable_component(mesh);
       return mesh;
     }
@@ -35,21 +34,46 @@ class mesh_component : public renderable_component
       return mesh;
     }
 
+    // the component isn't drawn until its model is loaded
+    template <Actor A>
+    static s_ptr<mesh_component> create_async(s_ptr<A>& owner_sp, const std::string& model_name)
+    {
+      auto mesh = std::make_shared<mesh_component>(owner_sp);
+      owner_sp->set_renderable_component(mesh);
+      engine::load_mesh_model_async(model_name, [weak = std::weak_ptr<mesh_component>(mesh), model_name](graphics::mesh_model&) {
+        if (auto loaded = weak.lock())
+          loaded->model_ = engine::acquire_mesh_model(model_name);
+      });
+      return mesh;
+    }
+
+    // the model is owned elsewhere
     template <Actor A>
     mesh_component(s_ptr<A>& owner_sp, graphics::mesh_model& _model)
-    : renderable_component(owner_sp, utils::shading_type::MESH), model_(_model) {}
+    : renderable_component(owner_sp, utils::shading_type::MESH), model_(&_model) {}
+    template <Actor A>
+    mesh_component(s_ptr<A>& owner_sp, mesh_model_handle&& _model)
+    : renderable_component(owner_sp, utils::shading_type::MESH), model_(std::move(_model)) {}
+    template <Actor A>
+    explicit mesh_component(s_ptr<A>& owner_sp)
+    : renderable_component(owner_sp, utils::shading_type::MESH) {}
     ~mesh_component() override = default;
 
     // getter
-    graphics::mesh_model& get_model() { return model_; }
+    // call only if is_resident()
+    graphics::mesh_model& get_model() { return *model_; }
+    bool is_resident() const                          { return static_cast<bool>(model_); }
     bool get_should_be_drawn() const                  { return should_be_drawn_; }
-    unsigned get_face_count() const                   { return model_.get_face_count(); }
+    unsigned get_face_count() const                   { return model_ ? model_->get_face_count() : 0; }
+    // marks the model as used in this frame, for the least recently used eviction
+    void touch_model() const { model_.touch(); }
     // setter
     void set_should_be_drawn()     { should_be_drawn_ = true; }
     void set_should_not_be_drawn() { should_be_drawn_ = false;}
   private:
     // hnll::graphics::mesh_model can be shared all over a game
-    graphics::mesh_model& model_;
+    // null while the model is loaded
+    mesh_model_handle model_;
     // represents weather its model should be drawn
     bool should_be_drawn_ = false;
 };
@@ -21,14 +21,13 @@ class meshlet_component : public renderable_component
     template <Actor A>
     static s_ptr<meshlet_component> create(s_ptr<A>& owner_sp, const std::string& model_name)
     {
-      auto& meshlet_model = engine::get_meshlet_model(model_name);
-      auto mesh = std::make_shared<meshlet_component>(owner_sp, meshlet_model);
+      auto mesh = std::make_shared<meshlet_component>(owner_sp, engine::acquire_meshlet_model(model_name));
       owner_sp->set_renderable_component(mesh);
       return mesh;
     }
     template <Actor A>
-    meshlet_component(s_ptr<A>& owner_sp, graphics::meshlet_model& model)
-      : renderable_component(owner_sp, utils::shading_type::MESHLET), model_(model) {}
+    meshlet_component(s_ptr<A>& owner_sp, meshlet_model_handle&& model)
+      : renderable_component(owner_sp, utils::shading_type::MESHLET), model_(std::move(model)) {}
     ~meshlet_component() override = default;
 
     void bind_and_draw(
@@ -36,16 +35,19 @@ class meshlet_component : public renderable_component
       std::vector<VkDescriptorSet>&& desc_sets,
       VkPipelineLayout& pipeline_layout)
     {
-      model_.bind(command_buffer, desc_sets, pipeline_layout);
-      model_.draw(command_buffer);
+      model_->bind(command_buffer, desc_sets, pipeline_layout);
+      model_->draw(command_buffer);
     }
 
+    // marks the model as used in this frame, for the least recently used eviction
+    void touch_model() const { model_.touch(); }
+
     // getter
-    uint32_t get_meshlet_count() const { return model_.get_meshlets_count(); }
+    uint32_t get_meshlet_count() const { return model_->get_meshlets_count(); }
 
   private:
-    // hnll::graphics::mesh_model can be shared all over a game
-    graphics::meshlet_model& model_;
+    // hnll::graphics::meshlet_model can be shared all over a game
+    meshlet_model_handle model_;
 };
 
 using meshlet_component_map = std::unordered_map<game::component_id, u_ptr<game::meshlet_component>>;
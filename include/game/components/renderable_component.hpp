@@ -40,6 +40,8 @@ class renderable_component : public hnll::game::component
     template<class V> void set_rotation(V&& vec)    { transform_sp_->rotation = std::forward<V>(vec); }
 
     void update_component(float dt) override {}
+    // the subclasses which update shared data should declare it
+    void declare_access(utils::access_list&) const override {}
 
   protected:
     s_ptr<hnll::utils::transform> transform_sp_;
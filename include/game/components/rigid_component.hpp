@@ -3,6 +3,8 @@
 // hnll
 #include <game/component.hpp>
 #include <utils/utils.hpp>
+#include <utils/slot_map.hpp>
+#include <physics/rigid_body.hpp>
 #include <eigen3/Eigen/Dense>
 
 // std
@@ -21,39 +23,62 @@ using vec3d = Eigen::Vector3d;
 namespace game {
 
 using actor_id           = unsigned int;
+using actor_handle       = utils::slot_handle;
 using rigid_component_id = unsigned int;
 
 class rigid_component : public component
 {
   public:
+    // the mesh factories throw if the model isn't resident : create them in the on_loaded callback of an async load
     static s_ptr<rigid_component> create_with_aabb(actor& owner, const s_ptr<hnll::game::mesh_component>& mesh_component);
     static s_ptr<rigid_component> create_with_b_sphere(actor& owner, const s_ptr<game::mesh_component>& mesh_component);
+    static s_ptr<rigid_component> create_with_convex_hull(actor& owner, const s_ptr<game::mesh_component>& mesh_component);
+    // compound collider for concave meshes. the tree is cached for each model
+    static s_ptr<rigid_component> create_with_sphere_tree(actor& owner, const std::string& model_name);
     static s_ptr<rigid_component> create_from_bounding_volume(actor& owner, u_ptr<geometry::bounding_volume>&& bv);
     static s_ptr<rigid_component> create(actor& owner, const std::vector<vec3d>& positions, geometry::bv_type type);
 
     explicit rigid_component(actor& owner);
     ~rigid_component() override = default;
 
+    // updated by the physics engine, not by the actor
+    void declare_access(utils::access_list&) const override {}
+
     // getter
     [[nodiscard]] const geometry::bounding_volume& get_bounding_volume() const { return *bounding_volume_; }
     [[nodiscard]] const utils::transform&          get_transform_ref()   const { return *transform_sp_; }
     [[nodiscard]] s_ptr<utils::transform>          get_transform()       const { return transform_sp_; }
     [[nodiscard]] rigid_component_id               get_id()              const { return rigid_component_id_; }
     [[nodiscard]] actor_id                         get_owner_id()        const { return owner_id_; }
+    // null until the owner is activated
+    [[nodiscard]] actor_handle                     get_owner_handle()    const { return owner_handle_; }
     [[nodiscard]] double get_mass()                                      const { return mass_; }
     [[nodiscard]] double get_restitution()                               const { return restitution_; }
+    [[nodiscard]] physics::rigid_body&             get_body()                  { return body_; }
+    [[nodiscard]] const physics::rigid_body&       get_body()            const { return body_; }
+    [[nodiscard]] physics::motion_type             get_motion_type()     const { return body_.type; }
 
     // setter
     void set_bounding_volume(u_ptr<geometry::bounding_volume>&& bv) { bounding_volume_ = std::move(bv); }
     void set_transform(const s_ptr<utils::transform>& transform_sp) { transform_sp_ = transform_sp; }
-    void set_mass(double mass)                                      { mass_ = mass; }
-    void set_restitution(double restitution)                        { restitution_ = restitution; }
+    // called by the physics engine when the owner is activated
+    void set_owner_handle(actor_handle handle)                      { owner_handle_ = handle; }
+    void set_mass(double mass);
+    // the contact solver's restitution stays 0 until this is called
+    void set_restitution(double restitution)                        { restitution_ = restitution; body_.restitution = restitution; }
+    void set_friction(double friction)                              { body_.friction = friction; }
+    // static by default. dynamic bodies are moved by the contact solver
+    void set_motion_type(physics::motion_type type);
+    // sleeping bodies should be woken up when they are moved by the game
+    void wake_up() { body_.wake_up(); }
 
   private:
     double mass_ = 1.f;
     double restitution_ = 1.f;
     s_ptr<hnll::utils::transform>    transform_sp_;
     u_ptr<geometry::bounding_volume> bounding_volume_;
+    physics::rigid_body              body_;
+    actor_handle       owner_handle_;
     actor_id           owner_id_;
     rigid_component_id rigid_component_id_;
 };
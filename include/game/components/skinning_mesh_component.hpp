@@ -36,6 +36,8 @@ class skinning_mesh_component : public renderable_component
       }
       model_.update_animation(target_animation_, animation_timer_);
     }
+    // the model is shared by every actor of the same mesh
+    void declare_access(utils::access_list& access) const override { access.write(&model_); }
 
     // getter
     graphics::skinning_mesh_model& get_model() { return model_; }
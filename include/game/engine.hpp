@@ -4,20 +4,34 @@
 #include <gui/engine.hpp>
 #include <game/modules/graphics_engine.hpp>
 #include <graphics/mesh_model.hpp>
+#include <utils/update_batches.hpp>
+#include <utils/ecs_world.hpp>
+#include <utils/slot_map.hpp>
+#include <utils/frame_pipeline.hpp>
+#include <utils/frame_scheduler.hpp>
+#include <utils/residency_manager.hpp>
+#include <game/render_snapshot.hpp>
 
 // lib
 #include <GLFW/glfw3.h>
 
 //std
 #include <chrono>
+#include <deque>
+#include <functional>
+#include <map>
 #include <vector>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <string>
 
 namespace hnll {
 
+namespace audio { class audio_thread; }
+
 namespace graphics {
+  class upload_batch;
   class meshlet_model;
   class skinning_mesh_model;
   class frame_anim_mesh_model;
@@ -35,12 +49,33 @@ class point_light_component;
 class physics_engine;
 
 using actor_id = unsigned int;
-using actor_map = std::unordered_map<actor_id, s_ptr<actor>>;
+using actor_handle = utils::slot_handle;
+using actor_map = utils::slot_map<s_ptr<actor>>;
+// keep the models resident while they are referred to
+using mesh_model_handle    = utils::resident_handle<graphics::mesh_model>;
+using meshlet_model_handle = utils::resident_handle<graphics::meshlet_model>;
 
 // TODO : use template
 template <class T>
 using graphics_model_map = std::unordered_map<std::string, u_ptr<T>>;
 
+enum class update_mode
+{
+  // the actors whose declared accesses don't conflict are updated at the same time
+  PARALLEL,
+  // one by one in the order of the ids, for replays and debugging
+  DETERMINISTIC,
+};
+
+enum class render_mode
+{
+  // update and render one after the other on the engine's thread
+  SERIAL,
+  // a render thread records the frames from snapshots, while the engine's thread updates the next ones
+  // needs every shading system to be pipeline safe, and falls back to SERIAL otherwise (and with imgui)
+  PIPELINED,
+};
+
 class engine {
   public:
     engine(const char *windowName = "honolulu engine", utils::rendering_type rendering_type = utils::rendering_type::VERTEX_SHADING);
@@ -57,7 +92,7 @@ class engine {
     void run();
 
     static void add_actor(const s_ptr<actor> &actor);
-    void remove_actor(actor_id id);
+    void remove_actor(actor& target);
 
     template <class ShadingSystem>
     static void check_and_add_shading_system(utils::shading_type type)
@@ -78,17 +113,60 @@ class engine {
 
     // getter
     static graphics_engine  &get_graphics_engine() { return *graphics_engine_; }
+    physics_engine          &get_physics_engine()  { return *physics_engine_; }
+    // shared scheduler of every module. the engine's thread is its main thread
+    static utils::job_system &get_job_system()     { return *job_system_; }
+    // packed data of the actors (actor::add_data) and of the entities without actor
+    static utils::ecs_world  &get_ecs_world()      { return ecs_world_; }
+    // long work spread over the frames, resumed on the engine's thread after the updates
+    static utils::frame_scheduler &get_frame_scheduler() { return *frame_scheduler_; }
+    // the audio device is opened at the first call. throws if it can't be opened
+    static audio::audio_thread &get_audio_thread();
     static graphics::device &get_graphics_device() { return graphics_engine_->get_device_r(); }
-    static actor& get_active_actor(actor_id id) { return *active_actor_map_[id]; }
-
-    static actor& get_pending_actor(actor_id id)  { return *pending_actor_map_[id]; }
+    // nullptr if the actor has been removed
+    static actor* get_active_actor(actor_handle handle)
+    { auto* res = active_actor_map_.get(handle); return res != nullptr ? res->get() : nullptr; }
     static graphics::mesh_model&    get_mesh_model(const std::string& model_name);
     static graphics::meshlet_model& get_meshlet_model(const std::string& model_name);
     static graphics::skinning_mesh_model& get_skinning_mesh_model(const std::string& model_name);
     static graphics::frame_anim_mesh_model& get_frame_anim_mesh_model(const std::string& model_name);
     static graphics::frame_anim_meshlet_model& get_frame_anim_meshlet_model(const std::string& model_name);
+    // loads the model if it isn't resident. the models without handle may be evicted under the budget
+    static mesh_model_handle    acquire_mesh_model(const std::string& model_name);
+    static meshlet_model_handle acquire_meshlet_model(const std::string& model_name);
+    // the models returned by get_*_model() are never evicted
+    static utils::residency_manager& get_residency_manager() { return residency_manager_; }
+    // models being parsed or uploaded
+    static size_t get_loading_model_count() { return loading_models_.size(); }
+    update_mode get_update_mode() const { return update_mode_; }
     // setter
     void set_frustum_info(utils::frustum_info&& _frustum_info);
+    void set_update_mode(update_mode mode) { update_mode_ = mode; }
+    // bytes of the mesh and meshlet models, both device and host
+    void set_model_budget(size_t budget_bytes) { residency_manager_.set_budget(budget_bytes); }
+    // the models of a lower priority are evicted first (default 0). kept for the reloads of the model
+    static void set_model_priority(utils::shading_type type, const std::string& model_name, int priority);
+    // milliseconds of each frame given to the tasks of the frame scheduler
+    void set_frame_budget(double budget_ms) { frame_budget_ms_ = budget_ms; }
+    // before run(). latency : frames the renderer may lag behind the update
+    void set_render_mode(render_mode mode, uint32_t latency = 1) { render_mode_ = mode; render_latency_ = latency; }
+    // parses the model on the workers, and uploads it with the other models of the frame
+    // on_loaded runs on the engine's thread once the model is resident (now if it already is)
+    // on_failed runs there instead with the error if the model can't be loaded. the error is printed if it is empty
+    static void load_mesh_model_async(
+      const std::string& model_name,
+      std::function<void(graphics::mesh_model&)>&& on_loaded = {},
+      std::function<void(const std::string&)>&& on_failed = {});
+    // the meshlets are separated on the workers
+    static void load_meshlet_model_async(
+      const std::string& model_name,
+      std::function<void(graphics::meshlet_model&)>&& on_loaded = {},
+      std::function<void(const std::string&)>&& on_failed = {});
+    // runs every frame after the actors' updates, in the order of addition
+    void add_ecs_system(std::function<void(utils::ecs_world&, float)>&& system)
+    { ecs_systems_.emplace_back(std::move(system)); }
+    // call when the accesses declared by the active actors change
+    void invalidate_update_plan() { is_update_plan_dirty_ = true; }
 
 #ifndef IMGUI_DISABLED
 
@@ -117,11 +195,23 @@ class engine {
     void process_input();
 
     void update();
+    void update_actors(float dt);
+    void build_update_plan();
 
     // engine spacific update
     virtual void update_game(float dt) {}
 
     void render();
+    void run_serial();
+    // falls back to run_serial() if a system which can't render from a snapshot is added
+    void run_pipelined();
+    // the frames in flight may still refer to the actor's render targets
+    void retire_actor(s_ptr<actor>&& dead);
+    // adds the rows the capture reads to the entity
+    static void add_render_state(utils::entity e, renderable_component& comp);
+    // the matrices of the render targets, after the physics wrote the poses
+    void update_world_transforms();
+    void release_retired_actors();
 
 #ifndef IMGUI_DISABLED
 
@@ -146,6 +236,26 @@ class engine {
     // use filenames as the key of the map
     void load_models();
     static void load_model(const std::string& model_name, utils::shading_type type);
+    // the models loaded asynchronously
+    static graphics::upload_batch& get_upload_batch();
+    // submits the uploads recorded in this frame, and commits the models whose uploads are complete
+    static void update_model_uploads();
+    static void add_loading_callback(
+      utils::shading_type type,
+      const std::string& model_name,
+      std::function<void()>&& on_loaded,
+      std::function<void(const std::string&)>&& on_failed);
+    // runs the on_loaded callbacks of a model on its completion
+    static void finish_loading(utils::shading_type type, const std::string& model_name);
+    // runs the on_failed callbacks of a model, called on the main thread
+    static void fail_loading(utils::shading_type type, const std::string& model_name, const std::string& error);
+    // registers a model of the map to the residency manager
+    template <typename Model>
+    static void track_model(utils::shading_type type, const std::string& model_name, graphics_model_map<Model>& map);
+    static utils::residency_id get_model_residency(utils::shading_type type, const std::string& model_name)
+    { return model_residencies_.at({ type, model_name }); }
+    // the frames in flight may still draw the evicted models
+    void release_retired_models();
 
     // glfw
     static void set_glfw_mouse_button_callbacks();
@@ -154,10 +264,37 @@ class engine {
 
     // actors
     static actor_map active_actor_map_;
-    static actor_map pending_actor_map_;
-    static std::vector<actor_id> dead_actor_ids_;
+    static std::vector<s_ptr<actor>> pending_actors_;
+    // actors may be created by the parallel updates
+    static std::mutex pending_actor_mutex_;
+    static std::vector<actor_handle> dead_actor_handles_;
+
+    // active actors in the order of the ids, and the batches of their updates
+    std::vector<actor*>   update_order_;
+    utils::update_batches update_batches_;
+    bool                  is_update_plan_dirty_ = true;
+    update_mode           update_mode_ = update_mode::PARALLEL;
+
+    render_mode render_mode_    = render_mode::SERIAL;
+    uint32_t    render_latency_ = 1;
+    // while run_pipelined() runs
+    utils::frame_pipeline<render_snapshot>* render_pipeline_ = nullptr;
+    // set by add_shading_system(), the pipeline safety is checked again
+    static bool is_shading_system_added_;
+    // dead actors, and the count of written frames when they died
+    std::deque<std::pair<uint64_t, s_ptr<actor>>> retired_actors_;
+
+    // outlives the engine, for the actors held elsewhere
+    static utils::ecs_world ecs_world_;
+    static u_ptr<audio::audio_thread> audio_thread_;
+    std::vector<std::function<void(utils::ecs_world&, float)>> ecs_systems_;
+    // the render rows of the lights without an owner actor
+    std::unordered_map<component_id, utils::scoped_entity> light_entities_;
 
     // modules
+    static u_ptr<utils::job_system> job_system_;
+    static u_ptr<utils::frame_scheduler> frame_scheduler_;
+    double frame_budget_ms_ = 2.0;
     static u_ptr<graphics_engine> graphics_engine_;
     u_ptr<physics_engine>         physics_engine_;
 
@@ -172,10 +309,37 @@ class engine {
     static graphics_model_map<graphics::frame_anim_mesh_model>    frame_anim_mesh_model_map_;
     static graphics_model_map<graphics::frame_anim_meshlet_model> frame_anim_meshlet_model_map_;
 
+    // the uploads of a frame, and the steps adding their models to the maps
+    struct model_upload
+    {
+      // destroyed after the batch, which waits for the transfer
+      std::vector<std::function<void()>> commits;
+      u_ptr<graphics::upload_batch>      batch;
+    };
+    struct loading_callback
+    {
+      std::function<void()>                   on_loaded;
+      std::function<void(const std::string&)> on_failed;
+    };
+    // callbacks of the models being loaded, by shading type and name
+    static std::map<std::pair<utils::shading_type, std::string>, std::vector<loading_callback>> loading_models_;
+    // recorded by the main thread jobs of this frame
+    static model_upload              recording_upload_;
+    static std::deque<model_upload>  submitted_uploads_;
+
+    // outlives the engine, for the handles held elsewhere
+    static utils::residency_manager  residency_manager_;
+    static std::map<std::pair<utils::shading_type, std::string>, utils::residency_id> model_residencies_;
+    static std::map<std::pair<utils::shading_type, std::string>, int> model_priorities_;
+    // evicted models, and the frame of their eviction
+    static std::deque<std::pair<uint64_t, s_ptr<void>>> retired_models_;
+
     bool is_updating_ = false; // for update
     bool is_running_ = false; // for run loop
 
     std::chrono::system_clock::time_point current_time_;
+    // dt of the last update. the physics slices it into fixed steps
+    float frame_dt_ = 0.f;
 
     // for rendering systems
     utils::viewer_info  viewer_info_;
@@ -7,6 +7,7 @@
 #include <graphics/descriptor_set_layout.hpp>
 #include <graphics/buffer.hpp>
 #include <game/components/renderable_component.hpp>
+#include <game/render_snapshot.hpp>
 #include <utils/rendering_utils.hpp>
 
 // std
@@ -31,18 +32,22 @@ class graphics_engine
     graphics_engine(const graphics_engine &) = delete;
     graphics_engine &operator= (const graphics_engine &) = delete;
 
+    // capture and render on this thread
     void render(const utils::viewer_info& _viewer_info, const utils::frustum_info& _frustum_info);
+    // game thread : copies the render states of the ecs world and the lights into the snapshot
+    void capture(render_snapshot& snapshot, const utils::viewer_info& _viewer_info, const utils::frustum_info& _frustum_info);
+    // records and submits a frame. only reads the snapshot, so it can run on the render thread
+    void render(const render_snapshot& snapshot);
+    // false if a shading system can't render from a snapshot
+    static bool is_pipeline_safe();
 
     void configure_shading_system();
     static void add_shading_system(u_ptr<shading_system>&& shading_system);
-    static void add_renderable_component(renderable_component &comp);
-    static void remove_renderable_component(const renderable_component &comp);
-    static void remove_renderable_component(utils::shading_type type, component_id id);
     static bool check_shading_system_exists(utils::shading_type type);
 
     inline void wait_idle() { vkDeviceWaitIdle(device_->get_device()); }
-    void update_ubo(int frame_index)
-    { ubo_buffers_[frame_index]->write_to_buffer(&ubo_); ubo_buffers_[frame_index]->flush(); }
+    void update_ubo(int frame_index, const utils::global_ubo& ubo)
+    { ubo_buffers_[frame_index]->write_to_buffer((void*)&ubo); ubo_buffers_[frame_index]->flush(); }
 
     inline graphics::device&     get_device_r()     { return *device_; }
     inline graphics::renderer&   get_renderer_r()   { return *renderer_; }
@@ -64,10 +69,14 @@ class graphics_engine
     u_ptr<graphics::renderer> renderer_;
 
     static shading_system_map shading_systems_;
+    static std::vector<u_ptr<shading_system>> replaced_shading_systems_;
 
     // shared between multiple system
     u_ptr<graphics::descriptor_pool>       global_pool_;
+    // written by the game thread (lights), copied into the snapshots
     utils::global_ubo                      ubo_{};
+    render_snapshot                        serial_snapshot_;
+    uint64_t                               frame_number_ = 0;
     std::vector<u_ptr<graphics::buffer>>   ubo_buffers_ {graphics::swap_chain::MAX_FRAMES_IN_FLIGHT};
     u_ptr<graphics::descriptor_set_layout> global_set_layout_;
     std::vector<VkDescriptorSet>           global_descriptor_sets_ {graphics::swap_chain::MAX_FRAMES_IN_FLIGHT};
@@ -2,25 +2,74 @@
 
 // hnll
 #include <utils/common_using.hpp>
+#include <utils/fixed_timestep.hpp>
+#include <utils/slot_map.hpp>
+
+// std
+#include <vector>
+#include <algorithm>
 
 namespace hnll {
 
 // forward declaration
-namespace physics { class collision_detector; }
+namespace physics {
+class collision_detector;
+class contact_manager;
+class contact_solver;
+struct collision_info;
+struct rigid_body;
+struct solver_settings;
+}
 
 namespace game {
 
+using actor_id     = unsigned int;
+using actor_handle = utils::slot_handle;
+
 class physics_engine {
   public:
-    physics_engine() = default;
-    ~physics_engine() = default;
+    physics_engine();
+    ~physics_engine();
+
+    // runs the fixed steps which fit in the frame time,
+    // then writes the dynamic bodies' poses interpolated between the last two steps for the rendering
+    // and re-updates the colliding actors once
+    void re_update(float frame_dt);
 
-    void re_update();
+    void adjust_intersection(const std::vector<physics::collision_info>& collision_info_list);
 
-    void adjust_intersection();
+    // called by the engine when the actor is activated
+    void activate_actor(actor_id id, actor_handle handle);
+    // drops the contacts of the actor's bodies and unregisters them. called by the engine when the actor is removed
+    void remove_actor(actor_id id);
+
+    // getter
+    physics::contact_solver&  get_contact_solver()  { return *contact_solver_; }
+    physics::contact_manager& get_contact_manager() { return *contact_manager_; }
+    utils::fixed_timestep&    get_timestep()        { return timestep_; }
+    int                       get_substep_count()   const { return substep_count_; }
+
+    // setter
+    // each fixed step is divided into substep_count solver steps
+    void set_substep_count(int count) { substep_count_ = std::max(count, 1); }
 
   private:
+    // detects collisions and solves the contacts of the dynamic bodies
+    void step(double dt);
+    void keep_latest_collisions();
+    // rebuilds the rigid_state rows of the active actors if a component or an actor is added or removed
+    void sync_rigid_states();
+
     static u_ptr<physics::collision_detector> collision_detector_;
+    u_ptr<physics::contact_manager> contact_manager_;
+    u_ptr<physics::contact_solver>  contact_solver_;
+    utils::fixed_timestep           timestep_;
+    int                             substep_count_ = 1;
+    std::vector<physics::rigid_body*> bodies_;
+    uint64_t                          synced_version_ = ~0ull;
+    bool                              is_rigid_state_dirty_ = true;
+    // collisions of the substeps of this frame, dispatched and cleared at its end
+    std::vector<physics::collision_info> collision_info_list_;
 };
 
-}} // namespace hnll::game
\ No newline at end of file
+}} // namespace hnll::game
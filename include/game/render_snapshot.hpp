@@ -0,0 +1,49 @@
+#pragma once
+
+// hnll
+#include <utils/rendering_utils.hpp>
+
+// std
+#include <cstdint>
+#include <map>
+#include <vector>
+
+namespace hnll::game {
+
+// forward declaration
+class renderable_component;
+class shading_system;
+
+// the state of a render target the renderer needs, copied on the game thread
+struct render_item
+{
+  // only its immutable data (models, meshes) is read by the renderer
+  // the engine keeps the removed targets alive until the frames which refer to them are rendered
+  renderable_component* target;
+  mat4     model_matrix;
+  mat4     normal_matrix;
+  // for the animated targets
+  uint32_t animation_index = 0;
+  uint32_t frame_index     = 0;
+};
+
+using render_item_list = std::vector<render_item>;
+
+// everything a frame is rendered from. written by the game thread, then read by the render thread
+struct render_snapshot
+{
+  uint64_t            frame_number = 0;
+  utils::viewer_info  viewer;
+  utils::frustum_info frustum;
+  // the lights written by the game
+  utils::global_ubo   ubo;
+  // by shading_type, in the rendering order
+  std::map<uint32_t, render_item_list> items;
+  // the systems at the capture. the game thread may add systems while the frame is rendered
+  std::map<uint32_t, shading_system*>  systems;
+
+  // keeps the capacities, the snapshots are reused
+  void clear() { for (auto& kv : items) kv.second.clear(); systems.clear(); }
+};
+
+} // namespace hnll::game
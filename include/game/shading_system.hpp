@@ -4,14 +4,13 @@
 #include <graphics/device.hpp>
 #include <graphics/pipeline.hpp>
 #include <game/components/renderable_component.hpp>
+#include <game/render_snapshot.hpp>
 #include <utils/rendering_utils.hpp>
 
 namespace hnll {
 
 namespace game {
 
-using render_target_map = std::unordered_map<component_id, renderable_component&>;
-
 class shading_system
 {
   public:
@@ -23,12 +22,13 @@ class shading_system
     shading_system(shading_system &&) = default;
     shading_system &operator=(shading_system &&) = default;
 
-    virtual void render(const utils::frame_info& frame_info){}
-
-    void add_render_target(component_id id, renderable_component& target)
-    { render_target_map_.emplace(id, target); }
-    void remove_render_target(component_id id)
-    { render_target_map_.erase(id); }
+    // records the commands of the captured items. may run on the render thread
+    virtual void render(const utils::frame_info& frame_info, const render_item_list& items){}
+    // called on the game thread for each target of this system, with its matrices filled
+    // copies the rest of the state render() needs into item. false skips the target this frame
+    virtual bool capture(render_item& item) { return true; }
+    // false if render() reads the state the game thread writes, which prevents the pipelined rendering
+    virtual bool is_pipeline_safe() const { return true; }
 
     // getter
     utils::shading_type          get_shading_type()   const   { return shading_type_; }
@@ -66,7 +66,6 @@ class shading_system
 
     // shading system is called in rendering_type-order at rendering process
     utils::shading_type   shading_type_;
-    render_target_map     render_target_map_;
 };
 
 // impl
@@ -13,7 +13,9 @@ class frame_anim_mesh_shading_system : public shading_system
 
     explicit frame_anim_mesh_shading_system(graphics::device& device);
 
-    void render(const utils::frame_info& frame_info) override;
+    void render(const utils::frame_info& frame_info, const render_item_list& items) override;
+    // with the animation frame of each target
+    bool capture(render_item& item) override;
 };
 
 }} // namespace hnll::game
\ No newline at end of file
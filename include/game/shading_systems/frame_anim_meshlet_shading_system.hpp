@@ -12,7 +12,9 @@ class frame_anim_meshlet_shading_system : public shading_system
   public:
     static u_ptr<frame_anim_meshlet_shading_system> create(graphics::device& device);
     explicit frame_anim_meshlet_shading_system(graphics::device& device);
-    void render(const utils::frame_info& frame_info) override;
+    void render(const utils::frame_info& frame_info, const render_item_list& items) override;
+    // with the animation frame of each target
+    bool capture(render_item& item) override;
   private:
     void setup_task_desc();
 
@@ -13,7 +13,7 @@ class grid_shading_system : public shading_system
 
     explicit grid_shading_system(graphics::device& device);
 
-    void render(const utils::frame_info& frame_info) override;
+    void render(const utils::frame_info& frame_info, const render_item_list& items) override;
 };
 
 }} // namespace hnll::game
\ No newline at end of file
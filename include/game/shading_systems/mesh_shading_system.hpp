@@ -13,7 +13,9 @@ class mesh_shading_system : public shading_system
 
     explicit mesh_shading_system(graphics::device& device);
 
-    void render(const utils::frame_info& frame_info) override;
+    void render(const utils::frame_info& frame_info, const render_item_list& items) override;
+    // skips the targets which are not marked to be drawn
+    bool capture(render_item& item) override;
 };
 
 }} // namespace hnll::game
\ No newline at end of file
@@ -16,7 +16,9 @@ class skinning_model_shading_system : public shading_system
     explicit skinning_model_shading_system(graphics::device& device);
     ~skinning_model_shading_system();
 
-    void render(const utils::frame_info& frame_info) override;
+    void render(const utils::frame_info& frame_info, const render_item_list& items) override;
+    // the skinning models are updated by the game thread while they are drawn
+    bool is_pipeline_safe() const override { return false; }
 };
 
 }} // namespace hnll::game
\ No newline at end of file
@@ -11,6 +11,6 @@ class wire_frustum_shading_system : public shading_system
   public:
     static u_ptr<wire_frustum_shading_system> create(graphics::device& device);
     wire_frustum_shading_system(graphics::device& device);
-    void render(const utils::frame_info& frame_info) override;
+    void render(const utils::frame_info& frame_info, const render_item_list& items) override;
 };
 }} // namespace hnll::game
\ No newline at end of file
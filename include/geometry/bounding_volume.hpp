@@ -9,11 +9,14 @@
 // std
 #include <memory>
 #include <vector>
+#include <span>
 // lib
 #include <eigen3/Eigen/Dense>
 
 namespace hnll {
 
+namespace utils { class job_system; }
+
 using vec3d = Eigen::Vector3d;
 
 namespace geometry {
@@ -22,14 +25,31 @@ namespace geometry {
 enum class bv_type
 {
   SPHERE,
-  AABB
+  AABB,
+  CONVEX_HULL,
+  SPHERE_TREE
 };
 
+// forward declaration
+class convex_hull;
+class sphere_tree;
+
 enum class bv_ctor_type
 {
   RITTER,
 };
 
+// strided view over float vertex data (e.g. graphics::vertex::position)
+// each element starts with x, y, z. stride is counted in floats.
+struct position_span
+{
+  std::span<const float> data;
+  size_t stride = 3;
+
+  inline size_t size()                  const { return stride == 0 ? 0 : data.size() / stride; }
+  inline const float* operator[](size_t i) const { return data.data() + i * stride; }
+};
+
 class bounding_volume
 {
   public:
@@ -46,6 +66,18 @@ class bounding_volume
     static u_ptr<bounding_volume> create_blank_aabb(const vec3d& initial_point = {0.f, 0.f, 0.f}); // for mesh separation
     static u_ptr<bounding_volume> create_bounding_sphere(bv_ctor_type type, const std::vector<vec3d> &vertices);
     static u_ptr<bounding_volume> ritter_ctor(const std::vector<vec3d> &vertices);
+    // zero-copy ctors. the chunks of the positions are processed by the jobs if jobs isn't nullptr
+    static u_ptr<bounding_volume> create_aabb(const position_span& positions, utils::job_system* jobs = nullptr);
+    static u_ptr<bounding_volume> create_bounding_sphere(bv_ctor_type type, const position_span& positions, utils::job_system* jobs = nullptr);
+    static u_ptr<bounding_volume> ritter_ctor(const position_span& positions, utils::job_system* jobs = nullptr);
+    // hull can be shared by every actor of the same model
+    static u_ptr<bounding_volume> create_convex_hull(const s_ptr<convex_hull>& hull);
+    // same as above
+    static u_ptr<bounding_volume> create_sphere_tree(const s_ptr<sphere_tree>& tree);
+
+    // farthest point along the direction in world space (for gjk)
+    // sphere tree is approximated by its root sphere
+    vec3d support(const vec3d& direction) const;
 
     // getter
     inline bv_type get_bv_type() const      { return bv_type_; }
@@ -56,6 +88,11 @@ class bounding_volume
     inline double get_sphere_radius()    const { return radius_.x(); }
     inline bool is_sphere()              const { return bv_type_ == bv_type::SPHERE; }
     inline bool is_aabb()                const { return bv_type_ == bv_type::AABB; }
+    inline bool is_convex_hull()         const { return bv_type_ == bv_type::CONVEX_HULL; }
+    inline bool is_sphere_tree()         const { return bv_type_ == bv_type::SPHERE_TREE; }
+    inline const s_ptr<convex_hull>& get_convex_hull() const { return convex_hull_; }
+    inline const s_ptr<sphere_tree>& get_sphere_tree() const { return sphere_tree_; }
+    inline const utils::transform&   get_transform()   const { return *transform_; }
     // aabb getter
     inline double get_max_x() const { return center_point_.x() + radius_.x(); }
     inline double get_min_x() const { return center_point_.x() - radius_.x(); }
@@ -75,6 +112,10 @@ class bounding_volume
     // if bv_type == SPHERE, only radius_.x() is valid.
     vec3d radius_;
     s_ptr<utils::transform> transform_;
+    // valid if bv_type == CONVEX_HULL. center_point_ and radius_ hold its local aabb
+    s_ptr<convex_hull> convex_hull_;
+    // valid if bv_type == SPHERE_TREE. center_point_ and radius_ hold its root sphere
+    s_ptr<sphere_tree> sphere_tree_;
 };
 
 // support functions
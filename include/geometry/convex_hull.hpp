@@ -0,0 +1,56 @@
+#pragma once
+
+// std
+#include <memory>
+#include <vector>
+#include <array>
+
+// lib
+#include <eigen3/Eigen/Dense>
+
+namespace hnll {
+
+template<typename T> using u_ptr = std::unique_ptr<T>;
+template<typename T> using s_ptr = std::shared_ptr<T>;
+using vec3d = Eigen::Vector3d;
+
+namespace geometry {
+
+// forward declaration
+struct position_span;
+
+// convex hull computed by quickhull
+// vertices and faces are in the local space of the source mesh
+class convex_hull
+{
+  public:
+    using triangle = std::array<uint32_t, 3>;
+
+    static s_ptr<convex_hull> create(const std::vector<vec3d>& points);
+    static s_ptr<convex_hull> create(const position_span& positions);
+
+    convex_hull(std::vector<vec3d>&& vertices, std::vector<triangle>&& faces);
+
+    // returns the index of the vertex farthest along the direction
+    uint32_t support_index(const vec3d& direction) const;
+    const vec3d& support(const vec3d& direction) const { return vertices_[support_index(direction)]; }
+
+    // getter
+    const std::vector<vec3d>&    get_vertices() const { return vertices_; }
+    const std::vector<triangle>& get_faces()    const { return faces_; }
+    size_t get_vertex_count() const { return vertices_.size(); }
+    size_t get_face_count()   const { return faces_.size(); }
+    // faces are empty if the input is flat or degenerate
+    bool   is_degenerate()    const { return faces_.empty(); }
+    vec3d  get_min() const { return min_; }
+    vec3d  get_max() const { return max_; }
+
+  private:
+    std::vector<vec3d>    vertices_;
+    // counter-clockwise seen from outside
+    std::vector<triangle> faces_;
+    vec3d min_;
+    vec3d max_;
+};
+
+}} // namespace hnll::geometry
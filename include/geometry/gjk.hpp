@@ -0,0 +1,70 @@
+#pragma once
+
+// std
+#include <array>
+#include <algorithm>
+
+// lib
+#include <eigen3/Eigen/Dense>
+
+namespace hnll {
+
+using vec3d = Eigen::Vector3d;
+
+namespace geometry {
+
+// forward declaration
+class bounding_volume;
+
+// result of the narrow phase (world space)
+struct contact
+{
+  // from a to b
+  vec3d  normal  = vec3d::Zero();
+  double depth   = 0.0;
+  // deepest point of each shape
+  vec3d  point_a = vec3d::Zero();
+  vec3d  point_b = vec3d::Zero();
+};
+
+// kept for each pair of shapes across frames
+// the last search direction is almost always a separating axis of the next frame,
+// so separated pairs usually exit after one support query
+struct gjk_cache
+{
+  vec3d direction = vec3d::Zero();
+  bool  is_valid  = false;
+};
+
+namespace gjk {
+
+// point of the minkowski difference (a - b) and its witness points
+struct support_point
+{
+  vec3d point;
+  vec3d a;
+  vec3d b;
+};
+
+struct simplex
+{
+  std::array<support_point, 4> points;
+  int size = 0;
+
+  void push_front(const support_point& p)
+  {
+    points = { p, points[0], points[1], points[2] };
+    size = std::min(size + 1, 4);
+  }
+};
+
+support_point minkowski_support(const bounding_volume& a, const bounding_volume& b, const vec3d& direction);
+
+// returns true if the shapes overlap. the final simplex is written to s for epa
+bool test(const bounding_volume& a, const bounding_volume& b, simplex& s, gjk_cache* cache = nullptr);
+
+// expanding polytope algorithm. s should be the simplex of an overlapping test()
+contact epa(const bounding_volume& a, const bounding_volume& b, const simplex& s);
+
+} // namespace gjk
+}} // namespace hnll::geometry
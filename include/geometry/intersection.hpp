@@ -18,12 +18,19 @@ namespace geometry {
 // forward declaration
 class bounding_volume;
 class perspective_frustum;
+struct contact;
+struct gjk_cache;
 struct ray;
 struct vertex;
 struct plane;
 
 namespace intersection {
 
+// a manifold keeps at most this number of contact points
+constexpr size_t MAX_CONTACT_POINTS = 4;
+// vertices within this ratio of the shape's extent from the supporting plane belong to the contact feature
+constexpr double CONTACT_FEATURE_TOLERANCE = 0.02;
+
 // returns the length of intersection
 double test_bounding_volumes(const bounding_volume& a, const bounding_volume& b);
 
@@ -33,7 +40,19 @@ double test_sphere_frustum(const geometry::bounding_volume& sphere, const perspe
 double test_aabb_aabb     (const bounding_volume& aabb_a, const bounding_volume& aabb_b);
 double test_aabb_sphere   (const bounding_volume& aabb, const bounding_volume& sphere);
 double test_sphere_sphere (const bounding_volume& sphere_a, const bounding_volume& sphere_b);
+// returns the distance along the ray direction to the hit point, 0 if they don't intersect
 double test_ray_triangle  (const ray& _ray, const std::vector<vec3d>& vertices);
+// allocation free version for the inner loops of acceleration structures
+// eps : |det| below which the ray is regarded as parallel to the triangle
+double test_ray_triangle  (const ray& _ray, const vec3d& v0, const vec3d& v1, const vec3d& v2, double eps = 1e-6);
+// gjk + epa. works for every bv_type, used if at least one of the pair is a convex hull
+double test_convex_convex (const bounding_volume& a, const bounding_volume& b, gjk_cache* cache = nullptr, contact* out = nullptr);
+// descends the sphere tree(s) and prunes every non-overlapping pair of nodes
+// without out, returns at the first overlapping leaf. otherwise returns the deepest one
+double test_sphere_tree   (const bounding_volume& a, const bounding_volume& b, contact* out = nullptr);
+// clips the contact features of polyhedral shapes (aabb, convex hull) against each other along deepest.normal
+// returns up to MAX_CONTACT_POINTS points. round shapes only have the deepest point
+std::vector<contact> create_contact_manifold(const bounding_volume& a, const bounding_volume& b, const contact& deepest);
 }; // namespace intersection
 
 // helper functions
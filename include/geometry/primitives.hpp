@@ -1,6 +1,7 @@
 #pragma once
 
 // std
+#include <atomic>
 #include <memory>
 #include <unordered_map>
 
@@ -56,8 +57,9 @@ struct face
   {
     auto face_sp = std::make_shared<face>();
     face_sp->half_edge_ = he;
-    static face_id id = 0;
-    face_sp->id_ = id++;
+    // the models are built on several threads (async loading, hnll_cook)
+    static std::atomic<face_id> id = 0;
+    face_sp->id_ = id.fetch_add(1, std::memory_order_relaxed);
     return face_sp;
   }
   face_id id_;
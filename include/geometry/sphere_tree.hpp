@@ -0,0 +1,84 @@
+#pragma once
+
+// std
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <string>
+#include <unordered_map>
+
+// lib
+#include <eigen3/Eigen/Dense>
+
+namespace hnll {
+
+template<typename T> using u_ptr = std::unique_ptr<T>;
+template<typename T> using s_ptr = std::shared_ptr<T>;
+using vec3d = Eigen::Vector3d;
+
+namespace geometry {
+
+// forward declaration
+struct position_span;
+
+struct sphere_tree_node
+{
+  vec3d  center = vec3d::Zero();
+  double radius = 0.0;
+  // two children are stored next to each other. leaf if child_count == 0
+  uint32_t first_child = 0;
+  uint32_t child_count = 0;
+
+  bool is_leaf() const { return child_count == 0; }
+};
+
+// hierarchical bounding spheres of a mesh's triangles (in the local space of the mesh)
+// built offline once per model, then shared by every rigid_component of the model
+class sphere_tree
+{
+  public:
+    static constexpr uint32_t DEFAULT_LEAF_TRIANGLE_COUNT = 8;
+
+    static s_ptr<sphere_tree> create(
+      const position_span& positions,
+      const std::vector<uint32_t>& indices,
+      uint32_t leaf_triangle_count = DEFAULT_LEAF_TRIANGLE_COUNT);
+
+    // returns the tree of the model from memory or the cache file, builds and writes it otherwise
+    static s_ptr<sphere_tree> create_with_cache(
+      const std::string& model_name,
+      const position_span& positions,
+      const std::vector<uint32_t>& indices);
+    // the tree of the model already in memory, nullptr otherwise
+    static s_ptr<sphere_tree> find(const std::string& model_name);
+    // identifies the mesh a cache file was built from
+    static uint64_t hash_source(const position_span& positions, const std::vector<uint32_t>& indices);
+
+    explicit sphere_tree(std::vector<sphere_tree_node>&& nodes) : nodes_(std::move(nodes)) {}
+
+    // sphere tree cache file format
+    /*
+     * model name
+     * source hash (hash_source())
+     * node count
+     * node id (0 ~ node count) :
+     *   center x, center y, center z, radius, first child, child count
+     */
+    // does nothing if HNLL_ENGN isn't set
+    static void write_cache(const sphere_tree& tree, const std::string& model_name, uint64_t source_hash);
+    // returns nullptr if the cache doesn't exist or was built from another mesh
+    static s_ptr<sphere_tree> load_cache(const std::string& model_name, uint64_t source_hash);
+
+    // getter
+    const std::vector<sphere_tree_node>& get_nodes() const { return nodes_; }
+    const sphere_tree_node& get_node(uint32_t id)    const { return nodes_[id]; }
+    const sphere_tree_node& get_root()               const { return nodes_[0]; }
+    size_t get_node_count() const { return nodes_.size(); }
+
+  private:
+    std::vector<sphere_tree_node> nodes_;
+
+    static std::unordered_map<std::string, s_ptr<sphere_tree>> sphere_tree_map_;
+};
+
+}} // namespace hnll::geometry
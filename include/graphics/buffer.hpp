@@ -11,6 +11,9 @@ namespace hnll{
 
 namespace graphics {
 
+  // forward declaration
+  class upload_batch;
+
   class buffer {
     public:
       buffer(
@@ -30,6 +33,7 @@ namespace graphics {
         VkMemoryPropertyFlags memory_property_flags,
         void* writing_data,
         VkDeviceSize min_offset_alignment = 1);
+      // the copy is recorded into the batch if it isn't nullptr, done and waited for otherwise
       static u_ptr<buffer> create_with_staging(
         device& device,
         VkDeviceSize instance_size,
@@ -37,7 +41,8 @@ namespace graphics {
         VkBufferUsageFlags usage_flags,
         VkMemoryPropertyFlags memory_property_flags,
         void* writing_data,
-        VkDeviceSize min_offset_alignment = 1);
+        VkDeviceSize min_offset_alignment = 1,
+        upload_batch* batch = nullptr);
 
       buffer(const buffer&) = delete;
       buffer& operator=(const buffer&) = delete;
@@ -7,6 +7,7 @@
 #include <vulkan/vulkan.hpp>
 
 // std
+#include <mutex>
 #include <string>
 #include <vector>
 #include <optional>
@@ -61,6 +62,8 @@ class device
     VkQueue              get_graphics_queue()       { return graphics_queue_; }
     VkQueue              get_present_queue()        { return present_queue_; }
     queue_family_indices get_queue_family_indices() { return queue_family_indices_; }
+    // held while submitting to or presenting on the queues, which are used by the render and the game threads
+    std::mutex&          get_queue_mutex()          { return queue_mutex_; }
 
     swap_chain_support_details get_swap_chain_support() { return query_swap_chain_support(physical_device_); }
     uint32_t                   find_memory_type(uint32_t type_filter, VkMemoryPropertyFlags properties);
@@ -118,6 +121,7 @@ class device
     queue_family_indices queue_family_indices_; // for hie ctor
     VkQueue graphics_queue_;
     VkQueue present_queue_;
+    std::mutex queue_mutex_;
     VkDebugUtilsMessengerEXT debug_messenger_;
     VkCommandPool command_pool_;
 
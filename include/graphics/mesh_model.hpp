@@ -18,10 +18,13 @@
 #include <functional>
 
 // forward declaration
-namespace hnll::geometry { class mesh_model; }
+namespace hnll::geometry { class mesh_model; struct position_span; }
 
 namespace hnll::graphics {
 
+// forward declaration
+class upload_batch;
+
 template<typename T> using u_ptr = std::unique_ptr<T>;
 template<typename T> using s_ptr = std::shared_ptr<T>;
 
@@ -30,7 +33,8 @@ class mesh_model
   public:
     // compatible with wavefront obj. file
 
-    mesh_model(device& device, const mesh_builder &builder);
+    // batch : records the uploads into it instead of waiting for them. draw after the batch is complete
+    mesh_model(device& device, const mesh_builder &builder, upload_batch* batch = nullptr);
     ~mesh_model();
 
     mesh_model(const mesh_model &) = delete;
@@ -47,10 +51,17 @@ class mesh_model
     // getter
     const std::vector<vertex>&   get_vertex_list() const { return vertex_list_; }
     std::vector<Eigen::Vector3d> get_vertex_position_list() const;
+    // view over vertex_list_'s positions without copy
+    geometry::position_span      get_vertex_position_span() const { return get_position_span(vertex_list_); }
+    // view over the positions of the vertices without copy
+    static geometry::position_span get_position_span(const std::vector<vertex>& vertices);
     unsigned                     get_face_count() const { return index_count_ / 3; }
+    // device buffers and the host copy of the vertices
+    size_t                       get_byte_size() const
+    { return vertex_count_ * sizeof(vertex) * 2 + index_count_ * sizeof(uint32_t); }
   private:
-    void create_vertex_buffers(const std::vector<vertex> &vertices);
-    void create_index_buffers(const std::vector<uint32_t> &indices);
+    void create_vertex_buffers(const std::vector<vertex> &vertices, upload_batch* batch);
+    void create_index_buffers(const std::vector<uint32_t> &indices, upload_batch* batch);
 
     device& device_;
     // contains buffer itself and buffer memory
@@ -4,6 +4,7 @@
 #include <graphics/meshlet_utils.hpp>
 
 // std
+#include <string>
 #include <vector>
 #include <memory>
 #include <stdint.h>
@@ -13,27 +14,47 @@
 #include <vulkan/vulkan.h>
 
 namespace hnll {
+
+// forward declaration
+namespace utils { class asset_package; }
+
 namespace graphics {
 
 // forward declaration
 class device;
 class buffer;
+class upload_batch;
 class descriptor_pool;
 class descriptor_set_layout;
 struct frame_info;
 struct vertex;
 struct mesh_builder;
 
+// the device independent data of a meshlet model
+struct meshlet_model_data
+{
+  std::vector<vertex>  raw_vertices;
+  std::vector<meshlet> meshlets;
+
+  // the package cooked by hnll_cook if it is fresh, otherwise parses and separates the obj file
+  static meshlet_model_data load_asset(const std::string& asset_name);
+  void write_package(utils::asset_package& package) const;
+  // returns false if the package lacks the chunks
+  bool read_package(const utils::asset_package& package);
+};
+
 class meshlet_model
 {
   public:
 
     meshlet_model(std::vector<vertex>&& raw_vertices, std::vector<meshlet>&& meshlets);
 
+    // the buffers are copied by the batch if it isn't nullptr, and can be used once it is complete
     static u_ptr<meshlet_model> create(
       device& _device,
       std::vector<vertex>&&  _raw_vertices,
-      std::vector<meshlet>&& _meshlets
+      std::vector<meshlet>&& _meshlets,
+      upload_batch* batch = nullptr
     );
 
     static u_ptr<meshlet_model> create_from_file(device& _device, std::string _filename);
@@ -51,13 +72,15 @@ class meshlet_model
     inline void* get_meshlets_data()     { return meshlets_.data(); }
     inline uint32_t get_meshlets_count() { return meshlet_count_; }
     std::vector<VkDescriptorSetLayout> get_raw_desc_set_layouts() const;
+    // device buffers and their host copies
+    size_t get_byte_size() const;
 
     static std::vector<u_ptr<descriptor_set_layout>> default_desc_set_layouts(device& _device);
 
   private:
-    void setup_descs(device& _device);
+    void setup_descs(device& _device, upload_batch* batch = nullptr);
     void create_desc_pool(device& _device);
-    void create_desc_buffers(device& _device);
+    void create_desc_buffers(device& _device, upload_batch* batch);
     void create_desc_set_layouts(device& _device);
     void create_desc_sets();
 
@@ -8,6 +8,7 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <span>
 
 namespace hnll{
 
@@ -87,7 +88,8 @@ class pipeline
       VkPipeline get_pipeline() const { return graphics_pipeline_; }
 
     protected:
-      void create_shader_module(const std::vector<char>& code, VkShaderModule* shader_module);
+      // spir-v, 4 byte aligned
+      void create_shader_module(std::span<const std::byte> code, VkShaderModule* shader_module);
 
       device& device_;
       VkPipeline graphics_pipeline_;
@@ -0,0 +1,51 @@
+#pragma once
+
+// hnll
+#include <graphics/device.hpp>
+#include <utils/common_using.hpp>
+
+// std
+#include <vector>
+
+namespace hnll::graphics {
+
+// forward declaration
+class buffer;
+
+// records the staging copies of many models into one command buffer, submitted once without waiting
+// the destination buffers can be used after is_complete() returns true
+// owns its command pool, so it can be recorded while the renderer records its frames
+class upload_batch
+{
+  public:
+    static u_ptr<upload_batch> create(device& device) { return std::make_unique<upload_batch>(device); }
+    explicit upload_batch(device& device);
+    // waits for the transfer
+    ~upload_batch();
+
+    upload_batch(const upload_batch&) = delete;
+    upload_batch& operator=(const upload_batch&) = delete;
+
+    // the staging buffer is kept alive until the transfer is complete
+    void copy_buffer(u_ptr<buffer>&& staging, VkBuffer dst_buffer, VkDeviceSize size);
+    void submit();
+    // true if the submitted copies are done. doesn't block
+    bool is_complete() const;
+
+    // getter
+    bool   is_empty()           const { return staging_buffers_.empty(); }
+    bool   is_submitted()       const { return is_submitted_; }
+    size_t get_copy_count()     const { return staging_buffers_.size(); }
+    VkDeviceSize get_byte_size() const { return byte_size_; }
+
+  private:
+    device&         device_;
+    VkCommandPool   command_pool_   = VK_NULL_HANDLE;
+    VkCommandBuffer command_buffer_ = VK_NULL_HANDLE;
+    VkFence         fence_          = VK_NULL_HANDLE;
+    std::vector<u_ptr<buffer>> staging_buffers_;
+    VkDeviceSize    byte_size_      = 0;
+    bool            is_submitted_   = false;
+};
+
+} // namespace hnll::graphics
@@ -1,12 +1,16 @@
 #pragma once
 
 // std
+#include <string>
 #include <vector>
 
 // lib
 #include <eigen3/Eigen/Dense>
 #include <vulkan/vulkan.h>
 
+// forward declaration
+namespace hnll::utils { class asset_package; class job_system; }
+
 namespace hnll::graphics {
 
 struct vertex
@@ -30,7 +34,14 @@ struct mesh_builder
   std::vector<vertex> vertices{};
   std::vector<uint32_t> indices{};
 
-  void load_model(const std::string& filename);
+  // wavefront obj. parsed in parallel if jobs isn't nullptr
+  void load_model(const std::string& filename, utils::job_system* jobs = nullptr);
+  // the package cooked by hnll_cook if it is fresh, otherwise parses the file
+  void load_asset(const std::string& asset_name, utils::job_system* jobs = nullptr);
+
+  void write_package(utils::asset_package& package) const;
+  // returns false if the package lacks the chunks
+  bool read_package(const utils::asset_package& package);
 };
 
 } // namespace hnll::graphics
@@ -0,0 +1,188 @@
+#pragma once
+
+// std
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// lib
+#include <eigen3/Eigen/Dense>
+
+namespace hnll {
+
+template<typename T> using u_ptr = std::unique_ptr<T>;
+template<typename T> using s_ptr = std::shared_ptr<T>;
+using vec3d = Eigen::Vector3d;
+
+// forward declaration
+namespace utils { class job_system; }
+namespace geometry {
+class  mesh_model;
+struct position_span;
+}
+
+namespace physics {
+
+using acoustic_material_id = uint32_t;
+using acoustic_source_id   = uint32_t;
+using acoustic_receiver_id = uint32_t;
+
+struct acoustic_material
+{
+  // ratio of the energy absorbed by a reflection
+  double absorption = 0.1;
+  // ratio of the reflected energy scattered in a lambertian lobe, the rest is specular
+  double scattering = 0.1;
+};
+
+// geometric acoustics : rays shot from every source bounce on the scene triangles (bvh) and
+// deposit their energy into time histograms of the spherical receivers they cross
+// the direct sound is a shadow ray, so occluded sources lose it
+// the reflected paths of each source are cached, a moved receiver only re-collects them
+// (36 bytes per reflection, about rays x 100 for a plaster room)
+// trace() updates the histograms of every moved source / receiver. rays are traced in parallel
+class acoustic_ray_tracer
+{
+  public:
+    static u_ptr<acoustic_ray_tracer> create() { return std::make_unique<acoustic_ray_tracer>(); }
+
+    acoustic_ray_tracer();
+
+    // material 0 is the default one
+    acoustic_material_id add_material(const acoustic_material& material);
+    // triangles in world space, every source is traced again by the next trace()
+    acoustic_ray_tracer* add_obstacle(const geometry::mesh_model& mesh, acoustic_material_id material = 0);
+    acoustic_ray_tracer* add_obstacle(const geometry::position_span& positions, const std::vector<uint32_t>& indices, acoustic_material_id material = 0);
+    void clear_obstacles();
+
+    acoustic_source_id   add_source(const vec3d& position);
+    acoustic_receiver_id add_receiver(const vec3d& position, double radius = 0.5);
+
+    void trace();
+
+    // energy of each bin relative to the direct sound at 1 m, reflections only
+    const std::vector<double>& get_histogram(acoustic_source_id source, acoustic_receiver_id receiver) const
+    { return sources_[source].paths[receiver].histogram; }
+    // 0 if the direct path is occluded
+    double get_direct_energy(acoustic_source_id source, acoustic_receiver_id receiver) const
+    { return sources_[source].paths[receiver].direct_energy; }
+    double get_direct_delay(acoustic_source_id source, acoustic_receiver_id receiver) const
+    { return sources_[source].paths[receiver].direct_delay; }
+    // pressure impulse response : the direct sound as a single tap and the histogram as shaped noise
+    std::vector<float> create_impulse_response(
+      acoustic_source_id source,
+      acoustic_receiver_id receiver,
+      double sampling_rate,
+      uint32_t seed = 1) const;
+
+    // returns the distance to the nearest triangle along the normalized direction, 0 if nothing is hit
+    double cast_ray(const vec3d& origin, const vec3d& direction);
+
+    // getter
+    size_t   get_triangle_count() const { return triangle_material_.size(); }
+    size_t   get_node_count()     const { return nodes_.size(); }
+    // cached reflection segments of every source
+    size_t   get_segment_count()  const;
+    uint32_t get_ray_count()      const { return ray_count_; }
+    double   get_bin_width()      const { return bin_width_; }
+    size_t   get_bin_count()      const { return static_cast<size_t>(max_time_ / bin_width_) + 1; }
+    const vec3d& get_source_position(acoustic_source_id id)     const { return sources_[id].position; }
+    const vec3d& get_receiver_position(acoustic_receiver_id id) const { return receivers_[id].position; }
+
+    // setter
+    // the setters of the tracing parameters retrace every source
+    acoustic_ray_tracer* set_ray_count(uint32_t count);
+    acoustic_ray_tracer* set_max_order(uint32_t order);
+    acoustic_ray_tracer* set_max_time(double seconds);
+    acoustic_ray_tracer* set_bin_width(double seconds);
+    acoustic_ray_tracer* set_sound_speed(double speed);
+    acoustic_ray_tracer* set_seed(uint64_t seed);
+    // the chunks of the rays are traced by the jobs. nullptr traces them on the caller's thread
+    acoustic_ray_tracer* set_job_system(utils::job_system* jobs) { jobs_ = jobs; return this; }
+    void set_source_position(acoustic_source_id id, const vec3d& position);
+    void set_receiver_position(acoustic_receiver_id id, const vec3d& position);
+
+  private:
+    struct triangle
+    {
+      vec3d v0, v1, v2;
+    };
+
+    // leaves have count > 0 and own the triangles [first, first + count)
+    // inner nodes have count == 0, their children are this + 1 and first
+    struct bvh_node
+    {
+      Eigen::Vector3f min;
+      Eigen::Vector3f max;
+      uint32_t first = 0;
+      uint32_t count = 0;
+    };
+
+    // a straight piece of a reflected path
+    struct segment
+    {
+      Eigen::Vector3f origin;
+      Eigen::Vector3f direction;
+      // path length from the source to the origin
+      float distance;
+      float length;
+      float energy;
+    };
+
+    struct path
+    {
+      std::vector<double> histogram;
+      double direct_energy = 0.0;
+      double direct_delay  = 0.0;
+    };
+
+    struct source
+    {
+      vec3d position;
+      std::vector<segment> segments;
+      // one per receiver
+      std::vector<path> paths;
+      bool is_dirty = true;
+    };
+
+    struct receiver
+    {
+      vec3d  position;
+      double radius;
+      bool   is_dirty = true;
+    };
+
+    struct hit
+    {
+      double   distance = 0.0;
+      uint32_t triangle = 0;
+    };
+
+    void build_bvh();
+    uint32_t build_node(uint32_t first, uint32_t count, std::vector<uint32_t>& order, const std::vector<Eigen::Vector3f>& centroids);
+    bool intersect(const vec3d& origin, const vec3d& direction, double max_distance, hit& result) const;
+
+    void trace_source(source& s);
+    void collect(const source& s, const receiver& r, path& p) const;
+    void mark_sources_dirty();
+
+    std::vector<acoustic_material> materials_;
+    std::vector<triangle> triangles_;
+    std::vector<acoustic_material_id> triangle_material_;
+    std::vector<bvh_node> nodes_;
+    bool is_bvh_dirty_ = true;
+
+    std::vector<source>   sources_;
+    std::vector<receiver> receivers_;
+
+    uint32_t ray_count_    = 8192;
+    uint32_t max_order_    = 256;
+    double   max_time_     = 2.0;
+    double   bin_width_    = 1e-3;
+    double   sound_speed_  = 343.0;
+    uint64_t seed_         = 1;
+    utils::job_system* jobs_ = nullptr;
+};
+
+}} // namespace hnll::physics
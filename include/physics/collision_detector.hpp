@@ -6,6 +6,8 @@
 // std
 #include <vector>
 #include <memory>
+#include <unordered_map>
+#include <cstdint>
 
 namespace hnll {
 
@@ -13,21 +15,40 @@ namespace hnll {
 namespace game {
 class rigid_component;
 using rigid_component_id = unsigned;
+using actor_id           = unsigned int;
 }
+namespace geometry { struct gjk_cache; }
 
 namespace physics {
 
 // forward declaration
 class collision_info;
+class contact_manager;
 
 class collision_detector
 {
   public:
-    static std::vector<collision_info> intersection_test();
+    // the pairs with a dynamic body also update their manifolds in contacts if it is given
+    static std::vector<collision_info> intersection_test(contact_manager* contacts = nullptr);
 
-    static void add_rigid_component(const s_ptr<game::rigid_component>& comp) { rigid_components_.push_back(comp); }
+    static void add_rigid_component(const s_ptr<game::rigid_component>& comp) { rigid_components_.push_back(comp); version_++; }
+    // removes the components of the actor
+    static void remove_rigid_components(game::actor_id owner);
+
+    // getter
+    static const std::vector<s_ptr<game::rigid_component>>& get_rigid_components() { return rigid_components_; }
+    // changes on each addition and removal
+    static uint64_t get_version() { return version_; }
   private:
+    // gjk warm start data of a convex pair, and the step it was last used in
+    struct cached_pair;
+
     static std::vector<s_ptr<game::rigid_component>> rigid_components_;
+    // keyed by the pair of rigid_component_ids. the pairs not tested in a step are evicted,
+    // including the pairs of the removed bodies
+    static std::unordered_map<uint64_t, cached_pair> gjk_caches_;
+    static uint64_t step_count_;
+    static uint64_t version_;
 };
 
 }} // namespace hnll::physics
\ No newline at end of file
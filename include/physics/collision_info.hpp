@@ -1,5 +1,8 @@
 #pragma once
 
+// hnll
+#include <utils/slot_map.hpp>
+
 // lib
 #include <eigen3/Eigen/Dense>
 
@@ -7,7 +10,7 @@ namespace hnll{
 
 using vec3d = Eigen::Vector3d;
 
-namespace game { using actor_id = unsigned int; }
+namespace game { using actor_handle = utils::slot_handle; }
 
 namespace physics {
 
@@ -16,8 +19,11 @@ struct collision_info
   double mass;
   vec3d  velocity;
   double intersection_depth;
-  game::actor_id actor_a;
-  game::actor_id actor_b;
+  game::actor_handle actor_a;
+  game::actor_handle actor_b;
+  // filled by the convex narrow phase (zero otherwise)
+  vec3d  normal        = vec3d::Zero(); // from actor_a to actor_b
+  vec3d  contact_point = vec3d::Zero();
 };
 
 }} // namespace hnll::physics
\ No newline at end of file
@@ -0,0 +1,99 @@
+#pragma once
+
+// hnll
+#include <utils/common_using.hpp>
+
+// lib
+#include <eigen3/Eigen/Dense>
+
+// std
+#include <array>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+namespace hnll {
+
+using vec3d = Eigen::Vector3d;
+
+namespace geometry { struct contact; }
+
+namespace physics {
+
+// forward declaration
+struct rigid_body;
+
+struct manifold_point
+{
+  // anchors in the local space of each body, used to match the points of the next frame
+  vec3d  local_a = vec3d::Zero();
+  vec3d  local_b = vec3d::Zero();
+  // world space
+  vec3d  point_a = vec3d::Zero();
+  vec3d  point_b = vec3d::Zero();
+  vec3d  normal  = vec3d::Zero(); // from a to b
+  double depth   = 0.0;
+  // accumulated impulses, carried over frames for warm starting
+  double normal_impulse = 0.0;
+  std::array<double, 2> tangent_impulse = { 0.0, 0.0 };
+  // scratch of the solver
+  vec3d  r_a = vec3d::Zero();
+  vec3d  r_b = vec3d::Zero();
+  std::array<vec3d, 2>  tangents;
+  double normal_mass = 0.0;
+  std::array<double, 2> tangent_mass = { 0.0, 0.0 };
+  double velocity_bias = 0.0;
+};
+
+// persistent contact of a pair of bodies (body_a->id < body_b->id)
+struct contact_manifold
+{
+  rigid_body* body_a = nullptr;
+  rigid_body* body_b = nullptr;
+  std::array<manifold_point, 4> points;
+  int      point_count = 0;
+  double   friction    = 0.0;
+  double   restitution = 0.0;
+  uint64_t last_frame  = 0;
+  // scratch of the solver
+  int      island = -1;
+};
+
+// keeps a manifold for each touching pair across frames
+// the narrow phase replaces the points every frame, and the accumulated impulses of
+// the points which stay at the same place are inherited (warm starting)
+class contact_manager
+{
+  public:
+    static u_ptr<contact_manager> create() { return std::make_unique<contact_manager>(); }
+
+    contact_manager() = default;
+
+    static uint64_t pair_key(uint32_t a, uint32_t b)
+    { return a < b ? (static_cast<uint64_t>(a) << 32) | b : (static_cast<uint64_t>(b) << 32) | a; }
+
+    void begin_frame() { frame_++; }
+    // contacts are from a to b
+    void update_manifold(rigid_body& a, rigid_body& b, const std::vector<geometry::contact>& contacts);
+    // removes the manifolds which were not updated in this frame
+    // the manifolds of sleeping pairs are kept, since the collision detector skips them
+    void end_frame();
+    void remove_body(uint32_t id);
+
+    // getter
+    std::unordered_map<uint64_t, contact_manifold>&       get_manifolds()       { return manifolds_; }
+    const std::unordered_map<uint64_t, contact_manifold>& get_manifolds() const { return manifolds_; }
+    size_t get_manifold_count() const { return manifolds_.size(); }
+    double get_match_distance() const { return match_distance_; }
+
+    // setter
+    void set_match_distance(double distance) { match_distance_ = distance; }
+
+  private:
+    std::unordered_map<uint64_t, contact_manifold> manifolds_;
+    uint64_t frame_ = 0;
+    // points closer than this to a point of the last frame inherit its impulses
+    double match_distance_ = 0.05;
+};
+
+}} // namespace hnll::physics
@@ -0,0 +1,79 @@
+#pragma once
+
+// hnll
+#include <utils/common_using.hpp>
+
+// lib
+#include <eigen3/Eigen/Dense>
+
+// std
+#include <vector>
+
+namespace hnll {
+
+namespace utils { class job_system; }
+
+using vec3d = Eigen::Vector3d;
+
+namespace physics {
+
+// forward declaration
+struct rigid_body;
+struct contact_manifold;
+class  contact_manager;
+
+struct solver_settings
+{
+  vec3d    gravity             = { 0.0, 9.8, 0.0 };
+  int      velocity_iterations = 8;
+  // ratio of the penetration resolved per step (baumgarte stabilization)
+  double   baumgarte           = 0.2;
+  // allowed penetration
+  double   linear_slop         = 0.005;
+  // relative velocity under which the contact doesn't bounce
+  double   restitution_threshold = 1.0;
+  // bodies slower than these for time_to_sleep seconds fall asleep with their island
+  double   linear_sleep_tolerance  = 0.05;
+  double   angular_sleep_tolerance = 0.05;
+  double   time_to_sleep           = 0.5;
+};
+
+// dynamic bodies connected by contacts, solved independently of the others
+struct island
+{
+  std::vector<rigid_body*>       bodies;
+  std::vector<contact_manifold*> manifolds;
+};
+
+// sequential impulse solver with warm starting
+// awake bodies are grouped into islands, which are solved in parallel by the job system and fall asleep as a whole
+class contact_solver
+{
+  public:
+    static u_ptr<contact_solver> create(const solver_settings& settings = {})
+    { return std::make_unique<contact_solver>(settings); }
+
+    explicit contact_solver(const solver_settings& settings = {}) : settings_(settings) {}
+
+    // integrates the awake dynamic bodies by dt
+    // the islands are solved by the jobs if jobs isn't nullptr
+    void step(const std::vector<rigid_body*>& bodies, contact_manager& contacts, double dt, utils::job_system* jobs = nullptr);
+
+    // getter
+    const solver_settings&     get_settings()     const { return settings_; }
+    const std::vector<island>& get_islands()      const { return islands_; }
+    size_t                     get_island_count() const { return islands_.size(); }
+
+    // setter
+    void set_settings(const solver_settings& settings) { settings_ = settings; }
+
+  private:
+    void build_islands(const std::vector<rigid_body*>& bodies, contact_manager& contacts);
+    void solve_island(island& isl, double dt) const;
+
+    solver_settings     settings_;
+    // islands of the last step
+    std::vector<island> islands_;
+};
+
+}} // namespace hnll::physics
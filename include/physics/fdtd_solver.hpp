@@ -1,16 +1,34 @@
 #pragma once
 
+// std
+#include <array>
+#include <cmath>
 #include <vector>
 #include <memory>
+#include <functional>
+#include <cstdint>
+
+// lib
+#include <eigen3/Eigen/Dense>
 
 namespace hnll {
 
 template<typename T> using u_ptr = std::unique_ptr<T>;
 template<typename T> using s_ptr = std::shared_ptr<T>;
+using vec3d = Eigen::Vector3d;
+
+// forward declaration
+namespace utils { class job_system; }
+namespace geometry {
+class  mesh_model;
+struct position_span;
+}
 
 namespace physics {
 
-// temporally one-dimensional implementation
+// staggered-grid (yee) velocity-pressure solver of the linear acoustic wave equation
+// pressure lives at the cell centers and each velocity component on the faces of its axis
+// the outer boundary is rigid, and covered by a split-field pml if pml thickness > 0
 class fdtd_solver
 {
   public:
@@ -18,15 +36,46 @@ class fdtd_solver
 
     fdtd_solver() = default;
 
+    // injects _input into the source cell (one sample per dt) and records the listener cell
     // _duration is in seconds
-    void solve(std::vector<double> _input, double _duration);
+    void solve(const std::vector<double>& _input, double _duration);
+    // advances count steps without any source
+    void step(uint32_t count = 1);
+    // on_step(step index) is called after each step on the caller's thread, and may add pressure for the next step
+    void step(uint32_t count, const std::function<void(uint64_t)>& on_step) { run(count, on_step); }
+    // clears every field, keeps the grid and the obstacles
+    void reset();
 
-    // setter
+    // voxelizes the triangles into obstacle cells (positions are in world space)
+    // closed meshes are filled, open meshes (walls) mark only the cells touched by the surface
+    fdtd_solver* add_obstacle(const geometry::mesh_model& mesh);
+    fdtd_solver* add_obstacle(const geometry::position_span& positions, const std::vector<uint32_t>& indices);
+    fdtd_solver* set_obstacle(uint32_t x, uint32_t y, uint32_t z, bool is_obstacle = true);
+
+    // soft source
+    void add_pressure(uint32_t x, uint32_t y, uint32_t z, double value);
+
+    // getter
     double get_dx()             const { return dx_; }
     double get_dt()             const { return dt_; }
     double get_stiffness()      const { return stiffness_; }
     double get_density_()       const { return density_; }
-    double get_phase_velocity() const { return phase_velocity_; }
+    double get_phase_velocity() const { return phase_velocity_ > 0.0 ? phase_velocity_ : std::sqrt(stiffness_ / density_); }
+    // c dt / dx, should be less than 1 / sqrt(3)
+    double get_courant_number() const { return get_phase_velocity() * dt_ / dx_; }
+    uint32_t get_size_x()       const { return size_x_; }
+    uint32_t get_size_y()       const { return size_y_; }
+    uint32_t get_size_z()       const { return size_z_; }
+    size_t   get_cell_count()   const { return static_cast<size_t>(size_x_) * size_y_ * size_z_; }
+    uint64_t get_step_count()   const { return step_count_; }
+    double get_pressure(uint32_t x, uint32_t y, uint32_t z) const { return pressure_[index(x, y, z)]; }
+    bool   is_obstacle(uint32_t x, uint32_t y, uint32_t z)  const { return open_[index(x, y, z)] == 0.f; }
+    // world space position of the cell center
+    vec3d  get_cell_center(uint32_t x, uint32_t y, uint32_t z) const { return origin_ + dx_ * vec3d(x + 0.5, y + 0.5, z + 0.5); }
+    const std::array<uint32_t, 3>& get_source()   const { return source_; }
+    const std::array<uint32_t, 3>& get_listener() const { return listener_; }
+    // pressure of the listener cell for each step of the last solve()
+    const std::vector<double>& get_output() const { return output_; }
 
     // setter
     fdtd_solver* set_dx(double _dx)             { dx_ = _dx; return this; }
@@ -36,16 +85,60 @@ class fdtd_solver
     fdtd_solver* set_phase_velocity(double _pv) { phase_velocity_ = _pv; return this; }
     fdtd_solver* set_max_stable_dx();
     fdtd_solver* set_min_stable_dt();
+    // reallocates every field
+    fdtd_solver* set_grid_size(uint32_t x, uint32_t y, uint32_t z);
+    // world space position of the minimum corner of the grid
+    fdtd_solver* set_origin(const vec3d& origin)      { origin_ = origin; return this; }
+    fdtd_solver* set_pml_thickness(uint32_t cells)    { pml_thickness_ = cells; return this; }
+    // the slabs are updated by the jobs. nullptr updates them on the caller's thread
+    fdtd_solver* set_job_system(utils::job_system* jobs) { jobs_ = jobs; return this; }
+    fdtd_solver* set_source(uint32_t x, uint32_t y, uint32_t z)   { source_ = { x, y, z }; return this; }
+    fdtd_solver* set_listener(uint32_t x, uint32_t y, uint32_t z) { listener_ = { x, y, z }; return this; }
 
   private:
-    // stable restriction dx_ / dt_ > sqrt(stiffness_ / density_)
-    double dx_;
-    double dt_;
-    double stiffness_;
-    double density_;
+    // fields are padded with a zero plane in front, so the backward differences of the first
+    // cells read zeros instead of branching
+    size_t index(uint32_t x, uint32_t y, uint32_t z) const
+    { return padding_ + (static_cast<size_t>(z) * size_y_ + y) * size_x_ + x; }
+    bool is_pml_cell(uint32_t x, uint32_t y, uint32_t z) const;
+
+    // on_step is called between the steps on the caller's thread
+    void run(uint32_t count, const std::function<void(uint64_t)>& on_step);
+    void update_pml_coefficients();
+    // updates the planes [z_begin, z_end). the velocity of the planes after z_velocity_end should be updated beforehand
+    void update_slab(uint32_t z_begin, uint32_t z_end, uint32_t z_velocity_end);
+    void update_velocity_row(uint32_t y, uint32_t z);
+    void update_pressure_row(uint32_t y, uint32_t z);
+
+    // stable restriction c dt / dx < 1 / sqrt(3)
+    double dx_             = 0.05;
+    double dt_             = 0.05 / 343.0 * 0.5;
+    double stiffness_      = 1.2 * 343.0 * 343.0;
+    double density_        = 1.2;
     double phase_velocity_ = -1.f;
-    std::vector<double> stress_;
-    std::vector<double> particle_velocity_;
+
+    uint32_t size_x_ = 0, size_y_ = 0, size_z_ = 0;
+    size_t   padding_ = 0;
+    vec3d    origin_ = vec3d::Zero();
+    uint32_t pml_thickness_ = 0;
+    utils::job_system* jobs_ = nullptr;
+    uint64_t step_count_    = 0;
+
+    std::vector<float> pressure_;
+    std::vector<float> velocity_x_, velocity_y_, velocity_z_;
+    // split pressure, only the pml cells are used
+    std::vector<float> pressure_x_, pressure_y_, pressure_z_;
+    // 1 for air, 0 for obstacles
+    std::vector<float> open_;
+
+    // per axis update coefficients : field = a * field - b * difference
+    // b of the interior cells is dt / (density dx) for velocity and density c^2 dt / dx for pressure
+    std::array<std::vector<float>, 3> velocity_a_, velocity_b_;
+    std::array<std::vector<float>, 3> pressure_a_, pressure_b_;
+
+    std::array<uint32_t, 3> source_   = { 0, 0, 0 };
+    std::array<uint32_t, 3> listener_ = { 0, 0, 0 };
+    std::vector<double> output_;
 };
 
-}} // namespace hnll::physics
\ No newline at end of file
+}} // namespace hnll::physics
@@ -0,0 +1,87 @@
+#pragma once
+
+// hnll
+#include <utils/spsc_ring.hpp>
+
+// std
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace hnll {
+
+template<typename T> using u_ptr = std::unique_ptr<T>;
+
+namespace physics {
+
+// forward declaration
+class fdtd_solver;
+
+// runs a fdtd_solver on a worker thread at its own dt, and streams the pressure of the receiver
+// cells through lock-free rings (one sample per step). the worker keeps target_latency samples
+// buffered ahead of the consumer, and sleeps while the rings are full enough
+class fdtd_stream
+{
+  public:
+    static constexpr size_t   DEFAULT_RING_CAPACITY    = 1 << 15;
+    static constexpr size_t   DEFAULT_TARGET_LATENCY   = 1 << 12;
+    static constexpr uint32_t DEFAULT_BATCH_STEP_COUNT = 64;
+
+    static u_ptr<fdtd_stream> create(u_ptr<fdtd_solver>&& solver, size_t ring_capacity = DEFAULT_RING_CAPACITY)
+    { return std::make_unique<fdtd_stream>(std::move(solver), ring_capacity); }
+
+    fdtd_stream(u_ptr<fdtd_solver>&& solver, size_t ring_capacity);
+    ~fdtd_stream();
+
+    // receivers should be added while stopped. returns the receiver id
+    uint32_t add_receiver(uint32_t x, uint32_t y, uint32_t z);
+    void start();
+    void stop();
+
+    // producer : excitation of the source cell, one sample per step. returns the number of pushed samples
+    size_t push_input(std::span<const float> samples) { return input_.push(samples.data(), samples.size()); }
+    // consumer : returns the number of popped samples
+    size_t pop_output(uint32_t receiver, std::span<float> samples) { return outputs_[receiver]->pop(samples.data(), samples.size()); }
+
+    // getter
+    // the solver should be touched only while stopped
+    fdtd_solver& get_solver() { return *solver_; }
+    double   get_sampling_rate() const;
+    bool     is_running()        const { return running_; }
+    size_t   get_buffered_count(uint32_t receiver) const { return outputs_[receiver]->size(); }
+    uint64_t get_step_count()    const { return step_count_; }
+    // batches started with less than a quarter of the target latency buffered : the simulation is behind real time
+    uint64_t get_late_batch_count()     const { return late_batch_count_; }
+    // samples lost because a receiver's ring was full
+    uint64_t get_dropped_sample_count() const { return dropped_sample_count_; }
+    size_t   get_target_latency()       const { return target_latency_; }
+
+    // setter
+    // clamped to the ring capacity
+    void set_target_latency(size_t samples);
+    void set_batch_step_count(uint32_t count) { batch_step_count_ = std::max(count, 1u); }
+
+  private:
+    void work();
+    size_t get_min_buffered_count() const;
+
+    u_ptr<fdtd_solver> solver_;
+    size_t ring_capacity_;
+    std::vector<std::array<uint32_t, 3>> receiver_cells_;
+    std::vector<u_ptr<utils::spsc_ring<float>>> outputs_;
+    utils::spsc_ring<float> input_;
+
+    std::thread worker_;
+    std::atomic<bool>     running_ = false;
+    std::atomic<size_t>   target_latency_   = DEFAULT_TARGET_LATENCY;
+    std::atomic<uint32_t> batch_step_count_ = DEFAULT_BATCH_STEP_COUNT;
+    std::atomic<uint64_t> step_count_           = 0;
+    std::atomic<uint64_t> late_batch_count_     = 0;
+    std::atomic<uint64_t> dropped_sample_count_ = 0;
+};
+
+}} // namespace hnll::physics
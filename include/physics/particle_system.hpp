@@ -0,0 +1,89 @@
+#pragma once
+
+// hnll
+#include <utils/common_using.hpp>
+#include <physics/spatial_hash.hpp>
+
+// std
+#include <vector>
+#include <array>
+
+namespace hnll::utils { class job_system; }
+
+namespace hnll::physics {
+
+// particles in structure-of-arrays layout, integrated by simd kernels
+// built-in forces (gravity, drag and the soft repulsion between particles) are applied in batches
+// instead of particle_component's per-object callbacks
+class particle_system
+{
+  public:
+    enum class integrator
+    {
+      SYMPLECTIC_EULER,
+      // position verlet. velocities are derived from the positions
+      VERLET,
+    };
+
+    static u_ptr<particle_system> create(size_t capacity = 0) { return std::make_unique<particle_system>(capacity); }
+
+    explicit particle_system(size_t capacity = 0);
+
+    // returns the id of the particle
+    uint32_t add_particle(const vec3& position, const vec3& velocity = vec3::Zero(), float mass = 1.f);
+    void clear();
+    void reserve(size_t capacity);
+
+    // accumulates the forces of this step, then integrates by dt
+    void update(float dt);
+
+    // external force for the next update
+    void add_force(uint32_t id, const vec3& force)
+    { for (int c = 0; c < 3; c++) force_[c][id] += force[c]; }
+
+    // getter
+    size_t      get_particle_count() const { return inv_mass_.size(); }
+    vec3        get_position(uint32_t id) const { return { position_[0][id], position_[1][id], position_[2][id] }; }
+    vec3        get_velocity(uint32_t id) const { return { velocity_[0][id], velocity_[1][id], velocity_[2][id] }; }
+    // each component is a contiguous array
+    const float* get_positions(int axis)  const { return position_[axis].data(); }
+    const float* get_velocities(int axis) const { return velocity_[axis].data(); }
+    const spatial_hash& get_spatial_hash() const { return spatial_hash_; }
+    integrator  get_integrator() const { return integrator_; }
+
+    // setter
+    void set_integrator(integrator type)          { integrator_ = type; }
+    void set_gravity(const vec3& gravity)         { gravity_ = gravity; }
+    void set_drag(float drag)                     { drag_ = drag; }
+    // particles closer than radius push each other. stiffness 0 disables the neighbour search
+    void set_interaction(float radius, float stiffness) { interaction_radius_ = radius; interaction_stiffness_ = stiffness; }
+    // the chunks of the particles are updated by the jobs. nullptr updates them on the caller's thread
+    void set_job_system(utils::job_system* jobs)  { jobs_ = jobs; }
+    void set_position(uint32_t id, const vec3& p);
+    void set_velocity(uint32_t id, const vec3& v);
+
+  private:
+    void apply_interaction_forces();
+    void integrate(float dt);
+
+    integrator integrator_ = integrator::SYMPLECTIC_EULER;
+    std::array<std::vector<float>, 3> position_;
+    std::array<std::vector<float>, 3> velocity_;
+    std::array<std::vector<float>, 3> force_;
+    // positions of the last step, for verlet
+    std::array<std::vector<float>, 3> previous_position_;
+    std::vector<float> inv_mass_;
+
+    vec3     gravity_               = { 0.f, 9.8f, 0.f };
+    float    drag_                  = 0.f;
+    float    interaction_radius_    = 0.f;
+    float    interaction_stiffness_ = 0.f;
+    utils::job_system* jobs_        = nullptr;
+    // dt of the last verlet step
+    float    last_dt_               = 0.f;
+    spatial_hash spatial_hash_;
+    // positions gathered in the order of spatial_hash_, so the neighbor queries read them contiguously
+    std::array<std::vector<float>, 3> sorted_position_;
+};
+
+} // namespace hnll::physics
@@ -0,0 +1,82 @@
+#pragma once
+
+// hnll
+#include <utils/utils.hpp>
+
+// lib
+#include <eigen3/Eigen/Dense>
+#include <eigen3/Eigen/Geometry>
+
+// std
+#include <cstdint>
+
+namespace hnll {
+
+using vec3d = Eigen::Vector3d;
+
+namespace geometry { class bounding_volume; }
+
+namespace physics {
+
+enum class motion_type
+{
+  // never moves
+  STATIC,
+  // moved by the game through its transform. infinite mass for the solver
+  KINEMATIC,
+  // moved by the solver. owns the transform
+  DYNAMIC,
+};
+
+// simulation state of a rigid_component
+// the center of mass is at the origin of the transform
+struct rigid_body
+{
+  uint32_t    id   = 0;
+  motion_type type = motion_type::STATIC;
+
+  vec3d              position         = vec3d::Zero();
+  Eigen::Quaterniond orientation      = Eigen::Quaterniond::Identity();
+  vec3d              linear_velocity  = vec3d::Zero();
+  vec3d              angular_velocity = vec3d::Zero();
+  // pose before the last step, for the render interpolation
+  vec3d              previous_position    = vec3d::Zero();
+  Eigen::Quaterniond previous_orientation = Eigen::Quaterniond::Identity();
+
+  double inv_mass          = 0.0;
+  // diagonal of the local inverse inertia tensor
+  vec3d  inv_inertia_local = vec3d::Zero();
+  double friction          = 0.5;
+  double restitution       = 0.0;
+  double linear_damping    = 0.0;
+  double angular_damping   = 0.05;
+
+  // seconds while the body has been almost still
+  double sleep_time  = 0.0;
+  bool   is_sleeping = false;
+
+  // scratch of the solver
+  int    solver_index = -1;
+
+  bool is_static()    const { return type == motion_type::STATIC; }
+  bool is_kinematic() const { return type == motion_type::KINEMATIC; }
+  bool is_dynamic()   const { return type == motion_type::DYNAMIC; }
+  // dynamic body which is simulated in this frame
+  bool is_awake()     const { return is_dynamic() && !is_sleeping; }
+
+  Eigen::Matrix3d get_inv_inertia_world() const;
+
+  // mass properties are approximated by the shape's sphere or box
+  void set_mass(double mass, const geometry::bounding_volume& shape, const vec3d& scale = vec3d::Ones());
+  void wake_up() { is_sleeping = false; sleep_time = 0.0; }
+  void sleep()   { is_sleeping = true; linear_velocity.setZero(); angular_velocity.setZero(); }
+
+  void save_previous_pose() { previous_position = position; previous_orientation = orientation; }
+
+  // kinematic bodies derive their velocity from the movement of the transform
+  void read_transform(const utils::transform& tf, double dt = 0.0);
+  // alpha in [0, 1] interpolates from the previous pose to the current one
+  void write_transform(utils::transform& tf, double alpha = 1.0) const;
+};
+
+}} // namespace hnll::physics
@@ -0,0 +1,69 @@
+#pragma once
+
+// std
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cmath>
+
+namespace hnll::physics {
+
+// uniform grid over unbounded space. cells are hashed into a table of 2^k buckets and
+// the particles are counting-sorted by bucket, so a query touches 27 contiguous ranges.
+// neighboring cells along x are mapped to consecutive buckets to keep the queries cache friendly
+class spatial_hash
+{
+  public:
+    // cell_size should be the interaction radius
+    void build(const float* x, const float* y, const float* z, size_t count, float cell_size);
+
+    // calls func(slot) for every particle in the 27 cells around the point
+    // slot is the index into get_sorted_ids(), so per-particle data gathered in that order is read contiguously
+    // candidates might be farther than cell_size, so the distance should be checked by func
+    template <typename Func>
+    void for_each_candidate(float x, float y, float z, Func&& func) const
+    {
+      const int cx = cell_coord(x), cy = cell_coord(y), cz = cell_coord(z);
+      // the 3 cells of a row along x are consecutive buckets starting at the row's base
+      // different cells can share a bucket, which should be visited only once
+      std::array<uint32_t, 9> row_bases;
+      int row_count = 0;
+      for (int dz = -1; dz <= 1; dz++) {
+        for (int dy = -1; dy <= 1; dy++) {
+          const auto base = hash(cx - 1, cy + dy, cz + dz);
+          for (uint32_t dx = 0; dx < 3; dx++) {
+            const auto bucket = (base + dx) & table_mask_;
+            bool duplicated = false;
+            for (int k = 0; k < row_count; k++)
+              duplicated |= ((bucket - row_bases[k]) & table_mask_) < 3;
+            if (duplicated) continue;
+
+            for (auto i = bucket_start_[bucket]; i < bucket_start_[bucket + 1]; i++)
+              func(i);
+          }
+          row_bases[row_count++] = base;
+        }
+      }
+    }
+
+    // getter
+    float  get_cell_size()  const { return cell_size_; }
+    size_t get_table_size() const { return bucket_start_.empty() ? 0 : bucket_start_.size() - 1; }
+    // particle ids sorted by bucket. iterating in this order improves the locality of the queries
+    const std::vector<uint32_t>& get_sorted_ids() const { return sorted_ids_; }
+
+  private:
+    int cell_coord(float v) const { return static_cast<int>(std::floor(v * inv_cell_size_)); }
+    uint32_t hash(int x, int y, int z) const
+    { return ((static_cast<uint32_t>(y) * 19349663u ^ static_cast<uint32_t>(z) * 83492791u) + static_cast<uint32_t>(x)) & table_mask_; }
+
+    float    cell_size_     = 1.f;
+    float    inv_cell_size_ = 1.f;
+    uint32_t table_mask_    = 0;
+    // bucket_start_[b] ~ bucket_start_[b + 1] is the range of bucket b in sorted_ids_
+    std::vector<uint32_t> bucket_start_;
+    std::vector<uint32_t> sorted_ids_;
+    std::vector<uint32_t> particle_buckets_;
+};
+
+} // namespace hnll::physics
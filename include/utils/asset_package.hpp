@@ -0,0 +1,88 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace hnll::utils {
+
+// source file of a cooked asset, recorded to detect the stale packages
+struct asset_dependency
+{
+  std::string path;
+  int64_t     write_time = 0;
+  uint64_t    size       = 0;
+
+  // the current state of the file. write_time is -1 if it doesn't exist
+  static asset_dependency stat(const std::string& path);
+  bool operator==(const asset_dependency& other) const = default;
+};
+
+// binary package of the preprocessed data of an asset (written by hnll_cook), loaded without parsing
+// named chunks of plain data, and the dependencies which were cooked into it
+class asset_package
+{
+  public:
+    static constexpr uint32_t MAGIC   = 0x4b50484e; // "NHPK"
+    // bump when the layout or the content of a cooked chunk changes
+    // 2 : the flipped uvs and the obj parser of the loader
+    static constexpr uint32_t VERSION = 2;
+
+    static std::unique_ptr<asset_package> create() { return std::make_unique<asset_package>(); }
+    // nullptr if the file doesn't exist. throws if it is not a package of this version
+    static std::unique_ptr<asset_package> load(const std::string& path);
+    // nullptr if the file doesn't exist, is of another version, or if a dependency changed
+    static std::unique_ptr<asset_package> load_if_fresh(const std::string& path);
+
+    void add_dependency(const std::string& path) { dependencies_.push_back(asset_dependency::stat(path)); }
+    void add_chunk(const std::string& name, const void* data, size_t size);
+    // the elements are copied bytewise, like the gpu buffers
+    template <typename T>
+    void add_chunk(const std::string& name, const std::vector<T>& values)
+    { add_chunk(name, values.data(), values.size() * sizeof(T)); }
+
+    // writes a temporary file and renames it, so that readers never see a partial package
+    void save(const std::string& path) const;
+
+    // true if no dependency changed since the cook
+    bool is_fresh() const;
+    bool has_chunk(const std::string& name) const { return find_chunk(name) != nullptr; }
+    // throws if the chunk doesn't exist
+    std::span<const std::byte> get_chunk_bytes(const std::string& name) const;
+    template <typename T>
+    std::vector<T> get_chunk(const std::string& name) const
+    {
+      auto bytes = get_chunk_bytes(name);
+      std::vector<T> values(bytes.size() / sizeof(T));
+      // the data of an empty chunk may be null
+      if (!values.empty())
+        std::memcpy(static_cast<void*>(values.data()), bytes.data(), values.size() * sizeof(T));
+      return values;
+    }
+
+    // getter
+    const std::vector<asset_dependency>& get_dependencies() const { return dependencies_; }
+    size_t get_chunk_count() const { return chunks_.size(); }
+
+  private:
+    struct chunk
+    {
+      std::string name;
+      uint64_t    offset;
+      uint64_t    size;
+    };
+
+    const chunk* find_chunk(const std::string& name) const;
+
+    std::vector<asset_dependency> dependencies_;
+    std::vector<chunk>            chunks_;
+    // chunk data, each aligned to 16 bytes
+    std::vector<std::byte>        data_;
+};
+
+} // namespace hnll::utils
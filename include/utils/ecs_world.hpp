@@ -0,0 +1,375 @@
+#pragma once
+
+// hnll
+#include <utils/job_system.hpp>
+
+// std
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace hnll::utils {
+
+// generational handle : a destroyed entity's index is reused with a new generation, so old handles
+// are detected instead of aliasing the new entity
+struct entity
+{
+  static constexpr uint32_t NULL_INDEX = ~0u;
+
+  uint32_t index      = NULL_INDEX;
+  uint32_t generation = 0;
+
+  bool is_null() const { return index == NULL_INDEX; }
+  bool operator==(const entity& other) const = default;
+};
+
+using component_type_id = uint32_t;
+
+// type erased operations of a component type
+struct component_type_info
+{
+  size_t size;
+  size_t alignment;
+  // move constructs dst from src, and destroys src
+  void (*relocate)(void* dst, void* src);
+  void (*destroy)(void* object);
+};
+
+namespace ecs_detail {
+
+component_type_id register_component_type(const component_type_info& info);
+const component_type_info& get_component_type_info(component_type_id id);
+
+template <typename T>
+void relocate(void* dst, void* src)
+{
+  new (dst) T(std::move(*static_cast<T*>(src)));
+  static_cast<T*>(src)->~T();
+}
+
+template <typename T>
+void destroy(void* object) { static_cast<T*>(object)->~T(); }
+
+} // namespace ecs_detail
+
+// ids are shared by every world of the process
+template <typename T>
+component_type_id component_type_of()
+{
+  static const component_type_id id = ecs_detail::register_component_type({
+    sizeof(T), alignof(T), &ecs_detail::relocate<T>, &ecs_detail::destroy<T> });
+  return id;
+}
+
+// entities of one signature (sorted component types) in fixed size chunks
+// each chunk stores its entities and every component type in separate contiguous arrays (soa)
+// the rows are dense : a removed row is filled with the last one
+class ecs_archetype
+{
+  public:
+    static constexpr size_t CHUNK_SIZE = 16 * 1024;
+    static constexpr int    NO_COLUMN  = -1;
+
+    explicit ecs_archetype(std::vector<component_type_id> signature);
+    ~ecs_archetype();
+
+    ecs_archetype(const ecs_archetype&) = delete;
+    ecs_archetype& operator=(const ecs_archetype&) = delete;
+
+    // returns the row. the components of the row are not constructed
+    uint32_t allocate(entity e);
+    // destroys the components of the row and fills it with the last row
+    // returns the entity moved into the row, a null entity if the row was the last one
+    entity remove(uint32_t row);
+    // same as above, for rows whose components were relocated or destroyed by the caller
+    entity remove_relocated(uint32_t row);
+
+    int column_of(component_type_id type) const;
+    // address of a component of a row
+    void* get_component(int column, uint32_t row)
+    {
+      return chunks_[row / chunk_capacity_] + column_offsets_[column]
+        + (row % chunk_capacity_) * column_info_[column].size;
+    }
+    void*   get_column(size_t chunk, int column) { return chunks_[chunk] + column_offsets_[column]; }
+    entity* get_entities(size_t chunk)           { return reinterpret_cast<entity*>(chunks_[chunk]); }
+    size_t  get_chunk_row_count(size_t chunk) const
+    { return std::min<size_t>(chunk_capacity_, row_count_ - chunk * chunk_capacity_); }
+
+    // getter
+    const std::vector<component_type_id>& get_signature() const { return signature_; }
+    const component_type_info& get_column_info(int column) const { return column_info_[column]; }
+    uint32_t get_row_count()      const { return row_count_; }
+    // chunks which hold rows
+    size_t   get_chunk_count()    const { return (row_count_ + chunk_capacity_ - 1) / chunk_capacity_; }
+    uint32_t get_chunk_capacity() const { return chunk_capacity_; }
+
+    // transitions of the archetype graph, filled by ecs_world
+    std::vector<std::pair<component_type_id, uint32_t>> add_edges;
+    std::vector<std::pair<component_type_id, uint32_t>> remove_edges;
+
+  private:
+    std::vector<component_type_id>   signature_;
+    std::vector<component_type_info> column_info_;
+    std::vector<size_t>              column_offsets_;
+    size_t   chunk_bytes_;
+    uint32_t chunk_capacity_;
+    uint32_t row_count_ = 0;
+    std::vector<std::byte*> chunks_;
+};
+
+// archetype based entity component storage
+// components are plain types, packed by signature. queries walk the matching archetypes chunk by chunk
+// structural changes (create, destroy, add, remove) are not allowed inside each() or under a structure_lock
+class ecs_world
+{
+  public:
+    static u_ptr<ecs_world> create() { return std::make_unique<ecs_world>(); }
+
+    ecs_world();
+    ~ecs_world();
+
+    ecs_world(const ecs_world&) = delete;
+    ecs_world& operator=(const ecs_world&) = delete;
+
+    // rejects the structural changes while it lives. each() holds one, so do the callers which let
+    // other threads read the world
+    struct structure_lock
+    {
+      explicit structure_lock(ecs_world& w) : world(w) { world.lock_depth_++; }
+      ~structure_lock() { world.lock_depth_--; }
+      structure_lock(const structure_lock&) = delete;
+      structure_lock& operator=(const structure_lock&) = delete;
+      ecs_world& world;
+    };
+
+    entity create_entity();
+    template <typename... Ts>
+    entity create_entity(Ts&&... components)
+    {
+      check_structural_change();
+      const auto archetype = find_or_create_archetype(sorted_signature<std::decay_t<Ts>...>());
+      const auto e = allocate_entity(archetype);
+      const auto row = records_[e.index].row;
+      auto& a = *archetypes_[archetype];
+      (construct<std::decay_t<Ts>>(a, row, std::forward<Ts>(components)), ...);
+      return e;
+    }
+    // destroying a dead entity does nothing
+    void destroy_entity(entity e);
+    bool is_alive(entity e) const
+    { return e.index < records_.size() && records_[e.index].generation == e.generation && records_[e.index].archetype != NO_ARCHETYPE; }
+
+    // replaces the component if the entity already has one
+    template <typename T, typename... Args>
+    T& add(entity e, Args&&... args)
+    {
+      check_alive(e);
+      const auto type = component_type_of<T>();
+      auto& record = records_[e.index];
+      auto* current = archetypes_[record.archetype].get();
+      if (auto column = current->column_of(type); column != ecs_archetype::NO_COLUMN) {
+        auto* component = static_cast<T*>(current->get_component(column, record.row));
+        *component = T(std::forward<Args>(args)...);
+        return *component;
+      }
+      check_structural_change();
+      move_entity(e, get_add_target(record.archetype, type));
+      return construct<T>(*archetypes_[record.archetype], record.row, std::forward<Args>(args)...);
+    }
+
+    template <typename T>
+    void remove(entity e)
+    {
+      check_alive(e);
+      const auto type = component_type_of<T>();
+      if (archetypes_[records_[e.index].archetype]->column_of(type) == ecs_archetype::NO_COLUMN)
+        return;
+      check_structural_change();
+      move_entity(e, get_remove_target(records_[e.index].archetype, type));
+    }
+
+    // nullptr if the entity is dead or doesn't have the component
+    template <typename T>
+    T* get(entity e)
+    {
+      if (!is_alive(e)) return nullptr;
+      const auto& record = records_[e.index];
+      auto& a = *archetypes_[record.archetype];
+      const auto column = a.column_of(component_type_of<T>());
+      return column == ecs_archetype::NO_COLUMN ? nullptr : static_cast<T*>(a.get_component(column, record.row));
+    }
+
+    template <typename T>
+    bool has(entity e) const
+    { return is_alive(e) && archetypes_[records_[e.index].archetype]->column_of(component_type_of<T>()) != ecs_archetype::NO_COLUMN; }
+
+    // func(const entity* entities, Ts*... components, size_t count) for each chunk which has every Ts
+    template <typename... Ts, typename Func>
+    void each_chunk(Func&& func)
+    {
+      const component_type_id types[] = { component_type_of<Ts>()... };
+      structure_lock scope(*this);
+      for (auto& a : archetypes_) {
+        if (a->get_row_count() == 0) continue;
+        int columns[sizeof...(Ts)];
+        if (!find_columns(*a, types, columns, sizeof...(Ts))) continue;
+        for (size_t c = 0; c < a->get_chunk_count(); c++)
+          call_chunk<Ts...>(*a, c, columns, func, std::index_sequence_for<Ts...>{});
+      }
+    }
+
+    // func(entity, Ts&...) or func(Ts&...) for each entity which has every Ts
+    template <typename... Ts, typename Func>
+    void each(Func&& func)
+    {
+      each_chunk<Ts...>([&func](const entity* entities, Ts*... components, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+          if constexpr (std::is_invocable_v<Func&, entity, Ts&...>)
+            func(entities[i], components[i]...);
+          else
+            func(components[i]...);
+        }
+      });
+    }
+
+    // same as each(), the chunks are distributed over the jobs. func should only touch its own entity
+    template <typename... Ts, typename Func>
+    void each_parallel(job_system& jobs, Func&& func)
+    {
+      const component_type_id types[] = { component_type_of<Ts>()... };
+      structure_lock scope(*this);
+      // (archetype, chunk, columns) of every matching chunk
+      struct work { ecs_archetype* archetype; size_t chunk; std::array<int, sizeof...(Ts)> columns; };
+      std::vector<work> works;
+      for (auto& a : archetypes_) {
+        work w{ a.get(), 0, {} };
+        if (a->get_row_count() == 0 || !find_columns(*a, types, w.columns.data(), sizeof...(Ts))) continue;
+        for (size_t c = 0; c < a->get_chunk_count(); c++) {
+          w.chunk = c;
+          works.push_back(w);
+        }
+      }
+      jobs.parallel_for(0, works.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+          call_chunk<Ts...>(*works[i].archetype, works[i].chunk, works[i].columns.data(),
+            [&func](const entity* entities, Ts*... components, size_t count) {
+              for (size_t r = 0; r < count; r++) {
+                if constexpr (std::is_invocable_v<Func&, entity, Ts&...>)
+                  func(entities[r], components[r]...);
+                else
+                  func(components[r]...);
+              }
+            }, std::index_sequence_for<Ts...>{});
+      });
+    }
+
+    // getter
+    size_t get_entity_count()    const { return entity_count_; }
+    size_t get_archetype_count() const { return archetypes_.size(); }
+    const ecs_archetype& get_archetype(size_t index) const { return *archetypes_[index]; }
+
+  private:
+    static constexpr uint32_t NO_ARCHETYPE = ~0u;
+
+    struct record
+    {
+      uint32_t archetype  = NO_ARCHETYPE;
+      uint32_t row        = 0;
+      uint32_t generation = 0;
+    };
+
+    template <typename... Ts>
+    static std::vector<component_type_id> sorted_signature()
+    {
+      std::vector<component_type_id> res = { component_type_of<Ts>()... };
+      std::sort(res.begin(), res.end());
+      if (std::adjacent_find(res.begin(), res.end()) != res.end())
+        throw std::runtime_error("ecs_world : a component type appears twice");
+      return res;
+    }
+
+    template <typename T, typename... Args>
+    static T& construct(ecs_archetype& a, uint32_t row, Args&&... args)
+    {
+      auto* address = a.get_component(a.column_of(component_type_of<T>()), row);
+      return *new (address) T(std::forward<Args>(args)...);
+    }
+
+    template <typename... Ts, typename Func, size_t... I>
+    static void call_chunk(ecs_archetype& a, size_t chunk, const int* columns, Func&& func, std::index_sequence<I...>)
+    {
+      func(a.get_entities(chunk), static_cast<Ts*>(a.get_column(chunk, columns[I]))..., a.get_chunk_row_count(chunk));
+    }
+
+    static bool find_columns(const ecs_archetype& a, const component_type_id* types, int* columns, size_t count);
+
+    void check_alive(entity e) const
+    { if (!is_alive(e)) throw std::runtime_error("ecs_world : the entity is dead"); }
+    void check_structural_change() const
+    { if (lock_depth_ > 0) throw std::runtime_error("ecs_world : structural change during an iteration or under a structure_lock"); }
+
+    entity   allocate_entity(uint32_t archetype);
+    uint32_t find_or_create_archetype(const std::vector<component_type_id>& signature);
+    uint32_t get_add_target(uint32_t archetype, component_type_id type);
+    uint32_t get_remove_target(uint32_t archetype, component_type_id type);
+    // relocates the shared components to the target archetype and destroys the others
+    // the components only the target has are left unconstructed
+    void move_entity(entity e, uint32_t target);
+
+    std::vector<record>   records_;
+    std::vector<uint32_t> free_indices_;
+    size_t entity_count_ = 0;
+
+    std::vector<u_ptr<ecs_archetype>> archetypes_;
+    std::map<std::vector<component_type_id>, uint32_t> archetype_map_;
+    int lock_depth_ = 0;
+};
+
+// owns an entity of a world, and destroys it with itself. movable
+// the world should outlive it
+class scoped_entity
+{
+  public:
+    scoped_entity() = default;
+    scoped_entity(ecs_world& world, entity e) : world_(&world), entity_(e) {}
+    scoped_entity(scoped_entity&& other) noexcept
+      : world_(std::exchange(other.world_, nullptr)), entity_(std::exchange(other.entity_, {})) {}
+    scoped_entity& operator=(scoped_entity&& other) noexcept
+    {
+      if (this != &other) {
+        reset();
+        world_  = std::exchange(other.world_, nullptr);
+        entity_ = std::exchange(other.entity_, {});
+      }
+      return *this;
+    }
+    ~scoped_entity() { reset(); }
+
+    void reset()
+    {
+      if (world_ != nullptr)
+        world_->destroy_entity(entity_);
+      world_  = nullptr;
+      entity_ = {};
+    }
+
+    // getter
+    entity     get()       const { return entity_; }
+    ecs_world* get_world() const { return world_; }
+    bool       is_null()   const { return world_ == nullptr; }
+
+  private:
+    ecs_world* world_ = nullptr;
+    entity     entity_;
+};
+
+} // namespace hnll::utils
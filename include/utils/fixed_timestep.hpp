@@ -0,0 +1,42 @@
+#pragma once
+
+// std
+#include <cstdint>
+
+namespace hnll::utils {
+
+// accumulates the frame time and slices it into fixed steps
+// the simulation cost per second doesn't depend on the frame rate, and the results are reproducible
+class fixed_timestep
+{
+  public:
+    explicit fixed_timestep(double step = 1.0 / 60.0, int max_steps_per_frame = 4)
+      : step_(step), max_steps_per_frame_(max_steps_per_frame) {}
+
+    // adds the frame time and returns the number of steps to run in this frame
+    // the time which exceeds max_steps_per_frame is dropped, so that a hitch doesn't spiral into longer frames
+    int advance(double frame_dt);
+    void reset() { accumulator_ = 0.0; }
+
+    // getter
+    double   get_step()                const { return step_; }
+    int      get_max_steps_per_frame() const { return max_steps_per_frame_; }
+    // [0, 1). how far the render time is from the last step, used to interpolate the last two states
+    double   get_alpha()               const { return accumulator_ / step_; }
+    double   get_dropped_time()        const { return dropped_time_; }
+    uint64_t get_step_count()          const { return step_count_; }
+
+    // setter
+    void set_step(double step)                     { step_ = step; accumulator_ = 0.0; }
+    void set_max_steps_per_frame(int max_steps)    { max_steps_per_frame_ = max_steps; }
+
+  private:
+    double   step_;
+    int      max_steps_per_frame_;
+    double   accumulator_  = 0.0;
+    // total time dropped by the catch-up budget
+    double   dropped_time_ = 0.0;
+    uint64_t step_count_   = 0;
+};
+
+} // namespace hnll::utils
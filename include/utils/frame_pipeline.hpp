@@ -0,0 +1,100 @@
+#pragma once
+
+// std
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace hnll::utils {
+
+// hands per-frame data from a producer thread to a consumer thread, in order
+// the producer runs at most `latency` frames ahead of the consumer, and blocks beyond it (back-pressure)
+// the frames are reused : a frame is only touched by the producer between begin_write() and end_write(),
+// and by the consumer between begin_read() and end_read()
+template <typename Frame>
+class frame_pipeline
+{
+  public:
+    explicit frame_pipeline(uint32_t latency = 1) : frames_(latency + 1) {}
+
+    frame_pipeline(const frame_pipeline&) = delete;
+    frame_pipeline& operator=(const frame_pipeline&) = delete;
+
+    // producer ---------------------------------------------------------------------------
+    // nullptr if the pipeline is closed
+    Frame* begin_write()
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      if (write_count_ - release_count_ == frames_.size()) {
+        const auto start = std::chrono::steady_clock::now();
+        writable_.wait(lock, [this] { return is_closed_ || write_count_ - release_count_ < frames_.size(); });
+        write_wait_ += std::chrono::steady_clock::now() - start;
+      }
+      if (is_closed_) return nullptr;
+      return &frames_[write_count_ % frames_.size()];
+    }
+
+    void end_write()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        write_count_++;
+      }
+      readable_.notify_one();
+    }
+
+    // consumer ---------------------------------------------------------------------------
+    // nullptr if the pipeline is closed and every written frame has been read
+    Frame* begin_read()
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      readable_.wait(lock, [this] { return is_closed_ || read_count_ < write_count_; });
+      if (read_count_ == write_count_) return nullptr;
+      return &frames_[read_count_++ % frames_.size()];
+    }
+
+    // the frame can be overwritten after this
+    void end_read()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        release_count_++;
+      }
+      writable_.notify_one();
+    }
+
+    // wakes both sides. the consumer still gets the frames written before
+    void close()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        is_closed_ = true;
+      }
+      writable_.notify_all();
+      readable_.notify_all();
+    }
+
+    // getter
+    uint32_t get_latency() const { return static_cast<uint32_t>(frames_.size() - 1); }
+    // frames the consumer has finished
+    uint64_t get_release_count() const { std::lock_guard<std::mutex> lock(mutex_); return release_count_; }
+    uint64_t get_write_count()   const { std::lock_guard<std::mutex> lock(mutex_); return write_count_; }
+    // time the producer has been blocked by the back-pressure
+    std::chrono::steady_clock::duration get_write_wait() const
+    { std::lock_guard<std::mutex> lock(mutex_); return write_wait_; }
+
+  private:
+    std::vector<Frame> frames_;
+    mutable std::mutex mutex_;
+    std::condition_variable writable_;
+    std::condition_variable readable_;
+    uint64_t write_count_   = 0;
+    uint64_t read_count_    = 0;
+    uint64_t release_count_ = 0;
+    bool     is_closed_     = false;
+    std::chrono::steady_clock::duration write_wait_{};
+};
+
+} // namespace hnll::utils
@@ -0,0 +1,157 @@
+#pragma once
+
+// std
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace hnll::utils {
+
+// coroutine spread over frames by a frame_scheduler
+// the body starts when the scheduler first resumes it, and suspends at co_await scheduler.yield() etc
+class frame_task
+{
+  public:
+    struct promise_type
+    {
+      frame_task get_return_object() { return frame_task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+      std::suspend_always initial_suspend() noexcept { return {}; }
+      std::suspend_always final_suspend()   noexcept { return {}; }
+      void return_void() {}
+      void unhandled_exception() { error = std::current_exception(); }
+
+      std::exception_ptr error;
+    };
+
+    frame_task() = default;
+    explicit frame_task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+    frame_task(frame_task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    frame_task& operator=(frame_task&& other) noexcept
+    {
+      if (this != &other) {
+        if (handle_) handle_.destroy();
+        handle_ = std::exchange(other.handle_, {});
+      }
+      return *this;
+    }
+    frame_task(const frame_task&) = delete;
+    frame_task& operator=(const frame_task&) = delete;
+    ~frame_task() { if (handle_) handle_.destroy(); }
+
+    std::coroutine_handle<promise_type> release() { return std::exchange(handle_, {}); }
+
+  private:
+    std::coroutine_handle<promise_type> handle_;
+};
+
+using frame_task_id = uint64_t;
+
+struct frame_scheduler_stats
+{
+  uint64_t frame_count          = 0;
+  // frames whose tasks ran longer than the budget
+  uint64_t overrun_frame_count  = 0;
+  // tasks which were not done at their deadline frame, counted once per task
+  uint64_t deadline_miss_count  = 0;
+  uint64_t completed_task_count = 0;
+  double   last_frame_ms        = 0.0;
+  double   max_overrun_ms       = 0.0;
+  double   total_overrun_ms     = 0.0;
+};
+
+// resumes the frame_tasks within a time budget per frame, on the thread which calls run_frame()
+// order : the tasks due in this frame or overdue, then by priority (higher first), then by deadline, then by age
+// the due tasks run even if the budget is spent. a slice which doesn't yield in time
+// overruns the budget, and is reported to the overrun hook
+class frame_scheduler
+{
+  public:
+    static constexpr uint64_t NO_DEADLINE = ~0ull;
+
+    using clock_func   = std::function<double()>;
+    // (task name, milliseconds beyond the budget)
+    using overrun_hook = std::function<void(const char*, double)>;
+
+    static std::unique_ptr<frame_scheduler> create(clock_func clock = {}) { return std::make_unique<frame_scheduler>(std::move(clock)); }
+    // clock : current time in milliseconds, the steady clock by default
+    explicit frame_scheduler(clock_func clock = {});
+    ~frame_scheduler();
+
+    frame_scheduler(const frame_scheduler&) = delete;
+    frame_scheduler& operator=(const frame_scheduler&) = delete;
+
+    // deadline_frames : frames from now in which the task should be done
+    frame_task_id spawn(frame_task&& task, int priority = 0, uint64_t deadline_frames = NO_DEADLINE, const char* name = "");
+    // destroys a task at its current suspension point (after its slice if it is running). returns false if it is already done
+    bool cancel(frame_task_id id);
+    bool is_done(frame_task_id id) const;
+
+    // resumes the tasks until budget_ms is spent. rethrows the first exception of a task, which is removed
+    void run_frame(double budget_ms);
+
+    // awaitables --------------------------------------------------------------------------
+    // suspends until the next frame only if the budget of this frame is spent
+    auto yield()
+    {
+      struct awaiter
+      {
+        frame_scheduler& scheduler;
+        bool await_ready() const { return !scheduler.is_budget_spent(); }
+        void await_suspend(std::coroutine_handle<>) const {}
+        void await_resume() const {}
+      };
+      return awaiter{ *this };
+    }
+    // always suspends until the next frame
+    auto next_frame()
+    {
+      struct awaiter
+      {
+        bool await_ready() const { return false; }
+        void await_suspend(std::coroutine_handle<>) const {}
+        void await_resume() const {}
+      };
+      return awaiter{};
+    }
+
+    // true if the running slice has spent the budget of the frame
+    bool is_budget_spent() const;
+
+    // getter
+    const frame_scheduler_stats& get_stats() const { return stats_; }
+    size_t   get_task_count() const { return tasks_.size() + spawned_.size(); }
+    uint64_t get_frame_count() const { return stats_.frame_count; }
+    // setter
+    void set_overrun_hook(overrun_hook hook) { overrun_hook_ = std::move(hook); }
+
+  private:
+    struct task_entry
+    {
+      std::coroutine_handle<frame_task::promise_type> handle;
+      frame_task_id id;
+      int           priority;
+      uint64_t      deadline_frame;
+      const char*   name;
+      bool          missed_deadline = false;
+      // done, or cancelled while the frame runs. destroyed at the end of the frame
+      bool          cancelled       = false;
+    };
+
+    void destroy(task_entry& entry);
+
+    clock_func clock_;
+    overrun_hook overrun_hook_;
+    std::vector<task_entry> tasks_;
+    // spawned while a frame runs, merged at the next frame
+    std::vector<task_entry> spawned_;
+    frame_task_id next_id_ = 0;
+    bool   is_running_     = false;
+    double frame_end_ms_   = 0.0;
+    frame_scheduler_stats stats_;
+};
+
+} // namespace hnll::utils
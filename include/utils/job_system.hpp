@@ -0,0 +1,194 @@
+#pragma once
+
+// hnll
+#include <utils/work_stealing_deque.hpp>
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace hnll::utils {
+
+template<typename T> using u_ptr = std::unique_ptr<T>;
+
+// forward declaration
+class job_system;
+struct job;
+
+// counts the unfinished jobs of a group. a job increments its counter when it is submitted and
+// decrements it when it finishes. the jobs submitted with run_after() start when it reaches zero
+// should outlive its jobs, and should not be re-armed while continuations are waiting for it
+class job_counter
+{
+  public:
+    job_counter() = default;
+    job_counter(const job_counter&) = delete;
+    job_counter& operator=(const job_counter&) = delete;
+
+    // the counter may be destroyed as soon as this returns true
+    bool is_done() const;
+    uint32_t get_value() const { return value_.load(std::memory_order_relaxed); }
+
+  private:
+    friend class job_system;
+
+    std::atomic<uint32_t> value_   = 0;
+    // threads sleeping in job_system::wait()
+    std::atomic<uint32_t> waiters_ = 0;
+    // held by the last decrement, until its last access to this counter
+    mutable std::mutex    mutex_;
+    std::vector<job*>     continuations_;
+};
+
+enum class job_affinity
+{
+  ANY,
+  // runs in job_system::wait() or process_main_thread_jobs() of the main thread (glfw, vulkan queue)
+  MAIN_THREAD,
+};
+
+// instrumentation for profilers. called by the thread which triggers the event
+// thread : job_system::get_thread_index() of that thread
+struct job_hooks
+{
+  std::function<void(uint32_t thread, const char* name)> on_job_begin;
+  std::function<void(uint32_t thread, const char* name)> on_job_end;
+  std::function<void(uint32_t thief, uint32_t victim)>   on_steal;
+  std::function<void(uint32_t thread)>                   on_sleep;
+  std::function<void(uint32_t thread)>                   on_wake;
+};
+
+// shared scheduler of the engine : one work-stealing deque per thread
+// the thread which creates the system is the main thread. it owns the last deque, and executes
+// jobs only while it waits (wait(), parallel_for()) or in process_main_thread_jobs()
+// the other threads submit through a shared queue
+// an exception thrown by a job is rethrown by the next wait() of any thread
+class job_system
+{
+  public:
+    static constexpr uint32_t NO_THREAD_INDEX = ~0u;
+
+    // worker_count = 0 : one worker per hardware thread but the main thread
+    // the hooks are fixed at the creation, since the idle workers read them
+    static u_ptr<job_system> create(unsigned worker_count = 0, job_hooks hooks = {})
+    { return std::make_unique<job_system>(worker_count, std::move(hooks)); }
+
+    explicit job_system(unsigned worker_count = 0, job_hooks hooks = {});
+    ~job_system();
+
+    job_system(const job_system&) = delete;
+    job_system& operator=(const job_system&) = delete;
+
+    // name : static string for the hooks, may be nullptr
+    void run(
+      std::function<void()>&& func,
+      job_counter* counter = nullptr,
+      job_affinity affinity = job_affinity::ANY,
+      const char* name = nullptr);
+    // starts when the dependency reaches zero. the counter is incremented now
+    void run_after(
+      job_counter& dependency,
+      std::function<void()>&& func,
+      job_counter* counter = nullptr,
+      job_affinity affinity = job_affinity::ANY,
+      const char* name = nullptr);
+
+    // executes other jobs until the counter reaches zero
+    void wait(const job_counter& counter);
+
+    // calls func(chunk_begin, chunk_end) over [begin, end) in chunks of grain elements, and waits
+    // grain = 0 splits the range in about 4 chunks per thread
+    template <typename Func>
+    void parallel_for(size_t begin, size_t end, size_t grain, Func&& func, const char* name = nullptr)
+    {
+      if (end <= begin) return;
+      const size_t count = end - begin;
+      if (grain == 0)
+        grain = std::max<size_t>(count / (4 * get_thread_count()), 1);
+      if (count <= grain || get_worker_count() == 0) {
+        func(begin, end);
+        return;
+      }
+      job_counter counter;
+      for (size_t chunk = begin + grain; chunk < end; chunk += grain) {
+        const size_t chunk_end = std::min(chunk + grain, end);
+        submit([&func, chunk, chunk_end] { func(chunk, chunk_end); }, &counter, job_affinity::ANY, name, false);
+      }
+      notify_all();
+      // the first chunk runs on this thread. the other chunks refer to func until they finish
+      try { func(begin, begin + grain); }
+      catch (...) {
+        wait(counter);
+        throw;
+      }
+      wait(counter);
+    }
+
+    // runs the main thread jobs which are ready. returns the number of executed jobs
+    size_t process_main_thread_jobs();
+
+    // getter
+    unsigned get_worker_count() const { return worker_count_; }
+    // workers + the main thread
+    unsigned get_thread_count() const { return get_worker_count() + 1; }
+    // [0, worker count) for the workers, worker count for the main thread, NO_THREAD_INDEX for the others
+    uint32_t get_thread_index() const;
+    bool     is_main_thread()   const { return get_thread_index() == get_worker_count(); }
+    // statistics since the creation
+    uint64_t get_executed_count(uint32_t thread_index) const { return threads_[thread_index]->executed.load(std::memory_order_relaxed); }
+    uint64_t get_steal_count(uint32_t thread_index)    const { return threads_[thread_index]->stolen.load(std::memory_order_relaxed); }
+
+  private:
+    struct alignas(64) thread_state
+    {
+      work_stealing_deque<job> deque;
+      std::atomic<uint64_t> executed = 0;
+      std::atomic<uint64_t> stolen   = 0;
+    };
+
+    void submit(std::function<void()>&& func, job_counter* counter, job_affinity affinity, const char* name, bool notify);
+    void schedule(job* j, bool notify);
+    void notify_all();
+    void worker_loop(uint32_t index);
+    // returns nullptr if no job is available for this thread
+    job* find_job(uint32_t index);
+    void execute(job* j, uint32_t index);
+    void finish(job_counter& counter);
+    void sleep(uint32_t index, uint32_t epoch);
+    void rethrow_error();
+
+    // fixed before the workers start, workers_ grows while they run
+    unsigned                         worker_count_;
+    std::vector<std::thread>         workers_;
+    // workers, then the main thread
+    std::vector<u_ptr<thread_state>> threads_;
+
+    // submitted by the threads without a deque
+    std::mutex        shared_mutex_;
+    std::deque<job*>  shared_queue_;
+    std::atomic<size_t> shared_count_ = 0;
+
+    std::mutex        main_mutex_;
+    std::deque<job*>  main_queue_;
+    std::atomic<size_t> main_count_ = 0;
+
+    // incremented whenever a job becomes available or a waited counter reaches zero
+    alignas(64) std::atomic<uint32_t> epoch_ = 0;
+    std::atomic<uint32_t> sleeper_count_ = 0;
+    std::atomic<bool>     is_running_ = true;
+
+    std::mutex         error_mutex_;
+    std::exception_ptr error_;
+
+    const job_hooks hooks_;
+};
+
+} // namespace hnll::utils
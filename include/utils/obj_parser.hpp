@@ -0,0 +1,49 @@
+#pragma once
+
+// std
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace hnll::utils {
+
+// forward declaration
+class job_system;
+
+// attribute indices of an obj vertex, -1 if absent
+struct obj_index
+{
+  int32_t position = -1;
+  int32_t texcoord = -1;
+  int32_t normal   = -1;
+};
+
+// triangulated (fan) and welded wavefront obj. the vertices are welded by value and ordered by
+// their first appearance, as the hash map of the tinyobjloader era did
+struct obj_data
+{
+  // xyz
+  std::vector<float> positions;
+  // rgb per position, 1 if absent
+  std::vector<float> colors;
+  // xyz
+  std::vector<float> normals;
+  // uv
+  std::vector<float> texcoords;
+
+  std::vector<obj_index> vertices;
+  std::vector<uint32_t>  indices;
+};
+
+// line aligned chunks of the text are parsed and welded in parallel if jobs isn't nullptr
+// throws std::runtime_error for a malformed file
+obj_data parse_obj(std::string_view text, job_system* jobs = nullptr);
+// mapped, not read
+obj_data load_obj(const std::string& path, job_system* jobs = nullptr);
+
+// exact for the usual obj numbers (up to 19 digits), falls back to std::from_chars for the others
+// returns the end of the number, nullptr if [first, last) doesn't start with a number
+const char* parse_float(const char* first, const char* last, float& value);
+
+} // namespace hnll::utils
@@ -0,0 +1,169 @@
+#pragma once
+
+// hnll
+#include <utils/slot_map.hpp>
+
+// std
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <utility>
+
+namespace hnll::utils {
+
+using residency_id = slot_handle;
+
+struct residency_stats
+{
+  size_t   resident_bytes      = 0;
+  size_t   peak_resident_bytes = 0;
+  uint64_t eviction_count      = 0;
+  size_t   evicted_bytes       = 0;
+  // resources added again after their eviction
+  uint64_t reload_count        = 0;
+  // trims which couldn't reach the budget, since the remaining resources are referenced
+  uint64_t over_budget_count   = 0;
+};
+
+// tracks the memory of shared resources (models etc) and their references
+// trim() evicts the unreferenced ones while the total exceeds the budget : the lowest priority first,
+// then the least recently used. thread safe, but the eviction callbacks run on the thread which trims
+class residency_manager
+{
+  public:
+    // (resource name, bytes)
+    using eviction_hook = std::function<void(const std::string&, size_t)>;
+    using reload_hook   = std::function<void(const std::string&)>;
+
+    static std::unique_ptr<residency_manager> create(size_t budget_bytes = SIZE_MAX)
+    { return std::make_unique<residency_manager>(budget_bytes); }
+    explicit residency_manager(size_t budget_bytes = SIZE_MAX) : budget_bytes_(budget_bytes) {}
+
+    residency_manager(const residency_manager&) = delete;
+    residency_manager& operator=(const residency_manager&) = delete;
+
+    // evict : frees the resource. called without a reference, after the resource is removed from the manager
+    residency_id add(std::string name, size_t bytes, int priority, std::function<void()>&& evict);
+    // the owner freed the resource itself
+    void remove(residency_id id);
+    // the owners freed every resource
+    void clear();
+
+    // the stale ids are ignored, so the references may outlive their resources
+    void acquire(residency_id id);
+    void release(residency_id id);
+    // marks the resource as used in this frame
+    void touch(residency_id id);
+    // never evicted, for the resources referred to without residency_ref
+    void pin(residency_id id);
+    void set_priority(residency_id id, int priority);
+    void next_frame();
+
+    // returns the evicted bytes
+    size_t trim();
+
+    // getter
+    bool     contains(residency_id id) const;
+    uint32_t get_ref_count(residency_id id) const;
+    size_t   get_budget() const         { return budget_bytes_; }
+    size_t   get_resident_bytes() const;
+    size_t   get_resource_count() const;
+    uint64_t get_frame_count() const    { return frame_count_; }
+    residency_stats get_stats() const;
+    // setter
+    void set_budget(size_t budget_bytes) { budget_bytes_ = budget_bytes; }
+    void set_eviction_hook(eviction_hook hook) { eviction_hook_ = std::move(hook); }
+    void set_reload_hook(reload_hook hook)     { reload_hook_ = std::move(hook); }
+
+  private:
+    struct entry
+    {
+      std::string name;
+      size_t      bytes;
+      int         priority;
+      uint32_t    ref_count = 0;
+      uint64_t    last_use_frame = 0;
+      bool        is_pinned = false;
+      std::function<void()> evict;
+    };
+
+    mutable std::mutex mutex_;
+    slot_map<entry> entries_;
+    // names of the evicted resources, to count their reloads
+    std::unordered_set<std::string> evicted_names_;
+    residency_stats stats_;
+    size_t   budget_bytes_;
+    uint64_t frame_count_ = 0;
+    eviction_hook eviction_hook_;
+    reload_hook   reload_hook_;
+};
+
+// counted reference to a resource of a residency_manager. copyable
+class residency_ref
+{
+  public:
+    residency_ref() = default;
+    residency_ref(residency_manager& manager, residency_id id) : manager_(&manager), id_(id) { manager_->acquire(id_); }
+    ~residency_ref() { reset(); }
+
+    residency_ref(const residency_ref& other) : manager_(other.manager_), id_(other.id_)
+    { if (manager_) manager_->acquire(id_); }
+    residency_ref& operator=(const residency_ref& other)
+    {
+      if (this != &other) { residency_ref copy(other); swap(copy); }
+      return *this;
+    }
+    residency_ref(residency_ref&& other) noexcept
+      : manager_(std::exchange(other.manager_, nullptr)), id_(std::exchange(other.id_, {})) {}
+    residency_ref& operator=(residency_ref&& other) noexcept
+    {
+      if (this != &other) { reset(); swap(other); }
+      return *this;
+    }
+
+    void reset()
+    {
+      if (manager_) manager_->release(id_);
+      manager_ = nullptr;
+      id_ = {};
+    }
+    void swap(residency_ref& other) noexcept { std::swap(manager_, other.manager_); std::swap(id_, other.id_); }
+
+    // marks the resource as used in this frame
+    void touch() const { if (manager_) manager_->touch(id_); }
+
+    // getter
+    residency_id get_id() const { return id_; }
+
+  private:
+    residency_manager* manager_ = nullptr;
+    residency_id       id_;
+};
+
+// pointer to a resource which keeps it resident
+// a handle without reference points to a resource owned elsewhere
+template <typename T>
+class resident_handle
+{
+  public:
+    resident_handle() = default;
+    explicit resident_handle(T* resource, residency_ref ref = {}) : resource_(resource), ref_(std::move(ref)) {}
+
+    T* get() const          { return resource_; }
+    T& operator*() const    { return *resource_; }
+    T* operator->() const   { return resource_; }
+    explicit operator bool() const { return resource_ != nullptr; }
+
+    void reset() { resource_ = nullptr; ref_.reset(); }
+    // does nothing for the resources held without reference
+    void touch() const { ref_.touch(); }
+
+  private:
+    T*            resource_ = nullptr;
+    residency_ref ref_;
+};
+
+} // namespace hnll::utils
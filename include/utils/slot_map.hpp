@@ -0,0 +1,138 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace hnll::utils {
+
+// stable reference to an element of a slot_map
+// the generation of a slot changes when its element is erased, so a stale handle finds nothing
+struct slot_handle
+{
+  static constexpr uint32_t NULL_INDEX = ~0u;
+
+  uint32_t index      = NULL_INDEX;
+  uint32_t generation = 0;
+
+  bool is_null() const { return index == NULL_INDEX; }
+  bool operator==(const slot_handle& other) const = default;
+};
+
+// O(1) insertion, erasure and lookup by handle, elements kept dense for the iterations
+// erasure moves the last element into the hole : the iteration order is not the insertion order,
+// and pointers to the elements are invalidated by insertions and erasures (the handles are not)
+template <typename T>
+class slot_map
+{
+  public:
+    using iterator       = typename std::vector<T>::iterator;
+    using const_iterator = typename std::vector<T>::const_iterator;
+
+    template <typename... Args>
+    slot_handle emplace(Args&&... args)
+    {
+      uint32_t index;
+      if (free_head_ != slot_handle::NULL_INDEX) {
+        index = free_head_;
+        free_head_ = slots_[index].target;
+      }
+      else {
+        index = static_cast<uint32_t>(slots_.size());
+        slots_.emplace_back();
+      }
+      auto& s = slots_[index];
+      s.target = static_cast<uint32_t>(values_.size());
+      values_.emplace_back(std::forward<Args>(args)...);
+      value_slots_.push_back(index);
+      return { index, s.generation };
+    }
+    slot_handle insert(const T& value) { return emplace(value); }
+    slot_handle insert(T&& value)      { return emplace(std::move(value)); }
+
+    // returns false if the handle is stale
+    bool erase(slot_handle handle)
+    {
+      if (!contains(handle))
+        return false;
+      auto& s = slots_[handle.index];
+      const auto hole = s.target;
+      if (hole + 1 != values_.size()) {
+        values_[hole] = std::move(values_.back());
+        value_slots_[hole] = value_slots_.back();
+        slots_[value_slots_[hole]].target = hole;
+      }
+      values_.pop_back();
+      value_slots_.pop_back();
+
+      s.generation++;
+      s.target = free_head_;
+      free_head_ = handle.index;
+      return true;
+    }
+
+    void clear()
+    {
+      // every live slot is freed with a new generation
+      for (auto index : value_slots_) {
+        slots_[index].generation++;
+        slots_[index].target = free_head_;
+        free_head_ = index;
+      }
+      values_.clear();
+      value_slots_.clear();
+    }
+
+    bool contains(slot_handle handle) const
+    {
+      // erasure changes the generation, so only a live element's handle matches
+      return handle.index < slots_.size() && slots_[handle.index].generation == handle.generation;
+    }
+    // nullptr if the handle is stale
+    T*       get(slot_handle handle)       { return contains(handle) ? &values_[slots_[handle.index].target] : nullptr; }
+    const T* get(slot_handle handle) const { return contains(handle) ? &values_[slots_[handle.index].target] : nullptr; }
+    // the handle should be valid
+    T&       operator[](slot_handle handle)       { return values_[slots_[handle.index].target]; }
+    const T& operator[](slot_handle handle) const { return values_[slots_[handle.index].target]; }
+
+    // handle of the i-th element of the iteration
+    slot_handle get_handle(size_t dense_index) const
+    { return { value_slots_[dense_index], slots_[value_slots_[dense_index]].generation }; }
+
+    iterator       begin()       { return values_.begin(); }
+    iterator       end()         { return values_.end(); }
+    const_iterator begin() const { return values_.begin(); }
+    const_iterator end()   const { return values_.end(); }
+
+    // getter
+    size_t size()  const { return values_.size(); }
+    bool   empty() const { return values_.empty(); }
+    // the elements, contiguous
+    std::vector<T>&       get_values()       { return values_; }
+    const std::vector<T>& get_values() const { return values_; }
+
+    void reserve(size_t count)
+    {
+      values_.reserve(count);
+      value_slots_.reserve(count);
+      slots_.reserve(count);
+    }
+
+  private:
+    struct slot
+    {
+      // index of the element if the slot is used, next free slot otherwise
+      uint32_t target     = slot_handle::NULL_INDEX;
+      uint32_t generation = 0;
+    };
+
+    std::vector<T>        values_;
+    // slot of each element
+    std::vector<uint32_t> value_slots_;
+    std::vector<slot>     slots_;
+    uint32_t free_head_ = slot_handle::NULL_INDEX;
+};
+
+} // namespace hnll::utils
@@ -0,0 +1,90 @@
+#pragma once
+
+// std
+#include <atomic>
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace hnll::utils {
+
+// lock-free ring buffer for exactly one producer thread and one consumer thread
+// the capacity is rounded up to a power of two. the elements are moved out by pop()
+template <typename T>
+class spsc_ring
+{
+  public:
+    explicit spsc_ring(size_t capacity)
+    {
+      size_t size = 1;
+      while (size < std::max<size_t>(capacity, 2))
+        size <<= 1;
+      buffer_.resize(size);
+      mask_ = size - 1;
+    }
+
+    spsc_ring(const spsc_ring&) = delete;
+    spsc_ring& operator=(const spsc_ring&) = delete;
+
+    // producer ---------------------------------------------------------------------------
+    // returns false if the ring is full
+    bool push(const T& value) { return push(&value, 1) == 1; }
+    bool push(T&& value)
+    {
+      const auto tail = tail_.load(std::memory_order_relaxed);
+      if (tail - head_.load(std::memory_order_acquire) == capacity())
+        return false;
+      buffer_[tail & mask_] = std::move(value);
+      tail_.store(tail + 1, std::memory_order_release);
+      return true;
+    }
+
+    // returns the number of pushed elements
+    size_t push(const T* data, size_t count)
+    {
+      const auto tail = tail_.load(std::memory_order_relaxed);
+      const auto head = head_.load(std::memory_order_acquire);
+      count = std::min(count, capacity() - (tail - head));
+      for (size_t i = 0; i < count; i++)
+        buffer_[(tail + i) & mask_] = data[i];
+      tail_.store(tail + count, std::memory_order_release);
+      return count;
+    }
+
+    // consumer ---------------------------------------------------------------------------
+    // returns false if the ring is empty
+    bool pop(T& value) { return pop(&value, 1) == 1; }
+
+    // returns the number of popped elements
+    size_t pop(T* data, size_t count)
+    {
+      const auto head = head_.load(std::memory_order_relaxed);
+      const auto tail = tail_.load(std::memory_order_acquire);
+      count = std::min(count, tail - head);
+      for (size_t i = 0; i < count; i++)
+        data[i] = std::move(buffer_[(head + i) & mask_]);
+      head_.store(head + count, std::memory_order_release);
+      return count;
+    }
+
+    // getter
+    // exact for the producer and the consumer, approximate for the other threads
+    size_t size() const
+    {
+      // head first : tail never falls behind a head loaded earlier
+      const auto head = head_.load(std::memory_order_acquire);
+      return tail_.load(std::memory_order_acquire) - head;
+    }
+    size_t capacity() const { return buffer_.size(); }
+    bool   empty()    const { return size() == 0; }
+
+  private:
+    std::vector<T> buffer_;
+    size_t mask_;
+    // monotonic counters. kept on separate cache lines to avoid false sharing
+    alignas(64) std::atomic<size_t> head_ = 0;
+    alignas(64) std::atomic<size_t> tail_ = 0;
+};
+
+} // namespace hnll::utils
@@ -0,0 +1,93 @@
+#pragma once
+
+// hnll
+#include <utils/job_system.hpp>
+
+// std
+#include <cstdint>
+#include <vector>
+
+namespace hnll::utils {
+
+// identifies the data shared by several updates : a type (resource_of<T>()) or an object (its address)
+using resource_id = uintptr_t;
+
+template <typename T>
+resource_id resource_of()
+{
+  static const char tag = 0;
+  return reinterpret_cast<resource_id>(&tag);
+}
+
+// the shared data an update reads and writes, besides the members of its owner
+// an exclusive update touches undeclared data, and runs alone
+class access_list
+{
+  public:
+    access_list& read(resource_id id);
+    access_list& write(resource_id id);
+    access_list& read(const void* object)  { return read(reinterpret_cast<resource_id>(object)); }
+    access_list& write(const void* object) { return write(reinterpret_cast<resource_id>(object)); }
+    template <typename T> access_list& read()  { return read(resource_of<T>()); }
+    template <typename T> access_list& write() { return write(resource_of<T>()); }
+    access_list& exclusive() { is_exclusive_ = true; return *this; }
+
+    void merge(const access_list& other);
+    void clear();
+    // true if they can't run at the same time
+    bool conflicts_with(const access_list& other) const;
+
+    // getter
+    bool is_exclusive() const { return is_exclusive_; }
+    // sorted, without duplicates. a written resource is not listed in the reads
+    const std::vector<resource_id>& get_reads()  const { return reads_; }
+    const std::vector<resource_id>& get_writes() const { return writes_; }
+
+  private:
+    std::vector<resource_id> reads_;
+    std::vector<resource_id> writes_;
+    bool is_exclusive_ = false;
+};
+
+// groups tasks into batches of tasks which don't conflict
+// a task is placed after every earlier task it conflicts with : running the batches in order, with
+// any order inside a batch, gives the same result as running the tasks in their submission order
+class update_batches
+{
+  public:
+    void clear();
+    // returns the task index
+    uint32_t add(const access_list& access);
+
+    // calls func(task index) for every task. jobs = nullptr runs everything in order on this thread
+    template <typename Func>
+    void run(job_system* jobs, Func&& func, size_t grain = 0) const
+    {
+      if (jobs == nullptr) {
+        for (uint32_t i = 0; i < task_count_; i++) func(i);
+        return;
+      }
+      for (const auto& batch : batches_) {
+        if (batch.size() == 1) {
+          func(batch[0]);
+          continue;
+        }
+        jobs->parallel_for(0, batch.size(), grain, [&](size_t begin, size_t end) {
+          for (size_t i = begin; i < end; i++) func(batch[i]);
+        });
+      }
+    }
+
+    // getter
+    uint32_t get_task_count()  const { return task_count_; }
+    size_t   get_batch_count() const { return batches_.size(); }
+    const std::vector<uint32_t>& get_batch(size_t index) const { return batches_[index]; }
+
+  private:
+    std::vector<std::vector<uint32_t>> batches_;
+    // union of the accesses of each batch
+    std::vector<access_list> batch_access_;
+    uint32_t task_count_ = 0;
+};
+
+} // namespace hnll::utils
@@ -25,12 +25,20 @@ static std::vector<std::string> loading_directories {
   std::string(std::getenv("HNLL_ENGN")) + "/models/primitives",
 };
 
+class vfs;
+// the packs added before the first call, then loading_directories, indexed once at the first call
+vfs& get_default_vfs();
+// the pack shadows loading_directories and the packs added after it. throws after get_default_vfs()
+void add_default_pack(const std::string& pack_path);
+// empty if the file doesn't exist, or is packed : open those through the vfs
 std::string get_full_path(const std::string& _filename);
 void mkdir_p(const std::string& _dir_name);
 // returns cache directory
 std::string create_cache_directory();
 // returns sub cache directory
 std::string create_sub_cache_directory(const std::string& _dir_name);
+// package of an asset cooked by hnll_cook : <cache>/cooked/<asset name>.<kind>.hpk
+std::string get_cooked_path(const std::string& _asset_name, const std::string& _kind);
 
 // 3d transformation
 struct transform
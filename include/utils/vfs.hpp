@@ -0,0 +1,115 @@
+#pragma once
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace hnll::utils {
+
+// read-only file mapped into the memory
+class mapped_file
+{
+  public:
+    // nullptr if the file can't be opened
+    static std::shared_ptr<const mapped_file> open(const std::string& path);
+    ~mapped_file();
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    // page aligned
+    std::span<const std::byte> get_bytes() const { return { static_cast<const std::byte*>(data_), size_ }; }
+
+    // use open()
+    mapped_file(const void* data, size_t size) : data_(data), size_(size) {}
+
+  private:
+    const void* data_;
+    size_t      size_;
+};
+
+// contents of a file of the vfs. keeps its mapping alive
+class vfs_file
+{
+  public:
+    vfs_file() = default;
+    vfs_file(std::shared_ptr<const mapped_file> mapping, std::span<const std::byte> bytes)
+      : mapping_(std::move(mapping)), bytes_(bytes) {}
+
+    std::span<const std::byte> get_bytes() const { return bytes_; }
+    std::string_view get_text() const { return { reinterpret_cast<const char*>(bytes_.data()), bytes_.size() }; }
+    size_t get_size() const { return bytes_.size(); }
+    explicit operator bool() const { return mapping_ != nullptr; }
+
+  private:
+    std::shared_ptr<const mapped_file> mapping_;
+    std::span<const std::byte>         bytes_;
+};
+
+// virtual file system over directories and pack files, addressed by the paths relative to their roots
+// a lookup is a hash lookup per mount, instead of probing the file system. the first mount of a path wins,
+// as in utils::loading_directories. the files are served as views over mmap, without copy
+// mount before the lookups : the lookups of several threads are safe, but not concurrently with the mounts
+class vfs
+{
+  public:
+    static constexpr uint32_t PACK_MAGIC   = 0x5346564e; // "NVFS"
+    static constexpr uint32_t PACK_VERSION = 1;
+
+    static std::unique_ptr<vfs> create() { return std::make_unique<vfs>(); }
+
+    // indexes the files under the directory once. the files added after the mount are not found
+    void mount_directory(const std::string& directory);
+    // pack written by write_pack(). its hash table is probed in place
+    void mount_pack(const std::string& pack_path);
+    // packs the files under the directory
+    static void write_pack(const std::string& directory, const std::string& pack_path);
+
+    bool exists(std::string_view path) const;
+    // an empty file if it doesn't exist
+    vfs_file open(std::string_view path) const;
+    // the path on the disk, for the libraries which open the files themselves. nullopt for the packed files
+    std::optional<std::string> get_real_path(std::string_view path) const;
+
+    // getter
+    size_t get_mount_count() const { return mounts_.size(); }
+
+    // setter
+    // a lookup checks that the indexed file still exists (one stat per hit), so that the removed files
+    // fall through to the later mounts. off by default, open() falls through anyway if the file is gone
+    void set_stale_check(bool enabled) { checks_stale_files_ = enabled; }
+
+  private:
+    // heterogeneous lookup by string_view
+    struct path_hash
+    {
+      using is_transparent = void;
+      size_t operator()(std::string_view path) const { return std::hash<std::string_view>{}(path); }
+    };
+    struct mount
+    {
+      // directory : the real paths by the relative paths. mapped at each open
+      std::unordered_map<std::string, std::string, path_hash, std::equal_to<>> files;
+      // pack
+      std::shared_ptr<const mapped_file> pack;
+    };
+
+    const std::string* find_directory_file(const mount& m, std::string_view path) const;
+    // bytes of the packed file, nullopt if it isn't in the pack
+    static std::optional<std::span<const std::byte>> find_packed_file(const mapped_file& pack, std::string_view path);
+
+    std::vector<mount> mounts_;
+    bool checks_stale_files_ = false;
+};
+
+// 64-bit fnv-1a, the hash of the pack tables
+uint64_t hash_path(std::string_view path);
+
+} // namespace hnll::utils
@@ -0,0 +1,122 @@
+#pragma once
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace hnll::utils {
+
+// chase-lev deque of pointers : the owner thread pushes and pops at the bottom (lifo),
+// the other threads steal from the top (fifo). lock-free, grows when it is full
+// the outgrown buffers are kept until the destruction, since a thief may still read them
+template <typename T>
+class work_stealing_deque
+{
+  public:
+    explicit work_stealing_deque(size_t capacity = 256)
+    {
+      size_t size = 1;
+      while (size < std::max<size_t>(capacity, 2))
+        size <<= 1;
+      buffers_.emplace_back(std::make_unique<buffer>(size));
+      buffer_.store(buffers_.back().get(), std::memory_order_relaxed);
+    }
+
+    work_stealing_deque(const work_stealing_deque&) = delete;
+    work_stealing_deque& operator=(const work_stealing_deque&) = delete;
+
+    // owner ------------------------------------------------------------------------------
+    void push(T* value)
+    {
+      const auto bottom = bottom_.load(std::memory_order_relaxed);
+      const auto top    = top_.load(std::memory_order_acquire);
+      auto* b = buffer_.load(std::memory_order_relaxed);
+      if (bottom - top >= static_cast<int64_t>(b->size)) {
+        b = grow(b, bottom, top);
+        buffer_.store(b, std::memory_order_release);
+      }
+      b->store(bottom, value);
+      bottom_.store(bottom + 1, std::memory_order_release);
+    }
+
+    // returns nullptr if the deque is empty
+    T* pop()
+    {
+      const auto bottom = bottom_.load(std::memory_order_relaxed) - 1;
+      auto* b = buffer_.load(std::memory_order_relaxed);
+      // seq_cst : the thieves see the reservation before this thread reads top
+      bottom_.store(bottom, std::memory_order_seq_cst);
+      auto top = top_.load(std::memory_order_seq_cst);
+
+      if (top > bottom) {
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+        return nullptr;
+      }
+      T* value = b->load(bottom);
+      if (top == bottom) {
+        // the last element, races with the thieves
+        if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+          value = nullptr;
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+      }
+      return value;
+    }
+
+    // thieves ----------------------------------------------------------------------------
+    // returns nullptr if the deque is empty or another thread won the element
+    T* steal()
+    {
+      auto top = top_.load(std::memory_order_seq_cst);
+      const auto bottom = bottom_.load(std::memory_order_seq_cst);
+      if (top >= bottom)
+        return nullptr;
+      T* value = buffer_.load(std::memory_order_acquire)->load(top);
+      if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        return nullptr;
+      return value;
+    }
+
+    // getter
+    // approximate for every thread but the owner
+    size_t size() const
+    {
+      const auto top = top_.load(std::memory_order_acquire);
+      const auto bottom = bottom_.load(std::memory_order_acquire);
+      return bottom > top ? static_cast<size_t>(bottom - top) : 0;
+    }
+    bool   empty()    const { return size() == 0; }
+    size_t capacity() const { return buffer_.load(std::memory_order_relaxed)->size; }
+
+  private:
+    struct buffer
+    {
+      explicit buffer(size_t _size) : size(_size), mask(_size - 1), elements(new std::atomic<T*>[_size]) {}
+      T*   load(int64_t i) const      { return elements[i & mask].load(std::memory_order_relaxed); }
+      void store(int64_t i, T* value) { elements[i & mask].store(value, std::memory_order_relaxed); }
+
+      size_t size;
+      size_t mask;
+      std::unique_ptr<std::atomic<T*>[]> elements;
+    };
+
+    buffer* grow(const buffer* old, int64_t bottom, int64_t top)
+    {
+      buffers_.emplace_back(std::make_unique<buffer>(old->size * 2));
+      auto* res = buffers_.back().get();
+      for (auto i = top; i < bottom; i++)
+        res->store(i, old->load(i));
+      return res;
+    }
+
+    // kept on separate cache lines : the owner writes bottom, the thieves write top
+    alignas(64) std::atomic<int64_t> top_    = 0;
+    alignas(64) std::atomic<int64_t> bottom_ = 0;
+    alignas(64) std::atomic<buffer*> buffer_;
+    // owned by the owner thread
+    std::vector<std::unique_ptr<buffer>> buffers_;
+};
+
+} // namespace hnll::utils
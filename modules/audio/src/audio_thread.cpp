@@ -0,0 +1,333 @@
+// hnll
+#include <audio/audio_thread.hpp>
+#include <audio/engine.hpp>
+#include <audio/streaming_source.hpp>
+
+// std
+#include <future>
+#include <stdexcept>
+
+namespace hnll::audio {
+
+audio_thread::audio_thread(device_type type, size_t command_capacity)
+  : device_type_(type), commands_(command_capacity)
+{
+  // the context is created on the audio thread
+  std::promise<result> started;
+  auto future = started.get_future();
+  worker_ = std::thread([this, type, &started] {
+    const auto res = type == device_type::LOOPBACK
+      ? engine::start_loopback_context()
+      : engine::start_hae_context();
+    started.set_value(res);
+    if (res == result::SUCCESS)
+      work();
+  });
+
+  if (future.get() == result::FAILURE) {
+    worker_.join();
+    throw std::runtime_error("audio_thread : failed to open the audio device");
+  }
+}
+
+audio_thread::~audio_thread()
+{
+  submit(make_command(command_type::QUIT));
+  worker_.join();
+}
+
+// producer -------------------------------------------------------------------------------
+audio_thread::command audio_thread::make_command(command_type type, uint32_t handle, uint32_t argument)
+{
+  command c;
+  c.type     = type;
+  c.handle   = handle;
+  c.argument = argument;
+  return c;
+}
+
+command_ticket audio_thread::submit(command&& c)
+{
+  if (!commands_.push(std::move(c))) {
+    stall_count_++;
+    while (!commands_.push(std::move(c)))
+      std::this_thread::yield();
+  }
+  signal_.fetch_add(1);
+  signal_.notify_one();
+  return ++submitted_count_;
+}
+
+uint32_t audio_thread::allocate(std::vector<uint32_t>& free_handles, uint32_t& next_handle)
+{
+  // a freed handle is reused only after its delete command, since the commands run in order
+  if (free_handles.empty())
+    return next_handle++;
+  auto res = free_handles.back();
+  free_handles.pop_back();
+  return res;
+}
+
+buffer_handle audio_thread::create_buffer()
+{
+  const auto handle = allocate(free_buffer_handles_, next_buffer_handle_);
+  submit(make_command(command_type::CREATE_BUFFER, handle));
+  return handle;
+}
+
+command_ticket audio_thread::upload(buffer_handle buffer, std::vector<ALshort>&& data, ALenum format, ALsizei sampling_rate)
+{
+  command c;
+  c.type = command_type::UPLOAD_BUFFER;
+  c.handle = buffer;
+  c.format = format;
+  c.sampling_rate = sampling_rate;
+  c.data = std::move(data);
+  return submit(std::move(c));
+}
+
+command_ticket audio_thread::delete_buffer(buffer_handle buffer)
+{
+  free_buffer_handles_.push_back(buffer);
+  return submit(make_command(command_type::DELETE_BUFFER, buffer));
+}
+
+source_handle audio_thread::create_source()
+{
+  const auto handle = allocate(free_source_handles_, next_source_handle_);
+  submit(make_command(command_type::CREATE_SOURCE, handle));
+  return handle;
+}
+
+command_ticket audio_thread::delete_source(source_handle source)
+{
+  free_source_handles_.push_back(source);
+  return submit(make_command(command_type::DELETE_SOURCE, source));
+}
+
+command_ticket audio_thread::bind(source_handle source, buffer_handle buffer)
+{ return submit(make_command(command_type::BIND, source, buffer)); }
+
+command_ticket audio_thread::play(source_handle source)
+{ return submit(make_command(command_type::PLAY, source)); }
+
+command_ticket audio_thread::stop(source_handle source)
+{ return submit(make_command(command_type::STOP, source)); }
+
+command_ticket audio_thread::set_gain(source_handle source, float gain)
+{
+  auto c = make_command(command_type::SET_GAIN, source);
+  c.values = { gain, 0.f, 0.f };
+  return submit(std::move(c));
+}
+
+command_ticket audio_thread::set_position(source_handle source, const std::array<float, 3>& position)
+{
+  auto c = make_command(command_type::SET_POSITION, source);
+  c.values = position;
+  return submit(std::move(c));
+}
+
+command_ticket audio_thread::set_looping(source_handle source, bool is_looping)
+{ return submit(make_command(command_type::SET_LOOPING, source, is_looping)); }
+
+stream_handle audio_thread::create_stream(const std::string& path, bool is_looping)
+{
+  const auto handle = allocate(free_stream_handles_, next_stream_handle_);
+  command c;
+  c.type = command_type::CREATE_STREAM;
+  c.handle = handle;
+  c.argument = is_looping;
+  c.path = path;
+  submit(std::move(c));
+  return handle;
+}
+
+stream_handle audio_thread::create_stream(streaming_source::fill_function fill, ALsizei sampling_rate, ALenum format)
+{
+  const auto handle = allocate(free_stream_handles_, next_stream_handle_);
+  command c;
+  c.type = command_type::CREATE_STREAM;
+  c.handle = handle;
+  c.format = format;
+  c.sampling_rate = sampling_rate;
+  c.fill = std::move(fill);
+  submit(std::move(c));
+  return handle;
+}
+
+command_ticket audio_thread::delete_stream(stream_handle stream)
+{
+  free_stream_handles_.push_back(stream);
+  return submit(make_command(command_type::DELETE_STREAM, stream));
+}
+
+command_ticket audio_thread::play_stream(stream_handle stream)
+{ return submit(make_command(command_type::PLAY_STREAM, stream)); }
+
+command_ticket audio_thread::stop_stream(stream_handle stream)
+{ return submit(make_command(command_type::STOP_STREAM, stream)); }
+
+void audio_thread::render(std::span<float> samples)
+{
+  if (device_type_ != device_type::LOOPBACK)
+    throw std::runtime_error("audio_thread : render() requires a loopback device");
+  command c;
+  c.type = command_type::RENDER;
+  c.output = samples.data();
+  c.output_count = samples.size();
+  wait(submit(std::move(c)));
+}
+
+void audio_thread::wait(command_ticket ticket) const
+{
+  auto processed = processed_count_.load(std::memory_order_acquire);
+  while (processed < ticket) {
+    processed_count_.wait(processed);
+    processed = processed_count_.load(std::memory_order_acquire);
+  }
+}
+
+// consumer -------------------------------------------------------------------------------
+void audio_thread::work()
+{
+  command c;
+  bool is_running = true;
+  while (is_running) {
+    // read the signal before checking the ring, so that a push after the check wakes the wait
+    const auto signal = signal_.load();
+    bool has_executed = false;
+    while (commands_.pop(c)) {
+      if (c.type == command_type::QUIT) is_running = false;
+      else                              execute(c);
+      processed_count_.fetch_add(1, std::memory_order_release);
+      has_executed = true;
+    }
+    if (has_executed)
+      processed_count_.notify_all();
+
+    // refill the streams
+    bool is_streaming = false;
+    for (auto& stream : streams_) {
+      if (stream && stream->is_playing()) {
+        stream->update();
+        is_streaming = true;
+      }
+    }
+
+    if (!has_executed && is_running) {
+      if (is_streaming) std::this_thread::sleep_for(STREAM_UPDATE_PERIOD);
+      else              signal_.wait(signal);
+    }
+  }
+
+  // the handles which were not deleted
+  streams_.clear();
+  for (auto& source : sources_)
+    if (source != 0)
+      engine::release_source(source);
+  for (auto& buffer : buffers_)
+    if (buffer != 0)
+      alDeleteBuffers(1, &buffer);
+  engine::kill_hae_context();
+}
+
+void audio_thread::execute(command& c)
+{
+  auto get_source = [this](uint32_t handle) { return handle < sources_.size() ? sources_[handle] : 0u; };
+  auto get_buffer = [this](uint32_t handle) { return handle < buffers_.size() ? buffers_[handle] : 0u; };
+
+  switch (c.type) {
+    case command_type::CREATE_BUFFER : {
+      if (c.handle >= buffers_.size()) buffers_.resize(c.handle + 1, 0);
+      alGenBuffers(1, &buffers_[c.handle]);
+      break;
+    }
+    case command_type::UPLOAD_BUFFER : {
+      alBufferData(get_buffer(c.handle), c.format, c.data.data(), static_cast<ALsizei>(c.data.size() * sizeof(ALshort)), c.sampling_rate);
+      // freed on this thread
+      c.data = {};
+      break;
+    }
+    case command_type::DELETE_BUFFER : {
+      if (auto id = get_buffer(c.handle)) {
+        alDeleteBuffers(1, &id);
+        buffers_[c.handle] = 0;
+      }
+      break;
+    }
+    case command_type::CREATE_SOURCE : {
+      if (c.handle >= sources_.size()) sources_.resize(c.handle + 1, 0);
+      source_id id = 0;
+      if (engine::acquire_source(id) == result::FAILURE)
+        failed_source_count_++;
+      sources_[c.handle] = id;
+      break;
+    }
+    case command_type::DELETE_SOURCE : {
+      if (auto id = get_source(c.handle)) {
+        engine::release_source(id);
+        sources_[c.handle] = 0;
+      }
+      break;
+    }
+    case command_type::BIND : {
+      if (auto id = get_source(c.handle))
+        alSourcei(id, AL_BUFFER, static_cast<ALint>(get_buffer(c.argument)));
+      break;
+    }
+    case command_type::PLAY : {
+      if (auto id = get_source(c.handle)) alSourcePlay(id);
+      break;
+    }
+    case command_type::STOP : {
+      if (auto id = get_source(c.handle)) alSourceStop(id);
+      break;
+    }
+    case command_type::SET_GAIN : {
+      if (auto id = get_source(c.handle)) alSourcef(id, AL_GAIN, c.values[0]);
+      break;
+    }
+    case command_type::SET_POSITION : {
+      if (auto id = get_source(c.handle)) alSource3f(id, AL_POSITION, c.values[0], c.values[1], c.values[2]);
+      break;
+    }
+    case command_type::SET_LOOPING : {
+      if (auto id = get_source(c.handle)) alSourcei(id, AL_LOOPING, c.argument ? AL_TRUE : AL_FALSE);
+      break;
+    }
+    case command_type::CREATE_STREAM : {
+      if (c.handle >= streams_.size()) streams_.resize(c.handle + 1);
+      try {
+        streams_[c.handle] = c.fill
+          ? streaming_source::create(std::move(c.fill), c.sampling_rate, streaming_source::DEFAULT_BUFFER_SAMPLE_COUNT, streaming_source::DEFAULT_BUFFER_COUNT, c.format)
+          : streaming_source::create_from_file(c.path, c.argument != 0);
+      }
+      catch (const std::runtime_error&) {
+        streams_[c.handle] = nullptr;
+        failed_stream_count_++;
+      }
+      break;
+    }
+    case command_type::DELETE_STREAM : {
+      if (c.handle < streams_.size()) streams_[c.handle] = nullptr;
+      break;
+    }
+    case command_type::PLAY_STREAM : {
+      if (c.handle < streams_.size() && streams_[c.handle]) streams_[c.handle]->play();
+      break;
+    }
+    case command_type::STOP_STREAM : {
+      if (c.handle < streams_.size() && streams_[c.handle]) streams_[c.handle]->stop();
+      break;
+    }
+    case command_type::RENDER : {
+      engine::render_loopback(std::span<float>(c.output, c.output_count));
+      break;
+    }
+    case command_type::QUIT :
+      break;
+  }
+}
+
+} // namespace hnll::audio
@@ -0,0 +1,131 @@
+// hnll
+#include <audio/convolver.hpp>
+
+// std
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <immintrin.h>
+#define HNLL_CONVOLVER_USE_SSE
+#endif
+
+namespace hnll::audio {
+
+namespace {
+
+size_t compute_stride(size_t block_size) { return (block_size + 1 + 3) & ~size_t(3); }
+
+// acc += x * h over count bins (a multiple of 4)
+inline void complex_multiply_add(
+  const float* xr, const float* xi,
+  const float* hr, const float* hi,
+  float* acc_r, float* acc_i,
+  size_t count)
+{
+  size_t k = 0;
+#ifdef HNLL_CONVOLVER_USE_SSE
+  for (; k < count; k += 4) {
+    const __m128 a = _mm_loadu_ps(xr + k), b = _mm_loadu_ps(xi + k);
+    const __m128 c = _mm_loadu_ps(hr + k), d = _mm_loadu_ps(hi + k);
+    _mm_storeu_ps(acc_r + k, _mm_add_ps(_mm_loadu_ps(acc_r + k), _mm_sub_ps(_mm_mul_ps(a, c), _mm_mul_ps(b, d))));
+    _mm_storeu_ps(acc_i + k, _mm_add_ps(_mm_loadu_ps(acc_i + k), _mm_add_ps(_mm_mul_ps(a, d), _mm_mul_ps(b, c))));
+  }
+#endif
+  for (; k < count; k++) {
+    acc_r[k] += xr[k] * hr[k] - xi[k] * hi[k];
+    acc_i[k] += xr[k] * hi[k] + xi[k] * hr[k];
+  }
+}
+
+} // anonymous namespace
+
+partitioned_filter::partitioned_filter(std::span<const float> impulse_response, size_t block_size)
+  : block_size_(block_size), stride_(compute_stride(block_size))
+{
+  fft transform(2 * block_size);
+  partition_count_ = std::max<size_t>((impulse_response.size() + block_size - 1) / block_size, 1);
+  re_.assign(partition_count_ * stride_, 0.f);
+  im_.assign(partition_count_ * stride_, 0.f);
+
+  // each partition is zero padded to the fft size
+  std::vector<float> padded(2 * block_size);
+  for (size_t p = 0; p < partition_count_; p++) {
+    std::fill(padded.begin(), padded.end(), 0.f);
+    const auto begin = std::min(p * block_size, impulse_response.size());
+    const auto end   = std::min(begin + block_size, impulse_response.size());
+    std::copy(impulse_response.begin() + begin, impulse_response.begin() + end, padded.begin());
+    transform.forward(padded.data(), re_.data() + p * stride_, im_.data() + p * stride_);
+  }
+}
+
+convolver::convolver(size_t block_size, size_t max_partition_count)
+  : block_size_(block_size),
+    partition_count_(std::max<size_t>(max_partition_count, 1)),
+    stride_(compute_stride(block_size)),
+    fft_(2 * block_size)
+{
+  window_.assign(2 * block_size, 0.f);
+  delay_re_.assign(partition_count_ * stride_, 0.f);
+  delay_im_.assign(partition_count_ * stride_, 0.f);
+  acc_re_.assign(stride_, 0.f);
+  acc_im_.assign(stride_, 0.f);
+  time_.assign(2 * block_size, 0.f);
+}
+
+void convolver::push(std::span<const float> input)
+{
+  if (input.size() != block_size_)
+    throw std::runtime_error("convolver : the input should be one block");
+
+  // slide the window by one block
+  std::copy(window_.begin() + block_size_, window_.end(), window_.begin());
+  std::copy(input.begin(), input.end(), window_.begin() + block_size_);
+
+  head_ = (head_ + 1) % partition_count_;
+  fft_.forward(window_.data(), delay_re_.data() + head_ * stride_, delay_im_.data() + head_ * stride_);
+}
+
+void convolver::convolve(const partitioned_filter& filter, std::span<float> output)
+{
+  if (filter.get_block_size() != block_size_ || filter.get_partition_count() > partition_count_)
+    throw std::runtime_error("convolver : the filter doesn't fit the convolver");
+  if (output.size() != block_size_)
+    throw std::runtime_error("convolver : the output should be one block");
+
+  // partition p of the filter meets the input of p blocks ago
+  std::fill(acc_re_.begin(), acc_re_.end(), 0.f);
+  std::fill(acc_im_.begin(), acc_im_.end(), 0.f);
+  for (size_t p = 0; p < filter.get_partition_count(); p++) {
+    const size_t slot = (head_ + partition_count_ - p) % partition_count_;
+    complex_multiply_add(
+      delay_re_.data() + slot * stride_, delay_im_.data() + slot * stride_,
+      filter.get_re(p), filter.get_im(p),
+      acc_re_.data(), acc_im_.data(),
+      stride_);
+  }
+
+  // the first half is circular aliasing
+  fft_.inverse(acc_re_.data(), acc_im_.data(), time_.data());
+  std::copy(time_.begin() + block_size_, time_.end(), output.begin());
+}
+
+void convolver::reset()
+{
+  std::fill(window_.begin(), window_.end(), 0.f);
+  std::fill(delay_re_.begin(), delay_re_.end(), 0.f);
+  std::fill(delay_im_.begin(), delay_im_.end(), 0.f);
+  head_ = 0;
+}
+
+void convolver::process(std::span<const float> input, const partitioned_filter& filter, std::span<float> output)
+{
+  if (input.size() % block_size_ != 0 || output.size() < input.size())
+    throw std::runtime_error("convolver : the input should be a multiple of the block size");
+  for (size_t i = 0; i < input.size(); i += block_size_) {
+    push(input.subspan(i, block_size_));
+    convolve(filter, output.subspan(i, block_size_));
+  }
+}
+
+} // namespace hnll::audio
@@ -7,17 +7,70 @@ namespace hnll::audio {
 std::queue<source_id> engine::pending_source_ids_;
 ALCdevice*  engine::device_ = nullptr;
 ALCcontext* engine::context_ = nullptr;
+LPALCRENDERSAMPLESSOFT engine::render_samples_ = nullptr;
 
-void engine::start_hae_context()
+result engine::start_hae_context()
 {
-  if (device_ || context_) return;
+  if (device_ || context_) return result::SUCCESS;
   // initialize openAL
   device_ = alcOpenDevice(nullptr);
+  if (!device_) return result::FAILURE;
   // TODO : configure context's attributes
   context_ = alcCreateContext(device_, nullptr);
+  if (!context_ || alcMakeContextCurrent(context_) != ALC_TRUE) {
+    if (context_) alcDestroyContext(context_);
+    alcCloseDevice(device_);
+    context_ = nullptr;
+    device_  = nullptr;
+    return result::FAILURE;
+  }
+
+  create_pending_sources();
+  return result::SUCCESS;
+}
+
+result engine::start_loopback_context(ALCsizei sampling_rate)
+{
+  if (device_ || context_) return result::FAILURE;
+  if (!alcIsExtensionPresent(nullptr, "ALC_SOFT_loopback")) return result::FAILURE;
+
+  auto open_device = reinterpret_cast<LPALCLOOPBACKOPENDEVICESOFT>(alcGetProcAddress(nullptr, "alcLoopbackOpenDeviceSOFT"));
+  auto is_supported = reinterpret_cast<LPALCISRENDERFORMATSUPPORTEDSOFT>(alcGetProcAddress(nullptr, "alcIsRenderFormatSupportedSOFT"));
+  auto render_samples = reinterpret_cast<LPALCRENDERSAMPLESSOFT>(alcGetProcAddress(nullptr, "alcRenderSamplesSOFT"));
+  if (!open_device || !is_supported || !render_samples) return result::FAILURE;
+
+  device_ = open_device(nullptr);
+  if (!device_) return result::FAILURE;
+  if (!is_supported(device_, sampling_rate, ALC_STEREO_SOFT, ALC_FLOAT_SOFT)) {
+    alcCloseDevice(device_);
+    device_ = nullptr;
+    return result::FAILURE;
+  }
+
+  // stereo 32 bit float
+  const ALCint attributes[] = {
+    ALC_FORMAT_CHANNELS_SOFT, ALC_STEREO_SOFT,
+    ALC_FORMAT_TYPE_SOFT, ALC_FLOAT_SOFT,
+    ALC_FREQUENCY, sampling_rate,
+    0
+  };
+  context_ = alcCreateContext(device_, attributes);
   alcMakeContextCurrent(context_);
+  render_samples_ = render_samples;
+
+  create_pending_sources();
+  return result::SUCCESS;
+}
 
-  // create pending sources
+result engine::render_loopback(std::span<float> samples)
+{
+  if (!render_samples_) return result::FAILURE;
+  render_samples_(device_, samples.data(), static_cast<ALCsizei>(samples.size() / 2));
+  return result::SUCCESS;
+}
+
+void engine::create_pending_sources()
+{
   source_id sources[SOURCE_COUNT];
   alGenSources(SOURCE_COUNT, sources);
   for (const auto& source : sources) {
@@ -31,6 +84,11 @@ void engine::kill_hae_context()
   alcMakeContextCurrent(nullptr);
   alcDestroyContext(context_);
   alcCloseDevice(device_);
+  // the sources died with the context
+  pending_source_ids_ = {};
+  device_  = nullptr;
+  context_ = nullptr;
+  render_samples_ = nullptr;
 }
 
 result engine::bind_audio_to_buffer(audio_data &audio_data)
@@ -78,6 +136,21 @@ result engine::bind_buffer_to_source(audio_data &audio_data)
   return result::SUCCESS;
 }
 
+result engine::acquire_source(source_id& id)
+{
+  if (pending_source_ids_.empty()) return result::FAILURE;
+  id = pending_source_ids_.front();
+  pending_source_ids_.pop();
+  return result::SUCCESS;
+}
+
+void engine::release_source(source_id id)
+{
+  alSourceStop(id);
+  alSourcei(id, AL_BUFFER, 0);
+  pending_source_ids_.push(id);
+}
+
 result engine::remove_audio_resources(audio_data& audio_data)
 {
   // remove source
@@ -0,0 +1,131 @@
+// hnll
+#include <audio/fft.hpp>
+
+// std
+#include <cmath>
+#include <stdexcept>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <immintrin.h>
+#define HNLL_FFT_USE_SSE
+#endif
+
+namespace hnll::audio {
+
+fft::fft(size_t size) : size_(size), half_(size / 2)
+{
+  if (size < 4 || (size & (size - 1)) != 0)
+    throw std::runtime_error("fft : the size should be a power of two (>= 4)");
+
+  uint32_t bit_count = 0;
+  while ((size_t(1) << bit_count) < half_) bit_count++;
+  bit_reverse_.resize(half_);
+  for (uint32_t i = 0; i < half_; i++) {
+    uint32_t reversed = 0;
+    for (uint32_t b = 0; b < bit_count; b++)
+      reversed |= ((i >> b) & 1u) << (bit_count - 1 - b);
+    bit_reverse_[i] = reversed;
+  }
+
+  for (size_t half = 1; half < half_; half <<= 1)
+    for (size_t k = 0; k < half; k++) {
+      const double angle = M_PI * double(k) / double(half);
+      stage_cos_.push_back(static_cast<float>(std::cos(angle)));
+      stage_sin_.push_back(static_cast<float>(std::sin(angle)));
+    }
+
+  for (size_t k = 0; k <= half_; k++) {
+    const double angle = 2.0 * M_PI * double(k) / double(size_);
+    split_cos_.push_back(static_cast<float>(std::cos(angle)));
+    split_sin_.push_back(static_cast<float>(std::sin(angle)));
+  }
+
+  work_re_.resize(half_);
+  work_im_.resize(half_);
+}
+
+void fft::transform(float* re, float* im) const
+{
+  size_t offset = 0;
+  for (size_t half = 1; half < half_; half <<= 1) {
+    // w_k = exp(-i pi k / half)
+    const float* wc = stage_cos_.data() + offset;
+    const float* ws = stage_sin_.data() + offset;
+    for (size_t j = 0; j < half_; j += 2 * half) {
+      size_t k = 0;
+#ifdef HNLL_FFT_USE_SSE
+      for (; k + 4 <= half; k += 4) {
+        float* ar = re + j + k; float* ai = im + j + k;
+        float* br = ar + half;  float* bi = ai + half;
+        const __m128 c = _mm_loadu_ps(wc + k), s = _mm_loadu_ps(ws + k);
+        const __m128 xr = _mm_loadu_ps(br), xi = _mm_loadu_ps(bi);
+        const __m128 tr = _mm_add_ps(_mm_mul_ps(c, xr), _mm_mul_ps(s, xi));
+        const __m128 ti = _mm_sub_ps(_mm_mul_ps(c, xi), _mm_mul_ps(s, xr));
+        const __m128 yr = _mm_loadu_ps(ar), yi = _mm_loadu_ps(ai);
+        _mm_storeu_ps(br, _mm_sub_ps(yr, tr));
+        _mm_storeu_ps(bi, _mm_sub_ps(yi, ti));
+        _mm_storeu_ps(ar, _mm_add_ps(yr, tr));
+        _mm_storeu_ps(ai, _mm_add_ps(yi, ti));
+      }
+#endif
+      for (; k < half; k++) {
+        const size_t a = j + k, b = a + half;
+        const float tr = wc[k] * re[b] + ws[k] * im[b];
+        const float ti = wc[k] * im[b] - ws[k] * re[b];
+        re[b] = re[a] - tr; im[b] = im[a] - ti;
+        re[a] += tr;        im[a] += ti;
+      }
+    }
+    offset += half;
+  }
+}
+
+void fft::forward(const float* input, float* re, float* im)
+{
+  // pack the even and odd samples into one complex signal of half the size
+  for (size_t n = 0; n < half_; n++) {
+    work_re_[bit_reverse_[n]] = input[2 * n];
+    work_im_[bit_reverse_[n]] = input[2 * n + 1];
+  }
+  transform(work_re_.data(), work_im_.data());
+
+  // X[k] = E[k] + W^k O[k], E and O being the spectra of the even and odd samples
+  for (size_t k = 0; k <= half_; k++) {
+    const size_t i = k == half_ ? 0 : k;
+    const size_t j = k == 0 ? 0 : half_ - k;
+    const float zr = work_re_[i], zi = work_im_[i];
+    const float cr = work_re_[j], ci = -work_im_[j];
+    const float er = 0.5f * (zr + cr), ei = 0.5f * (zi + ci);
+    // O = (Z[k] - conj(Z[M - k])) / 2i
+    const float orr = 0.5f * (zi - ci), oi = -0.5f * (zr - cr);
+    const float c = split_cos_[k], s = split_sin_[k];
+    re[k] = er + c * orr + s * oi;
+    im[k] = ei + c * oi - s * orr;
+  }
+}
+
+void fft::inverse(const float* re, const float* im, float* output)
+{
+  // rebuild Z = E + i O, with the 1 / half_ normalization folded in
+  const float scale = 0.5f / static_cast<float>(half_);
+  for (size_t k = 0; k < half_; k++) {
+    const float xr = re[k], xi = im[k];
+    const float cr = re[half_ - k], ci = -im[half_ - k];
+    const float er = scale * (xr + cr), ei = scale * (xi + ci);
+    // O = (X[k] - conj(X[M - k])) / 2W^k
+    const float dr = scale * (xr - cr), di = scale * (xi - ci);
+    const float c = split_cos_[k], s = split_sin_[k];
+    const float orr = dr * c - di * s, oi = dr * s + di * c;
+    // the inverse transform is the conjugate of the forward transform of the conjugate
+    work_re_[bit_reverse_[k]] = er - oi;
+    work_im_[bit_reverse_[k]] = -(ei + orr);
+  }
+  transform(work_re_.data(), work_im_.data());
+
+  for (size_t n = 0; n < half_; n++) {
+    output[2 * n]     = work_re_[n];
+    output[2 * n + 1] = -work_im_[n];
+  }
+}
+
+} // namespace hnll::audio
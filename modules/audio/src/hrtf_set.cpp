@@ -0,0 +1,111 @@
+// hnll
+#include <audio/hrtf_set.hpp>
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace hnll::audio {
+
+namespace {
+
+constexpr double HEAD_RADIUS    = 0.0875; // m
+constexpr double SOUND_SPEED    = 343.0;  // m/s
+constexpr double MIN_SHADOW     = 0.1;
+constexpr double MIN_SHADOW_ANGLE = 150.0 * M_PI / 180.0;
+constexpr size_t IMPULSE_RESPONSE_LENGTH = 128;
+
+// theta : angle between the source and the ear axis
+std::vector<float> create_spherical_head_response(double theta, double sampling_rate)
+{
+  // woodworth's delay, shifted to be positive
+  const double a_c = HEAD_RADIUS / SOUND_SPEED;
+  const double delay = theta < M_PI / 2
+    ? a_c * (1.0 - std::cos(theta))
+    : a_c * (1.0 + theta - M_PI / 2);
+
+  // brown-duda head shadow : (1 + alpha s / 2w0) / (1 + s / 2w0) through the bilinear transform
+  const double alpha = (1.0 + MIN_SHADOW / 2) + (1.0 - MIN_SHADOW / 2) * std::cos(theta / MIN_SHADOW_ANGLE * M_PI);
+  const double k  = sampling_rate * a_c;
+  const double b0 = (1.0 + alpha * k) / (1.0 + k);
+  const double b1 = (1.0 - alpha * k) / (1.0 + k);
+  const double a1 = (1.0 - k) / (1.0 + k);
+
+  // a linearly interpolated impulse at the delay, through the filter
+  std::vector<double> impulse(IMPULSE_RESPONSE_LENGTH, 0.0);
+  const double position = std::min(delay * sampling_rate + 1.0, double(IMPULSE_RESPONSE_LENGTH - 2));
+  const auto index = static_cast<size_t>(position);
+  const double fraction = position - double(index);
+  impulse[index]     = 1.0 - fraction;
+  impulse[index + 1] = fraction;
+
+  std::vector<float> res(IMPULSE_RESPONSE_LENGTH);
+  double previous_x = 0.0, previous_y = 0.0;
+  for (size_t n = 0; n < IMPULSE_RESPONSE_LENGTH; n++) {
+    const double y = b0 * impulse[n] + b1 * previous_x - a1 * previous_y;
+    previous_x = impulse[n];
+    previous_y = y;
+    res[n] = static_cast<float>(y);
+  }
+  return res;
+}
+
+} // anonymous namespace
+
+u_ptr<hrtf_set> hrtf_set::create_spherical_head(double sampling_rate, size_t block_size, uint32_t azimuth_count)
+{
+  auto res = create(block_size);
+  const Eigen::Vector3d right_ear = { 1.0, 0.0, 0.0 };
+
+  auto add_direction = [&](const Eigen::Vector3d& direction) {
+    const double theta_left  = std::acos(std::clamp(direction.dot(-right_ear), -1.0, 1.0));
+    const double theta_right = std::acos(std::clamp(direction.dot(right_ear), -1.0, 1.0));
+    res->add(direction,
+      create_spherical_head_response(theta_left, sampling_rate),
+      create_spherical_head_response(theta_right, sampling_rate));
+  };
+
+  for (double elevation : { -45.0, 0.0, 45.0 }) {
+    const double e = elevation * M_PI / 180.0;
+    for (uint32_t i = 0; i < azimuth_count; i++) {
+      // clockwise from the front
+      const double phi = 2.0 * M_PI * i / azimuth_count;
+      add_direction({ std::sin(phi) * std::cos(e), std::sin(e), -std::cos(phi) * std::cos(e) });
+    }
+  }
+  add_direction({ 0.0,  1.0, 0.0 });
+  add_direction({ 0.0, -1.0, 0.0 });
+  return res;
+}
+
+size_t hrtf_set::add(const Eigen::Vector3d& direction, std::span<const float> left, std::span<const float> right)
+{
+  if (direction.norm() == 0.0)
+    throw std::runtime_error("hrtf_set : the direction should not be zero");
+  entry e;
+  e.direction = direction.normalized();
+  e.left  = partitioned_filter::create(left, block_size_);
+  e.right = partitioned_filter::create(right, block_size_);
+  max_partition_count_ = std::max({ max_partition_count_, e.left->get_partition_count(), e.right->get_partition_count() });
+  entries_.emplace_back(std::move(e));
+  return entries_.size() - 1;
+}
+
+size_t hrtf_set::find_nearest(const Eigen::Vector3d& direction) const
+{
+  if (entries_.empty())
+    throw std::runtime_error("hrtf_set : empty");
+  size_t res = 0;
+  double best = -2.0;
+  for (size_t i = 0; i < entries_.size(); i++) {
+    const auto similarity = entries_[i].direction.dot(direction);
+    if (similarity > best) {
+      best = similarity;
+      res = i;
+    }
+  }
+  return res;
+}
+
+} // namespace hnll::audio
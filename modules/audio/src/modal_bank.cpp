@@ -0,0 +1,166 @@
+// hnll
+#include <audio/modal_bank.hpp>
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <immintrin.h>
+#define HNLL_MODAL_BANK_USE_SSE
+#endif
+
+namespace hnll::audio {
+
+namespace {
+
+// samples rendered per pass over the modes. the per sample accumulators stay in l1
+constexpr size_t BLOCK_SAMPLE_COUNT = 256;
+constexpr size_t LANE_COUNT = 4;
+
+} // anonymous namespace
+
+modal_bank::modal_bank(double sampling_rate, size_t max_mode_count) : sampling_rate_(sampling_rate)
+{
+  if (sampling_rate <= 0.0)
+    throw std::runtime_error("modal_bank : sampling rate should be positive");
+  const auto capacity = (std::max<size_t>(max_mode_count, 1) + LANE_COUNT - 1) / LANE_COUNT * LANE_COUNT;
+  re_.assign(capacity, 0.f);
+  im_.assign(capacity, 0.f);
+  cos_.assign(capacity, 0.f);
+  sin_.assign(capacity, 0.f);
+}
+
+material_id modal_bank::add_material(std::span<const modal_mode> modes)
+{
+  mode_table table;
+  for (const auto& mode : modes) {
+    if (mode.frequency <= 0.f || mode.frequency >= 0.5 * sampling_rate_)
+      continue;
+    const double omega = 2.0 * M_PI * mode.frequency / sampling_rate_;
+    const double r = std::exp(-std::max(mode.damping, 0.f) / sampling_rate_);
+    table.cos_coefficients.push_back(static_cast<float>(r * std::cos(omega)));
+    table.sin_coefficients.push_back(static_cast<float>(r * std::sin(omega)));
+    table.gains.push_back(mode.gain);
+  }
+  materials_.emplace_back(std::move(table));
+  return static_cast<material_id>(materials_.size() - 1);
+}
+
+void modal_bank::excite(material_id material, float impulse)
+{
+  const auto& table = materials_.at(material);
+  const auto count = table.gains.size();
+  const auto fit = std::min(count, re_.size() - active_count_);
+  dropped_mode_count_ += count - fit;
+
+  // the impulse response of a phasor starting at (a, 0) is a * r^n * sin(omega * n) on the imaginary axis
+  for (size_t i = 0; i < fit; i++) {
+    const auto slot = active_count_ + i;
+    re_[slot]  = impulse * table.gains[i];
+    im_[slot]  = 0.f;
+    cos_[slot] = table.cos_coefficients[i];
+    sin_[slot] = table.sin_coefficients[i];
+  }
+  active_count_ += fit;
+}
+
+void modal_bank::render(std::span<float> output)
+{
+  const size_t group_count = (active_count_ + LANE_COUNT - 1) / LANE_COUNT;
+
+  for (size_t begin = 0; begin < output.size(); begin += BLOCK_SAMPLE_COUNT) {
+    const size_t block = std::min(BLOCK_SAMPLE_COUNT, output.size() - begin);
+#ifdef HNLL_MODAL_BANK_USE_SSE
+    alignas(16) __m128 acc[BLOCK_SAMPLE_COUNT];
+    for (size_t n = 0; n < block; n++)
+      acc[n] = _mm_setzero_ps();
+
+    for (size_t g = 0; g < group_count; g++) {
+      const size_t i = g * LANE_COUNT;
+      __m128 re = _mm_loadu_ps(re_.data() + i);
+      __m128 im = _mm_loadu_ps(im_.data() + i);
+      const __m128 c = _mm_loadu_ps(cos_.data() + i);
+      const __m128 s = _mm_loadu_ps(sin_.data() + i);
+      for (size_t n = 0; n < block; n++) {
+        const __m128 next_re = _mm_sub_ps(_mm_mul_ps(c, re), _mm_mul_ps(s, im));
+        im = _mm_add_ps(_mm_mul_ps(s, re), _mm_mul_ps(c, im));
+        re = next_re;
+        acc[n] = _mm_add_ps(acc[n], im);
+      }
+      _mm_storeu_ps(re_.data() + i, re);
+      _mm_storeu_ps(im_.data() + i, im);
+    }
+
+    for (size_t n = 0; n < block; n++) {
+      alignas(16) float lanes[LANE_COUNT];
+      _mm_store_ps(lanes, acc[n]);
+      output[begin + n] += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    }
+#else
+    float acc[BLOCK_SAMPLE_COUNT] = {};
+    for (size_t i = 0; i < group_count * LANE_COUNT; i++) {
+      float re = re_[i], im = im_[i];
+      const float c = cos_[i], s = sin_[i];
+      for (size_t n = 0; n < block; n++) {
+        const float next_re = c * re - s * im;
+        im = s * re + c * im;
+        re = next_re;
+        acc[n] += im;
+      }
+      re_[i] = re;
+      im_[i] = im;
+    }
+    for (size_t n = 0; n < block; n++)
+      output[begin + n] += acc[n];
+#endif
+  }
+
+  retire_silent_modes();
+}
+
+void modal_bank::retire_silent_modes()
+{
+  constexpr float threshold = SILENCE_THRESHOLD * SILENCE_THRESHOLD;
+  size_t i = 0;
+  while (i < active_count_) {
+    if (re_[i] * re_[i] + im_[i] * im_[i] >= threshold) {
+      i++;
+      continue;
+    }
+    // swap with the last active mode and clear its lane
+    const auto last = --active_count_;
+    re_[i]  = re_[last];  re_[last]  = 0.f;
+    im_[i]  = im_[last];  im_[last]  = 0.f;
+    cos_[i] = cos_[last]; cos_[last] = 0.f;
+    sin_[i] = sin_[last]; sin_[last] = 0.f;
+  }
+}
+
+void modal_bank::clear()
+{
+  std::fill(re_.begin(),  re_.end(),  0.f);
+  std::fill(im_.begin(),  im_.end(),  0.f);
+  std::fill(cos_.begin(), cos_.end(), 0.f);
+  std::fill(sin_.begin(), sin_.end(), 0.f);
+  active_count_ = 0;
+}
+
+std::vector<modal_mode> modal_bank::create_rayleigh_modes(
+  float fundamental,
+  std::span<const float> ratios,
+  float alpha,
+  float beta)
+{
+  std::vector<modal_mode> res;
+  res.reserve(ratios.size());
+  for (auto ratio : ratios) {
+    const float frequency = fundamental * ratio;
+    const float omega = 2.f * static_cast<float>(M_PI) * frequency;
+    res.push_back({ frequency, alpha + beta * omega * omega, 1.f / ratio });
+  }
+  return res;
+}
+
+} // namespace hnll::audio
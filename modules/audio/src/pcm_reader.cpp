@@ -0,0 +1,133 @@
+// hnll
+#include <audio/pcm_reader.hpp>
+
+// std
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+namespace hnll::audio {
+
+namespace {
+
+constexpr uint16_t WAVE_FORMAT_PCM        = 1;
+constexpr uint16_t WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
+uint32_t read_u32(const uint8_t* p) { return p[0] | (p[1] << 8) | (p[2] << 16) | (uint32_t(p[3]) << 24); }
+uint16_t read_u16(const uint8_t* p) { return static_cast<uint16_t>(p[0] | (p[1] << 8)); }
+
+} // anonymous namespace
+
+u_ptr<pcm_reader> pcm_reader::create_from_wav(const std::string& path)
+{
+  std::ifstream file(path, std::ios::binary);
+  if (!file)
+    throw std::runtime_error("pcm_reader : failed to open " + path);
+
+  uint8_t header[12];
+  if (!file.read(reinterpret_cast<char*>(header), sizeof(header))
+      || std::memcmp(header, "RIFF", 4) != 0 || std::memcmp(header + 8, "WAVE", 4) != 0)
+    throw std::runtime_error("pcm_reader : not a WAV file : " + path);
+
+  // walk the chunks until the data chunk
+  uint16_t channel_count = 0, bits_per_sample = 0;
+  uint32_t sampling_rate = 0;
+  bool has_format = false;
+  while (true) {
+    uint8_t chunk[8];
+    if (!file.read(reinterpret_cast<char*>(chunk), sizeof(chunk)))
+      throw std::runtime_error("pcm_reader : no data chunk : " + path);
+    const auto size = read_u32(chunk + 4);
+
+    if (std::memcmp(chunk, "fmt ", 4) == 0) {
+      std::vector<uint8_t> fmt(std::max<uint32_t>(size, 16));
+      if (!file.read(reinterpret_cast<char*>(fmt.data()), size))
+        throw std::runtime_error("pcm_reader : broken fmt chunk : " + path);
+      const auto tag = read_u16(fmt.data());
+      // the sub format of WAVE_FORMAT_EXTENSIBLE starts with the format tag
+      const bool is_pcm = tag == WAVE_FORMAT_PCM || (tag == WAVE_FORMAT_EXTENSIBLE && size >= 26 && read_u16(fmt.data() + 24) == WAVE_FORMAT_PCM);
+      if (!is_pcm)
+        throw std::runtime_error("pcm_reader : only PCM WAV files are supported : " + path);
+      channel_count   = read_u16(fmt.data() + 2);
+      sampling_rate   = read_u32(fmt.data() + 4);
+      bits_per_sample = read_u16(fmt.data() + 14);
+      has_format = true;
+      file.seekg(size & 1, std::ios::cur);
+      continue;
+    }
+    else if (std::memcmp(chunk, "data", 4) == 0) {
+      if (!has_format)
+        throw std::runtime_error("pcm_reader : data chunk before fmt chunk : " + path);
+      const auto offset = static_cast<size_t>(file.tellg());
+      // the size field of a truncated or streamed file may be wrong
+      const auto available = std::filesystem::file_size(path) - offset;
+      return std::make_unique<pcm_reader>(path, channel_count, static_cast<ALsizei>(sampling_rate), bits_per_sample, offset, std::min<size_t>(size, available));
+    }
+    // chunks are padded to an even size
+    file.seekg(size + (size & 1), std::ios::cur);
+  }
+}
+
+u_ptr<pcm_reader> pcm_reader::create_from_raw(const std::string& path, uint32_t channel_count, ALsizei sampling_rate)
+{
+  if (!std::filesystem::exists(path))
+    throw std::runtime_error("pcm_reader : failed to open " + path);
+  return std::make_unique<pcm_reader>(path, channel_count, sampling_rate, 16, 0, std::filesystem::file_size(path));
+}
+
+pcm_reader::pcm_reader(const std::string& path, uint32_t channel_count, ALsizei sampling_rate, uint32_t bits_per_sample, size_t data_offset, size_t data_size)
+  : file_(path, std::ios::binary), channel_count_(channel_count), sampling_rate_(sampling_rate), data_offset_(data_offset)
+{
+  if (!file_)
+    throw std::runtime_error("pcm_reader : failed to open " + path);
+  if (channel_count != 1 && channel_count != 2)
+    throw std::runtime_error("pcm_reader : only mono and stereo are supported : " + path);
+  if (bits_per_sample != 8 && bits_per_sample != 16)
+    throw std::runtime_error("pcm_reader : only 8 and 16 bit samples are supported : " + path);
+  if (sampling_rate <= 0)
+    throw std::runtime_error("pcm_reader : invalid sampling rate : " + path);
+
+  bytes_per_sample_ = bits_per_sample / 8;
+  frame_count_ = data_size / (bytes_per_sample_ * channel_count_);
+  seek(0);
+}
+
+size_t pcm_reader::read(std::span<ALshort> samples)
+{
+  const size_t frame_count = std::min(samples.size() / channel_count_, frame_count_ - frame_position_);
+  const size_t sample_count = frame_count * channel_count_;
+  if (sample_count == 0) return 0;
+
+  if (bytes_per_sample_ == 2) {
+    file_.read(reinterpret_cast<char*>(samples.data()), static_cast<std::streamsize>(sample_count * sizeof(ALshort)));
+  }
+  else {
+    // unsigned 8 bit
+    narrow_samples_.resize(sample_count);
+    file_.read(reinterpret_cast<char*>(narrow_samples_.data()), static_cast<std::streamsize>(sample_count));
+    for (size_t i = 0; i < sample_count; i++)
+      samples[i] = static_cast<ALshort>((int(narrow_samples_[i]) - 128) << 8);
+  }
+
+  // a short read means the file shrank
+  const auto read_count = static_cast<size_t>(file_.gcount()) / bytes_per_sample_ / channel_count_;
+  if (read_count < frame_count) {
+    frame_count_ = frame_position_ + read_count;
+    file_.clear();
+  }
+  frame_position_ += read_count;
+  return read_count * channel_count_;
+}
+
+void pcm_reader::seek(size_t frame)
+{
+  frame_position_ = std::min(frame, frame_count_);
+  file_.clear();
+  file_.seekg(static_cast<std::streamoff>(data_offset_ + frame_position_ * bytes_per_sample_ * channel_count_));
+}
+
+ALenum pcm_reader::get_format() const
+{ return channel_count_ == 1 ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16; }
+
+} // namespace hnll::audio
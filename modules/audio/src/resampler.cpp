@@ -0,0 +1,139 @@
+// hnll
+#include <audio/resampler.hpp>
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <immintrin.h>
+#define HNLL_RESAMPLER_USE_SSE
+#endif
+
+namespace hnll::audio {
+
+namespace {
+
+// keeps the transition band below the nyquist frequency of the lower rate
+constexpr double CUTOFF_RATIO = 0.95;
+
+double blackman(double u)
+{
+  if (std::abs(u) >= 1.0) return 0.0;
+  return 0.42 + 0.5 * std::cos(M_PI * u) + 0.08 * std::cos(2.0 * M_PI * u);
+}
+
+double sinc(double x)
+{
+  if (std::abs(x) < 1e-9) return 1.0;
+  return std::sin(M_PI * x) / (M_PI * x);
+}
+
+// returns the dot products of the input with two rows of the table
+inline void dot2(const float* x, const float* row0, const float* row1, uint32_t count, float& out0, float& out1)
+{
+  uint32_t k = 0;
+  float sum0 = 0.f, sum1 = 0.f;
+#ifdef HNLL_RESAMPLER_USE_SSE
+  __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+  for (; k + 4 <= count; k += 4) {
+    const __m128 v = _mm_loadu_ps(x + k);
+    acc0 = _mm_add_ps(acc0, _mm_mul_ps(v, _mm_loadu_ps(row0 + k)));
+    acc1 = _mm_add_ps(acc1, _mm_mul_ps(v, _mm_loadu_ps(row1 + k)));
+  }
+  alignas(16) float lanes0[4], lanes1[4];
+  _mm_store_ps(lanes0, acc0);
+  _mm_store_ps(lanes1, acc1);
+  sum0 = (lanes0[0] + lanes0[1]) + (lanes0[2] + lanes0[3]);
+  sum1 = (lanes1[0] + lanes1[1]) + (lanes1[2] + lanes1[3]);
+#endif
+  for (; k < count; k++) {
+    sum0 += x[k] * row0[k];
+    sum1 += x[k] * row1[k];
+  }
+  out0 = sum0;
+  out1 = sum1;
+}
+
+} // anonymous namespace
+
+resampler::resampler(double input_rate, double output_rate, uint32_t tap_count)
+  : input_rate_(input_rate), output_rate_(output_rate)
+{
+  if (input_rate <= 0.0 || output_rate <= 0.0)
+    throw std::runtime_error("resampler : sampling rates should be positive");
+  step_      = input_rate / output_rate;
+  tap_count_ = std::max((tap_count + 3) & ~3u, 4u);
+
+  // row p is the filter for the fractional delay p / PHASE_COUNT
+  const int half = static_cast<int>(tap_count_ / 2);
+  const double cutoff = CUTOFF_RATIO * std::min(1.0, output_rate / input_rate);
+  table_.resize(static_cast<size_t>(PHASE_COUNT + 1) * tap_count_);
+  for (uint32_t p = 0; p <= PHASE_COUNT; p++) {
+    float* row = table_.data() + static_cast<size_t>(p) * tap_count_;
+    double sum = 0.0;
+    for (uint32_t k = 0; k < tap_count_; k++) {
+      const double d = double(p) / PHASE_COUNT + (half - 1) - int(k);
+      row[k] = static_cast<float>(cutoff * sinc(cutoff * d) * blackman(d / half));
+      sum += row[k];
+    }
+    // unit dc gain
+    for (uint32_t k = 0; k < tap_count_; k++)
+      row[k] = static_cast<float>(row[k] / sum);
+  }
+  reset();
+}
+
+void resampler::reset()
+{
+  pending_.assign(tap_count_ / 2 - 1, 0.f);
+  time_ = tap_count_ / 2 - 1;
+}
+
+void resampler::push(std::span<const float> input)
+{
+  pending_.insert(pending_.end(), input.begin(), input.end());
+}
+
+size_t resampler::get_available_count() const
+{
+  // the output at time t reads pending_[floor(t) - half + 1, floor(t) + half], so t < size - half
+  const double limit = static_cast<double>(pending_.size()) - tap_count_ / 2;
+  if (time_ >= limit) return 0;
+  return static_cast<size_t>(std::ceil((limit - time_) / step_));
+}
+
+size_t resampler::pull(std::span<float> output)
+{
+  const size_t capacity = std::min(output.size(), get_available_count());
+  const uint32_t offset = tap_count_ / 2 - 1;
+
+  size_t count = 0;
+  for (; count < capacity; count++) {
+    const auto i = static_cast<size_t>(time_);
+    // guards the rounding of get_available_count()
+    if (i + tap_count_ / 2 >= pending_.size()) break;
+    const double phase = (time_ - i) * PHASE_COUNT;
+    const auto p = std::min(static_cast<uint32_t>(phase), PHASE_COUNT - 1);
+    const auto w = static_cast<float>(phase - p);
+
+    float y0, y1;
+    dot2(pending_.data() + i - offset,
+         table_.data() + static_cast<size_t>(p) * tap_count_,
+         table_.data() + static_cast<size_t>(p + 1) * tap_count_,
+         tap_count_, y0, y1);
+    output[count] = y0 + (y1 - y0) * w;
+    time_ += step_;
+  }
+
+  // drop the input which no later output reads
+  const auto first = std::min(static_cast<size_t>(time_) - offset, pending_.size());
+  if (first > 0) {
+    pending_.erase(pending_.begin(), pending_.begin() + static_cast<std::ptrdiff_t>(first));
+    time_ -= static_cast<double>(first);
+  }
+  return count;
+}
+
+} // namespace hnll::audio
@@ -0,0 +1,126 @@
+// hnll
+#include <audio/spatial_mixer.hpp>
+
+// std
+#include <algorithm>
+#include <stdexcept>
+
+namespace hnll::audio {
+
+spatial_mixer::spatial_mixer(s_ptr<hrtf_set> hrtfs, std::span<const float> reverb_impulse_response, size_t max_voice_count)
+  : hrtfs_(std::move(hrtfs)), voices_(max_voice_count)
+{
+  if (hrtfs_ == nullptr || hrtfs_->get_entry_count() == 0)
+    throw std::runtime_error("spatial_mixer : the hrtf set is empty");
+  block_size_ = hrtfs_->get_block_size();
+
+  // in the reverse order, so that the first voice gets the id 0
+  for (size_t i = 0; i < max_voice_count; i++) {
+    voices_[i].input = convolver::create(block_size_, hrtfs_->get_max_partition_count());
+    free_ids_.push_back(static_cast<spatial_voice_id>(max_voice_count - 1 - i));
+  }
+
+  reverb_filter_ = partitioned_filter::create(reverb_impulse_response, block_size_);
+  reverb_ = convolver::create(block_size_, reverb_filter_->get_partition_count());
+
+  left_.assign(block_size_, 0.f);
+  right_.assign(block_size_, 0.f);
+  reverb_input_.assign(block_size_, 0.f);
+  ear_.assign(block_size_, 0.f);
+}
+
+spatial_voice_id spatial_mixer::add_voice()
+{
+  if (free_ids_.empty())
+    throw std::runtime_error("spatial_mixer : every voice is used");
+  const auto id = free_ids_.back();
+  free_ids_.pop_back();
+
+  auto& v = voices_[id];
+  v.input->reset();
+  v.previous_hrtf_index = hrtfs_->find_nearest({ 0.0, 0.0, -1.0 });
+  v.hrtf_index  = v.previous_hrtf_index;
+  v.gain        = 1.f;
+  v.reverb_send = 0.f;
+  v.is_alive = true;
+  voice_count_++;
+  return id;
+}
+
+void spatial_mixer::remove_voice(spatial_voice_id id)
+{
+  if (id >= voices_.size() || !voices_[id].is_alive) return;
+  voices_[id].is_alive = false;
+  free_ids_.push_back(id);
+  voice_count_--;
+}
+
+spatial_mixer::voice& spatial_mixer::get_voice(spatial_voice_id id)
+{
+  if (id >= voices_.size())
+    throw std::runtime_error("spatial_mixer : voice id out of range");
+  return voices_[id];
+}
+
+void spatial_mixer::set_direction(spatial_voice_id id, const Eigen::Vector3d& direction)
+{
+  auto& v = get_voice(id);
+  if (direction.norm() == 0.0) return;
+  v.hrtf_index.store(hrtfs_->find_nearest(direction.normalized()), std::memory_order_relaxed);
+}
+
+void spatial_mixer::process_voice(spatial_voice_id id, std::span<const float> input)
+{
+  auto& v = get_voice(id);
+  // the parameters of the whole block
+  const auto  hrtf_index  = v.hrtf_index.load(std::memory_order_relaxed);
+  const float gain        = v.gain.load(std::memory_order_relaxed);
+  const float reverb_send = v.reverb_send.load(std::memory_order_relaxed);
+  // one fft of the input serves both ears and both sides of a crossfade
+  v.input->push(input);
+
+  if (hrtf_index == v.previous_hrtf_index)
+    mix(hrtfs_->get_entry(hrtf_index), v, gain, 1.f, 1.f);
+  else {
+    mix(hrtfs_->get_entry(v.previous_hrtf_index), v, gain, 1.f, 0.f);
+    mix(hrtfs_->get_entry(hrtf_index), v, gain, 0.f, 1.f);
+    v.previous_hrtf_index = hrtf_index;
+  }
+
+  if (reverb_send != 0.f)
+    for (size_t i = 0; i < block_size_; i++)
+      reverb_input_[i] += reverb_send * gain * input[i];
+}
+
+void spatial_mixer::mix(const hrtf_set::entry& entry, voice& v, float voice_gain, float from_gain, float to_gain)
+{
+  const float step = (to_gain - from_gain) / static_cast<float>(block_size_);
+  for (auto [filter, output] : { std::pair{ entry.left.get(), &left_ }, { entry.right.get(), &right_ } }) {
+    v.input->convolve(*filter, ear_);
+    float gain = voice_gain * from_gain;
+    const float gain_step = voice_gain * step;
+    for (size_t i = 0; i < block_size_; i++, gain += gain_step)
+      (*output)[i] += gain * ear_[i];
+  }
+}
+
+void spatial_mixer::render(std::span<float> stereo)
+{
+  if (stereo.size() != 2 * block_size_)
+    throw std::runtime_error("spatial_mixer : the output should be one stereo block");
+
+  // the shared reverb is mono, the same on both ears
+  reverb_->push(reverb_input_);
+  reverb_->convolve(*reverb_filter_, ear_);
+  const float reverb_gain = reverb_gain_.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < block_size_; i++) {
+    stereo[2 * i]     = left_[i]  + reverb_gain * ear_[i];
+    stereo[2 * i + 1] = right_[i] + reverb_gain * ear_[i];
+  }
+
+  std::fill(left_.begin(), left_.end(), 0.f);
+  std::fill(right_.begin(), right_.end(), 0.f);
+  std::fill(reverb_input_.begin(), reverb_input_.end(), 0.f);
+}
+
+} // namespace hnll::audio
@@ -0,0 +1,147 @@
+// hnll
+#include <audio/streaming_source.hpp>
+#include <audio/engine.hpp>
+#include <audio/pcm_reader.hpp>
+
+// std
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+
+namespace hnll::audio {
+
+u_ptr<streaming_source> streaming_source::create(
+  fill_function fill,
+  ALsizei sampling_rate,
+  size_t buffer_sample_count,
+  size_t buffer_count,
+  ALenum format)
+{
+  return std::make_unique<streaming_source>(std::move(fill), sampling_rate, buffer_sample_count, buffer_count, format);
+}
+
+u_ptr<streaming_source> streaming_source::create_from_file(
+  const std::string& path,
+  bool is_looping,
+  size_t buffer_sample_count,
+  size_t buffer_count)
+{
+  const auto extension = std::filesystem::path(path).extension();
+  auto reader = (extension == ".pcm" || extension == ".raw")
+    ? pcm_reader::create_from_raw(path, 1, 44100)
+    : pcm_reader::create_from_wav(path);
+
+  auto res = std::make_unique<streaming_source>(nullptr, reader->get_sampling_rate(), buffer_sample_count, buffer_count, reader->get_format());
+  auto* raw = res.get();
+  res->fill_ = [raw](std::span<ALshort> samples) { return raw->read_file(samples); };
+  res->reader_ = std::move(reader);
+  res->is_looping_ = is_looping;
+  return res;
+}
+
+streaming_source::streaming_source(fill_function fill, ALsizei sampling_rate, size_t buffer_sample_count, size_t buffer_count, ALenum format)
+  : fill_(std::move(fill)), sampling_rate_(sampling_rate), format_(format)
+{
+  if (format != AL_FORMAT_MONO16 && format != AL_FORMAT_STEREO16)
+    throw std::runtime_error("streaming_source : only 16 bit mono and stereo are supported");
+  // whole frames only
+  buffer_sample_count -= buffer_sample_count % get_channel_count();
+  if (buffer_count < 2 || buffer_sample_count == 0)
+    throw std::runtime_error("streaming_source : at least two non-empty buffers are required");
+  if (engine::acquire_source(source_id_) == result::FAILURE)
+    throw std::runtime_error("streaming_source : no pending source");
+
+  buffer_ids_.resize(buffer_count);
+  alGenBuffers(static_cast<ALsizei>(buffer_count), buffer_ids_.data());
+  samples_.resize(buffer_sample_count);
+}
+
+streaming_source::~streaming_source()
+{
+  stop();
+  alDeleteBuffers(static_cast<ALsizei>(buffer_ids_.size()), buffer_ids_.data());
+  engine::release_source(source_id_);
+}
+
+void streaming_source::play()
+{
+  if (is_playing_) return;
+  if (reader_ && is_finished_) {
+    reader_->rewind();
+    is_finished_ = false;
+  }
+  for (auto id : buffer_ids_)
+    fill_and_queue(id);
+  alSourcePlay(source_id_);
+  is_playing_ = true;
+}
+
+void streaming_source::stop()
+{
+  if (!is_playing_) return;
+  alSourceStop(source_id_);
+  // every buffer is processed after stop
+  ALint queued = 0;
+  alGetSourcei(source_id_, AL_BUFFERS_QUEUED, &queued);
+  std::vector<buffer_id> ids(queued);
+  if (queued > 0)
+    alSourceUnqueueBuffers(source_id_, queued, ids.data());
+  is_playing_ = false;
+}
+
+void streaming_source::update()
+{
+  if (!is_playing_) return;
+
+  ALint processed = 0;
+  alGetSourcei(source_id_, AL_BUFFERS_PROCESSED, &processed);
+  while (processed-- > 0) {
+    buffer_id id;
+    alSourceUnqueueBuffers(source_id_, 1, &id);
+    fill_and_queue(id);
+  }
+
+  // the source stops by itself when every queued buffer has been played
+  ALint state = 0;
+  alGetSourcei(source_id_, AL_SOURCE_STATE, &state);
+  if (state != AL_PLAYING) {
+    // every buffer up to the end of the file has been played
+    if (is_finished_) {
+      stop();
+      return;
+    }
+    underrun_count_++;
+    alSourcePlay(source_id_);
+  }
+}
+
+void streaming_source::fill_and_queue(buffer_id id)
+{
+  // nothing left after the end of the file. the buffer stays unqueued
+  if (is_finished_) return;
+
+  const auto written = std::min(fill_(std::span<ALshort>(samples_)), samples_.size());
+  if (written < samples_.size()) {
+    if (!is_finished_) starved_buffer_count_++;
+    std::fill(samples_.begin() + static_cast<std::ptrdiff_t>(written), samples_.end(), ALshort(0));
+  }
+  alBufferData(id, format_, samples_.data(), static_cast<ALsizei>(samples_.size() * sizeof(ALshort)), sampling_rate_);
+  alSourceQueueBuffers(source_id_, 1, &id);
+}
+
+size_t streaming_source::read_file(std::span<ALshort> samples)
+{
+  size_t written = reader_->read(samples);
+  while (is_looping_ && written < samples.size()) {
+    reader_->rewind();
+    const auto count = reader_->read(samples.subspan(written));
+    // empty file
+    if (count == 0) break;
+    written += count;
+  }
+  if (!is_looping_ && reader_->is_end())
+    is_finished_ = true;
+  return written;
+}
+
+} // namespace hnll::audio
@@ -0,0 +1,222 @@
+// hnll
+#include <audio/voice_manager.hpp>
+#include <audio/audio_data.hpp>
+#include <audio/engine.hpp>
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace hnll::audio {
+
+namespace {
+
+inline uint32_t get_index(voice_id id)      { return static_cast<uint32_t>(id); }
+inline uint32_t get_generation(voice_id id) { return static_cast<uint32_t>(id >> 32); }
+
+float compute_audibility(const voice_params& params, const Eigen::Vector3d& listener_position)
+{
+  const auto distance = std::clamp(
+    static_cast<float>((params.position - listener_position).norm()),
+    params.min_distance,
+    params.max_distance);
+  // same curve as AL_INVERSE_DISTANCE_CLAMPED
+  const auto attenuation = params.min_distance / (params.min_distance + params.rolloff * (distance - params.min_distance));
+  return params.gain * attenuation;
+}
+
+} // anonymous namespace
+
+voice_manager::voice_manager(size_t max_real_count)
+{
+  for (size_t i = 0; i < max_real_count; i++) {
+    source_id id;
+    if (engine::acquire_source(id) == result::FAILURE) break;
+    owned_sources_.push_back(id);
+  }
+  if (owned_sources_.empty())
+    throw std::runtime_error("voice_manager : no pending source");
+  max_real_count_ = owned_sources_.size();
+  free_sources_ = owned_sources_;
+}
+
+voice_manager::~voice_manager()
+{
+  stop_all();
+  for (auto id : owned_sources_)
+    engine::release_source(id);
+}
+
+voice_id voice_manager::play(const audio_data& data, const voice_params& params)
+{
+  if (!data.is_bound_to_buffer())
+    throw std::runtime_error("voice_manager : audio_data is not bound to a buffer");
+
+  uint32_t index;
+  if (!free_indices_.empty()) {
+    index = free_indices_.back();
+    free_indices_.pop_back();
+  }
+  else {
+    index = static_cast<uint32_t>(voices_.size());
+    voices_.emplace_back();
+  }
+
+  const auto channel_count = (data.get_format() == AL_FORMAT_STEREO16 || data.get_format() == AL_FORMAT_STEREO8) ? 2 : 1;
+  const auto sample_size   = (data.get_format() == AL_FORMAT_MONO8 || data.get_format() == AL_FORMAT_STEREO8) ? 1 : 2;
+
+  auto& v = voices_[index];
+  v.params     = params;
+  v.buffer     = data.get_buffer_id();
+  v.duration   = float(data.get_data_size_in_byte()) / float(channel_count * sample_size * data.get_sampling_rate());
+  v.cursor     = 0.f;
+  v.audibility = 0.f;
+  v.is_alive   = true;
+  v.is_real    = false;
+  voice_count_++;
+  return (voice_id(v.generation) << 32) | index;
+}
+
+void voice_manager::stop(voice_id id)
+{
+  if (find(id) != nullptr)
+    free_voice(get_index(id));
+}
+
+void voice_manager::stop_all()
+{
+  for (uint32_t i = 0; i < voices_.size(); i++)
+    if (voices_[i].is_alive)
+      free_voice(i);
+}
+
+void voice_manager::update(float dt, const Eigen::Vector3d& listener_position)
+{
+  // advance the cursors and collect the audible voices
+  candidates_.clear();
+  for (uint32_t i = 0; i < voices_.size(); i++) {
+    auto& v = voices_[i];
+    if (!v.is_alive) continue;
+
+    v.cursor += dt * v.params.pitch;
+    if (v.cursor >= v.duration) {
+      if (!v.params.is_looping || v.duration <= 0.f) {
+        free_voice(i);
+        continue;
+      }
+      v.cursor = std::fmod(v.cursor, v.duration);
+    }
+
+    v.audibility = compute_audibility(v.params, listener_position);
+    if (v.audibility >= AUDIBILITY_THRESHOLD)
+      candidates_.push_back(i);
+  }
+
+  // the most important voices get the real sources
+  auto score = [this](uint32_t i) {
+    const auto& v = voices_[i];
+    return v.audibility * v.params.priority * (v.is_real ? REAL_VOICE_BONUS : 1.f);
+  };
+  const auto real_count = std::min(candidates_.size(), max_real_count_);
+  std::nth_element(candidates_.begin(), candidates_.begin() + real_count, candidates_.end(),
+    [&score](uint32_t a, uint32_t b) { return score(a) > score(b); });
+
+  // unbind first, so that the sources of the losers are free for the winners
+  for (size_t k = real_count; k < candidates_.size(); k++) {
+    auto& v = voices_[candidates_[k]];
+    if (v.is_real) {
+      unbind(v);
+      stolen_count_++;
+    }
+  }
+  for (uint32_t i = 0; i < voices_.size(); i++) {
+    auto& v = voices_[i];
+    if (v.is_alive && v.is_real && v.audibility < AUDIBILITY_THRESHOLD)
+      unbind(v);
+  }
+
+  for (size_t k = 0; k < real_count; k++) {
+    auto& v = voices_[candidates_[k]];
+    if (v.is_real) apply_params(v, listener_position);
+    else           bind(v, listener_position);
+  }
+}
+
+bool voice_manager::is_real(voice_id id) const
+{
+  auto v = find(id);
+  return v != nullptr && v->is_real;
+}
+
+float voice_manager::get_audibility(voice_id id) const
+{
+  auto v = find(id);
+  return v != nullptr ? v->audibility : 0.f;
+}
+
+void voice_manager::set_position(voice_id id, const Eigen::Vector3d& position)
+{ if (auto v = find(id)) v->params.position = position; }
+
+void voice_manager::set_gain(voice_id id, float gain)
+{ if (auto v = find(id)) v->params.gain = gain; }
+
+void voice_manager::set_priority(voice_id id, float priority)
+{ if (auto v = find(id)) v->params.priority = priority; }
+
+voice_manager::voice* voice_manager::find(voice_id id)
+{
+  const auto index = get_index(id);
+  if (index >= voices_.size()) return nullptr;
+  auto& v = voices_[index];
+  return (v.is_alive && v.generation == get_generation(id)) ? &v : nullptr;
+}
+
+const voice_manager::voice* voice_manager::find(voice_id id) const
+{ return const_cast<voice_manager*>(this)->find(id); }
+
+void voice_manager::free_voice(uint32_t index)
+{
+  auto& v = voices_[index];
+  if (v.is_real)
+    unbind(v);
+  v.is_alive = false;
+  // invalidates the handles of this slot
+  v.generation++;
+  free_indices_.push_back(index);
+  voice_count_--;
+}
+
+void voice_manager::bind(voice& v, const Eigen::Vector3d& listener_position)
+{
+  v.source = free_sources_.back();
+  free_sources_.pop_back();
+  v.is_real = true;
+
+  alSourcei(v.source, AL_BUFFER, static_cast<ALint>(v.buffer));
+  alSourcei(v.source, AL_LOOPING, v.params.is_looping ? AL_TRUE : AL_FALSE);
+  // the attenuation is applied through AL_GAIN, so the position is only used for panning
+  alSourcei(v.source, AL_SOURCE_RELATIVE, AL_TRUE);
+  alSourcef(v.source, AL_ROLLOFF_FACTOR, 0.f);
+  alSourcef(v.source, AL_SEC_OFFSET, v.cursor);
+  apply_params(v, listener_position);
+  alSourcePlay(v.source);
+}
+
+void voice_manager::unbind(voice& v)
+{
+  alSourceStop(v.source);
+  alSourcei(v.source, AL_BUFFER, 0);
+  free_sources_.push_back(v.source);
+  v.is_real = false;
+}
+
+void voice_manager::apply_params(const voice& v, const Eigen::Vector3d& listener_position)
+{
+  const Eigen::Vector3d relative = v.params.position - listener_position;
+  alSourcef(v.source, AL_GAIN, v.audibility);
+  alSourcef(v.source, AL_PITCH, v.params.pitch);
+  alSource3f(v.source, AL_POSITION, float(relative.x()), float(relative.y()), float(relative.z()));
+}
+
+} // namespace hnll::audio
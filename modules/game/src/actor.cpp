@@ -1,8 +1,12 @@
 // hnll
 #include <game/actor.hpp>
 #include <game/engine.hpp>
+#include <game/components/renderable_component.hpp>
 #include <physics/collision_info.hpp>
 
+// std
+#include <atomic>
+
 namespace hnll::game {
 
 s_ptr<actor> actor::create()
@@ -15,12 +19,22 @@ s_ptr<actor> actor::create()
 
 actor::actor()
 { 
-  static actor_id id = 0;
+  // actors may be created by parallel updates
+  static std::atomic<actor_id> id = 0;
   // add automatically
   id_ = id++;
   transform_sp_ = std::make_shared<hnll::utils::transform>();
 }
 
+utils::ecs_world& actor::get_ecs_world() { return engine::get_ecs_world(); }
+
+utils::entity actor::get_entity()
+{
+  if (entity_.is_null())
+    entity_ = utils::scoped_entity(get_ecs_world(), get_ecs_world().create_entity());
+  return entity_.get();
+}
+
 void actor::update(float dt)
 {
   update_actor(dt);
@@ -37,6 +51,20 @@ void actor::update_components(float dt)
     renderable_component_->update(dt);
 }
 
+void actor::declare_actor_access(utils::access_list& access) const
+{ access.write(this); }
+
+void actor::declare_access(utils::access_list& access) const
+{
+  declare_actor_access(access);
+  for (const auto& comp : unique_components_)
+    comp->declare_access(access);
+  for (const auto& comp : shared_components_)
+    comp->declare_access(access);
+  if (is_renderable())
+    renderable_component_->declare_access(access);
+}
+
 void actor::re_update(const physics::collision_info &info) {}
 
 #ifndef IMGUI_DISABLED
@@ -1,15 +1,33 @@
 // hnll
 #include <game/components/rigid_component.hpp>
 #include <game/components/mesh_component.hpp>
+#include <game/engine.hpp>
 #include <geometry/bounding_volume.hpp>
+#include <geometry/convex_hull.hpp>
+#include <geometry/sphere_tree.hpp>
 #include <physics/collision_detector.hpp>
 
+// std
+#include <stdexcept>
+
 namespace hnll::game {
 
+namespace {
+
+// the model of a component is null while it is loaded
+geometry::position_span get_resident_positions(const s_ptr<mesh_component>& mesh_component)
+{
+  if (!mesh_component->is_resident())
+    throw std::runtime_error("rigid_component : the model of the mesh component isn't resident yet");
+  return mesh_component->get_model().get_vertex_position_span();
+}
+
+} // anonymous namespace
+
 s_ptr<rigid_component> rigid_component::create_with_aabb(actor& owner, const s_ptr<hnll::game::mesh_component>& mesh_component)
 {
-  auto mesh_vertices = mesh_component->get_model().get_vertex_position_list();
-  auto bv = geometry::bounding_volume::create_aabb(mesh_vertices);
+  auto mesh_positions = get_resident_positions(mesh_component);
+  auto bv = geometry::bounding_volume::create_aabb(mesh_positions, &engine::get_job_system());
   bv->set_transform(owner.get_transform_sp());
 
   // automatically add to the intersection (as static member)
@@ -21,8 +39,39 @@ s_ptr<rigid_component> rigid_component::create_with_aabb(actor& owner, const s_p
 
 s_ptr<rigid_component> rigid_component::create_with_b_sphere(actor& owner, const s_ptr<game::mesh_component>& mesh_component)
 {
-  auto mesh_vertices = mesh_component->get_model().get_vertex_position_list();
-  auto bv = geometry::bounding_volume::create_bounding_sphere(geometry::bv_ctor_type::RITTER, mesh_vertices);
+  auto mesh_positions = get_resident_positions(mesh_component);
+  auto bv = geometry::bounding_volume::create_bounding_sphere(geometry::bv_ctor_type::RITTER, mesh_positions, &engine::get_job_system());
+  bv->set_transform(owner.get_transform_sp());
+
+  auto rc = std::make_shared<rigid_component>(owner);
+  rc->set_bounding_volume(std::move(bv));
+  physics::collision_detector::add_rigid_component(rc);
+  return rc;
+}
+
+s_ptr<rigid_component> rigid_component::create_with_convex_hull(actor& owner, const s_ptr<game::mesh_component>& mesh_component)
+{
+  auto hull = geometry::convex_hull::create(get_resident_positions(mesh_component));
+  auto bv = geometry::bounding_volume::create_convex_hull(hull);
+  bv->set_transform(owner.get_transform_sp());
+
+  auto rc = std::make_shared<rigid_component>(owner);
+  rc->set_bounding_volume(std::move(bv));
+  physics::collision_detector::add_rigid_component(rc);
+  return rc;
+}
+
+s_ptr<rigid_component> rigid_component::create_with_sphere_tree(actor& owner, const std::string& model_name)
+{
+  auto tree = geometry::sphere_tree::find(model_name);
+  // the mesh models don't keep their indices, so they are loaded again only to build or validate the tree
+  if (tree == nullptr) {
+    graphics::mesh_builder builder;
+    builder.load_asset(model_name);
+    auto positions = graphics::mesh_model::get_position_span(builder.vertices);
+    tree = geometry::sphere_tree::create_with_cache(model_name, positions, builder.indices);
+  }
+  auto bv = geometry::bounding_volume::create_sphere_tree(tree);
   bv->set_transform(owner.get_transform_sp());
 
   auto rc = std::make_shared<rigid_component>(owner);
@@ -48,6 +97,8 @@ s_ptr<rigid_component> rigid_component::create(actor& owner, const std::vector<v
   else if (type == geometry::bv_type::SPHERE)
     bv = geometry::bounding_volume::create_bounding_sphere
     (geometry::bv_ctor_type::RITTER, positions);
+  else if (type == geometry::bv_type::CONVEX_HULL)
+    bv = geometry::bounding_volume::create_convex_hull(geometry::convex_hull::create(positions));
 
   bv->set_transform(owner.get_transform_sp());
 
@@ -60,9 +111,38 @@ rigid_component::rigid_component(actor& owner) : component()
   static rigid_component_id id = 0;
 
   this->rigid_component_id_ = id++;
-  this->owner_id_ = owner.get_id();
+  this->owner_handle_ = owner.get_handle();
+  this->owner_id_     = owner.get_id();
   // use same transform as owner's
   this->transform_sp_ = owner.get_transform_sp();
+
+  body_.id = rigid_component_id_;
+  body_.read_transform(*transform_sp_);
+}
+
+void rigid_component::set_mass(double mass)
+{
+  mass_ = mass;
+  if (body_.is_dynamic() && bounding_volume_) {
+    const auto& scale = transform_sp_->scale;
+    body_.set_mass(mass_, *bounding_volume_, { scale.x, scale.y, scale.z });
+  }
+}
+
+void rigid_component::set_motion_type(physics::motion_type type)
+{
+  body_.type = type;
+  body_.read_transform(*transform_sp_);
+  body_.linear_velocity.setZero();
+  body_.angular_velocity.setZero();
+  body_.wake_up();
+  // static and kinematic bodies have infinite mass
+  if (type == physics::motion_type::DYNAMIC)
+    set_mass(mass_);
+  else {
+    body_.inv_mass = 0.0;
+    body_.inv_inertia_local.setZero();
+  }
 }
 
 } // namespace hnll::game
\ No newline at end of file
@@ -1,6 +1,7 @@
 // hnll
 #include <game/engine.hpp>
 #include <game/actor.hpp>
+#include <game/actor_data.hpp>
 #include <game/shading_system.hpp>
 // modules
 #include <game/modules/physics_engine.hpp>
@@ -23,13 +24,19 @@
 #include <graphics/skinning_mesh_model.hpp>
 #include <graphics/frame_anim_mesh_model.hpp>
 #include <graphics/frame_anim_meshlet_model.hpp>
+#include <graphics/upload_batch.hpp>
+
+#include <audio/audio_thread.hpp>
 
 // lib
 #include <imgui.h>
 
 // std
+#include <algorithm>
+#include <exception>
 #include <filesystem>
 #include <iostream>
+#include <thread>
 
 namespace hnll::game {
 
@@ -37,15 +44,28 @@ constexpr float MAX_FPS = 60.0f;
 constexpr float MAX_DT = 0.05f;
 
 // static members
-u_ptr<graphics_engine>  engine::graphics_engine_{};
-actor_map               engine::active_actor_map_{};
-actor_map               engine::pending_actor_map_{};
-std::vector<actor_id>   engine::dead_actor_ids_{};
+u_ptr<utils::job_system>  engine::job_system_{};
+u_ptr<utils::frame_scheduler> engine::frame_scheduler_{};
+utils::ecs_world          engine::ecs_world_{};
+u_ptr<audio::audio_thread> engine::audio_thread_{};
+bool                      engine::is_shading_system_added_ = false;
+u_ptr<graphics_engine>    engine::graphics_engine_{};
+actor_map                 engine::active_actor_map_{};
+std::vector<s_ptr<actor>> engine::pending_actors_{};
+std::mutex                engine::pending_actor_mutex_;
+std::vector<actor_handle> engine::dead_actor_handles_{};
 graphics_model_map<graphics::mesh_model>               engine::mesh_model_map_;
 graphics_model_map<graphics::meshlet_model>            engine::meshlet_model_map_;
 graphics_model_map<graphics::skinning_mesh_model>      engine::skinning_mesh_model_map_;
 graphics_model_map<graphics::frame_anim_mesh_model>    engine::frame_anim_mesh_model_map_;
 graphics_model_map<graphics::frame_anim_meshlet_model> engine::frame_anim_meshlet_model_map_;
+std::map<std::pair<utils::shading_type, std::string>, std::vector<engine::loading_callback>> engine::loading_models_;
+engine::model_upload             engine::recording_upload_;
+std::deque<engine::model_upload> engine::submitted_uploads_;
+utils::residency_manager         engine::residency_manager_;
+std::map<std::pair<utils::shading_type, std::string>, utils::residency_id> engine::model_residencies_;
+std::map<std::pair<utils::shading_type, std::string>, int> engine::model_priorities_;
+std::deque<std::pair<uint64_t, s_ptr<void>>> engine::retired_models_;
 
 // glfw
 GLFWwindow* engine::glfw_window_;
@@ -53,7 +73,11 @@ std::vector<u_ptr<std::function<void(GLFWwindow*, int, int, int)>>> engine::glfw
 
 engine::engine(const char* window_name, utils::rendering_type rendering_type)
 {
+  // before the modules, which may submit jobs while they are created
+  job_system_      = utils::job_system::create();
+  frame_scheduler_ = utils::frame_scheduler::create();
   graphics_engine_ = std::make_unique<graphics_engine>(window_name, rendering_type);
+  physics_engine_  = std::make_unique<physics_engine>();
 
   set_glfw_window();
 
@@ -74,12 +98,33 @@ engine::engine(const char* window_name, utils::rendering_type rendering_type)
 
 engine::~engine() = default;
 
+audio::audio_thread& engine::get_audio_thread()
+{
+  if (!audio_thread_)
+    audio_thread_ = audio::audio_thread::create();
+  return *audio_thread_;
+}
+
 void engine::run()
 {
   current_time_ = std::chrono::system_clock::now();
+#ifdef IMGUI_DISABLED
+  if (render_mode_ == render_mode::PIPELINED && graphics_engine_->is_pipeline_safe())
+    run_pipelined();
+  else
+#endif
+    run_serial();
+  graphics_engine_->wait_idle();
+  cleanup();
+}
+
+void engine::run_serial()
+{
   while (!glfwWindowShouldClose(glfw_window_))
   {
     glfwPollEvents();
+    // glfw and vulkan work submitted by the jobs
+    job_system_->process_main_thread_jobs();
     process_input();
     update();
     // TODO : implement as physics engine
@@ -87,8 +132,85 @@ void engine::run()
 
     render();
   }
-  graphics_engine_->wait_idle();
-  cleanup();
+}
+
+void engine::run_pipelined()
+{
+  utils::frame_pipeline<render_snapshot> pipeline(render_latency_);
+  render_pipeline_ = &pipeline;
+
+  std::exception_ptr render_error;
+  std::thread render_thread([this, &pipeline, &render_error] {
+    try {
+      while (auto* snapshot = pipeline.begin_read()) {
+        graphics_engine_->render(*snapshot);
+        pipeline.end_read();
+      }
+    }
+    catch (...) {
+      render_error = std::current_exception();
+      pipeline.close();
+    }
+  });
+
+  bool falls_back = false;
+  while (!glfwWindowShouldClose(glfw_window_))
+  {
+    glfwPollEvents();
+    job_system_->process_main_thread_jobs();
+    process_input();
+    update();
+    re_update_actors();
+
+    // the loaded models may have added systems. an unsafe one never reaches a snapshot
+    if (is_shading_system_added_) {
+      is_shading_system_added_ = false;
+      if (!graphics_engine_->is_pipeline_safe()) {
+        falls_back = true;
+        break;
+      }
+    }
+
+    // blocks while the renderer is behind by the latency
+    auto* snapshot = pipeline.begin_write();
+    if (snapshot == nullptr)
+      break;
+    viewer_info_ = camera_up_->get_viewer_info();
+    graphics_engine_->capture(*snapshot, viewer_info_, frustum_info_);
+    pipeline.end_write();
+    release_retired_actors();
+  }
+
+  pipeline.close();
+  render_thread.join();
+  render_pipeline_ = nullptr;
+  release_retired_actors();
+  if (render_error)
+    std::rethrow_exception(render_error);
+
+  if (falls_back) {
+    // the frame of the fallback is skipped, the serial loop updates again
+    graphics_engine_->wait_idle();
+    run_serial();
+  }
+}
+
+void engine::retire_actor(s_ptr<actor>&& dead)
+{
+  // no longer captured nor synced by the physics
+  dead->remove_data<render_state>();
+  dead->remove_data<world_transform>();
+  dead->remove_data<rigid_state>();
+  if (render_pipeline_ != nullptr)
+    retired_actors_.emplace_back(render_pipeline_->get_write_count(), std::move(dead));
+}
+
+void engine::release_retired_actors()
+{
+  // every frame written before the death has been rendered
+  const auto rendered = render_pipeline_ != nullptr ? render_pipeline_->get_release_count() : ~0ull;
+  while (!retired_actors_.empty() && retired_actors_.front().first <= rendered)
+    retired_actors_.pop_front();
 }
 
 void engine::process_input()
@@ -109,17 +231,11 @@ void engine::update()
 //  } while(dt < 1.0f / MAX_FPS);
 
   dt = std::min(dt, MAX_DT);
+  frame_dt_ = dt;
 
-  for (auto& kv : active_actor_map_) {
-    const auto id = kv.first;
-    auto& actor = kv.second;
-    if(actor->get_actor_state() == actor::state::ACTIVE)
-      actor->update(dt);
-    // check if the actor is dead
-    if (actor->get_actor_state() == actor::state::DEAD) {
-      dead_actor_ids_.emplace_back(id);
-    }
-  }
+  update_actors(dt);
+  for (auto& system : ecs_systems_)
+    system(ecs_world_, dt);
 
   // engine specific update
   update_game(dt);
@@ -128,30 +244,107 @@ void engine::update()
   camera_up_->update(dt);
   light_manager_up_->update(dt);
 
+  // the tasks may add or remove actors
+  frame_scheduler_->run_frame(frame_budget_ms_);
+  // the callbacks of the loaded models may add actors
+  update_model_uploads();
+  // evicts the unreferenced models over the budget
+  residency_manager_.next_frame();
+  residency_manager_.trim();
+  release_retired_models();
+
   current_time_ = new_time;
   is_updating_ = false;
 
   // activate pending actor
-  for (auto& pend : pending_actor_map_) {
-    if(pend.second->is_renderable())
-      graphics_engine_->add_renderable_component(pend.second->get_renderable_component_r());
-    active_actor_map_.emplace(pend.first, std::move(pend.second));
+  std::lock_guard<std::mutex> lock(pending_actor_mutex_);
+  if (!pending_actors_.empty() || !dead_actor_handles_.empty())
+    is_update_plan_dirty_ = true;
+  for (auto& pend : pending_actors_) {
+    // removed during the update
+    if (pend->get_actor_state() == actor::state::DEAD) {
+      physics_engine_->remove_actor(pend->get_id());
+      continue;
+    }
+    auto& activated = *pend;
+    if (activated.is_renderable())
+      add_render_state(activated.get_entity(), activated.get_renderable_component_r());
+    activated.set_handle(active_actor_map_.insert(std::move(pend)));
+    physics_engine_->activate_actor(activated.get_id(), activated.get_handle());
   }
-  pending_actor_map_.clear();
+  pending_actors_.clear();
   // clear all the dead actors
-  for (const auto& id : dead_actor_ids_) {
-    if (active_actor_map_[id]->is_renderable())
-      graphics_engine_->remove_renderable_component(active_actor_map_[id]->get_renderable_component_r());
-    active_actor_map_.erase(id);
+  for (const auto& handle : dead_actor_handles_) {
+    auto* dead = get_active_actor(handle);
+    if (dead == nullptr) continue;
+    physics_engine_->remove_actor(dead->get_id());
+    dead->set_handle({});
+    retire_actor(std::move(*active_actor_map_.get(handle)));
+    active_actor_map_.erase(handle);
   }
-  dead_actor_ids_.clear();
+  dead_actor_handles_.clear();
+}
+
+void engine::update_actors(float dt)
+{
+  if (is_update_plan_dirty_)
+    build_update_plan();
+
+  auto* jobs = update_mode_ == update_mode::PARALLEL ? job_system_.get() : nullptr;
+  // the actors may read their data in parallel, so adding or removing it throws in both modes
+  utils::ecs_world::structure_lock lock(ecs_world_);
+  update_batches_.run(jobs, [this, dt](uint32_t i) {
+    auto* a = update_order_[i];
+    if (a->get_actor_state() == actor::state::ACTIVE)
+      a->update(dt);
+  });
+
+  // check if the actor is dead
+  for (auto* a : update_order_)
+    if (a->get_actor_state() == actor::state::DEAD)
+      dead_actor_handles_.emplace_back(a->get_handle());
+}
+
+void engine::build_update_plan()
+{
+  update_order_.clear();
+  update_order_.reserve(active_actor_map_.size());
+  for (auto& a : active_actor_map_)
+    update_order_.emplace_back(a.get());
+  std::sort(update_order_.begin(), update_order_.end(),
+    [](const actor* a, const actor* b) { return a->get_id() < b->get_id(); });
+
+  update_batches_.clear();
+  utils::access_list access;
+  for (auto* a : update_order_) {
+    access.clear();
+    a->declare_access(access);
+    update_batches_.add(access);
+  }
+  is_update_plan_dirty_ = false;
 }
 
 
 // physics
 void engine::re_update_actors()
 {
-  physics_engine_->re_update();
+  physics_engine_->re_update(frame_dt_);
+  update_world_transforms();
+}
+
+void engine::add_render_state(utils::entity e, renderable_component& comp)
+{
+  ecs_world_.add<world_transform>(e, comp.get_transform_sp().get());
+  ecs_world_.add<render_state>(e, &comp, static_cast<uint32_t>(comp.get_shading_type()));
+}
+
+void engine::update_world_transforms()
+{
+  auto refresh = [](world_transform& transform) { transform.refresh(); };
+  if (update_mode_ == update_mode::PARALLEL)
+    ecs_world_.each_parallel<world_transform>(*job_system_, refresh);
+  else
+    ecs_world_.each<world_transform>(refresh);
 }
 
 void engine::render()
@@ -173,11 +366,8 @@ void engine::update_gui()
 {
   // some general imgui upgrade
   update_game_gui();
-  for (auto& kv : active_actor_map_) {
-  const id_t& id = kv.first;
-  auto& actor = kv.second;
-  actor->update_gui();
-  }
+  for (auto& actor : active_actor_map_)
+    actor->update_gui();
 }
 #endif
 
@@ -243,6 +433,7 @@ void engine::load_model(const std::string &model_name, utils::shading_type type)
         check_and_add_shading_system<mesh_shading_system>(type);
         auto model = graphics::mesh_model::create_from_file(get_graphics_device(), path.filename().string());
         mesh_model_map_.emplace(path.filename().string(), std::move(model));
+        track_model(type, path.filename().string(), mesh_model_map_);
       }
       else
         std::cerr << "extension " << path.extension().string() << " is not supported for shading_type::MESH." << std::endl;
@@ -253,6 +444,7 @@ void engine::load_model(const std::string &model_name, utils::shading_type type)
         check_and_add_shading_system<meshlet_shading_system>(type);
         auto model = graphics::meshlet_model::create_from_file(get_graphics_device(), path.filename().string());
         meshlet_model_map_.emplace(path.filename().string(), std::move(model));
+        track_model(type, path.filename().string(), meshlet_model_map_);
       }
       else
         std::cerr << "extension " << path.extension().string() << " is not supported for shading_type::MESHLET." << std::endl;
@@ -291,19 +483,258 @@ void engine::load_model(const std::string &model_name, utils::shading_type type)
   }
 }
 
+template <typename Model>
+void engine::track_model(utils::shading_type type, const std::string& model_name, graphics_model_map<Model>& map)
+{
+  int priority = 0;
+  if (auto it = model_priorities_.find({ type, model_name }); it != model_priorities_.end())
+    priority = it->second;
+  auto id = residency_manager_.add(model_name, map.at(model_name)->get_byte_size(), priority, [type, model_name, &map] {
+    auto it = map.find(model_name);
+    if (it != map.end()) {
+      retired_models_.emplace_back(residency_manager_.get_frame_count(), s_ptr<void>(std::move(it->second)));
+      map.erase(it);
+    }
+    model_residencies_.erase({ type, model_name });
+  });
+  model_residencies_[{ type, model_name }] = id;
+}
+
+void engine::set_model_priority(utils::shading_type type, const std::string& model_name, int priority)
+{
+  model_priorities_[{ type, model_name }] = priority;
+  auto it = model_residencies_.find({ type, model_name });
+  if (it != model_residencies_.end())
+    residency_manager_.set_priority(it->second, priority);
+}
+
+void engine::release_retired_models()
+{
+  // the renderer lags behind by the latency, and the device by the frames in flight
+  const uint64_t delay = graphics::swap_chain::MAX_FRAMES_IN_FLIGHT + render_latency_ + 1;
+  const auto frame = residency_manager_.get_frame_count();
+  while (!retired_models_.empty() && retired_models_.front().first + delay <= frame)
+    retired_models_.pop_front();
+}
+
+mesh_model_handle engine::acquire_mesh_model(const std::string& model_name)
+{
+  if (mesh_model_map_.find(model_name) == mesh_model_map_.end())
+    load_model(model_name, utils::shading_type::MESH);
+  auto it = mesh_model_map_.find(model_name);
+  if (it == mesh_model_map_.end())
+    return {};
+  const auto id = get_model_residency(utils::shading_type::MESH, model_name);
+  return mesh_model_handle(it->second.get(), utils::residency_ref(residency_manager_, id));
+}
+
+meshlet_model_handle engine::acquire_meshlet_model(const std::string& model_name)
+{
+  if (meshlet_model_map_.find(model_name) == meshlet_model_map_.end())
+    load_model(model_name, utils::shading_type::MESHLET);
+  auto it = meshlet_model_map_.find(model_name);
+  if (it == meshlet_model_map_.end())
+    return {};
+  const auto id = get_model_residency(utils::shading_type::MESHLET, model_name);
+  return meshlet_model_handle(it->second.get(), utils::residency_ref(residency_manager_, id));
+}
+
+graphics::upload_batch& engine::get_upload_batch()
+{
+  if (!recording_upload_.batch)
+    recording_upload_.batch = graphics::upload_batch::create(get_graphics_device());
+  return *recording_upload_.batch;
+}
+
+void engine::update_model_uploads()
+{
+  if (recording_upload_.batch) {
+    recording_upload_.batch->submit();
+    submitted_uploads_.emplace_back(std::move(recording_upload_));
+    recording_upload_ = {};
+  }
+  // the batches are submitted to the same queue, so they complete in order
+  while (!submitted_uploads_.empty() && submitted_uploads_.front().batch->is_complete()) {
+    auto upload = std::move(submitted_uploads_.front());
+    submitted_uploads_.pop_front();
+    for (auto& commit : upload.commits)
+      commit();
+  }
+}
+
+void engine::add_loading_callback(
+  utils::shading_type type,
+  const std::string& model_name,
+  std::function<void()>&& on_loaded,
+  std::function<void(const std::string&)>&& on_failed)
+{
+  // the entry marks the model as loading even without callbacks
+  loading_models_[{ type, model_name }].push_back({ std::move(on_loaded), std::move(on_failed) });
+}
+
+void engine::finish_loading(utils::shading_type type, const std::string& model_name)
+{
+  auto node = loading_models_.extract({ type, model_name });
+  if (node.empty())
+    return;
+  for (auto& callback : node.mapped())
+    if (callback.on_loaded) callback.on_loaded();
+}
+
+void engine::fail_loading(utils::shading_type type, const std::string& model_name, const std::string& error)
+{
+  auto node = loading_models_.extract({ type, model_name });
+  if (node.empty())
+    return;
+  bool reported = false;
+  for (auto& callback : node.mapped()) {
+    if (callback.on_failed) {
+      callback.on_failed(error);
+      reported = true;
+    }
+  }
+  if (!reported)
+    std::cerr << "failed to load " << model_name << " : " << error << std::endl;
+}
+
+void engine::load_mesh_model_async(
+  const std::string& model_name,
+  std::function<void(graphics::mesh_model&)>&& on_loaded,
+  std::function<void(const std::string&)>&& on_failed)
+{
+  if (auto it = mesh_model_map_.find(model_name); it != mesh_model_map_.end()) {
+    if (on_loaded) on_loaded(*it->second);
+    return;
+  }
+
+  const auto type = utils::shading_type::MESH;
+  const bool is_loading = loading_models_.contains({ type, model_name });
+  add_loading_callback(type, model_name, on_loaded ?
+    std::function<void()>([model_name, func = std::move(on_loaded)] { func(*mesh_model_map_.at(model_name)); }) :
+    std::function<void()>(), std::move(on_failed));
+  if (is_loading)
+    return;
+
+  check_and_add_shading_system<mesh_shading_system>(type);
+  // the job system outlives the running jobs
+  auto& jobs = *job_system_;
+  jobs.run([&jobs, model_name, type] {
+    auto builder = std::make_shared<graphics::mesh_builder>();
+    try {
+      // the parse is split into the jobs too
+      builder->load_asset(model_name, &jobs);
+    }
+    catch (const std::exception& e) {
+      jobs.run([model_name, type, error = std::string(e.what())] { fail_loading(type, model_name, error); },
+        nullptr, utils::job_affinity::MAIN_THREAD);
+      return;
+    }
+
+    // the uploads are recorded on the main thread
+    jobs.run([model_name, type, builder] {
+      auto model = std::make_shared<u_ptr<graphics::mesh_model>>();
+      try {
+        *model = std::make_unique<graphics::mesh_model>(get_graphics_device(), *builder, &get_upload_batch());
+      }
+      catch (const std::exception& e) {
+        fail_loading(type, model_name, e.what());
+        return;
+      }
+      recording_upload_.commits.emplace_back([model_name, type, model] {
+        // a synchronous get_mesh_model() may have loaded it meanwhile
+        if (mesh_model_map_.try_emplace(model_name, std::move(*model)).second)
+          track_model(type, model_name, mesh_model_map_);
+        finish_loading(type, model_name);
+      });
+    }, nullptr, utils::job_affinity::MAIN_THREAD, "upload mesh model");
+  }, nullptr, utils::job_affinity::ANY, "load mesh model");
+}
+
+void engine::load_meshlet_model_async(
+  const std::string& model_name,
+  std::function<void(graphics::meshlet_model&)>&& on_loaded,
+  std::function<void(const std::string&)>&& on_failed)
+{
+  if (auto it = meshlet_model_map_.find(model_name); it != meshlet_model_map_.end()) {
+    if (on_loaded) on_loaded(*it->second);
+    return;
+  }
+
+  const auto type = utils::shading_type::MESHLET;
+  const bool is_loading = loading_models_.contains({ type, model_name });
+  add_loading_callback(type, model_name, on_loaded ?
+    std::function<void()>([model_name, func = std::move(on_loaded)] { func(*meshlet_model_map_.at(model_name)); }) :
+    std::function<void()>(), std::move(on_failed));
+  if (is_loading)
+    return;
+
+  check_and_add_shading_system<meshlet_shading_system>(type);
+  auto& jobs = *job_system_;
+  jobs.run([&jobs, model_name, type] {
+    auto data = std::make_shared<graphics::meshlet_model_data>();
+    try {
+      *data = graphics::meshlet_model_data::load_asset(model_name);
+    }
+    catch (const std::exception& e) {
+      jobs.run([model_name, type, error = std::string(e.what())] { fail_loading(type, model_name, error); },
+        nullptr, utils::job_affinity::MAIN_THREAD);
+      return;
+    }
+
+    // the buffers are recorded into the upload batch like the mesh models'
+    jobs.run([model_name, type, data] {
+      auto model = std::make_shared<u_ptr<graphics::meshlet_model>>();
+      try {
+        *model = graphics::meshlet_model::create(
+          get_graphics_device(), std::move(data->raw_vertices), std::move(data->meshlets), &get_upload_batch());
+      }
+      catch (const std::exception& e) {
+        fail_loading(type, model_name, e.what());
+        return;
+      }
+      recording_upload_.commits.emplace_back([model_name, type, model] {
+        if (meshlet_model_map_.try_emplace(model_name, std::move(*model)).second)
+          track_model(type, model_name, meshlet_model_map_);
+        finish_loading(type, model_name);
+      });
+    }, nullptr, utils::job_affinity::MAIN_THREAD, "upload meshlet model");
+  }, nullptr, utils::job_affinity::ANY, "load meshlet model");
+}
+
 // actors should be created as shared_ptr
 void engine::add_actor(const s_ptr<actor>& actor)
-{ pending_actor_map_.emplace(actor->get_id(), actor); }
+{
+  std::lock_guard<std::mutex> lock(pending_actor_mutex_);
+  pending_actors_.emplace_back(actor);
+}
 
-void engine::remove_actor(id_t id)
+void engine::remove_actor(actor& target)
 {
-  pending_actor_map_.erase(id);
-  active_actor_map_.erase(id);
+  std::lock_guard<std::mutex> lock(pending_actor_mutex_);
+  // the target may be the caller, or read by the other updates. removed at the end of the update
+  if (is_updating_) {
+    target.set_actor_state(actor::state::DEAD);
+    if (!target.get_handle().is_null())
+      dead_actor_handles_.emplace_back(target.get_handle());
+    return;
+  }
+  // the maps may hold the last reference to the target
+  const auto handle = target.get_handle();
+  target.set_handle({});
+  std::erase_if(pending_actors_, [&target](const s_ptr<actor>& a) { return a.get() == &target; });
+  // the pending actors may have registered their rigid components too
+  physics_engine_->remove_actor(target.get_id());
+  if (auto* active = active_actor_map_.get(handle)) {
+    retire_actor(std::move(*active));
+    active_actor_map_.erase(handle);
+  }
+  is_update_plan_dirty_ = true;
 }
 
 void engine::add_shading_system(u_ptr<hnll::game::shading_system> &&shading_system)
 {
   graphics_engine_->add_shading_system(std::move(shading_system));
+  is_shading_system_added_ = true;
 }
 
 void engine::load_actor()
@@ -351,28 +782,45 @@ void engine::add_point_light(s_ptr<actor>& owner, s_ptr<point_light_component>&
 void engine::add_point_light_without_owner(const s_ptr<point_light_component>& light_comp)
 {
   // path to the renderer
-  graphics_engine_->add_renderable_component(*light_comp);
+  const auto e = ecs_world_.create_entity();
+  light_entities_[light_comp->get_id()] = utils::scoped_entity(ecs_world_, e);
+  add_render_state(e, *light_comp);
   // path to the manager
   light_manager_up_->add_light_comp(light_comp);
 }
 
 void engine::remove_point_light_without_owner(component_id id)
 {
-  graphics_engine_->remove_renderable_component(utils::shading_type::POINT_LIGHT, id);
+  light_entities_.erase(id);
   light_manager_up_->remove_light_comp(id);
 }
 
 void engine::cleanup()
 {
+  // the tasks may refer to the actors and the models
+  frame_scheduler_.reset();
+  // waits for the transfers before the models are freed
+  recording_upload_ = {};
+  submitted_uploads_.clear();
+  loading_models_.clear();
+  retired_models_.clear();
+  model_residencies_.clear();
+  model_priorities_.clear();
+  residency_manager_.clear();
   active_actor_map_.clear();
-  pending_actor_map_.clear();
-  dead_actor_ids_.clear();
+  pending_actors_.clear();
+  dead_actor_handles_.clear();
+  light_entities_.clear();
   mesh_model_map_.clear();
   meshlet_model_map_.clear();
   skinning_mesh_model_map_.clear();
   frame_anim_mesh_model_map_.clear();
   frame_anim_meshlet_model_map_.clear();
+  // after the actors, whose audio components delete their sources
+  audio_thread_.reset();
   hnll::graphics::renderer::cleanup_swap_chain();
+  // joins the workers
+  job_system_.reset();
 }
 
 // glfw
@@ -407,6 +855,8 @@ graphics::mesh_model& engine::get_mesh_model(const std::string &model_name)
   if (mesh_model_map_.find(model_name) == mesh_model_map_.end()) {
     load_model(model_name, utils::shading_type::MESH);
   }
+  // the reference is not counted
+  residency_manager_.pin(get_model_residency(utils::shading_type::MESH, model_name));
   return *mesh_model_map_[model_name];
 }
 
@@ -415,6 +865,8 @@ graphics::meshlet_model& engine::get_meshlet_model(const std::string& model_name
   if (meshlet_model_map_.find(model_name) == meshlet_model_map_.end()) {
     load_model(model_name, utils::shading_type::MESHLET);
   }
+  // the reference is not counted
+  residency_manager_.pin(get_model_residency(utils::shading_type::MESHLET, model_name));
   return *meshlet_model_map_[model_name];
 }
 
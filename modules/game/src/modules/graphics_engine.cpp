@@ -2,6 +2,8 @@
 // hnll
 #include <game/modules/graphics_engine.hpp>
 #include <game/shading_system.hpp>
+#include <game/engine.hpp>
+#include <game/actor_data.hpp>
 
 //std
 #include <array>
@@ -13,6 +15,7 @@ namespace hnll::game {
 
 // static members
 graphics_engine::shading_system_map    graphics_engine::shading_systems_;
+std::vector<u_ptr<shading_system>>     graphics_engine::replaced_shading_systems_;
 
 graphics_engine::graphics_engine(const char* window_name, utils::rendering_type rendering_type)
 {
@@ -34,6 +37,7 @@ graphics_engine::~graphics_engine()
   for (auto& system_kv : shading_systems_) {
     system_kv.second.reset();
   }
+  replaced_shading_systems_.clear();
 }
 
 // todo : separate into some functions
@@ -74,8 +78,42 @@ void graphics_engine::init()
   configure_shading_system();
 }
 
-// each render systems automatically detect render target components
 void graphics_engine::render(const utils::viewer_info& _viewer_info, const utils::frustum_info& _frustum_info)
+{
+  capture(serial_snapshot_, _viewer_info, _frustum_info);
+  render(serial_snapshot_);
+}
+
+// each render systems automatically detect render target components
+void graphics_engine::capture(render_snapshot& snapshot, const utils::viewer_info& _viewer_info, const utils::frustum_info& _frustum_info)
+{
+  snapshot.clear();
+  snapshot.frame_number = frame_number_++;
+  snapshot.viewer  = _viewer_info;
+  snapshot.frustum = _frustum_info;
+  snapshot.ubo     = ubo_;
+  for (auto& system : shading_systems_)
+    snapshot.systems[system.first] = system.second.get();
+  // the targets are grouped by their archetypes, and usually by their types
+  uint32_t last_type = ~0u;
+  shading_system*   system = nullptr;
+  render_item_list* items  = nullptr;
+  engine::get_ecs_world().each<render_state, world_transform>([&](render_state& state, world_transform& transform) {
+    if (state.shading_type != last_type) {
+      last_type = state.shading_type;
+      auto it = snapshot.systems.find(last_type);
+      system = it != snapshot.systems.end() ? it->second : nullptr;
+      items  = system != nullptr ? &snapshot.items[last_type] : nullptr;
+    }
+    if (system == nullptr)
+      return;
+    render_item item{ state.target, transform.model_matrix, transform.normal_matrix };
+    if (system->capture(item))
+      items->push_back(item);
+  });
+}
+
+void graphics_engine::render(const render_snapshot& snapshot)
 {
   // returns nullptr if the swap chain is need to be recreated
   if (auto command_buffer = renderer_->begin_frame()) {
@@ -85,26 +123,29 @@ void graphics_engine::render(const utils::viewer_info& _viewer_info, const utils
         frame_index, 
         command_buffer, 
         global_descriptor_sets_[frame_index],
-        _frustum_info
+        snapshot.frustum
     };
 
     // update 
-    ubo_.projection   = _viewer_info.projection;
-    ubo_.view         = _viewer_info.view;
-    ubo_.inverse_view = _viewer_info.inverse_view;
+    auto ubo = snapshot.ubo;
+    ubo.projection   = snapshot.viewer.projection;
+    ubo.view         = snapshot.viewer.view;
+    ubo.inverse_view = snapshot.viewer.inverse_view;
     // temp
-    ubo_.point_lights[0] = {{0.f, -6.f, 0.f, 0.f}, { 1.f, 1.f, 1.f, 1.f}};
-    ubo_.lights_count = 1;
-    ubo_.ambient_light_color = { 0.6f, 0.6f, 0.6f, 0.6f };
-    update_ubo(frame_index);
+    ubo.point_lights[0] = {{0.f, -6.f, 0.f, 0.f}, { 1.f, 1.f, 1.f, 1.f}};
+    ubo.lights_count = 1;
+    ubo.ambient_light_color = { 0.6f, 0.6f, 0.6f, 0.6f };
+    update_ubo(frame_index, ubo);
 
     // rendering
     renderer_->begin_swap_chain_render_pass(command_buffer, HVE_RENDER_PASS_ID);
     // programmable stage of rendering
-    // system can now access game objects via frame_info
+    // system can now access the captured targets
 
-    for (auto& system : shading_systems_) {
-      system.second->render(frame_info);
+    static const render_item_list no_items;
+    for (auto& system : snapshot.systems) {
+      auto it = snapshot.items.find(system.first);
+      system.second->render(frame_info, it != snapshot.items.end() ? it->second : no_items);
     }
 
     renderer_->end_swap_chain_render_pass(command_buffer);
@@ -119,16 +160,21 @@ void graphics_engine::configure_shading_system()
 }
 
 void graphics_engine::add_shading_system(u_ptr<shading_system> &&system)
-{ shading_systems_[static_cast<uint32_t>(system->get_shading_type())] = std::move(system); }
-
-void graphics_engine::add_renderable_component(renderable_component& comp)
-{ shading_systems_[static_cast<uint32_t>(comp.get_shading_type())]->add_render_target(comp.get_id(), comp); }
-
-void graphics_engine::remove_renderable_component(const renderable_component& comp)
-{ shading_systems_[static_cast<uint32_t>(comp.get_shading_type())]->remove_render_target(comp.get_id()); }
+{
+  auto& slot = shading_systems_[static_cast<uint32_t>(system->get_shading_type())];
+  // the snapshots in flight may still refer to the replaced one
+  if (slot)
+    replaced_shading_systems_.emplace_back(std::move(slot));
+  slot = std::move(system);
+}
 
-void graphics_engine::remove_renderable_component(utils::shading_type type, component_id id)
-{ shading_systems_[static_cast<uint32_t>(type)]->remove_render_target(id); }
+bool graphics_engine::is_pipeline_safe()
+{
+  for (const auto& system : shading_systems_)
+    if (!system.second->is_pipeline_safe())
+      return false;
+  return true;
+}
 
 bool graphics_engine::check_shading_system_exists(utils::shading_type type)
 { return shading_systems_.find(static_cast<uint32_t>(type)) != shading_systems_.end(); }
@@ -1,28 +1,158 @@
 // hnll
 #include <game/engine.hpp>
+#include <game/actor.hpp>
+#include <game/actor_data.hpp>
 #include <game/modules/physics_engine.hpp>
+#include <game/components/rigid_component.hpp>
 #include <geometry/intersection.hpp>
 #include <physics/collision_info.hpp>
 #include <physics/collision_detector.hpp>
+#include <physics/contact_manager.hpp>
+#include <physics/contact_solver.hpp>
+
+// std
+#include <unordered_set>
 
 namespace hnll::game {
 
 // static members' declaration
 u_ptr<physics::collision_detector> physics_engine::collision_detector_{};
 
+physics_engine::physics_engine()
+{
+  contact_manager_ = physics::contact_manager::create();
+  contact_solver_  = physics::contact_solver::create();
+}
+
+physics_engine::~physics_engine() = default;
+
+void physics_engine::re_update(float frame_dt)
+{
+  sync_rigid_states();
+  auto& world = engine::get_ecs_world();
+
+  bodies_.clear();
+  world.each<rigid_state>([this, frame_dt](rigid_state& state) {
+    for (auto* rc : state.components) {
+      auto& body = rc->get_body();
+      // static and kinematic bodies follow their transforms
+      if (!body.is_dynamic())
+        body.read_transform(rc->get_transform_ref(), frame_dt);
+      // the transforms of the dynamic bodies hold the interpolated poses of the last frame
+      else
+        body.write_transform(*rc->get_transform());
+      bodies_.push_back(&body);
+    }
+  });
+
+  const int step_count = timestep_.advance(frame_dt);
+  const double dt = timestep_.get_step() / substep_count_;
+  for (int i = 0; i < step_count; i++) {
+    for (auto* body : bodies_)
+      body->save_previous_pose();
+    for (int j = 0; j < substep_count_; j++)
+      step(dt);
+  }
+  // the handlers have side effects, so a frame without a step doesn't dispatch the last collisions again
+  if (step_count > 0) {
+    keep_latest_collisions();
+    adjust_intersection(collision_info_list_);
+    collision_info_list_.clear();
+  }
+
+  const double alpha = timestep_.get_alpha();
+  world.each<rigid_state>([alpha](rigid_state& state) {
+    for (auto* rc : state.components)
+      if (rc->get_body().is_dynamic())
+        rc->get_body().write_transform(*rc->get_transform(), alpha);
+  });
+}
+
+void physics_engine::step(double dt)
+{
+  contact_manager_->begin_frame();
+  auto collision_info_list = physics::collision_detector::intersection_test(contact_manager_.get());
+  contact_manager_->end_frame();
+  collision_info_list_.insert(collision_info_list_.end(), collision_info_list.begin(), collision_info_list.end());
+
+  contact_solver_->step(bodies_, *contact_manager_, dt, &engine::get_job_system());
+
+  // dynamic bodies own their transforms
+  engine::get_ecs_world().each<rigid_state>([](rigid_state& state) {
+    for (auto* rc : state.components)
+      if (rc->get_body().is_dynamic())
+        rc->get_body().write_transform(*rc->get_transform());
+  });
+}
+
+void physics_engine::sync_rigid_states()
+{
+  // the factories add the components at any time, the actors are activated at the end of the update
+  const auto version = physics::collision_detector::get_version();
+  if (!is_rigid_state_dirty_ && version == synced_version_)
+    return;
+  is_rigid_state_dirty_ = false;
+  synced_version_       = version;
+
+  auto& world = engine::get_ecs_world();
+  world.each<rigid_state>([](rigid_state& state) { state.components.clear(); });
+  // the components of the pending actors join on their activation
+  for (const auto& rc : physics::collision_detector::get_rigid_components()) {
+    auto* owner = engine::get_active_actor(rc->get_owner_handle());
+    if (owner == nullptr) continue;
+    auto* state = owner->get_data<rigid_state>();
+    if (state == nullptr)
+      state = &owner->add_data<rigid_state>();
+    state->components.push_back(rc.get());
+  }
+  // the actors whose components are all removed
+  std::vector<utils::entity> emptied;
+  world.each<rigid_state>([&emptied](utils::entity e, rigid_state& state) {
+    if (state.components.empty())
+      emptied.push_back(e);
+  });
+  for (auto e : emptied)
+    world.remove<rigid_state>(e);
+}
+
+void physics_engine::keep_latest_collisions()
+{
+  // a pair collides in many substeps, but its actors are re-updated once per frame with the latest info
+  std::unordered_set<uint64_t> pairs;
+  std::vector<physics::collision_info> latest;
+  for (auto it = collision_info_list_.rbegin(); it != collision_info_list_.rend(); ++it) {
+    const auto key = (static_cast<uint64_t>(it->actor_a.index) << 32) | it->actor_b.index;
+    if (pairs.insert(key).second)
+      latest.push_back(*it);
+  }
+  collision_info_list_.assign(latest.rbegin(), latest.rend());
+}
+
+void physics_engine::activate_actor(actor_id id, actor_handle handle)
+{
+  // the components created before the activation don't know the handle
+  for (const auto& rc : physics::collision_detector::get_rigid_components())
+    if (rc->get_owner_id() == id)
+      rc->set_owner_handle(handle);
+  is_rigid_state_dirty_ = true;
+}
 
-void physics_engine::re_update()
+void physics_engine::remove_actor(actor_id id)
 {
-  adjust_intersection();
+  // the manifolds refer to the bodies
+  for (const auto& rc : physics::collision_detector::get_rigid_components())
+    if (rc->get_owner_id() == id)
+      contact_manager_->remove_body(rc->get_body().id);
+  physics::collision_detector::remove_rigid_components(id);
 }
 
-void physics_engine::adjust_intersection()
+void physics_engine::adjust_intersection(const std::vector<physics::collision_info>& collision_info_list)
 {
   // actors will be re-updated in this function
-  auto collision_info_list = physics::collision_detector::intersection_test();
+  // the removed actors are skipped
   for (const auto& info : collision_info_list) {
-    game::engine::get_active_actor(info.actor_a).re_update(info);
-    game::engine::get_active_actor(info.actor_b).re_update(info);
+    if (auto* a = game::engine::get_active_actor(info.actor_a)) a->re_update(info);
+    if (auto* b = game::engine::get_active_actor(info.actor_b)) b->re_update(info);
   }
 }
-} // namespace hnll::physics
\ No newline at end of file
+} // namespace hnll::physics
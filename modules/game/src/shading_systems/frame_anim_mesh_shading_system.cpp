@@ -37,16 +37,16 @@ frame_anim_mesh_shading_system::frame_anim_mesh_shading_system(graphics::device
   );
 }
 
-void frame_anim_mesh_shading_system::render(const utils::frame_info& frame_info)
+void frame_anim_mesh_shading_system::render(const utils::frame_info& frame_info, const render_item_list& items)
 {
   pipeline_->bind(frame_info.command_buffer);
 
-  for (auto& target : render_target_map_) {
-    auto obj = dynamic_cast<frame_anim_component<graphics::frame_anim_mesh_model>*>(&target.second);
+  for (const auto& item : items) {
+    auto obj = dynamic_cast<frame_anim_component<graphics::frame_anim_mesh_model>*>(item.target);
 
     frame_anim_push_constant push{};
-    push.model_matrix = obj->get_transform().mat4().cast<float>();
-    push.normal_matrix = obj->get_transform().normal_matrix().cast<float>();
+    push.model_matrix = item.model_matrix;
+    push.normal_matrix = item.normal_matrix;
 
     vkCmdPushConstants(
       frame_info.command_buffer,
@@ -68,7 +68,15 @@ void frame_anim_mesh_shading_system::render(const utils::frame_info& frame_info)
       nullptr
     );
 
-    obj->bind_and_draw(frame_info.command_buffer);
+    obj->bind_and_draw_frame(item.animation_index, item.frame_index, frame_info.command_buffer);
   }
 }
+
+bool frame_anim_mesh_shading_system::capture(render_item& item)
+{
+  auto obj = dynamic_cast<frame_anim_component<graphics::frame_anim_mesh_model>*>(item.target);
+  item.animation_index = obj->get_animation_index();
+  item.frame_index     = obj->get_frame_index();
+  return true;
+}
 }
\ No newline at end of file
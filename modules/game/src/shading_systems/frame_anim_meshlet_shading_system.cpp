@@ -92,17 +92,17 @@ frame_anim_meshlet_shading_system::frame_anim_meshlet_shading_system(graphics::d
   );
 }
 
-void frame_anim_meshlet_shading_system::render(const utils::frame_info &frame_info)
+void frame_anim_meshlet_shading_system::render(const utils::frame_info& frame_info, const render_item_list& items)
 {
   auto command_buffer = frame_info.command_buffer;
   pipeline_->bind(command_buffer);
 
-  for (auto& target : render_target_map_) {
-    auto obj = dynamic_cast<frame_anim_component<graphics::frame_anim_meshlet_model> *>(&target.second);
+  for (const auto& item : items) {
+    auto obj = dynamic_cast<frame_anim_component<graphics::frame_anim_meshlet_model> *>(item.target);
 
     frame_anim_meshlet_push_constant push{};
-    push.model_matrix  = obj->get_transform().mat4().cast<float>();
-    push.normal_matrix = obj->get_transform().normal_matrix().cast<float>();
+    push.model_matrix  = item.model_matrix;
+    push.normal_matrix = item.normal_matrix;
 
     vkCmdPushConstants(
       command_buffer,
@@ -122,7 +122,9 @@ void frame_anim_meshlet_shading_system::render(const utils::frame_info &frame_in
       frame_info.global_descriptor_set,
       task_desc_sets_->get_set(frame_info.frame_index)
     };
-    obj->bind_and_draw(
+    obj->bind_and_draw_frame(
+      item.animation_index,
+      item.frame_index,
       command_buffer,
       external_desc_sets,
       pipeline_layout_
@@ -130,4 +132,12 @@ void frame_anim_meshlet_shading_system::render(const utils::frame_info &frame_in
   }
 }
 
+bool frame_anim_meshlet_shading_system::capture(render_item& item)
+{
+  auto obj = dynamic_cast<frame_anim_component<graphics::frame_anim_meshlet_model> *>(item.target);
+  item.animation_index = obj->get_animation_index();
+  item.frame_index     = obj->get_frame_index();
+  return true;
+}
+
 } // namespace hnll::game
\ No newline at end of file
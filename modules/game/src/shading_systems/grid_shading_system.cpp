@@ -29,7 +29,7 @@ grid_shading_system::grid_shading_system(graphics::device& device)
   );
 }
 
-void grid_shading_system::render(const utils::frame_info &frame_info)
+void grid_shading_system::render(const utils::frame_info& frame_info, const render_item_list& items)
 {
   pipeline_->bind(frame_info.command_buffer);
 
@@ -45,7 +45,7 @@ mesh_shading_system::mesh_shading_system(graphics::device &device)
   );
 }
 
-void mesh_shading_system::render(const utils::frame_info& frame_info)
+void mesh_shading_system::render(const utils::frame_info& frame_info, const render_item_list& items)
 {
   pipeline_->bind(frame_info.command_buffer);
 
@@ -60,17 +60,12 @@ void mesh_shading_system::render(const utils::frame_info& frame_info)
     nullptr
   );
 
-  for (auto& target : render_target_map_) {
-    auto obj = dynamic_cast<mesh_component*>(&target.second);
-
-    if (!obj->get_should_be_drawn()) {
-      continue;
-    }
-    obj->set_should_not_be_drawn();
+  for (const auto& item : items) {
+    auto obj = dynamic_cast<mesh_component*>(item.target);
 
     mesh_push_constant push{};
-    push.model_matrix  = obj->get_transform().mat4().cast<float>();
-    push.normal_matrix = obj->get_transform().normal_matrix().cast<float>();
+    push.model_matrix  = item.model_matrix;
+    push.normal_matrix = item.normal_matrix;
 
     vkCmdPushConstants(
       frame_info.command_buffer,
@@ -86,4 +81,20 @@ void mesh_shading_system::render(const utils::frame_info& frame_info)
   }
 }
 
+bool mesh_shading_system::capture(render_item& item)
+{
+  auto obj = dynamic_cast<mesh_component*>(item.target);
+
+  if (!obj->get_should_be_drawn()) {
+    return false;
+  }
+  obj->set_should_not_be_drawn();
+  // skipped while its model is loaded
+  if (!obj->is_resident()) {
+    return false;
+  }
+  obj->touch_model();
+  return true;
+}
+
 }} // namespace hnll::game
\ No newline at end of file
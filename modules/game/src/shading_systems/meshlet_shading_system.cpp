@@ -84,17 +84,17 @@ meshlet_shading_system::meshlet_shading_system(graphics::device &device)
   );
 }
 
-void meshlet_shading_system::render(const utils::frame_info &frame_info)
+void meshlet_shading_system::render(const utils::frame_info& frame_info, const render_item_list& items)
 {
   auto command_buffer = frame_info.command_buffer;
   pipeline_->bind(command_buffer);
 
-  for (auto &target: render_target_map_) {
-    auto obj = dynamic_cast<meshlet_component *>(&target.second);
+  for (const auto& item : items) {
+    auto obj = dynamic_cast<meshlet_component *>(item.target);
 
     meshlet_push_constant push{};
-    push.model_matrix = obj->get_transform().mat4().cast<float>();
-    push.normal_matrix = obj->get_transform().normal_matrix().cast<float>();
+    push.model_matrix = item.model_matrix;
+    push.normal_matrix = item.normal_matrix;
 
     // task desc set update
 
@@ -120,4 +120,10 @@ void meshlet_shading_system::render(const utils::frame_info &frame_info)
   }
 }
 
-} // namespace hnll::game
\ No newline at end of file
+bool meshlet_shading_system::capture(render_item& item)
+{
+  dynamic_cast<meshlet_component*>(item.target)->touch_model();
+  return true;
+}
+
+} // namespace hnll::game
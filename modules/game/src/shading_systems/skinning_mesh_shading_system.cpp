@@ -53,16 +53,16 @@ skinning_model_shading_system::~skinning_model_shading_system()
   graphics::skinning_mesh_model::erase_desc_set_layout();
 }
 
-void skinning_model_shading_system::render(const utils::frame_info& frame_info)
+void skinning_model_shading_system::render(const utils::frame_info& frame_info, const render_item_list& items)
 {
   pipeline_->bind(frame_info.command_buffer);
 
-  for (auto& target : render_target_map_) {
-    auto obj = dynamic_cast<skinning_mesh_component*>(&target.second);
+  for (const auto& item : items) {
+    auto obj = dynamic_cast<skinning_mesh_component*>(item.target);
 
     graphics::skinning_mesh_push_constant push{};
-    push.model_matrix  = obj->get_transform().mat4().cast<float>();
-    push.normal_matrix = obj->get_transform().normal_matrix().cast<float>();
+    push.model_matrix  = item.model_matrix;
+    push.normal_matrix = item.normal_matrix;
 
     obj->get_model().bind(frame_info.command_buffer, frame_info.global_descriptor_set, pipeline_layout_);
     obj->get_model().draw(frame_info.command_buffer, frame_info.global_descriptor_set, pipeline_layout_, push);
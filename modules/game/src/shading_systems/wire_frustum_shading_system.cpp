@@ -35,7 +35,7 @@ wire_frustum_shading_system::wire_frustum_shading_system(graphics::device &devic
   );
 }
 
-void wire_frustum_shading_system::render(const utils::frame_info &frame_info)
+void wire_frustum_shading_system::render(const utils::frame_info& frame_info, const render_item_list& items)
 {
   auto command_buffer = frame_info.command_buffer;
   pipeline_->bind(command_buffer);
@@ -51,10 +51,10 @@ void wire_frustum_shading_system::render(const utils::frame_info &frame_info)
     nullptr
   );
 
-  for (auto& target : render_target_map_) {
-    auto obj = dynamic_cast<game::wire_frame_frustum_component*>(&target.second);
+  for (const auto& item : items) {
+    auto obj = dynamic_cast<game::wire_frame_frustum_component*>(item.target);
     wire_frustum_push_constant push{};
-    push.model_mat = obj->get_transform_sp()->mat4().cast<float>();
+    push.model_mat = item.model_matrix;
 
     vkCmdPushConstants(
       command_buffer,
@@ -1,12 +1,24 @@
 // hnll
 #include <geometry/bounding_volume.hpp>
+#include <geometry/convex_hull.hpp>
+#include <geometry/sphere_tree.hpp>
+#include <utils/job_system.hpp>
+
+// std
+#include <algorithm>
+
+// simd
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define HNLL_BV_USE_SSE
+#endif
 
 namespace hnll::geometry {
 
 u_ptr<bounding_volume> bounding_volume::create_aabb(const std::vector<vec3d>& vertices)
 {
   // TODO : compute convex-hull
-  auto convex_hull = vertices;
+  const auto& convex_hull = vertices;
   double minx = convex_hull[0].x(),
          maxx = convex_hull[0].x(),
          miny = convex_hull[0].y(),
@@ -32,6 +44,47 @@ u_ptr<bounding_volume> bounding_volume::create_blank_aabb(const vec3d& initial_p
   return std::make_unique<bounding_volume>(initial_point, vec3d(0.f, 0.f, 0.f));
 }
 
+u_ptr<bounding_volume> bounding_volume::create_convex_hull(const s_ptr<convex_hull>& hull)
+{
+  auto bv = std::make_unique<bounding_volume>(
+    vec3d((hull->get_max() + hull->get_min()) / 2),
+    vec3d((hull->get_max() - hull->get_min()) / 2));
+  bv->bv_type_ = bv_type::CONVEX_HULL;
+  bv->convex_hull_ = hull;
+  return bv;
+}
+
+u_ptr<bounding_volume> bounding_volume::create_sphere_tree(const s_ptr<sphere_tree>& tree)
+{
+  const auto& root = tree->get_root();
+  auto bv = std::make_unique<bounding_volume>(root.center, root.radius);
+  bv->bv_type_ = bv_type::SPHERE_TREE;
+  bv->sphere_tree_ = tree;
+  return bv;
+}
+
+vec3d bounding_volume::support(const vec3d& direction) const
+{
+  switch (bv_type_) {
+    case bv_type::SPHERE :
+    case bv_type::SPHERE_TREE : {
+      auto length = direction.norm();
+      if (length == 0.0) return get_world_center_point();
+      return get_world_center_point() + direction * (get_sphere_radius() / length);
+    }
+    case bv_type::AABB :
+      return get_world_center_point() + direction.cwiseSign().cwiseProduct(radius_);
+    case bv_type::CONVEX_HULL : {
+      // the hull is in the local space, so the direction is transformed by the transpose
+      const auto mat = transform_->rotate_mat3();
+      const auto& local = convex_hull_->support(mat.transpose() * direction);
+      return mat * local + transform_->get_translation_eigen();
+    }
+    default:
+      throw std::runtime_error("invalid bv_type");
+  }
+}
+
 u_ptr<bounding_volume> bounding_volume::create_bounding_sphere(bv_ctor_type type, const std::vector<vec3d>& vertices)
 {
   switch (type) {
@@ -83,7 +136,7 @@ u_ptr<bounding_volume> sphere_from_distant_points(const std::vector<Eigen::Vecto
 
 void extend_sphere_to_point(bounding_volume& sphere, const Eigen::Vector3d& point)
 {
-  auto diff = point - sphere.get_world_center_point();
+  vec3d diff = point - sphere.get_world_center_point();
   auto dist2 = diff.dot(diff);
   if (dist2 > sphere.get_sphere_radius() * sphere.get_sphere_radius()) {
     auto dist = std::sqrt(dist2);
@@ -102,4 +155,248 @@ u_ptr<bounding_volume> bounding_volume::ritter_ctor(const std::vector<Eigen::Vec
   return sphere;
 }
 
+// ------------------------------------------------------------------------------------------
+// position_span ctors
+// vertices are read in place, so no double-precision copy of the mesh is made
+
+namespace {
+
+// ranges smaller than this are not worth a job
+// the chunks don't depend on the job count, so the results don't either
+constexpr size_t POSITIONS_PER_CHUNK = 1 << 14;
+
+size_t chunk_count_of(size_t position_count)
+{ return (position_count + POSITIONS_PER_CHUNK - 1) / POSITIONS_PER_CHUNK; }
+
+// calls func(begin, end, chunk_index) for each chunk, on the jobs if jobs isn't nullptr
+template <typename Func>
+void for_each_chunk(size_t position_count, utils::job_system* jobs, Func&& func)
+{
+  auto chunk_range = [&func, position_count](size_t first, size_t last) {
+    for (size_t c = first; c < last; c++)
+      func(c * POSITIONS_PER_CHUNK, std::min((c + 1) * POSITIONS_PER_CHUNK, position_count), c);
+  };
+  const auto chunk_count = chunk_count_of(position_count);
+  if (jobs == nullptr)
+    chunk_range(0, chunk_count);
+  else
+    jobs->parallel_for(0, chunk_count, 1, chunk_range, "bounding_volume");
+}
+
+struct min_max { float min[3]; float max[3]; };
+
+min_max min_max_of_range(const position_span& positions, size_t begin, size_t end)
+{
+  min_max res;
+  const float* first = positions[begin];
+  for (int j = 0; j < 3; j++)
+    res.min[j] = res.max[j] = first[j];
+
+#ifdef HNLL_BV_USE_SSE
+  // each element has at least one padding float, so 4 lanes can be loaded at once
+  if (positions.stride >= 4) {
+    __m128 mn0 = _mm_loadu_ps(first), mx0 = mn0;
+    __m128 mn1 = mn0, mx1 = mn0;
+    size_t i = begin + 1;
+    // two accumulators to hide the latency of min/max
+    for (; i + 1 < end; i += 2) {
+      __m128 p0 = _mm_loadu_ps(positions[i]);
+      __m128 p1 = _mm_loadu_ps(positions[i + 1]);
+      mn0 = _mm_min_ps(mn0, p0); mx0 = _mm_max_ps(mx0, p0);
+      mn1 = _mm_min_ps(mn1, p1); mx1 = _mm_max_ps(mx1, p1);
+    }
+    if (i < end) {
+      __m128 p = _mm_loadu_ps(positions[i]);
+      mn0 = _mm_min_ps(mn0, p); mx0 = _mm_max_ps(mx0, p);
+    }
+    alignas(16) float mn[4], mx[4];
+    _mm_store_ps(mn, _mm_min_ps(mn0, mn1));
+    _mm_store_ps(mx, _mm_max_ps(mx0, mx1));
+    std::copy_n(mn, 3, res.min);
+    std::copy_n(mx, 3, res.max);
+    return res;
+  }
+#endif
+
+  for (size_t i = begin + 1; i < end; i++) {
+    const float* p = positions[i];
+    for (int j = 0; j < 3; j++) {
+      res.min[j] = std::min(res.min[j], p[j]);
+      res.max[j] = std::max(res.max[j], p[j]);
+    }
+  }
+  return res;
+}
+
+// index of min/max point of each axis
+struct extreme_points { size_t min[3]; size_t max[3]; };
+
+extreme_points extreme_points_of_range(const position_span& positions, size_t begin, size_t end)
+{
+  extreme_points res;
+  for (int j = 0; j < 3; j++)
+    res.min[j] = res.max[j] = begin;
+  for (size_t i = begin + 1; i < end; i++) {
+    const float* p = positions[i];
+    for (int j = 0; j < 3; j++) {
+      if (p[j] < positions[res.min[j]][j]) res.min[j] = i;
+      if (p[j] > positions[res.max[j]][j]) res.max[j] = i;
+    }
+  }
+  return res;
+}
+
+struct sphere_d { vec3d center; double radius; };
+
+inline vec3d to_vec3d(const float* p) { return { p[0], p[1], p[2] }; }
+
+// same as extend_sphere_to_point()
+inline void extend_sphere_d(sphere_d& sphere, const vec3d& point)
+{
+  auto diff = point - sphere.center;
+  auto dist2 = diff.dot(diff);
+  if (dist2 > sphere.radius * sphere.radius) {
+    auto dist = std::sqrt(dist2);
+    auto new_radius = (sphere.radius + dist) * 0.5;
+    auto k = (new_radius - sphere.radius) / dist;
+    sphere.radius = new_radius;
+    sphere.center += diff * k;
+  }
+}
+
+void extend_sphere_by_range(sphere_d& sphere, const position_span& positions, size_t begin, size_t end)
+{
+  size_t i = begin;
+#ifdef HNLL_BV_USE_SSE
+  // tests 4 points at once, and falls back to the exact update only for the points which might be
+  // outside. the test is done in double as extend_sphere_d() : a float test loses the points slightly
+  // outside when the coordinates are large relative to the radius. the radius is shrunk by far more
+  // than the rounding error of the double test, so that it never skips a point which is outside.
+  if (positions.stride >= 4) {
+    auto load_sphere = [&sphere](__m128d& cx, __m128d& cy, __m128d& cz, __m128d& r2) {
+      cx = _mm_set1_pd(sphere.center.x());
+      cy = _mm_set1_pd(sphere.center.y());
+      cz = _mm_set1_pd(sphere.center.z());
+      r2 = _mm_set1_pd(sphere.radius * sphere.radius * (1.0 - 1e-12));
+    };
+    // bit k of the result : point k is maybe outside
+    auto test_pair = [](__m128 x, __m128 y, __m128 z, __m128d cx, __m128d cy, __m128d cz, __m128d r2) {
+      __m128d dx = _mm_sub_pd(_mm_cvtps_pd(x), cx);
+      __m128d dy = _mm_sub_pd(_mm_cvtps_pd(y), cy);
+      __m128d dz = _mm_sub_pd(_mm_cvtps_pd(z), cz);
+      __m128d dist2 = _mm_add_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)), _mm_mul_pd(dz, dz));
+      return _mm_movemask_pd(_mm_cmpgt_pd(dist2, r2));
+    };
+    __m128d cx, cy, cz, r2;
+    load_sphere(cx, cy, cz, r2);
+    for (; i + 3 < end; i += 4) {
+      __m128 x = _mm_loadu_ps(positions[i]);
+      __m128 y = _mm_loadu_ps(positions[i + 1]);
+      __m128 z = _mm_loadu_ps(positions[i + 2]);
+      __m128 w = _mm_loadu_ps(positions[i + 3]);
+      // rows become x, y, z, (padding) of the 4 points
+      _MM_TRANSPOSE4_PS(x, y, z, w);
+      int outside = test_pair(x, y, z, cx, cy, cz, r2);
+      outside |= test_pair(_mm_movehl_ps(x, x), _mm_movehl_ps(y, y), _mm_movehl_ps(z, z), cx, cy, cz, r2) << 2;
+      if (outside == 0) continue;
+      for (int k = 0; k < 4; k++)
+        if (outside & (1 << k))
+          extend_sphere_d(sphere, to_vec3d(positions[i + k]));
+      load_sphere(cx, cy, cz, r2);
+    }
+  }
+#endif
+  for (; i < end; i++)
+    extend_sphere_d(sphere, to_vec3d(positions[i]));
+}
+
+// smallest sphere enclosing both spheres
+sphere_d merge_spheres(const sphere_d& a, const sphere_d& b)
+{
+  vec3d diff = b.center - a.center;
+  double dist = diff.norm();
+  if (dist + b.radius <= a.radius) return a;
+  if (dist + a.radius <= b.radius) return b;
+  double radius = (dist + a.radius + b.radius) * 0.5;
+  return { a.center + diff * ((radius - a.radius) / dist), radius };
+}
+
+} // anonymous namespace
+
+u_ptr<bounding_volume> bounding_volume::create_aabb(const position_span& positions, utils::job_system* jobs)
+{
+  const auto count = positions.size();
+  if (count == 0)
+    throw std::runtime_error("bounding_volume::create_aabb : empty position span");
+
+  std::vector<min_max> partial(chunk_count_of(count));
+  for_each_chunk(count, jobs, [&](size_t begin, size_t end, size_t idx) {
+    partial[idx] = min_max_of_range(positions, begin, end);
+  });
+
+  auto res = partial[0];
+  for (size_t t = 1; t < partial.size(); t++) {
+    for (int j = 0; j < 3; j++) {
+      res.min[j] = std::min(res.min[j], partial[t].min[j]);
+      res.max[j] = std::max(res.max[j], partial[t].max[j]);
+    }
+  }
+
+  vec3d min = { res.min[0], res.min[1], res.min[2] };
+  vec3d max = { res.max[0], res.max[1], res.max[2] };
+  return std::make_unique<bounding_volume>(vec3d((max + min) / 2), vec3d((max - min) / 2));
+}
+
+u_ptr<bounding_volume> bounding_volume::create_bounding_sphere(bv_ctor_type type, const position_span& positions, utils::job_system* jobs)
+{
+  switch (type) {
+    case bv_ctor_type::RITTER:
+      return ritter_ctor(positions, jobs);
+    default:
+      throw std::runtime_error("invalid bounding-sphere-ctor type");
+  }
+}
+
+u_ptr<bounding_volume> bounding_volume::ritter_ctor(const position_span& positions, utils::job_system* jobs)
+{
+  const auto count = positions.size();
+  if (count == 0)
+    throw std::runtime_error("bounding_volume::ritter_ctor : empty position span");
+
+  const auto chunk_count = chunk_count_of(count);
+
+  // most separated points on aabb
+  std::vector<extreme_points> partial_extremes(chunk_count);
+  for_each_chunk(count, jobs, [&](size_t begin, size_t end, size_t idx) {
+    partial_extremes[idx] = extreme_points_of_range(positions, begin, end);
+  });
+  auto extremes = partial_extremes[0];
+  for (size_t t = 1; t < chunk_count; t++) {
+    for (int j = 0; j < 3; j++) {
+      if (positions[partial_extremes[t].min[j]][j] < positions[extremes.min[j]][j]) extremes.min[j] = partial_extremes[t].min[j];
+      if (positions[partial_extremes[t].max[j]][j] > positions[extremes.max[j]][j]) extremes.max[j] = partial_extremes[t].max[j];
+    }
+  }
+  int axis = 0;
+  double max_dist2 = -1.0;
+  for (int j = 0; j < 3; j++) {
+    auto dist2 = (to_vec3d(positions[extremes.max[j]]) - to_vec3d(positions[extremes.min[j]])).squaredNorm();
+    if (dist2 > max_dist2) { max_dist2 = dist2; axis = j; }
+  }
+  auto a = to_vec3d(positions[extremes.min[axis]]);
+  auto b = to_vec3d(positions[extremes.max[axis]]);
+  sphere_d initial = { (a + b) * 0.5, (a - b).norm() * 0.5 };
+
+  // each chunk grows its own sphere, then they are merged
+  std::vector<sphere_d> partial_spheres(chunk_count, initial);
+  for_each_chunk(count, jobs, [&](size_t begin, size_t end, size_t idx) {
+    extend_sphere_by_range(partial_spheres[idx], positions, begin, end);
+  });
+  auto sphere = partial_spheres[0];
+  for (size_t t = 1; t < chunk_count; t++)
+    sphere = merge_spheres(sphere, partial_spheres[t]);
+
+  return std::make_unique<bounding_volume>(sphere.center, sphere.radius);
+}
+
 } // namespace hnll::physics
\ No newline at end of file
@@ -0,0 +1,295 @@
+// hnll
+#include <geometry/convex_hull.hpp>
+#include <geometry/bounding_volume.hpp>
+
+// std
+#include <unordered_map>
+#include <limits>
+
+namespace hnll::geometry {
+
+namespace {
+
+// plane : normal.dot(x) == offset
+struct qh_face
+{
+  std::array<uint32_t, 3> v;
+  vec3d  normal;
+  double offset;
+  // points which are in front of this face
+  std::vector<uint32_t> outside;
+  uint32_t furthest      = 0;
+  double   furthest_dist = 0.0;
+  bool     alive   = true;
+  bool     visible = false;
+};
+
+inline uint64_t edge_key(uint32_t a, uint32_t b) { return (static_cast<uint64_t>(a) << 32) | b; }
+
+// Points provides size() and operator()(i) which returns vec3d
+template <typename Points>
+class quickhull_builder
+{
+  public:
+    explicit quickhull_builder(const Points& points) : points_(points) {}
+
+    s_ptr<convex_hull> build()
+    {
+      const auto count = static_cast<uint32_t>(points_.size());
+      if (count == 0)
+        throw std::runtime_error("convex_hull : no points");
+
+      // extreme points of each axis
+      std::array<uint32_t, 3> min_idx{}, max_idx{};
+      vec3d abs_max = vec3d::Zero();
+      for (uint32_t i = 0; i < count; i++) {
+        const vec3d p = points_(i);
+        for (int j = 0; j < 3; j++) {
+          if (p[j] < points_(min_idx[j])[j]) min_idx[j] = i;
+          if (p[j] > points_(max_idx[j])[j]) max_idx[j] = i;
+          abs_max[j] = std::max(abs_max[j], std::abs(p[j]));
+        }
+      }
+      eps_ = 1e-9 * std::max(abs_max.sum(), 1e-12);
+
+      if (!create_initial_simplex(min_idx, max_idx))
+        return create_degenerate();
+
+      // expand the hull until no face has an outside point
+      for (size_t f = 0; f < faces_.size(); f++) {
+        if (faces_[f].alive && !faces_[f].outside.empty())
+          add_point_to_hull(static_cast<uint32_t>(f));
+      }
+
+      return compact();
+    }
+
+  private:
+    double distance(const qh_face& face, const vec3d& p) const { return face.normal.dot(p) - face.offset; }
+
+    uint32_t add_face(uint32_t a, uint32_t b, uint32_t c)
+    {
+      qh_face face;
+      face.v = { a, b, c };
+      const vec3d pa = points_(a), pb = points_(b), pc = points_(c);
+      face.normal = (pb - pa).cross(pc - pa).normalized();
+      face.offset = face.normal.dot(pa);
+      auto id = static_cast<uint32_t>(faces_.size());
+      edge_to_face_[edge_key(a, b)] = id;
+      edge_to_face_[edge_key(b, c)] = id;
+      edge_to_face_[edge_key(c, a)] = id;
+      faces_.emplace_back(std::move(face));
+      return id;
+    }
+
+    void remove_face(uint32_t id)
+    {
+      auto& face = faces_[id];
+      face.alive = false;
+      for (int k = 0; k < 3; k++) {
+        auto it = edge_to_face_.find(edge_key(face.v[k], face.v[(k + 1) % 3]));
+        if (it != edge_to_face_.end() && it->second == id)
+          edge_to_face_.erase(it);
+      }
+    }
+
+    // assigns each point to the first face it is in front of. the others are inside the hull
+    void assign_points(const std::vector<uint32_t>& points, const std::vector<uint32_t>& faces)
+    {
+      for (auto p_id : points) {
+        const vec3d p = points_(p_id);
+        for (auto f_id : faces) {
+          auto& face = faces_[f_id];
+          auto dist = distance(face, p);
+          if (dist > eps_) {
+            if (face.outside.empty() || dist > face.furthest_dist) {
+              face.furthest = p_id;
+              face.furthest_dist = dist;
+            }
+            face.outside.push_back(p_id);
+            break;
+          }
+        }
+      }
+    }
+
+    bool create_initial_simplex(const std::array<uint32_t, 3>& min_idx, const std::array<uint32_t, 3>& max_idx)
+    {
+      // the most separated pair of the extreme points
+      uint32_t i0 = min_idx[0], i1 = max_idx[0];
+      double max_dist2 = -1.0;
+      for (int j = 0; j < 3; j++) {
+        auto dist2 = (points_(max_idx[j]) - points_(min_idx[j])).squaredNorm();
+        if (dist2 > max_dist2) { max_dist2 = dist2; i0 = min_idx[j]; i1 = max_idx[j]; }
+      }
+      if (std::sqrt(max_dist2) <= eps_) return false;
+
+      const auto count = static_cast<uint32_t>(points_.size());
+      const vec3d p0 = points_(i0), p1 = points_(i1);
+      const vec3d line = (p1 - p0).normalized();
+
+      // the farthest point from the line
+      uint32_t i2 = i0;
+      double max_line_dist = 0.0;
+      for (uint32_t i = 0; i < count; i++) {
+        auto dist = line.cross(points_(i) - p0).norm();
+        if (dist > max_line_dist) { max_line_dist = dist; i2 = i; }
+      }
+      if (max_line_dist <= eps_) return false;
+
+      // the farthest point from the plane
+      const vec3d normal = (p1 - p0).cross(points_(i2) - p0).normalized();
+      uint32_t i3 = i0;
+      double max_plane_dist = 0.0;
+      for (uint32_t i = 0; i < count; i++) {
+        auto dist = std::abs(normal.dot(points_(i) - p0));
+        if (dist > max_plane_dist) { max_plane_dist = dist; i3 = i; }
+      }
+      if (max_plane_dist <= eps_) return false;
+
+      // faces of the tetrahedron should face outward
+      if (normal.dot(points_(i3) - p0) > 0.0) std::swap(i1, i2);
+      std::vector<uint32_t> initial_faces = {
+        add_face(i0, i1, i2),
+        add_face(i0, i3, i1),
+        add_face(i1, i3, i2),
+        add_face(i2, i3, i0),
+      };
+
+      std::vector<uint32_t> others;
+      others.reserve(count);
+      for (uint32_t i = 0; i < count; i++)
+        if (i != i0 && i != i1 && i != i2 && i != i3)
+          others.push_back(i);
+      assign_points(others, initial_faces);
+      return true;
+    }
+
+    void add_point_to_hull(uint32_t face_id)
+    {
+      const uint32_t eye = faces_[face_id].furthest;
+      const vec3d eye_point = points_(eye);
+
+      // collect visible faces and the horizon by flood fill
+      std::vector<uint32_t> visible_faces = { face_id };
+      std::vector<std::pair<uint32_t, uint32_t>> horizon;
+      faces_[face_id].visible = true;
+      for (size_t i = 0; i < visible_faces.size(); i++) {
+        const auto v = faces_[visible_faces[i]].v;
+        for (int k = 0; k < 3; k++) {
+          auto a = v[k], b = v[(k + 1) % 3];
+          auto neighbor = edge_to_face_.find(edge_key(b, a));
+          if (neighbor == edge_to_face_.end()) continue;
+          auto& face = faces_[neighbor->second];
+          if (face.visible) continue;
+          if (distance(face, eye_point) > eps_) {
+            face.visible = true;
+            visible_faces.push_back(neighbor->second);
+          }
+          else
+            horizon.emplace_back(a, b);
+        }
+      }
+
+      // orphaned points should be reassigned to the new faces
+      std::vector<uint32_t> orphans;
+      for (auto f_id : visible_faces) {
+        for (auto p_id : faces_[f_id].outside)
+          if (p_id != eye) orphans.push_back(p_id);
+        faces_[f_id].outside.clear();
+        faces_[f_id].outside.shrink_to_fit();
+        remove_face(f_id);
+      }
+
+      std::vector<uint32_t> new_faces;
+      new_faces.reserve(horizon.size());
+      for (const auto& edge : horizon)
+        new_faces.push_back(add_face(edge.first, edge.second, eye));
+
+      assign_points(orphans, new_faces);
+    }
+
+    s_ptr<convex_hull> compact()
+    {
+      std::unordered_map<uint32_t, uint32_t> remap;
+      std::vector<vec3d> vertices;
+      std::vector<convex_hull::triangle> faces;
+      for (const auto& face : faces_) {
+        if (!face.alive) continue;
+        convex_hull::triangle tri;
+        for (int k = 0; k < 3; k++) {
+          auto [it, inserted] = remap.emplace(face.v[k], static_cast<uint32_t>(vertices.size()));
+          if (inserted) vertices.push_back(points_(face.v[k]));
+          tri[k] = it->second;
+        }
+        faces.push_back(tri);
+      }
+      return std::make_shared<convex_hull>(std::move(vertices), std::move(faces));
+    }
+
+    // flat or collinear input : keep every point, support functions still work
+    s_ptr<convex_hull> create_degenerate()
+    {
+      std::vector<vec3d> vertices(points_.size());
+      for (size_t i = 0; i < vertices.size(); i++)
+        vertices[i] = points_(static_cast<uint32_t>(i));
+      return std::make_shared<convex_hull>(std::move(vertices), std::vector<convex_hull::triangle>{});
+    }
+
+    const Points& points_;
+    std::vector<qh_face> faces_;
+    // directed edge -> face on the left of the edge
+    std::unordered_map<uint64_t, uint32_t> edge_to_face_;
+    double eps_ = 0.0;
+};
+
+struct vector_points
+{
+  const std::vector<vec3d>& points;
+  size_t size() const { return points.size(); }
+  const vec3d& operator()(uint32_t i) const { return points[i]; }
+};
+
+struct span_points
+{
+  const position_span& positions;
+  size_t size() const { return positions.size(); }
+  vec3d operator()(uint32_t i) const { auto p = positions[i]; return { p[0], p[1], p[2] }; }
+};
+
+} // anonymous namespace
+
+s_ptr<convex_hull> convex_hull::create(const std::vector<vec3d>& points)
+{
+  vector_points accessor{points};
+  return quickhull_builder<vector_points>(accessor).build();
+}
+
+s_ptr<convex_hull> convex_hull::create(const position_span& positions)
+{
+  span_points accessor{positions};
+  return quickhull_builder<span_points>(accessor).build();
+}
+
+convex_hull::convex_hull(std::vector<vec3d>&& vertices, std::vector<triangle>&& faces)
+  : vertices_(std::move(vertices)), faces_(std::move(faces))
+{
+  min_ = max_ = vertices_[0];
+  for (const auto& v : vertices_) {
+    min_ = min_.cwiseMin(v);
+    max_ = max_.cwiseMax(v);
+  }
+}
+
+uint32_t convex_hull::support_index(const vec3d& direction) const
+{
+  uint32_t best = 0;
+  double best_dot = -std::numeric_limits<double>::infinity();
+  for (uint32_t i = 0; i < vertices_.size(); i++) {
+    auto d = vertices_[i].dot(direction);
+    if (d > best_dot) { best_dot = d; best = i; }
+  }
+  return best;
+}
+
+} // namespace hnll::geometry
@@ -0,0 +1,292 @@
+// hnll
+#include <geometry/gjk.hpp>
+#include <geometry/bounding_volume.hpp>
+
+// std
+#include <vector>
+#include <limits>
+
+namespace hnll::geometry::gjk {
+
+constexpr int    GJK_MAX_ITERATION = 64;
+constexpr int    EPA_MAX_ITERATION = 64;
+constexpr double EPA_TOLERANCE     = 1e-6;
+
+support_point minkowski_support(const bounding_volume& a, const bounding_volume& b, const vec3d& direction)
+{
+  auto pa = a.support(direction);
+  auto pb = b.support(-direction);
+  return { pa - pb, pa, pb };
+}
+
+// ------------------------------------------------------------------------------------------
+// gjk
+// points[0] is always the newest point of the simplex
+
+namespace {
+
+inline bool same_direction(const vec3d& a, const vec3d& b) { return a.dot(b) > 0.0; }
+
+bool line_case(simplex& s, vec3d& direction)
+{
+  auto a = s.points[0], b = s.points[1];
+  vec3d ab = b.point - a.point, ao = -a.point;
+  if (same_direction(ab, ao))
+    direction = ab.cross(ao).cross(ab);
+  else {
+    s.points[0] = a; s.size = 1;
+    direction = ao;
+  }
+  return false;
+}
+
+bool triangle_case(simplex& s, vec3d& direction)
+{
+  auto a = s.points[0], b = s.points[1], c = s.points[2];
+  vec3d ab = b.point - a.point, ac = c.point - a.point, ao = -a.point;
+  vec3d abc = ab.cross(ac);
+
+  if (same_direction(abc.cross(ac), ao)) {
+    if (same_direction(ac, ao)) {
+      s.points[0] = a; s.points[1] = c; s.size = 2;
+      direction = ac.cross(ao).cross(ac);
+      return false;
+    }
+    s.points[0] = a; s.points[1] = b; s.size = 2;
+    return line_case(s, direction);
+  }
+  if (same_direction(ab.cross(abc), ao)) {
+    s.points[0] = a; s.points[1] = b; s.size = 2;
+    return line_case(s, direction);
+  }
+  if (same_direction(abc, ao))
+    direction = abc;
+  else {
+    s.points[1] = c; s.points[2] = b;
+    direction = -abc;
+  }
+  return false;
+}
+
+bool tetrahedron_case(simplex& s, vec3d& direction)
+{
+  auto a = s.points[0], b = s.points[1], c = s.points[2], d = s.points[3];
+  vec3d ao = -a.point;
+
+  // faces including the newest point. normals are oriented away from the opposite vertex
+  const std::array<std::array<support_point, 3>, 3> faces = {{ {a, b, c}, {a, c, d}, {a, d, b} }};
+  const std::array<support_point, 3> opposites = { d, b, c };
+  for (int i = 0; i < 3; i++) {
+    const auto& f = faces[i];
+    vec3d normal = (f[1].point - f[0].point).cross(f[2].point - f[0].point);
+    if (normal.dot(opposites[i].point - f[0].point) > 0.0) normal = -normal;
+    if (same_direction(normal, ao)) {
+      s.points[0] = f[0]; s.points[1] = f[1]; s.points[2] = f[2]; s.size = 3;
+      return triangle_case(s, direction);
+    }
+  }
+  return true;
+}
+
+bool next_simplex(simplex& s, vec3d& direction)
+{
+  switch (s.size) {
+    case 2 : return line_case(s, direction);
+    case 3 : return triangle_case(s, direction);
+    case 4 : return tetrahedron_case(s, direction);
+    default: return false;
+  }
+}
+
+} // anonymous namespace
+
+bool test(const bounding_volume& a, const bounding_volume& b, simplex& s, gjk_cache* cache)
+{
+  vec3d direction = b.get_world_center_point() - a.get_world_center_point();
+  if (cache && cache->is_valid)
+    direction = cache->direction;
+  if (direction.squaredNorm() < std::numeric_limits<double>::epsilon())
+    direction = vec3d(1.0, 0.0, 0.0);
+
+  s = simplex{};
+  s.push_front(minkowski_support(a, b, direction));
+  direction = -s.points[0].point;
+
+  bool result = true;
+  for (int i = 0; i < GJK_MAX_ITERATION; i++) {
+    // the origin is on the simplex
+    if (direction.squaredNorm() < std::numeric_limits<double>::epsilon())
+      break;
+
+    auto p = minkowski_support(a, b, direction);
+    if (p.point.dot(direction) <= 0.0) {
+      // found a separating axis
+      result = false;
+      break;
+    }
+    s.push_front(p);
+    if (next_simplex(s, direction))
+      break;
+  }
+
+  if (cache) {
+    cache->direction = direction;
+    cache->is_valid  = direction.squaredNorm() >= std::numeric_limits<double>::epsilon();
+  }
+  return result;
+}
+
+// ------------------------------------------------------------------------------------------
+// epa
+
+namespace {
+
+struct epa_face
+{
+  std::array<uint32_t, 3> v;
+  vec3d  normal;
+  double distance;
+};
+
+// normal is oriented away from the interior point
+epa_face make_face(const std::vector<support_point>& vertices, uint32_t i0, uint32_t i1, uint32_t i2, const vec3d& interior)
+{
+  epa_face face{{i0, i1, i2}, vec3d::Zero(), 0.0};
+  const auto& p0 = vertices[i0].point;
+  face.normal = (vertices[i1].point - p0).cross(vertices[i2].point - p0);
+  auto length = face.normal.norm();
+  face.normal = length > 0.0 ? vec3d(face.normal / length) : vec3d::Zero();
+  if (face.normal.dot(p0 - interior) < 0.0) {
+    std::swap(face.v[1], face.v[2]);
+    face.normal = -face.normal;
+  }
+  face.distance = face.normal.dot(p0);
+  return face;
+}
+
+// adds support points until the simplex becomes a tetrahedron
+// returns false if the minkowski difference is flat (touching contact)
+bool blow_up_simplex(const bounding_volume& a, const bounding_volume& b, std::vector<support_point>& vertices)
+{
+  static const std::array<vec3d, 6> axes = {
+    vec3d( 1, 0, 0), vec3d(-1, 0, 0), vec3d(0,  1, 0),
+    vec3d( 0,-1, 0), vec3d( 0, 0, 1), vec3d(0,  0,-1),
+  };
+  constexpr double eps = 1e-10;
+
+  auto is_independent = [&vertices](const vec3d& p) {
+    switch (vertices.size()) {
+      case 1 : return (p - vertices[0].point).squaredNorm() > eps;
+      case 2 : return (vertices[1].point - vertices[0].point).cross(p - vertices[0].point).squaredNorm() > eps;
+      case 3 : {
+        vec3d n = (vertices[1].point - vertices[0].point).cross(vertices[2].point - vertices[0].point);
+        return std::abs(n.dot(p - vertices[0].point)) > eps;
+      }
+      default: return false;
+    }
+  };
+
+  while (vertices.size() < 4) {
+    bool found = false;
+    std::vector<vec3d> directions(axes.begin(), axes.end());
+    // the normal of the triangle is the best candidate
+    if (vertices.size() == 3) {
+      vec3d n = (vertices[1].point - vertices[0].point).cross(vertices[2].point - vertices[0].point);
+      directions.insert(directions.begin(), { n, vec3d(-n) });
+    }
+    for (const auto& dir : directions) {
+      auto p = minkowski_support(a, b, dir);
+      if (is_independent(p.point)) {
+        vertices.push_back(p);
+        found = true;
+        break;
+      }
+    }
+    if (!found) return false;
+  }
+  return true;
+}
+
+vec3d barycentric(const vec3d& p, const vec3d& a, const vec3d& b, const vec3d& c)
+{
+  vec3d v0 = b - a, v1 = c - a, v2 = p - a;
+  double d00 = v0.dot(v0), d01 = v0.dot(v1), d11 = v1.dot(v1);
+  double d20 = v2.dot(v0), d21 = v2.dot(v1);
+  double denom = d00 * d11 - d01 * d01;
+  if (std::abs(denom) < std::numeric_limits<double>::epsilon())
+    return { 1.0, 0.0, 0.0 };
+  double v = (d11 * d20 - d01 * d21) / denom;
+  double w = (d00 * d21 - d01 * d20) / denom;
+  return { 1.0 - v - w, v, w };
+}
+
+} // anonymous namespace
+
+contact epa(const bounding_volume& a, const bounding_volume& b, const simplex& s)
+{
+  std::vector<support_point> vertices(s.points.begin(), s.points.begin() + s.size);
+  if (vertices.empty() || !blow_up_simplex(a, b, vertices))
+    return {};
+
+  const vec3d interior = (vertices[0].point + vertices[1].point + vertices[2].point + vertices[3].point) * 0.25;
+  std::vector<epa_face> faces = {
+    make_face(vertices, 0, 1, 2, interior),
+    make_face(vertices, 0, 3, 1, interior),
+    make_face(vertices, 0, 2, 3, interior),
+    make_face(vertices, 1, 3, 2, interior),
+  };
+
+  auto find_closest = [&faces] {
+    size_t closest = 0;
+    for (size_t i = 1; i < faces.size(); i++)
+      if (faces[i].distance < faces[closest].distance) closest = i;
+    return closest;
+  };
+
+  for (int iteration = 0; iteration < EPA_MAX_ITERATION; iteration++) {
+    const auto& face = faces[find_closest()];
+    auto p = minkowski_support(a, b, face.normal);
+    if (p.point.dot(face.normal) - face.distance < EPA_TOLERANCE)
+      break;
+
+    // remove the faces which can see the new point, keeping the boundary edges
+    const auto new_id = static_cast<uint32_t>(vertices.size());
+    vertices.push_back(p);
+    std::vector<std::pair<uint32_t, uint32_t>> loose_edges;
+    std::vector<epa_face> remaining;
+    remaining.reserve(faces.size());
+    for (const auto& f : faces) {
+      if (f.normal.dot(p.point - vertices[f.v[0]].point) <= 0.0) {
+        remaining.push_back(f);
+        continue;
+      }
+      for (int k = 0; k < 3; k++) {
+        std::pair<uint32_t, uint32_t> edge = { f.v[k], f.v[(k + 1) % 3] };
+        auto reversed = std::find(loose_edges.begin(), loose_edges.end(), std::make_pair(edge.second, edge.first));
+        if (reversed != loose_edges.end()) loose_edges.erase(reversed);
+        else loose_edges.push_back(edge);
+      }
+    }
+    // numerically stuck
+    if (loose_edges.empty()) break;
+
+    for (const auto& edge : loose_edges)
+      remaining.push_back(make_face(vertices, edge.first, edge.second, new_id, interior));
+    faces = std::move(remaining);
+  }
+
+  const auto& face = faces[find_closest()];
+  const auto& v0 = vertices[face.v[0]];
+  const auto& v1 = vertices[face.v[1]];
+  const auto& v2 = vertices[face.v[2]];
+  auto bary = barycentric(face.normal * face.distance, v0.point, v1.point, v2.point);
+
+  contact res;
+  res.normal  = face.normal;
+  res.depth   = std::max(face.distance, 0.0);
+  res.point_a = bary.x() * v0.a + bary.y() * v1.a + bary.z() * v2.a;
+  res.point_b = bary.x() * v0.b + bary.y() * v1.b + bary.z() * v2.b;
+  return res;
+}
+
+} // namespace hnll::geometry::gjk
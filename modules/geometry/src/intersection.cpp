@@ -4,15 +4,24 @@
 #include <geometry/bounding_volume.hpp>
 #include <geometry/perspective_frustum.hpp>
 #include <geometry/primitives.hpp>
+#include <geometry/gjk.hpp>
+#include <geometry/sphere_tree.hpp>
+#include <geometry/convex_hull.hpp>
 
 // lib
 #include <eigen3/Eigen/Dense>
 
+// std
+#include <algorithm>
+#include <limits>
+
 namespace hnll::geometry {
 
 double intersection::test_bounding_volumes(const bounding_volume &a, const bounding_volume &b)
 {
   // call intersection test depending on the types of bv
+  if (a.is_sphere_tree() || b.is_sphere_tree()) return test_sphere_tree(a, b);
+  if (a.is_convex_hull() || b.is_convex_hull()) return test_convex_convex(a, b);
   if (a.is_aabb() && b.is_aabb())     return test_aabb_aabb(a, b);
   if (a.is_aabb() && b.is_sphere())   return test_aabb_sphere(a, b);
   if (a.is_sphere() && b.is_aabb())   return test_aabb_sphere(b, a);
@@ -30,6 +39,283 @@ double intersection::test_aabb_aabb(const bounding_volume &aabb_a, const boundin
   return true;
 }
 
+double intersection::test_convex_convex(const bounding_volume &a, const bounding_volume &b, gjk_cache* cache, contact* out)
+{
+  gjk::simplex simplex;
+  if (!gjk::test(a, b, simplex, cache))
+    return 0.0;
+
+  auto res = gjk::epa(a, b, simplex);
+  if (out) *out = res;
+  return res.depth;
+}
+
+// ------------------------------------------------------------------------------------------
+// sphere tree
+
+namespace {
+
+struct world_sphere { vec3d center; double radius; };
+
+// transforms the nodes of a sphere tree into the world space
+struct tree_transform
+{
+  explicit tree_transform(const utils::transform& tf)
+    : mat(tf.rotate_mat3()),
+      translation(tf.translation.x, tf.translation.y, tf.translation.z),
+      scale(std::max({ std::abs(tf.scale.x), std::abs(tf.scale.y), std::abs(tf.scale.z) })) {}
+
+  world_sphere apply(const sphere_tree_node& node) const
+  { return { mat * node.center + translation, node.radius * scale }; }
+
+  Eigen::Matrix3d mat;
+  vec3d  translation;
+  double scale;
+};
+
+double test_tree_tree(const bounding_volume& a, const bounding_volume& b, contact* out)
+{
+  const auto& tree_a = *a.get_sphere_tree();
+  const auto& tree_b = *b.get_sphere_tree();
+  const tree_transform tf_a(a.get_transform()), tf_b(b.get_transform());
+
+  double deepest = 0.0;
+  std::vector<std::pair<uint32_t, uint32_t>> stack = { {0, 0} };
+  while (!stack.empty()) {
+    auto [id_a, id_b] = stack.back();
+    stack.pop_back();
+    const auto& node_a = tree_a.get_node(id_a);
+    const auto& node_b = tree_b.get_node(id_b);
+    const auto sphere_a = tf_a.apply(node_a);
+    const auto sphere_b = tf_b.apply(node_b);
+
+    vec3d diff = sphere_b.center - sphere_a.center;
+    double radius_sum = sphere_a.radius + sphere_b.radius;
+    double dist2 = diff.squaredNorm();
+    // early out for the whole pair of subtrees
+    if (dist2 >= radius_sum * radius_sum) continue;
+
+    if (node_a.is_leaf() && node_b.is_leaf()) {
+      double dist = std::sqrt(dist2);
+      double depth = radius_sum - dist;
+      if (out == nullptr) return depth;
+      if (depth > deepest) {
+        deepest = depth;
+        out->normal  = dist > 0.0 ? vec3d(diff / dist) : vec3d(0.0, 1.0, 0.0);
+        out->depth   = depth;
+        out->point_a = sphere_a.center + out->normal * sphere_a.radius;
+        out->point_b = sphere_b.center - out->normal * sphere_b.radius;
+      }
+      continue;
+    }
+
+    // descend the larger one
+    bool descend_a = node_b.is_leaf() || (!node_a.is_leaf() && sphere_a.radius >= sphere_b.radius);
+    if (descend_a)
+      for (uint32_t c = 0; c < node_a.child_count; c++) stack.emplace_back(node_a.first_child + c, id_b);
+    else
+      for (uint32_t c = 0; c < node_b.child_count; c++) stack.emplace_back(id_a, node_b.first_child + c);
+  }
+  return deepest;
+}
+
+// other can be any bv_type except SPHERE_TREE
+double test_tree_other(const bounding_volume& tree_bv, const bounding_volume& other, contact* out)
+{
+  const auto& tree = *tree_bv.get_sphere_tree();
+  const tree_transform tf(tree_bv.get_transform());
+  // reused for every node (world space)
+  bounding_volume probe(vec3d(0.0, 0.0, 0.0), 1.0);
+
+  double deepest = 0.0;
+  std::vector<uint32_t> stack = { 0 };
+  while (!stack.empty()) {
+    auto id = stack.back();
+    stack.pop_back();
+    const auto& node = tree.get_node(id);
+    const auto sphere = tf.apply(node);
+    probe.set_center_point(sphere.center);
+    probe.set_sphere_radius(sphere.radius);
+
+    auto depth = intersection::test_bounding_volumes(probe, other);
+    if (!depth) continue;
+
+    if (node.is_leaf()) {
+      if (out == nullptr) return depth;
+      contact leaf_contact;
+      if (intersection::test_convex_convex(probe, other, nullptr, &leaf_contact) > deepest) {
+        deepest = leaf_contact.depth;
+        *out = leaf_contact;
+      }
+      continue;
+    }
+    for (uint32_t c = 0; c < node.child_count; c++)
+      stack.push_back(node.first_child + c);
+  }
+  return deepest;
+}
+
+} // anonymous namespace
+
+double intersection::test_sphere_tree(const bounding_volume &a, const bounding_volume &b, contact* out)
+{
+  if (a.is_sphere_tree() && b.is_sphere_tree()) return test_tree_tree(a, b, out);
+  if (a.is_sphere_tree()) return test_tree_other(a, b, out);
+
+  auto depth = test_tree_other(b, a, out);
+  // the contact should be seen from a
+  if (out && depth) {
+    out->normal = -out->normal;
+    std::swap(out->point_a, out->point_b);
+  }
+  return depth;
+}
+
+// ------------------------------------------------------------------------------------------
+// contact manifold
+
+namespace {
+
+// vertices of the polyhedral shapes in the world space. empty for the round shapes
+std::vector<vec3d> world_vertices(const bounding_volume& bv)
+{
+  std::vector<vec3d> res;
+  if (bv.is_aabb()) {
+    const vec3d center = bv.get_world_center_point(), radius = bv.get_aabb_radius();
+    for (int i = 0; i < 8; i++)
+      res.emplace_back(center + vec3d(i & 1 ? radius.x() : -radius.x(), i & 2 ? radius.y() : -radius.y(), i & 4 ? radius.z() : -radius.z()));
+  }
+  else if (bv.is_convex_hull()) {
+    const auto& tf = bv.get_transform();
+    const auto mat = tf.rotate_mat3();
+    const vec3d translation = { tf.translation.x, tf.translation.y, tf.translation.z };
+    for (const auto& v : bv.get_convex_hull()->get_vertices())
+      res.emplace_back(mat * v + translation);
+  }
+  return res;
+}
+
+// vertices on the supporting plane along the direction (a vertex, an edge or a face)
+// sorted counter-clockwise around the direction
+std::vector<vec3d> support_feature(const std::vector<vec3d>& vertices, const vec3d& direction, const vec3d& u, const vec3d& v)
+{
+  double max_dot = -std::numeric_limits<double>::infinity(), min_dot = -max_dot;
+  for (const auto& p : vertices) {
+    max_dot = std::max(max_dot, p.dot(direction));
+    min_dot = std::min(min_dot, p.dot(direction));
+  }
+  const double tolerance = intersection::CONTACT_FEATURE_TOLERANCE * std::max(max_dot - min_dot, 1e-6);
+
+  std::vector<vec3d> feature;
+  vec3d centroid = vec3d::Zero();
+  for (const auto& p : vertices) {
+    if (p.dot(direction) >= max_dot - tolerance) {
+      feature.push_back(p);
+      centroid += p;
+    }
+  }
+  centroid /= static_cast<double>(feature.size());
+  std::sort(feature.begin(), feature.end(), [&](const vec3d& p, const vec3d& q) {
+    return std::atan2((p - centroid).dot(v), (p - centroid).dot(u)) < std::atan2((q - centroid).dot(v), (q - centroid).dot(u));
+  });
+  return feature;
+}
+
+// sutherland-hodgman clipping of the incident polygon by the reference polygon on the contact plane
+std::vector<vec3d> clip_polygon(std::vector<vec3d> incident, const std::vector<vec3d>& reference, const vec3d& u, const vec3d& v)
+{
+  auto cross_2d = [&](const vec3d& edge, const vec3d& p) { return edge.dot(u) * p.dot(v) - edge.dot(v) * p.dot(u); };
+  for (size_t i = 0; i < reference.size() && !incident.empty(); i++) {
+    const auto& r0 = reference[i];
+    const vec3d edge = reference[(i + 1) % reference.size()] - r0;
+    std::vector<vec3d> clipped;
+    for (size_t j = 0; j < incident.size(); j++) {
+      const auto& p = incident[j];
+      const auto& q = incident[(j + 1) % incident.size()];
+      const double dp = cross_2d(edge, p - r0), dq = cross_2d(edge, q - r0);
+      if (dp >= 0.0) clipped.push_back(p);
+      if ((dp >= 0.0) != (dq >= 0.0))
+        clipped.push_back(p + (q - p) * (dp / (dp - dq)));
+    }
+    incident = std::move(clipped);
+  }
+  return incident;
+}
+
+// keeps the deepest point and the three points which maximize the area of the manifold
+void reduce_contacts(std::vector<contact>& contacts)
+{
+  if (contacts.size() <= intersection::MAX_CONTACT_POINTS) return;
+
+  std::vector<contact> res;
+  auto pick = [&](auto&& score) {
+    auto best = std::max_element(contacts.begin(), contacts.end(),
+      [&](const contact& x, const contact& y) { return score(x) < score(y); });
+    res.push_back(*best);
+    contacts.erase(best);
+  };
+  pick([](const contact& c) { return c.depth; });
+  const vec3d p0 = res[0].point_b, normal = res[0].normal;
+  pick([&](const contact& c) { return (c.point_b - p0).squaredNorm(); });
+  const vec3d p1 = res[1].point_b;
+  pick([&](const contact& c) { return std::abs((p1 - p0).cross(c.point_b - p0).dot(normal)); });
+  const vec3d p2 = res[2].point_b;
+  // the farthest point outside of the triangle
+  const double sign = (p1 - p0).cross(p2 - p0).dot(normal) >= 0.0 ? 1.0 : -1.0;
+  pick([&](const contact& c) {
+    return -std::min({
+      sign * (p1 - p0).cross(c.point_b - p0).dot(normal),
+      sign * (p2 - p1).cross(c.point_b - p1).dot(normal),
+      sign * (p0 - p2).cross(c.point_b - p2).dot(normal) });
+  });
+  contacts = std::move(res);
+}
+
+} // anonymous namespace
+
+std::vector<contact> intersection::create_contact_manifold(const bounding_volume &a, const bounding_volume &b, const contact& deepest)
+{
+  const auto vertices_a = world_vertices(a);
+  const auto vertices_b = world_vertices(b);
+  if (vertices_a.empty() || vertices_b.empty() || deepest.normal.isZero())
+    return { deepest };
+
+  // basis of the contact plane
+  const vec3d& normal = deepest.normal;
+  const vec3d u = (std::abs(normal.x()) < 0.57 ? vec3d::UnitX() : vec3d::UnitY()).cross(normal).normalized();
+  const vec3d v = normal.cross(u);
+
+  // a's feature faces b and vice versa
+  auto feature_a = support_feature(vertices_a, normal, u, v);
+  auto feature_b = support_feature(vertices_b, -normal, u, v);
+  if (feature_a.size() < 3 && feature_b.size() < 3)
+    return { deepest };
+
+  // a face of one shape is the reference and the other feature is clipped by it
+  const bool a_is_reference = feature_a.size() >= 3;
+  const auto clipped = a_is_reference ?
+    clip_polygon(std::move(feature_b), feature_a, u, v) :
+    clip_polygon(std::move(feature_a), feature_b, u, v);
+  const double reference_offset = a_is_reference ?
+    feature_a[0].dot(normal) : feature_b[0].dot(normal);
+
+  std::vector<contact> res;
+  for (const auto& p : clipped) {
+    contact c;
+    c.normal = normal;
+    c.depth  = a_is_reference ? reference_offset - p.dot(normal) : p.dot(normal) - reference_offset;
+    if (c.depth < 0.0) continue;
+    c.point_a = a_is_reference ? vec3d(p + normal * c.depth) : p;
+    c.point_b = a_is_reference ? p : vec3d(p - normal * c.depth);
+    res.push_back(c);
+  }
+  if (res.empty())
+    return { deepest };
+
+  reduce_contacts(res);
+  return res;
+}
+
 double intersection::test_sphere_sphere(const bounding_volume &sphere_a, const bounding_volume &sphere_b)
 {
   Eigen::Vector3d difference = sphere_a.get_world_center_point() - sphere_b.get_world_center_point();
@@ -108,12 +394,12 @@ double intersection::test_sphere_frustum(const geometry::bounding_volume &sphere
 
 double intersection::test_ray_triangle(const ray &_ray, const std::vector<vec3d>& _vertices)
 {
-  _ray.direction.normalized();
+  return test_ray_triangle(_ray, _vertices[0], _vertices[1], _vertices[2]);
+}
+
+double intersection::test_ray_triangle(const ray &_ray, const vec3d& v0, const vec3d& v1, const vec3d& v2, double eps)
+{
   // moeller's method
-  constexpr double eps = 1e-6f;
-  const auto& v0 = _vertices[0];
-  const auto& v1 = _vertices[1];
-  const auto& v2 = _vertices[2];
 
   vec3d e1 = v1 - v0;
   vec3d e2 = v2 - v0;
@@ -123,20 +409,20 @@ double intersection::test_ray_triangle(const ray &_ray, const std::vector<vec3d>
   vec3d beta  = r.cross(e1);
 
   double det = e1.dot(alpha);
-  float inv_det = 1.f / det;
 
   // the ray and the triangle are parallel
   if (std::abs(det) < eps) {
-    return false;
+    return 0.0;
   }
+  double inv_det = 1.0 / det;
 
   // check barycentric parameters of the triangle
   double u = alpha.dot(r) * inv_det;
-  if (u < 0.f || u > 1.f) return false;
+  if (u < 0.0 || u > 1.0) return 0.0;
   double v = beta.dot(_ray.direction) * inv_det;
-  if (v < 0.f || u + v > 1.f) return false;
+  if (v < 0.0 || u + v > 1.0) return 0.0;
   double t = e2.dot(beta) * inv_det;
-  if (t < 0.f) return false;
+  if (t < 0.0) return 0.0;
 
   return t;
 }
@@ -9,9 +9,6 @@
 // std
 #include <filesystem>
 
-// lib
-#include <tiny_obj_loader/tiny_obj_loader.h>
-
 namespace hnll::geometry {
 
 bool operator==(const vertex& rhs, const vertex& lhs)
@@ -0,0 +1,212 @@
+// hnll
+#include <geometry/sphere_tree.hpp>
+#include <geometry/bounding_volume.hpp>
+#include <utils/utils.hpp>
+
+// std
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+
+namespace hnll::geometry {
+
+std::unordered_map<std::string, s_ptr<sphere_tree>> sphere_tree::sphere_tree_map_{};
+
+namespace {
+
+// top-down median split of the triangles
+class sphere_tree_builder
+{
+  public:
+    sphere_tree_builder(const position_span& positions, const std::vector<uint32_t>& indices, uint32_t leaf_triangle_count)
+      : positions_(positions), indices_(indices), leaf_triangle_count_(std::max(leaf_triangle_count, 1u)) {}
+
+    std::vector<sphere_tree_node> build()
+    {
+      const auto triangle_count = indices_.size() / 3;
+      if (triangle_count == 0)
+        throw std::runtime_error("sphere_tree : no triangle");
+
+      triangles_.resize(triangle_count);
+      centroids_.resize(triangle_count);
+      for (uint32_t t = 0; t < triangle_count; t++) {
+        triangles_[t] = t;
+        centroids_[t] = (position(t, 0) + position(t, 1) + position(t, 2)) / 3.0;
+      }
+
+      nodes_.emplace_back();
+      build_node(0, 0, triangle_count);
+      return std::move(nodes_);
+    }
+
+  private:
+    vec3d position(uint32_t triangle, int k) const
+    {
+      auto p = positions_[indices_[triangle * 3 + k]];
+      return { p[0], p[1], p[2] };
+    }
+
+    void build_node(uint32_t node_id, size_t begin, size_t end)
+    {
+      // sphere of every vertex in the range, which also encloses the triangles
+      std::vector<vec3d> vertices;
+      vertices.reserve((end - begin) * 3);
+      for (size_t i = begin; i < end; i++)
+        for (int k = 0; k < 3; k++)
+          vertices.push_back(position(triangles_[i], k));
+      auto sphere = bounding_volume::ritter_ctor(vertices);
+      nodes_[node_id].center = sphere->get_local_center_point();
+      nodes_[node_id].radius = sphere->get_sphere_radius();
+
+      if (end - begin <= leaf_triangle_count_)
+        return;
+
+      // split at the median of the longest axis of the centroids
+      vec3d min = centroids_[triangles_[begin]], max = min;
+      for (size_t i = begin + 1; i < end; i++) {
+        min = min.cwiseMin(centroids_[triangles_[i]]);
+        max = max.cwiseMax(centroids_[triangles_[i]]);
+      }
+      int axis;
+      (max - min).maxCoeff(&axis);
+      const auto mid = (begin + end) / 2;
+      std::nth_element(triangles_.begin() + begin, triangles_.begin() + mid, triangles_.begin() + end,
+        [this, axis](uint32_t a, uint32_t b) { return centroids_[a][axis] < centroids_[b][axis]; });
+
+      const auto first_child = static_cast<uint32_t>(nodes_.size());
+      nodes_.emplace_back();
+      nodes_.emplace_back();
+      nodes_[node_id].first_child = first_child;
+      nodes_[node_id].child_count = 2;
+      build_node(first_child,     begin, mid);
+      build_node(first_child + 1, mid,   end);
+    }
+
+    const position_span&         positions_;
+    const std::vector<uint32_t>& indices_;
+    const uint32_t               leaf_triangle_count_;
+    std::vector<uint32_t>         triangles_;
+    std::vector<vec3d>            centroids_;
+    std::vector<sphere_tree_node> nodes_;
+};
+
+} // anonymous namespace
+
+s_ptr<sphere_tree> sphere_tree::create(
+  const position_span& positions,
+  const std::vector<uint32_t>& indices,
+  uint32_t leaf_triangle_count)
+{
+  sphere_tree_builder builder(positions, indices, leaf_triangle_count);
+  return std::make_shared<sphere_tree>(builder.build());
+}
+
+s_ptr<sphere_tree> sphere_tree::create_with_cache(
+  const std::string& model_name,
+  const position_span& positions,
+  const std::vector<uint32_t>& indices)
+{
+  if (auto it = sphere_tree_map_.find(model_name); it != sphere_tree_map_.end())
+    return it->second;
+
+  const auto source_hash = hash_source(positions, indices);
+  auto tree = load_cache(model_name, source_hash);
+  if (tree == nullptr) {
+    tree = create(positions, indices);
+    write_cache(*tree, model_name, source_hash);
+  }
+  sphere_tree_map_.emplace(model_name, tree);
+  return tree;
+}
+
+s_ptr<sphere_tree> sphere_tree::find(const std::string& model_name)
+{
+  auto it = sphere_tree_map_.find(model_name);
+  return it != sphere_tree_map_.end() ? it->second : nullptr;
+}
+
+uint64_t sphere_tree::hash_source(const position_span& positions, const std::vector<uint32_t>& indices)
+{
+  // fnv-1a over the bits of the positions (without the padding) and the indices
+  uint64_t hash = 0xcbf29ce484222325ull;
+  auto add = [&hash](const void* data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+      hash ^= static_cast<const uint8_t*>(data)[i];
+      hash *= 0x100000001b3ull;
+    }
+  };
+  for (size_t i = 0; i < positions.size(); i++)
+    add(positions[i], 3 * sizeof(float));
+  add(indices.data(), indices.size() * sizeof(uint32_t));
+  return hash;
+}
+
+void sphere_tree::write_cache(const sphere_tree& tree, const std::string& model_name, uint64_t source_hash)
+{
+  if (std::getenv("HNLL_ENGN") == nullptr)
+    return;
+  auto directory = utils::create_sub_cache_directory("sphere_trees");
+
+  std::ofstream writing_file;
+  std::string filepath = directory + "/" + model_name + ".st";
+  writing_file.open(filepath, std::ios::out);
+  writing_file.precision(std::numeric_limits<double>::max_digits10);
+
+  writing_file << model_name << std::endl;
+  writing_file << source_hash << std::endl;
+  writing_file << tree.nodes_.size() << std::endl;
+  for (const auto& node : tree.nodes_) {
+    writing_file << node.center.x() << ',' << node.center.y() << ',' << node.center.z() << ','
+                 << node.radius << ',' << node.first_child << ',' << node.child_count << std::endl;
+  }
+  writing_file.close();
+}
+
+s_ptr<sphere_tree> sphere_tree::load_cache(const std::string& model_name, uint64_t source_hash)
+{
+  const char* engine_dir = std::getenv("HNLL_ENGN");
+  if (engine_dir == nullptr)
+    return nullptr;
+  std::string cache_dir = std::string(engine_dir) + "/cache/sphere_trees/";
+  std::string file_path = cache_dir + model_name + ".st";
+
+  // cache does not exist
+  if (!std::filesystem::exists(file_path))
+    return nullptr;
+
+  std::ifstream reading_file(file_path);
+  std::string buffer;
+
+  if (reading_file.fail())
+    throw std::runtime_error("failed to open file" + file_path);
+
+  // model name
+  getline(reading_file, buffer);
+  // the model has been modified since the cache was written
+  getline(reading_file, buffer);
+  if (std::stoull(buffer) != source_hash) return nullptr;
+
+  getline(reading_file, buffer);
+  std::vector<sphere_tree_node> nodes(std::stoull(buffer));
+  for (auto& node : nodes) {
+    getline(reading_file, buffer, ',');
+    node.center.x() = std::stod(buffer);
+    getline(reading_file, buffer, ',');
+    node.center.y() = std::stod(buffer);
+    getline(reading_file, buffer, ',');
+    node.center.z() = std::stod(buffer);
+    getline(reading_file, buffer, ',');
+    node.radius = std::stod(buffer);
+    getline(reading_file, buffer, ',');
+    node.first_child = std::stoul(buffer);
+    getline(reading_file, buffer);
+    node.child_count = std::stoul(buffer);
+  }
+
+  if (nodes.empty()) return nullptr;
+  return std::make_shared<sphere_tree>(std::move(nodes));
+}
+
+} // namespace hnll::geometry
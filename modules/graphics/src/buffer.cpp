@@ -7,6 +7,7 @@
 
 // hnll
 #include <graphics/buffer.hpp>
+#include <graphics/upload_batch.hpp>
  
 // std
 #include <cassert>
@@ -73,7 +74,8 @@ u_ptr<buffer> buffer::create_with_staging(
   VkBufferUsageFlags usage_flags,
   VkMemoryPropertyFlags memory_property_flags,
   void* writing_data,
-  VkDeviceSize min_offset_alignment)
+  VkDeviceSize min_offset_alignment,
+  upload_batch* batch)
 {
   auto staging = std::make_unique<buffer>(
     device,
@@ -97,7 +99,10 @@ u_ptr<buffer> buffer::create_with_staging(
   );
 
   VkDeviceSize buffer_size = instance_size * instance_count;
-  device.copy_buffer(staging->get_buffer(), ret->get_buffer(), buffer_size);
+  if (batch != nullptr)
+    batch->copy_buffer(std::move(staging), ret->get_buffer(), buffer_size);
+  else
+    device.copy_buffer(staging->get_buffer(), ret->get_buffer(), buffer_size);
 
   return ret;
 }
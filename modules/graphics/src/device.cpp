@@ -692,8 +692,11 @@ void device::end_one_shot_commands(VkCommandBuffer command_buffer)
   submit_info.commandBufferCount = 1;
   submit_info.pCommandBuffers = &command_buffer;
 
-  vkQueueSubmit(graphics_queue_, 1, &submit_info, VK_NULL_HANDLE);
-  vkQueueWaitIdle(graphics_queue_);
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    vkQueueSubmit(graphics_queue_, 1, &submit_info, VK_NULL_HANDLE);
+    vkQueueWaitIdle(graphics_queue_);
+  }
 
   vkFreeCommandBuffers(device_, command_pool_, 1, &command_buffer);
 }
@@ -1,13 +1,16 @@
 // hnll
 #include <graphics/mesh_model.hpp>
+#include <graphics/upload_batch.hpp>
 #include <graphics/utils.hpp>
 #include <geometry/mesh_model.hpp>
 #include <geometry/primitives.hpp>
+#include <geometry/bounding_volume.hpp>
 #include <utils/utils.hpp>
+#include <utils/asset_package.hpp>
+#include <utils/job_system.hpp>
+#include <utils/obj_parser.hpp>
 
 // libs
-#define TINYOBJLOADER_IMPLEMENTATION
-#include <tiny_obj_loader/tiny_obj_loader.h>
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/hash.hpp>
 
@@ -18,10 +21,10 @@
 
 namespace hnll::graphics {
 
-mesh_model::mesh_model(device& device, const mesh_builder &builder) : device_{device}
+mesh_model::mesh_model(device& device, const mesh_builder &builder, upload_batch* batch) : device_{device}
 {
-  create_vertex_buffers(builder.vertices);
-  create_index_buffers(builder.indices);
+  create_vertex_buffers(builder.vertices, batch);
+  create_index_buffers(builder.indices, batch);
 
   vertex_list_ = std::move(builder.vertices);
 }
@@ -33,14 +36,13 @@ mesh_model::~mesh_model()
 
 u_ptr<mesh_model> mesh_model::create_from_file(device &device, const std::string &filename)
 {
-  auto filepath = utils::get_full_path(filename);
   mesh_builder builder;
-  builder.load_model(filepath);
+  builder.load_asset(filename);
   std::cout << filename << " vertex count: " << builder.vertices.size() << "\n";
   return std::make_unique<mesh_model>(device, builder);
 }
 
-void mesh_model::create_vertex_buffers(const std::vector<vertex> &vertices)
+void mesh_model::create_vertex_buffers(const std::vector<vertex> &vertices, upload_batch* batch)
 {
   // vertexCount must be larger than 3 (triangle) 
   // use a host visible buffer as temporary buffer, use a device local buffer as actual vertex buffer
@@ -49,16 +51,16 @@ void mesh_model::create_vertex_buffers(const std::vector<vertex> &vertices)
   uint32_t vertex_size = sizeof(vertices[0]);
 
   // staging buffer creation
-  buffer staging_buffer {
+  auto staging_buffer = std::make_unique<buffer>(
     device_,
     vertex_size, // for calculating alignment
     vertex_count_, // same as above
     VK_BUFFER_USAGE_TRANSFER_SRC_BIT, // usage
     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT // property
-  };
+  );
   // mapping the data to the buffer
-  staging_buffer.map();
-  staging_buffer.write_to_buffer((void *)vertices.data());
+  staging_buffer->map();
+  staging_buffer->write_to_buffer((void *)vertices.data());
 
   // vertex buffer creation
   vertex_buffer_ = std::make_unique<buffer>(
@@ -69,11 +71,14 @@ void mesh_model::create_vertex_buffers(const std::vector<vertex> &vertices)
     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT// property
   );
   // copy the data from staging buffer to the vertex buffer
-  device_.copy_buffer(staging_buffer.get_buffer(), vertex_buffer_->get_buffer(), buffer_size);
+  if (batch != nullptr)
+    batch->copy_buffer(std::move(staging_buffer), vertex_buffer_->get_buffer(), buffer_size);
+  else
+    device_.copy_buffer(staging_buffer->get_buffer(), vertex_buffer_->get_buffer(), buffer_size);
   // staging buffer is automatically freed in the dtor 
 }
 
-void mesh_model::create_index_buffers(const std::vector<uint32_t> &indices)
+void mesh_model::create_index_buffers(const std::vector<uint32_t> &indices, upload_batch* batch)
 {
   index_count_ = static_cast<uint32_t>(indices.size());
   // if there is no index, nothing to do
@@ -84,16 +89,16 @@ void mesh_model::create_index_buffers(const std::vector<uint32_t> &indices)
   uint32_t indexSize = sizeof(indices[0]);
 
   // copy the data to the staging buffer
-  buffer staging_buffer {
+  auto staging_buffer = std::make_unique<buffer>(
     device_,
     indexSize,
     index_count_,
     VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-  };
+    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+  );
 
-  staging_buffer.map();
-  staging_buffer.write_to_buffer((void *)indices.data());
+  staging_buffer->map();
+  staging_buffer->write_to_buffer((void *)indices.data());
 
   index_buffer_ = std::make_unique<buffer> (
     device_,
@@ -104,7 +109,10 @@ void mesh_model::create_index_buffers(const std::vector<uint32_t> &indices)
   );
 
   // copy the data from staging buffer to the vertex buffer
-  device_.copy_buffer(staging_buffer.get_buffer(), index_buffer_->get_buffer(), buffer_size);
+  if (batch != nullptr)
+    batch->copy_buffer(std::move(staging_buffer), index_buffer_->get_buffer(), buffer_size);
+  else
+    device_.copy_buffer(staging_buffer->get_buffer(), index_buffer_->get_buffer(), buffer_size);
 }
 
 void mesh_model::bind(VkCommandBuffer command_buffer)
@@ -126,62 +134,49 @@ void mesh_model::draw(VkCommandBuffer command_buffer)
     vkCmdDraw(command_buffer, vertex_count_, 1, 0, 0);
 }
 
-void mesh_builder::load_model(const std::string& filename)
+void mesh_builder::load_model(const std::string& filename, utils::job_system* jobs)
 {
-  // loader
-  tinyobj::attrib_t attrib;
-  std::vector<tinyobj::shape_t> shapes;
-  std::vector<tinyobj::material_t> materials;
-  std::string warn, err;
-
-  if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filename.c_str()))
-    throw std::runtime_error(warn + err);
-
-  vertices.clear();
-  indices.clear();
-
-  std::unordered_map<vertex, uint32_t> unique_vertices{};
-
-  for (const auto &shape : shapes) {
-    for (const auto &index : shape.mesh.indices) {
-      vertex vertex{};
-      // copy the vertex
-      if (index.vertex_index >= 0) {
-        vertex.position = {
-          attrib.vertices[3 * index.vertex_index + 0],
-          attrib.vertices[3 * index.vertex_index + 1],
-          attrib.vertices[3 * index.vertex_index + 2]
-        };
-        // color support
-        vertex.color = {
-          attrib.colors[3 * index.vertex_index + 0],
-          attrib.colors[3 * index.vertex_index + 1],
-          attrib.colors[3 * index.vertex_index + 2]
-        };
-      }
-      // copy the normal
-      if (index.normal_index >= 0) {
-        vertex.normal = {
-          attrib.normals[3 * index.normal_index + 0],
-          attrib.normals[3 * index.normal_index + 1],
-          attrib.normals[3 * index.normal_index + 2]
-        };
-      }
-      // copy the texture coordinate
-      if (index.texcoord_index >= 0) {
-        vertex.uv = {
-          attrib.vertices[2 * index.texcoord_index + 0],
-          attrib.vertices[2 * index.texcoord_index + 1]
-        };
-      }
-      // if vertex is a new vertex
-      if (unique_vertices.find(vertex) == unique_vertices.end()) {
-        unique_vertices[vertex] = static_cast<uint32_t>(vertices.size());
-        vertices.push_back(vertex);
-      }
-      indices.push_back(unique_vertices[vertex]);
+  auto data = utils::load_obj(filename, jobs);
+
+  vertices.resize(data.vertices.size());
+  auto build = [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      const auto& index = data.vertices[i];
+      auto& v = vertices[i];
+      v = {};
+      v.position = Eigen::Map<const Eigen::Vector3f>(&data.positions[3 * index.position]);
+      v.color    = Eigen::Map<const Eigen::Vector3f>(&data.colors[3 * index.position]);
+      if (index.normal >= 0)
+        v.normal = Eigen::Map<const Eigen::Vector3f>(&data.normals[3 * index.normal]);
+      if (index.texcoord >= 0)
+        v.uv     = Eigen::Map<const Eigen::Vector2f>(&data.texcoords[2 * index.texcoord]);
     }
-  }
+  };
+  if (jobs != nullptr) jobs->parallel_for(0, vertices.size(), 0, build, "mesh vertices");
+  else                 build(0, vertices.size());
+  indices = std::move(data.indices);
+}
+
+void mesh_builder::load_asset(const std::string& asset_name, utils::job_system* jobs)
+{
+  auto package = utils::asset_package::load_if_fresh(utils::get_cooked_path(asset_name, "mesh"));
+  if (package == nullptr || !read_package(*package))
+    load_model(utils::get_full_path(asset_name), jobs);
+}
+
+void mesh_builder::write_package(utils::asset_package& package) const
+{
+  package.add_chunk("vertices", vertices);
+  package.add_chunk("indices", indices);
+}
+
+bool mesh_builder::read_package(const utils::asset_package& package)
+{
+  if (!package.has_chunk("vertices") || !package.has_chunk("indices"))
+    return false;
+  vertices = package.get_chunk<vertex>("vertices");
+  indices  = package.get_chunk<uint32_t>("indices");
+  return true;
 }
 
 std::vector<Eigen::Vector3d> mesh_model::get_vertex_position_list() const
@@ -194,6 +189,17 @@ std::vector<Eigen::Vector3d> mesh_model::get_vertex_position_list() const
   return vertex_position_list;
 }
 
+geometry::position_span mesh_model::get_position_span(const std::vector<vertex>& vertices)
+{
+  // position is the first member of vertex
+  static_assert(offsetof(vertex, position) == 0 && sizeof(vertex) % sizeof(float) == 0);
+  constexpr size_t stride = sizeof(vertex) / sizeof(float);
+  return {
+    std::span<const float>(reinterpret_cast<const float*>(vertices.data()), vertices.size() * stride),
+    stride
+  };
+}
+
 graphics::vertex convert_geometry_to_graphics_vertex(const s_ptr<geometry::vertex>& gv)
 {
   graphics::vertex res;
@@ -7,6 +7,7 @@
 #include <geometry/mesh_separation.hpp>
 #include <geometry/mesh_model.hpp>
 #include <utils/utils.hpp>
+#include <utils/asset_package.hpp>
 
 // std
 #include <iostream>
@@ -22,34 +23,59 @@ meshlet_model::meshlet_model(std::vector<vertex> &&raw_vertices, std::vector<mes
 
 u_ptr<meshlet_model> meshlet_model::create(
   device& _device,
-  std::vector<vertex>&& _raw_vertices, std::vector<meshlet>&& _meshlets)
+  std::vector<vertex>&& _raw_vertices, std::vector<meshlet>&& _meshlets,
+  upload_batch* batch)
 {
   auto ret = std::make_unique<meshlet_model>(
     std::move(_raw_vertices),
     std::move(_meshlets)
   );
 
-  ret->setup_descs(_device);
+  ret->setup_descs(_device, batch);
 
   return ret;
 }
 
 u_ptr<meshlet_model> meshlet_model::create_from_file(hnll::graphics::device &_device, std::string _filename)
 {
-  std::vector<meshlet> meshlets;
+  auto data = meshlet_model_data::load_asset(_filename);
+  return create(_device, std::move(data.raw_vertices), std::move(data.meshlets));
+}
+
+meshlet_model_data meshlet_model_data::load_asset(const std::string& asset_name)
+{
+  meshlet_model_data data;
+  auto package = utils::asset_package::load_if_fresh(utils::get_cooked_path(asset_name, "meshlet"));
+  if (package != nullptr && data.read_package(*package))
+    return data;
 
-  auto filepath = utils::get_full_path(_filename);
+  auto filepath = utils::get_full_path(asset_name);
 
   // prepare required data
   auto geometry_model = geometry::mesh_model::create_from_obj_file(filepath);
 
   // if model's cache exists
-  meshlets = geometry::mesh_separation::load_meshlet_cache(_filename);
-  if (meshlets.size() == 0) {
-    meshlets = geometry::mesh_separation::separate(geometry_model, _filename);
+  data.meshlets = geometry::mesh_separation::load_meshlet_cache(asset_name);
+  if (data.meshlets.size() == 0) {
+    data.meshlets = geometry::mesh_separation::separate(geometry_model, asset_name);
   }
+  data.raw_vertices = geometry_model->move_raw_vertices();
+  return data;
+}
 
-  return create(_device, geometry_model->move_raw_vertices(), std::move(meshlets));
+void meshlet_model_data::write_package(utils::asset_package& package) const
+{
+  package.add_chunk("raw_vertices", raw_vertices);
+  package.add_chunk("meshlets", meshlets);
+}
+
+bool meshlet_model_data::read_package(const utils::asset_package& package)
+{
+  if (!package.has_chunk("raw_vertices") || !package.has_chunk("meshlets"))
+    return false;
+  raw_vertices = package.get_chunk<vertex>("raw_vertices");
+  meshlets     = package.get_chunk<meshlet>("meshlets");
+  return true;
 }
 
 void meshlet_model::bind(
@@ -88,10 +114,10 @@ void meshlet_model::draw(VkCommandBuffer _command_buffer)
   );
 }
 
-void meshlet_model::setup_descs(device& _device)
+void meshlet_model::setup_descs(device& _device, upload_batch* batch)
 {
   create_desc_pool(_device);
-  create_desc_buffers(_device);
+  create_desc_buffers(_device, batch);
   create_desc_set_layouts(_device);
   create_desc_sets();
 }
@@ -104,7 +130,7 @@ void meshlet_model::create_desc_pool(hnll::graphics::device &_device)
     .build();
 }
 
-void meshlet_model::create_desc_buffers(device& _device)
+void meshlet_model::create_desc_buffers(device& _device, upload_batch* batch)
 {
   desc_buffers_.resize(DESC_SET_COUNT);
 
@@ -114,7 +140,9 @@ void meshlet_model::create_desc_buffers(device& _device)
     raw_vertices_.size(),
     VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-    raw_vertices_.data()
+    raw_vertices_.data(),
+    1,
+    batch
   );
 
   desc_buffers_[MESHLET_DESC_ID] = graphics::buffer::create_with_staging(
@@ -123,7 +151,9 @@ void meshlet_model::create_desc_buffers(device& _device)
     meshlets_.size(),
     VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-    meshlets_.data()
+    meshlets_.data(),
+    1,
+    batch
   );
 }
 
@@ -160,6 +190,14 @@ const buffer& meshlet_model::get_vertex_buffer()  const
 const buffer& meshlet_model::get_meshlet_buffer() const
 { return *desc_buffers_[MESHLET_DESC_ID]; }
 
+size_t meshlet_model::get_byte_size() const
+{
+  size_t bytes = raw_vertices_.size() * sizeof(vertex) + meshlets_.size() * sizeof(meshlet);
+  for (const auto& desc_buffer : desc_buffers_)
+    bytes += desc_buffer->get_buffer_size();
+  return bytes;
+}
+
 std::vector<VkDescriptorSetLayout> meshlet_model::get_raw_desc_set_layouts() const
 {
   std::vector<VkDescriptorSetLayout> ret;
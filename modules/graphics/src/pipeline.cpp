@@ -2,6 +2,7 @@
 #include <graphics/pipeline.hpp>
 #include <graphics/mesh_model.hpp>
 #include <graphics/utils.hpp>
+#include <utils/vfs.hpp>
 
 // std
 #include <iostream>
@@ -197,8 +198,11 @@ void pipeline::create_graphics_pipeline(
   // create shader module
   shader_modules_.resize(shader_stage_count);
   for (int i = 0; i < shader_stage_count; i++) {
-    auto raw_code = read_file(_shader_filepaths[i]);
-    create_shader_module(raw_code, &shader_modules_[i]);
+    // mapped, not copied. vulkan copies the code into the module
+    auto code = utils::mapped_file::open(_shader_filepaths[i]);
+    if (code == nullptr)
+      throw std::runtime_error("failed to open file: " + _shader_filepaths[i]);
+    create_shader_module(code->get_bytes(), &shader_modules_[i]);
 
     if (_shader_stage_flags[i] == VK_SHADER_STAGE_VERTEX_BIT)
       has_vertex_shader = true;
@@ -257,12 +261,12 @@ void pipeline::create_graphics_pipeline(
     throw std::runtime_error("failed to create graphics pipeline!");
 }
 
-void pipeline::create_shader_module(const std::vector<char>& code, VkShaderModule* shader_module)
+void pipeline::create_shader_module(std::span<const std::byte> code, VkShaderModule* shader_module)
 {
   VkShaderModuleCreateInfo create_info{};
   create_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
   create_info.codeSize = code.size();
-  // char to uint32_t
+  // byte to uint32_t
   create_info.pCode = reinterpret_cast<const uint32_t*>(code.data());
 
   if (vkCreateShaderModule(device_.get_device(), &create_info, nullptr, shader_module) != VK_SUCCESS)
@@ -140,6 +140,7 @@ VkResult swap_chain::submit_command_buffers(const VkCommandBuffer *buffers, uint
   // need to be manually restore the fence to the unsignaled state
   vkResetFences(device_.get_device(), 1, &in_flight_fences_[current_frame_]);
 
+  std::lock_guard<std::mutex> lock(device_.get_queue_mutex());
   // submit the command buffer to the graphics queue with fence
   if (vkQueueSubmit(device_.get_graphics_queue(), 1, &submit_info, in_flight_fences_[current_frame_]) != VK_SUCCESS)
       throw std::runtime_error("failed to submit draw command buffer!");
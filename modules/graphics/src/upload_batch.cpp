@@ -0,0 +1,87 @@
+// hnll
+#include <graphics/upload_batch.hpp>
+#include <graphics/buffer.hpp>
+
+// std
+#include <mutex>
+#include <stdexcept>
+
+namespace hnll::graphics {
+
+upload_batch::upload_batch(device& device) : device_(device)
+{
+  VkCommandPoolCreateInfo pool_info{};
+  pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+  pool_info.queueFamilyIndex = device_.get_queue_family_indices().graphics_family_.value();
+  pool_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+  if (vkCreateCommandPool(device_.get_device(), &pool_info, nullptr, &command_pool_) != VK_SUCCESS)
+    throw std::runtime_error("upload_batch : failed to create command pool.");
+
+  VkCommandBufferAllocateInfo allocate_info{};
+  allocate_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+  allocate_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  allocate_info.commandPool = command_pool_;
+  allocate_info.commandBufferCount = 1;
+  vkAllocateCommandBuffers(device_.get_device(), &allocate_info, &command_buffer_);
+
+  VkCommandBufferBeginInfo begin_info{};
+  begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+  vkBeginCommandBuffer(command_buffer_, &begin_info);
+
+  VkFenceCreateInfo fence_info{};
+  fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+  if (vkCreateFence(device_.get_device(), &fence_info, nullptr, &fence_) != VK_SUCCESS)
+    throw std::runtime_error("upload_batch : failed to create fence.");
+}
+
+upload_batch::~upload_batch()
+{
+  if (is_submitted_ && !is_empty())
+    vkWaitForFences(device_.get_device(), 1, &fence_, VK_TRUE, UINT64_MAX);
+  vkDestroyFence(device_.get_device(), fence_, nullptr);
+  // frees the command buffer
+  vkDestroyCommandPool(device_.get_device(), command_pool_, nullptr);
+  // the staging buffers are freed after the transfer
+}
+
+void upload_batch::copy_buffer(u_ptr<buffer>&& staging, VkBuffer dst_buffer, VkDeviceSize size)
+{
+  if (is_submitted_)
+    throw std::runtime_error("upload_batch : the batch is already submitted.");
+
+  VkBufferCopy copy_region{};
+  copy_region.size = size;
+  vkCmdCopyBuffer(command_buffer_, staging->get_buffer(), dst_buffer, 1, &copy_region);
+
+  byte_size_ += size;
+  staging_buffers_.emplace_back(std::move(staging));
+}
+
+void upload_batch::submit()
+{
+  if (is_submitted_)
+    throw std::runtime_error("upload_batch : the batch is already submitted.");
+  vkEndCommandBuffer(command_buffer_);
+  is_submitted_ = true;
+  if (is_empty())
+    return;
+
+  VkSubmitInfo submit_info{};
+  submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submit_info.commandBufferCount = 1;
+  submit_info.pCommandBuffers = &command_buffer_;
+
+  std::lock_guard<std::mutex> lock(device_.get_queue_mutex());
+  if (vkQueueSubmit(device_.get_graphics_queue(), 1, &submit_info, fence_) != VK_SUCCESS)
+    throw std::runtime_error("upload_batch : failed to submit the copies.");
+}
+
+bool upload_batch::is_complete() const
+{
+  if (!is_submitted_) return false;
+  if (is_empty())     return true;
+  return vkGetFenceStatus(device_.get_device(), fence_) == VK_SUCCESS;
+}
+
+} // namespace hnll::graphics
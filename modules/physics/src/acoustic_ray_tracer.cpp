@@ -0,0 +1,485 @@
+// hnll
+#include <physics/acoustic_ray_tracer.hpp>
+#include <geometry/bounding_volume.hpp>
+#include <geometry/intersection.hpp>
+#include <geometry/mesh_model.hpp>
+#include <geometry/primitives.hpp>
+#include <utils/job_system.hpp>
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <stdexcept>
+
+namespace hnll::physics {
+
+namespace {
+
+// the chunks don't depend on the job count, so the results don't either
+constexpr size_t   RAYS_PER_CHUNK          = 256;
+constexpr size_t   SEGMENTS_PER_CHUNK      = 1 << 14;
+constexpr uint32_t MAX_LEAF_TRIANGLES      = 4;
+constexpr uint32_t MAX_BVH_DEPTH           = 64;
+// -60 dB, the end of the reverberation time
+constexpr double   MIN_RAY_ENERGY          = 1e-6;
+// reflected rays start this far from the surface so that they don't hit it again
+constexpr double   SURFACE_OFFSET          = 1e-6;
+// rays grazing the room surfaces are still tested
+constexpr double   PARALLEL_EPSILON        = 1e-12;
+
+size_t chunk_count_of(size_t count, size_t chunk_size)
+{ return std::max<size_t>((count + chunk_size - 1) / chunk_size, 1); }
+
+// calls func(chunk index, begin, end) for each chunk, on the jobs if jobs isn't nullptr
+template <typename Func>
+void for_each_chunk(size_t count, size_t chunk_size, utils::job_system* jobs, Func&& func)
+{
+  auto chunk_range = [&func, count, chunk_size](size_t first, size_t last) {
+    for (size_t c = first; c < last; c++)
+      func(c, std::min(c * chunk_size, count), std::min((c + 1) * chunk_size, count));
+  };
+  const auto chunk_count = chunk_count_of(count, chunk_size);
+  if (jobs == nullptr)
+    chunk_range(0, chunk_count);
+  else
+    jobs->parallel_for(0, chunk_count, 1, chunk_range, "acoustic_ray_tracer");
+}
+
+// every ray has its own generator, so the paths don't depend on the chunks
+uint64_t split_mix(uint64_t& state)
+{
+  uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+double uniform(uint64_t& state)
+{ return static_cast<double>(split_mix(state) >> 11) * (1.0 / 9007199254740992.0); }
+
+// evenly spread directions
+vec3d fibonacci_direction(uint32_t index, uint32_t count)
+{
+  const double golden_angle = M_PI * (3.0 - std::sqrt(5.0));
+  const double y = 1.0 - 2.0 * (index + 0.5) / count;
+  const double r = std::sqrt(std::max(1.0 - y * y, 0.0));
+  const double phi = golden_angle * index;
+  return { r * std::cos(phi), y, r * std::sin(phi) };
+}
+
+vec3d cosine_direction(const vec3d& normal, uint64_t& state)
+{
+  const double u = uniform(state), v = uniform(state);
+  const double r = std::sqrt(u), phi = 2.0 * M_PI * v;
+  const vec3d tangent   = (std::abs(normal.x()) < 0.9 ? vec3d::UnitX() : vec3d::UnitY()).cross(normal).normalized();
+  const vec3d bitangent = normal.cross(tangent);
+  return (r * std::cos(phi) * tangent + r * std::sin(phi) * bitangent + std::sqrt(1.0 - u) * normal).normalized();
+}
+
+bool test_ray_aabb(const Eigen::Vector3f& origin, const Eigen::Vector3f& inv_direction, float max_distance,
+  const Eigen::Vector3f& min, const Eigen::Vector3f& max)
+{
+  float t_min = 0.f, t_max = max_distance;
+  for (int i = 0; i < 3; i++) {
+    float t0 = (min[i] - origin[i]) * inv_direction[i];
+    float t1 = (max[i] - origin[i]) * inv_direction[i];
+    if (t0 > t1) std::swap(t0, t1);
+    t_min = std::max(t_min, t0);
+    t_max = std::min(t_max, t1);
+  }
+  return t_min <= t_max;
+}
+
+} // anonymous namespace
+
+acoustic_ray_tracer::acoustic_ray_tracer()
+{
+  materials_.emplace_back();
+}
+
+acoustic_material_id acoustic_ray_tracer::add_material(const acoustic_material& material)
+{
+  materials_.push_back(material);
+  return static_cast<acoustic_material_id>(materials_.size() - 1);
+}
+
+acoustic_ray_tracer* acoustic_ray_tracer::add_obstacle(const geometry::mesh_model& mesh, acoustic_material_id material)
+{
+  std::vector<float> positions;
+  std::vector<uint32_t> indices;
+  positions.reserve(mesh.get_face_count() * 9);
+  for (const auto& kv : mesh.get_face_map()) {
+    auto he = kv.second->half_edge_;
+    for (int k = 0; k < 3; k++) {
+      const auto& p = he->get_vertex()->position_;
+      indices.push_back(static_cast<uint32_t>(positions.size() / 3));
+      positions.insert(positions.end(), { float(p.x()), float(p.y()), float(p.z()) });
+      he = he->get_next();
+    }
+  }
+  return add_obstacle(geometry::position_span{ positions, 3 }, indices, material);
+}
+
+acoustic_ray_tracer* acoustic_ray_tracer::add_obstacle(
+  const geometry::position_span& positions,
+  const std::vector<uint32_t>& indices,
+  acoustic_material_id material)
+{
+  if (material >= materials_.size())
+    throw std::runtime_error("acoustic_ray_tracer : unknown material");
+
+  auto to_vec3d = [&](uint32_t id) {
+    auto p = positions[id];
+    return vec3d(p[0], p[1], p[2]);
+  };
+  for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+    triangles_.push_back({ to_vec3d(indices[i]), to_vec3d(indices[i + 1]), to_vec3d(indices[i + 2]) });
+    triangle_material_.push_back(material);
+  }
+  is_bvh_dirty_ = true;
+  mark_sources_dirty();
+  return this;
+}
+
+void acoustic_ray_tracer::clear_obstacles()
+{
+  triangles_.clear();
+  triangle_material_.clear();
+  nodes_.clear();
+  is_bvh_dirty_ = true;
+  mark_sources_dirty();
+}
+
+acoustic_source_id acoustic_ray_tracer::add_source(const vec3d& position)
+{
+  source s;
+  s.position = position;
+  s.paths.resize(receivers_.size());
+  sources_.emplace_back(std::move(s));
+  return static_cast<acoustic_source_id>(sources_.size() - 1);
+}
+
+acoustic_receiver_id acoustic_ray_tracer::add_receiver(const vec3d& position, double radius)
+{
+  if (radius <= 0.0)
+    throw std::runtime_error("acoustic_ray_tracer : the receiver radius should be positive");
+  receivers_.push_back({ position, radius, true });
+  for (auto& s : sources_)
+    s.paths.emplace_back();
+  return static_cast<acoustic_receiver_id>(receivers_.size() - 1);
+}
+
+void acoustic_ray_tracer::set_source_position(acoustic_source_id id, const vec3d& position)
+{
+  sources_[id].position = position;
+  sources_[id].is_dirty = true;
+}
+
+void acoustic_ray_tracer::set_receiver_position(acoustic_receiver_id id, const vec3d& position)
+{
+  receivers_[id].position = position;
+  receivers_[id].is_dirty = true;
+}
+
+acoustic_ray_tracer* acoustic_ray_tracer::set_ray_count(uint32_t count)
+{ ray_count_ = std::max(count, 1u); mark_sources_dirty(); return this; }
+
+acoustic_ray_tracer* acoustic_ray_tracer::set_max_order(uint32_t order)
+{ max_order_ = order; mark_sources_dirty(); return this; }
+
+acoustic_ray_tracer* acoustic_ray_tracer::set_max_time(double seconds)
+{ max_time_ = seconds; mark_sources_dirty(); return this; }
+
+acoustic_ray_tracer* acoustic_ray_tracer::set_bin_width(double seconds)
+{
+  if (seconds <= 0.0)
+    throw std::runtime_error("acoustic_ray_tracer : the bin width should be positive");
+  bin_width_ = seconds;
+  mark_sources_dirty();
+  return this;
+}
+
+acoustic_ray_tracer* acoustic_ray_tracer::set_sound_speed(double speed)
+{ sound_speed_ = speed; mark_sources_dirty(); return this; }
+
+acoustic_ray_tracer* acoustic_ray_tracer::set_seed(uint64_t seed)
+{ seed_ = seed; mark_sources_dirty(); return this; }
+
+void acoustic_ray_tracer::mark_sources_dirty()
+{
+  for (auto& s : sources_)
+    s.is_dirty = true;
+}
+
+size_t acoustic_ray_tracer::get_segment_count() const
+{
+  size_t res = 0;
+  for (const auto& s : sources_)
+    res += s.segments.size();
+  return res;
+}
+
+// ------------------------------- bvh
+void acoustic_ray_tracer::build_bvh()
+{
+  nodes_.clear();
+  is_bvh_dirty_ = false;
+  if (triangles_.empty()) return;
+
+  const auto count = static_cast<uint32_t>(triangles_.size());
+  std::vector<uint32_t> order(count);
+  std::vector<Eigen::Vector3f> centroids(count);
+  for (uint32_t i = 0; i < count; i++) {
+    order[i] = i;
+    const auto& t = triangles_[i];
+    centroids[i] = ((t.v0 + t.v1 + t.v2) / 3.0).cast<float>();
+  }
+  nodes_.reserve(2 * count / MAX_LEAF_TRIANGLES + 1);
+  build_node(0, count, order, centroids);
+
+  // leaves own contiguous triangles
+  std::vector<triangle> triangles(count);
+  std::vector<acoustic_material_id> materials(count);
+  for (uint32_t i = 0; i < count; i++) {
+    triangles[i] = triangles_[order[i]];
+    materials[i] = triangle_material_[order[i]];
+  }
+  triangles_ = std::move(triangles);
+  triangle_material_ = std::move(materials);
+}
+
+uint32_t acoustic_ray_tracer::build_node(
+  uint32_t first,
+  uint32_t count,
+  std::vector<uint32_t>& order,
+  const std::vector<Eigen::Vector3f>& centroids)
+{
+  const auto index = static_cast<uint32_t>(nodes_.size());
+  nodes_.emplace_back();
+
+  Eigen::Vector3f min = Eigen::Vector3f::Constant(std::numeric_limits<float>::max());
+  Eigen::Vector3f max = -min;
+  Eigen::Vector3f centroid_min = min, centroid_max = max;
+  for (uint32_t i = first; i < first + count; i++) {
+    const auto& t = triangles_[order[i]];
+    for (const auto* v : { &t.v0, &t.v1, &t.v2 }) {
+      min = min.cwiseMin(v->cast<float>());
+      max = max.cwiseMax(v->cast<float>());
+    }
+    centroid_min = centroid_min.cwiseMin(centroids[order[i]]);
+    centroid_max = centroid_max.cwiseMax(centroids[order[i]]);
+  }
+  // the float box should not cut the double triangles
+  const Eigen::Vector3f padding = Eigen::Vector3f::Constant(1e-4f) + 1e-6f * (max - min);
+  nodes_[index].min = min - padding;
+  nodes_[index].max = max + padding;
+
+  if (count <= MAX_LEAF_TRIANGLES) {
+    nodes_[index].first = first;
+    nodes_[index].count = count;
+    return index;
+  }
+
+  // median split along the longest axis of the centroids
+  int axis;
+  (centroid_max - centroid_min).maxCoeff(&axis);
+  const uint32_t middle = first + count / 2;
+  std::nth_element(order.begin() + first, order.begin() + middle, order.begin() + first + count,
+    [&](uint32_t a, uint32_t b) { return centroids[a][axis] < centroids[b][axis]; });
+
+  build_node(first, middle - first, order, centroids);
+  const auto right = build_node(middle, first + count - middle, order, centroids);
+  nodes_[index].first = right;
+  return index;
+}
+
+bool acoustic_ray_tracer::intersect(const vec3d& origin, const vec3d& direction, double max_distance, hit& result) const
+{
+  if (nodes_.empty()) return false;
+
+  const Eigen::Vector3f origin_f = origin.cast<float>();
+  const Eigen::Vector3f inv_direction = direction.cast<float>().cwiseInverse();
+  const geometry::ray r = { origin, direction };
+
+  bool is_hit = false;
+  std::array<uint32_t, MAX_BVH_DEPTH> stack;
+  uint32_t stack_size = 0;
+  stack[stack_size++] = 0;
+  while (stack_size > 0) {
+    const auto& node = nodes_[stack[--stack_size]];
+    if (!test_ray_aabb(origin_f, inv_direction, static_cast<float>(max_distance), node.min, node.max))
+      continue;
+
+    if (node.count == 0) {
+      const auto self = static_cast<uint32_t>(&node - nodes_.data());
+      stack[stack_size++] = node.first;
+      stack[stack_size++] = self + 1;
+      continue;
+    }
+    for (uint32_t i = node.first; i < node.first + node.count; i++) {
+      const auto& t = triangles_[i];
+      const auto distance = geometry::intersection::test_ray_triangle(r, t.v0, t.v1, t.v2, PARALLEL_EPSILON);
+      if (distance > SURFACE_OFFSET && distance < max_distance) {
+        max_distance = distance;
+        result = { distance, i };
+        is_hit = true;
+      }
+    }
+  }
+  return is_hit;
+}
+
+double acoustic_ray_tracer::cast_ray(const vec3d& origin, const vec3d& direction)
+{
+  if (is_bvh_dirty_) build_bvh();
+  hit h;
+  return intersect(origin, direction, std::numeric_limits<double>::max(), h) ? h.distance : 0.0;
+}
+
+// ------------------------------- tracing
+void acoustic_ray_tracer::trace()
+{
+  if (is_bvh_dirty_) build_bvh();
+
+  for (auto& s : sources_)
+    if (s.is_dirty)
+      trace_source(s);
+
+  // a moved receiver re-collects the cached segments of every source
+  for (auto& s : sources_)
+    for (size_t i = 0; i < receivers_.size(); i++)
+      if (s.is_dirty || receivers_[i].is_dirty)
+        collect(s, receivers_[i], s.paths[i]);
+
+  for (auto& s : sources_)   s.is_dirty = false;
+  for (auto& r : receivers_) r.is_dirty = false;
+}
+
+void acoustic_ray_tracer::trace_source(source& s)
+{
+  const double max_distance = max_time_ * sound_speed_;
+  std::vector<std::vector<segment>> chunk_segments(chunk_count_of(ray_count_, RAYS_PER_CHUNK));
+
+  for_each_chunk(ray_count_, RAYS_PER_CHUNK, jobs_, [&](size_t chunk, size_t begin, size_t end) {
+    auto& segments = chunk_segments[chunk];
+    for (auto i = static_cast<uint32_t>(begin); i < end; i++) {
+      uint64_t state = seed_ ^ (0x2545f4914f6cdd1dull * (i + 1));
+      vec3d origin = s.position;
+      vec3d direction = fibonacci_direction(i, ray_count_);
+      double distance = 0.0, energy = 1.0;
+
+      for (uint32_t order = 0; order <= max_order_; order++) {
+        hit h;
+        const bool is_hit = intersect(origin, direction, max_distance - distance, h);
+        const double length = is_hit ? h.distance : max_distance - distance;
+        // the direct sound is the shadow ray of collect()
+        if (order > 0)
+          segments.push_back({
+            origin.cast<float>(), direction.cast<float>(),
+            static_cast<float>(distance), static_cast<float>(length), static_cast<float>(energy) });
+        if (!is_hit) break;
+
+        const auto& material = materials_[triangle_material_[h.triangle]];
+        energy *= 1.0 - material.absorption;
+        distance += h.distance;
+        if (energy < MIN_RAY_ENERGY) break;
+
+        const auto& t = triangles_[h.triangle];
+        vec3d normal = (t.v1 - t.v0).cross(t.v2 - t.v0).normalized();
+        if (normal.dot(direction) > 0.0) normal = -normal;
+        origin += h.distance * direction + SURFACE_OFFSET * normal;
+        direction = uniform(state) < material.scattering
+          ? cosine_direction(normal, state)
+          : vec3d(direction - 2.0 * direction.dot(normal) * normal);
+      }
+    }
+  });
+
+  s.segments.clear();
+  size_t total = 0;
+  for (const auto& segments : chunk_segments) total += segments.size();
+  s.segments.reserve(total);
+  for (const auto& segments : chunk_segments)
+    s.segments.insert(s.segments.end(), segments.begin(), segments.end());
+}
+
+void acoustic_ray_tracer::collect(const source& s, const receiver& r, path& p) const
+{
+  const auto bin_count = get_bin_count();
+  p.histogram.assign(bin_count, 0.0);
+
+  // direct sound, unless a triangle is in between
+  const vec3d to_receiver = r.position - s.position;
+  const double distance = to_receiver.norm();
+  hit h;
+  const bool is_occluded = distance > 0.0 && intersect(s.position, to_receiver / distance, distance, h);
+  p.direct_energy = is_occluded ? 0.0 : 1.0 / std::pow(std::max(distance, r.radius), 2);
+  p.direct_delay  = distance / sound_speed_;
+
+  // a ray of energy e crossing the sphere along a chord of length l contributes 4 pi e l / (n v) :
+  // n rays of a point source give 1 / d^2 at a distance d on average
+  const double volume = 4.0 / 3.0 * M_PI * std::pow(r.radius, 3);
+  const double scale = 4.0 * M_PI / (ray_count_ * volume);
+  const Eigen::Vector3f center = r.position.cast<float>();
+  const auto radius2 = static_cast<float>(r.radius * r.radius);
+  const auto inv_bin = static_cast<float>(1.0 / (sound_speed_ * bin_width_));
+
+  const auto chunk_count = chunk_count_of(s.segments.size(), SEGMENTS_PER_CHUNK);
+  std::vector<std::vector<double>> histograms(chunk_count, std::vector<double>(bin_count, 0.0));
+  for_each_chunk(s.segments.size(), SEGMENTS_PER_CHUNK, jobs_, [&](size_t chunk, size_t begin, size_t end) {
+    auto& histogram = histograms[chunk];
+    for (size_t i = begin; i < end; i++) {
+      const auto& seg = s.segments[i];
+      const Eigen::Vector3f to_center = center - seg.origin;
+      const float t_center = to_center.dot(seg.direction);
+      const float distance2 = to_center.squaredNorm() - t_center * t_center;
+      if (distance2 >= radius2) continue;
+      const float half = std::sqrt(radius2 - distance2);
+      const float t0 = std::max(t_center - half, 0.f);
+      const float t1 = std::min(t_center + half, seg.length);
+      if (t1 <= t0) continue;
+
+      const auto bin = static_cast<size_t>((seg.distance + 0.5f * (t0 + t1)) * inv_bin);
+      if (bin < bin_count)
+        histogram[bin] += seg.energy * (t1 - t0);
+    }
+  });
+
+  for (const auto& histogram : histograms)
+    for (size_t i = 0; i < bin_count; i++)
+      p.histogram[i] += scale * histogram[i];
+}
+
+std::vector<float> acoustic_ray_tracer::create_impulse_response(
+  acoustic_source_id source_id,
+  acoustic_receiver_id receiver_id,
+  double sampling_rate,
+  uint32_t seed) const
+{
+  const auto& p = sources_[source_id].paths[receiver_id];
+  const double samples_per_bin = bin_width_ * sampling_rate;
+  if (samples_per_bin < 1.0)
+    throw std::runtime_error("acoustic_ray_tracer : a bin should be longer than a sample");
+
+  // the histogram is the envelope of random signs : each bin keeps its energy
+  std::vector<float> res(static_cast<size_t>(p.histogram.size() * samples_per_bin) + 1, 0.f);
+  std::mt19937 engine(seed);
+  std::bernoulli_distribution sign;
+  for (size_t bin = 0; bin < p.histogram.size(); bin++) {
+    const auto begin = static_cast<size_t>(std::round(bin * samples_per_bin));
+    const auto end   = std::min(static_cast<size_t>(std::round((bin + 1) * samples_per_bin)), res.size());
+    if (end <= begin) continue;
+    const auto amplitude = static_cast<float>(std::sqrt(p.histogram[bin] / double(end - begin)));
+    for (size_t i = begin; i < end; i++)
+      res[i] = sign(engine) ? amplitude : -amplitude;
+  }
+
+  const auto direct = static_cast<size_t>(std::round(p.direct_delay * sampling_rate));
+  if (direct < res.size())
+    res[direct] += static_cast<float>(std::sqrt(p.direct_energy));
+  return res;
+}
+
+} // namespace hnll::physics
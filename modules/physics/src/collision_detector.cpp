@@ -4,14 +4,27 @@
 #include <game/components/rigid_component.hpp>
 #include <geometry/bounding_volume.hpp>
 #include <geometry/intersection.hpp>
+#include <geometry/gjk.hpp>
+#include <physics/contact_manager.hpp>
+#include <physics/rigid_body.hpp>
 
 namespace hnll::physics {
 
 std::vector<s_ptr<game::rigid_component>> collision_detector::rigid_components_ = {};
+struct collision_detector::cached_pair
+{
+  geometry::gjk_cache cache;
+  uint64_t last_step = 0;
+};
+
+std::unordered_map<uint64_t, collision_detector::cached_pair> collision_detector::gjk_caches_ = {};
+uint64_t collision_detector::step_count_ = 0;
+uint64_t collision_detector::version_ = 0;
 
-std::vector<collision_info> collision_detector::intersection_test()
+std::vector<collision_info> collision_detector::intersection_test(contact_manager* contacts)
 {
   std::vector<collision_info> res;
+  step_count_++;
 
   int rc_count = rigid_components_.size();
 
@@ -22,18 +35,57 @@ std::vector<collision_info> collision_detector::intersection_test()
       auto& b = rigid_components_[j];
       // skip if the owners are the same
       if (a->get_id() == b->get_id()) continue;
-      if (auto depth = geometry::intersection::test_bounding_volumes(a->get_bounding_volume(), b->get_bounding_volume()); depth) {
-        // create collision_info
-        collision_info info;
-        info.intersection_depth = depth;
-        info.actor_a = a->get_owner_id();
-        info.actor_b = b->get_owner_id();
-        res.emplace_back(std::move(info));
+      const auto& bv_a = a->get_bounding_volume();
+      const auto& bv_b = b->get_bounding_volume();
+      auto& body_a = a->get_body();
+      auto& body_b = b->get_body();
+
+      // pairs with a dynamic body are handed to the contact solver
+      const bool simulated = contacts && (body_a.is_dynamic() || body_b.is_dynamic());
+      // nothing moves, so the manifold of the last frame is still valid
+      if (simulated && !body_a.is_awake() && !body_b.is_awake() && !body_a.is_kinematic() && !body_b.is_kinematic())
+        continue;
+
+      geometry::contact contact;
+      double depth;
+      // compound colliders descend their sphere trees
+      if (bv_a.is_sphere_tree() || bv_b.is_sphere_tree())
+        depth = geometry::intersection::test_sphere_tree(bv_a, bv_b, &contact);
+      // convex colliders and the simulated pairs go through gjk / epa with the cache of the previous frame
+      else if (simulated || bv_a.is_convex_hull() || bv_b.is_convex_hull()) {
+        auto key = (static_cast<uint64_t>(a->get_id()) << 32) | b->get_id();
+        auto& cached = gjk_caches_[key];
+        cached.last_step = step_count_;
+        depth = geometry::intersection::test_convex_convex(bv_a, bv_b, &cached.cache, &contact);
       }
+      else
+        depth = geometry::intersection::test_bounding_volumes(bv_a, bv_b);
+
+      if (!depth) continue;
+
+      if (simulated)
+        contacts->update_manifold(body_a, body_b, geometry::intersection::create_contact_manifold(bv_a, bv_b, contact));
+
+      // create collision_info
+      collision_info info;
+      info.intersection_depth = depth;
+      info.actor_a = a->get_owner_handle();
+      info.actor_b = b->get_owner_handle();
+      info.normal = contact.normal;
+      info.contact_point = (contact.point_a + contact.point_b) * 0.5;
+      res.emplace_back(std::move(info));
     }
   }
 
+  // the sleeping pairs are evicted too, and start from scratch when they wake up
+  std::erase_if(gjk_caches_, [](const auto& pair) { return pair.second.last_step != step_count_; });
   return res;
 }
 
+void collision_detector::remove_rigid_components(game::actor_id owner)
+{
+  if (std::erase_if(rigid_components_, [owner](const auto& rc) { return rc->get_owner_id() == owner; }) > 0)
+    version_++;
+}
+
 } // namespace hnll::physics
\ No newline at end of file
@@ -0,0 +1,84 @@
+// hnll
+#include <physics/contact_manager.hpp>
+#include <physics/rigid_body.hpp>
+#include <geometry/gjk.hpp>
+
+// std
+#include <algorithm>
+#include <cmath>
+
+namespace hnll::physics {
+
+void contact_manager::update_manifold(rigid_body& a, rigid_body& b, const std::vector<geometry::contact>& contacts)
+{
+  if (contacts.empty()) return;
+
+  // manifolds are stored in the order of the ids
+  const bool swapped = a.id > b.id;
+  auto& body_a = swapped ? b : a;
+  auto& body_b = swapped ? a : b;
+
+  auto [it, inserted] = manifolds_.try_emplace(pair_key(a.id, b.id));
+  auto& manifold = it->second;
+  if (inserted) {
+    manifold.body_a = &body_a;
+    manifold.body_b = &body_b;
+    manifold.friction    = std::sqrt(body_a.friction * body_b.friction);
+    manifold.restitution = std::min(body_a.restitution, body_b.restitution);
+    // a new touch wakes the sleeping bodies up
+    if (body_a.is_dynamic()) body_a.wake_up();
+    if (body_b.is_dynamic()) body_b.wake_up();
+  }
+  manifold.last_frame = frame_;
+
+  const auto inv_rotation_a = body_a.orientation.conjugate();
+  const auto inv_rotation_b = body_b.orientation.conjugate();
+  const double match_distance2 = match_distance_ * match_distance_;
+
+  std::array<manifold_point, 4> new_points;
+  const int count = static_cast<int>(std::min(contacts.size(), new_points.size()));
+  for (int i = 0; i < count; i++) {
+    const auto& c = contacts[i];
+    auto& p = new_points[i];
+    p.normal  = swapped ? vec3d(-c.normal) : c.normal;
+    p.point_a = swapped ? c.point_b : c.point_a;
+    p.point_b = swapped ? c.point_a : c.point_b;
+    p.depth   = c.depth;
+    p.local_a = inv_rotation_a * (p.point_a - body_a.position);
+    p.local_b = inv_rotation_b * (p.point_b - body_b.position);
+
+    // inherit the impulses of the closest old point
+    double best = match_distance2;
+    for (int j = 0; j < manifold.point_count; j++) {
+      const auto& old = manifold.points[j];
+      const double d2 = std::min((old.local_a - p.local_a).squaredNorm(), (old.local_b - p.local_b).squaredNorm());
+      if (d2 < best) {
+        best = d2;
+        p.normal_impulse  = old.normal_impulse;
+        p.tangent_impulse = old.tangent_impulse;
+      }
+    }
+  }
+  manifold.points      = new_points;
+  manifold.point_count = count;
+}
+
+void contact_manager::end_frame()
+{
+  std::erase_if(manifolds_, [this](const auto& kv) {
+    const auto& m = kv.second;
+    if (m.last_frame == frame_) return false;
+    // neither body moves, so the contact is still valid
+    const bool frozen = !m.body_a->is_awake() && !m.body_b->is_awake() && !m.body_a->is_kinematic() && !m.body_b->is_kinematic();
+    return !frozen;
+  });
+}
+
+void contact_manager::remove_body(uint32_t id)
+{
+  std::erase_if(manifolds_, [id](const auto& kv) {
+    return kv.second.body_a->id == id || kv.second.body_b->id == id;
+  });
+}
+
+} // namespace hnll::physics
@@ -0,0 +1,236 @@
+// hnll
+#include <physics/contact_solver.hpp>
+#include <physics/contact_manager.hpp>
+#include <physics/rigid_body.hpp>
+#include <utils/job_system.hpp>
+
+// std
+#include <algorithm>
+#include <array>
+#include <limits>
+
+namespace hnll::physics {
+
+namespace {
+
+// islands are solved on the calling thread if the whole scene has fewer contacts than this
+constexpr size_t MIN_CONTACTS_FOR_JOBS = 64;
+
+// velocity of a body during the solve
+struct velocity_state
+{
+  vec3d  linear;
+  vec3d  angular;
+  double inv_mass;
+  Eigen::Matrix3d inv_inertia;
+};
+
+// tangents of the friction, deterministic for the same normal so that the impulses can be warm started
+std::array<vec3d, 2> tangent_basis(const vec3d& normal)
+{
+  vec3d t0 = (std::abs(normal.x()) < 0.57 ? vec3d::UnitX() : vec3d::UnitY()).cross(normal).normalized();
+  return { t0, normal.cross(t0) };
+}
+
+inline vec3d relative_velocity(const velocity_state& a, const velocity_state& b, const manifold_point& p)
+{ return b.linear + b.angular.cross(p.r_b) - a.linear - a.angular.cross(p.r_a); }
+
+// impulse is applied to b, and its reaction to a
+inline void apply_impulse(velocity_state& a, velocity_state& b, const manifold_point& p, const vec3d& impulse)
+{
+  a.linear  -= a.inv_mass * impulse;
+  a.angular -= a.inv_inertia * p.r_a.cross(impulse);
+  b.linear  += b.inv_mass * impulse;
+  b.angular += b.inv_inertia * p.r_b.cross(impulse);
+}
+
+inline double effective_mass(const velocity_state& a, const velocity_state& b, const manifold_point& p, const vec3d& dir)
+{
+  const vec3d ra_n = p.r_a.cross(dir), rb_n = p.r_b.cross(dir);
+  const double k = a.inv_mass + b.inv_mass + ra_n.dot(a.inv_inertia * ra_n) + rb_n.dot(b.inv_inertia * rb_n);
+  return k > 0.0 ? 1.0 / k : 0.0;
+}
+
+} // anonymous namespace
+
+void contact_solver::step(const std::vector<rigid_body*>& bodies, contact_manager& contacts, double dt, utils::job_system* jobs)
+{
+  if (dt <= 0.0) return;
+
+  build_islands(bodies, contacts);
+
+  // large islands first for the load balance
+  std::sort(islands_.begin(), islands_.end(), [](const island& a, const island& b) {
+    return a.bodies.size() + a.manifolds.size() > b.bodies.size() + b.manifolds.size();
+  });
+
+  size_t contact_count = 0;
+  for (const auto& isl : islands_)
+    contact_count += isl.manifolds.size();
+
+  if (jobs == nullptr || islands_.size() < 2 || contact_count < MIN_CONTACTS_FOR_JOBS) {
+    for (auto& isl : islands_)
+      solve_island(isl, dt);
+    return;
+  }
+
+  // one island per job, since the sorted islands vary much in size
+  jobs->parallel_for(0, islands_.size(), 1, [this, dt](size_t begin, size_t end) {
+    for (auto i = begin; i < end; i++)
+      solve_island(islands_[i], dt);
+  }, "contact_solver");
+}
+
+void contact_solver::build_islands(const std::vector<rigid_body*>& bodies, contact_manager& contacts)
+{
+  islands_.clear();
+
+  for (int i = 0; i < static_cast<int>(bodies.size()); i++)
+    bodies[i]->solver_index = i;
+  auto is_listed = [&bodies](const rigid_body* body) {
+    return body->solver_index >= 0 && body->solver_index < static_cast<int>(bodies.size()) && bodies[body->solver_index] == body;
+  };
+
+  // contact graph between the dynamic bodies
+  std::vector<std::vector<contact_manifold*>> edges(bodies.size());
+  for (auto& kv : contacts.get_manifolds()) {
+    auto& m = kv.second;
+    m.island = -1;
+    if (m.point_count == 0) continue;
+    for (auto* body : { m.body_a, m.body_b })
+      if (body->is_dynamic() && is_listed(body))
+        edges[body->solver_index].push_back(&m);
+    // moving kinematic bodies push the sleeping bodies
+    if (m.body_a->is_kinematic() && !m.body_a->linear_velocity.isZero() && m.body_b->is_sleeping) m.body_b->wake_up();
+    if (m.body_b->is_kinematic() && !m.body_b->linear_velocity.isZero() && m.body_a->is_sleeping) m.body_a->wake_up();
+  }
+
+  // depth first search from each awake body. the sleeping bodies it reaches are woken up
+  std::vector<bool> visited(bodies.size(), false);
+  std::vector<rigid_body*> stack;
+  for (auto* seed : bodies) {
+    if (!seed->is_awake() || visited[seed->solver_index]) continue;
+
+    island isl;
+    visited[seed->solver_index] = true;
+    stack.push_back(seed);
+    while (!stack.empty()) {
+      auto* body = stack.back();
+      stack.pop_back();
+      if (body->is_sleeping) body->wake_up();
+      isl.bodies.push_back(body);
+
+      for (auto* m : edges[body->solver_index]) {
+        auto* other = m->body_a == body ? m->body_b : m->body_a;
+        if (m->island >= 0 || (other->is_dynamic() && !is_listed(other))) continue;
+        m->island = static_cast<int>(islands_.size());
+        isl.manifolds.push_back(m);
+
+        // static and kinematic bodies don't connect islands
+        if (!other->is_dynamic() || visited[other->solver_index]) continue;
+        visited[other->solver_index] = true;
+        stack.push_back(other);
+      }
+    }
+    islands_.emplace_back(std::move(isl));
+  }
+}
+
+void contact_solver::solve_island(island& isl, double dt) const
+{
+  // island bodies come first, static and kinematic bodies are appended for each contact
+  std::vector<velocity_state> states;
+  states.reserve(isl.bodies.size() + isl.manifolds.size());
+  for (int i = 0; i < static_cast<int>(isl.bodies.size()); i++) {
+    auto* body = isl.bodies[i];
+    body->solver_index = i;
+    vec3d v = (body->linear_velocity + settings_.gravity * dt) / (1.0 + dt * body->linear_damping);
+    vec3d w = body->angular_velocity / (1.0 + dt * body->angular_damping);
+    states.push_back({ v, w, body->inv_mass, body->get_inv_inertia_world() });
+  }
+  auto state_index = [&](const rigid_body* body) {
+    if (body->is_dynamic()) return body->solver_index;
+    states.push_back({ body->linear_velocity, vec3d::Zero(), 0.0, Eigen::Matrix3d::Zero() });
+    return static_cast<int>(states.size()) - 1;
+  };
+  std::vector<std::pair<int, int>> pairs;
+  pairs.reserve(isl.manifolds.size());
+  for (auto* m : isl.manifolds)
+    pairs.emplace_back(state_index(m->body_a), state_index(m->body_b));
+
+  // prepare the constraints and apply the impulses of the last frame
+  for (size_t k = 0; k < isl.manifolds.size(); k++) {
+    auto* m = isl.manifolds[k];
+    auto& a = states[pairs[k].first];
+    auto& b = states[pairs[k].second];
+    for (int i = 0; i < m->point_count; i++) {
+      auto& p = m->points[i];
+      const vec3d mid = (p.point_a + p.point_b) * 0.5;
+      p.r_a = mid - m->body_a->position;
+      p.r_b = mid - m->body_b->position;
+      p.tangents = tangent_basis(p.normal);
+      p.normal_mass = effective_mass(a, b, p, p.normal);
+      p.tangent_mass = { effective_mass(a, b, p, p.tangents[0]), effective_mass(a, b, p, p.tangents[1]) };
+
+      const double vn = relative_velocity(a, b, p).dot(p.normal);
+      p.velocity_bias = settings_.baumgarte / dt * std::max(p.depth - settings_.linear_slop, 0.0);
+      if (vn < -settings_.restitution_threshold)
+        p.velocity_bias = std::max(p.velocity_bias, -m->restitution * vn);
+
+      apply_impulse(a, b, p, p.normal * p.normal_impulse + p.tangents[0] * p.tangent_impulse[0] + p.tangents[1] * p.tangent_impulse[1]);
+    }
+  }
+
+  for (int iteration = 0; iteration < settings_.velocity_iterations; iteration++) {
+    for (size_t k = 0; k < isl.manifolds.size(); k++) {
+      auto* m = isl.manifolds[k];
+      auto& a = states[pairs[k].first];
+      auto& b = states[pairs[k].second];
+      for (int i = 0; i < m->point_count; i++) {
+        auto& p = m->points[i];
+
+        // friction is bounded by the current normal impulse
+        const double max_friction = m->friction * p.normal_impulse;
+        for (int t = 0; t < 2; t++) {
+          const double vt = relative_velocity(a, b, p).dot(p.tangents[t]);
+          const double old_impulse = p.tangent_impulse[t];
+          p.tangent_impulse[t] = std::clamp(old_impulse - p.tangent_mass[t] * vt, -max_friction, max_friction);
+          apply_impulse(a, b, p, p.tangents[t] * (p.tangent_impulse[t] - old_impulse));
+        }
+
+        // non-penetration
+        const double vn = relative_velocity(a, b, p).dot(p.normal);
+        const double old_impulse = p.normal_impulse;
+        p.normal_impulse = std::max(old_impulse + p.normal_mass * (p.velocity_bias - vn), 0.0);
+        apply_impulse(a, b, p, p.normal * (p.normal_impulse - old_impulse));
+      }
+    }
+  }
+
+  // integrate the positions and check if the island can sleep
+  double min_sleep_time = std::numeric_limits<double>::max();
+  const double linear_tolerance2  = settings_.linear_sleep_tolerance * settings_.linear_sleep_tolerance;
+  const double angular_tolerance2 = settings_.angular_sleep_tolerance * settings_.angular_sleep_tolerance;
+  for (size_t i = 0; i < isl.bodies.size(); i++) {
+    auto* body = isl.bodies[i];
+    const auto& state = states[i];
+    body->linear_velocity  = state.linear;
+    body->angular_velocity = state.angular;
+    body->position += state.linear * dt;
+    const Eigen::Quaterniond spin(0.0, state.angular.x() * dt * 0.5, state.angular.y() * dt * 0.5, state.angular.z() * dt * 0.5);
+    body->orientation.coeffs() += (spin * body->orientation).coeffs();
+    body->orientation.normalize();
+
+    if (state.linear.squaredNorm() > linear_tolerance2 || state.angular.squaredNorm() > angular_tolerance2)
+      body->sleep_time = 0.0;
+    else
+      body->sleep_time += dt;
+    min_sleep_time = std::min(min_sleep_time, body->sleep_time);
+  }
+
+  if (min_sleep_time >= settings_.time_to_sleep)
+    for (auto* body : isl.bodies)
+      body->sleep();
+}
+
+} // namespace hnll::physics
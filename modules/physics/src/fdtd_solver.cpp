@@ -1,18 +1,122 @@
+// hnll
 #include <physics/fdtd_solver.hpp>
+#include <geometry/bounding_volume.hpp>
+#include <geometry/mesh_model.hpp>
+#include <utils/job_system.hpp>
+
+// std
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <immintrin.h>
+#define HNLL_FDTD_USE_SSE
+#endif
 
 namespace hnll::physics {
 
 double VELOCITY_RATIO = 0.95;
 
-void fdtd_solver::solve(std::vector<double> _input, double _duration)
+namespace {
+
+// amplitude of the wave reflected by the pml
+constexpr double PML_REFLECTION   = 1e-3;
+// cells of a y-block, the rows of a block stay in the cache while the block marches along z
+constexpr size_t BLOCK_CELL_COUNT   = 1 << 14;
+constexpr size_t MIN_CELLS_PER_SLAB = 1 << 15;
+
+// one slab per thread of the jobs, unless the slabs would be too thin
+uint32_t decide_slab_count(uint32_t plane_count, size_t cell_count, const utils::job_system* jobs)
+{
+  if (jobs == nullptr)
+    return 1;
+  auto max_count = static_cast<uint32_t>(std::max<size_t>(cell_count / MIN_CELLS_PER_SLAB, 1));
+  return std::max(std::min({ jobs->get_thread_count(), max_count, plane_count }), 1u);
+}
+
+// v[x] = open[x] * open[x + stride] * (a[x] * v[x] - b[x] * (p[x + stride] - p[x]))
+// a and b are per-lane if PER_LANE, otherwise a[0] and b[0] are used for every cell
+template <bool PER_LANE>
+void velocity_row(float* v, const float* p, const float* open, size_t stride, const float* a, const float* b, size_t count)
 {
+  size_t x = 0;
+#ifdef HNLL_FDTD_USE_SSE
+  __m128 va = _mm_set1_ps(a[0]), vb = _mm_set1_ps(b[0]);
+  for (; x + 4 <= count; x += 4) {
+    if constexpr (PER_LANE) { va = _mm_loadu_ps(a + x); vb = _mm_loadu_ps(b + x); }
+    __m128 dp   = _mm_sub_ps(_mm_loadu_ps(p + x + stride), _mm_loadu_ps(p + x));
+    __m128 mask = _mm_mul_ps(_mm_loadu_ps(open + x), _mm_loadu_ps(open + x + stride));
+    __m128 next = _mm_sub_ps(_mm_mul_ps(va, _mm_loadu_ps(v + x)), _mm_mul_ps(vb, dp));
+    _mm_storeu_ps(v + x, _mm_mul_ps(mask, next));
+  }
+#endif
+  for (; x < count; x++) {
+    const float ax = PER_LANE ? a[x] : a[0], bx = PER_LANE ? b[x] : b[0];
+    v[x] = open[x] * open[x + stride] * (ax * v[x] - bx * (p[x + stride] - p[x]));
+  }
+}
 
+// p[x] -= b * divergence
+void pressure_row(float* p, const float* vx, const float* vy, const float* vz, size_t stride_y, size_t stride_z, float b, size_t begin, size_t end)
+{
+  size_t x = begin;
+#ifdef HNLL_FDTD_USE_SSE
+  const __m128 vb = _mm_set1_ps(b);
+  for (; x + 4 <= end; x += 4) {
+    __m128 div = _mm_sub_ps(_mm_loadu_ps(vx + x), _mm_loadu_ps(vx + x - 1));
+    div = _mm_add_ps(div, _mm_sub_ps(_mm_loadu_ps(vy + x), _mm_loadu_ps(vy + x - stride_y)));
+    div = _mm_add_ps(div, _mm_sub_ps(_mm_loadu_ps(vz + x), _mm_loadu_ps(vz + x - stride_z)));
+    _mm_storeu_ps(p + x, _mm_sub_ps(_mm_loadu_ps(p + x), _mm_mul_ps(vb, div)));
+  }
+#endif
+  for (; x < end; x++)
+    p[x] -= b * ((vx[x] - vx[x - 1]) + (vy[x] - vy[x - stride_y]) + (vz[x] - vz[x - stride_z]));
 }
 
+// split-field update of the pml cells : p_k = a_k p_k - b_k d_k v_k, p = p_x + p_y + p_z
+struct split_row
+{
+  float* p; float* px; float* py; float* pz;
+  const float* vx; const float* vy; const float* vz;
+  const float* ax; const float* bx;
+  float ay, by, az, bz;
+};
+
+void pressure_split_row(const split_row& r, size_t stride_y, size_t stride_z, size_t begin, size_t end)
+{
+  size_t x = begin;
+#ifdef HNLL_FDTD_USE_SSE
+  const __m128 vay = _mm_set1_ps(r.ay), vby = _mm_set1_ps(r.by), vaz = _mm_set1_ps(r.az), vbz = _mm_set1_ps(r.bz);
+  for (; x + 4 <= end; x += 4) {
+    __m128 px = _mm_sub_ps(_mm_mul_ps(_mm_loadu_ps(r.ax + x), _mm_loadu_ps(r.px + x)),
+                           _mm_mul_ps(_mm_loadu_ps(r.bx + x), _mm_sub_ps(_mm_loadu_ps(r.vx + x), _mm_loadu_ps(r.vx + x - 1))));
+    __m128 py = _mm_sub_ps(_mm_mul_ps(vay, _mm_loadu_ps(r.py + x)),
+                           _mm_mul_ps(vby, _mm_sub_ps(_mm_loadu_ps(r.vy + x), _mm_loadu_ps(r.vy + x - stride_y))));
+    __m128 pz = _mm_sub_ps(_mm_mul_ps(vaz, _mm_loadu_ps(r.pz + x)),
+                           _mm_mul_ps(vbz, _mm_sub_ps(_mm_loadu_ps(r.vz + x), _mm_loadu_ps(r.vz + x - stride_z))));
+    _mm_storeu_ps(r.px + x, px);
+    _mm_storeu_ps(r.py + x, py);
+    _mm_storeu_ps(r.pz + x, pz);
+    _mm_storeu_ps(r.p + x, _mm_add_ps(px, _mm_add_ps(py, pz)));
+  }
+#endif
+  for (; x < end; x++) {
+    r.px[x] = r.ax[x] * r.px[x] - r.bx[x] * (r.vx[x] - r.vx[x - 1]);
+    r.py[x] = r.ay * r.py[x] - r.by * (r.vy[x] - r.vy[x - stride_y]);
+    r.pz[x] = r.az * r.pz[x] - r.bz * (r.vz[x] - r.vz[x - stride_z]);
+    r.p[x]  = r.px[x] + r.py[x] + r.pz[x];
+  }
+}
+
+} // anonymous namespace
+
+// ------------------------------------------------------------------------------------------
+// setup
+
 fdtd_solver* fdtd_solver::set_max_stable_dx()
 {
   if (phase_velocity_ > 0.f) {
-    dx_ = VELOCITY_RATIO * phase_velocity_ * dt_;
+    dx_ = std::sqrt(3.0) * phase_velocity_ * dt_ / VELOCITY_RATIO;
   }
   return this;
 }
@@ -20,8 +124,292 @@ fdtd_solver* fdtd_solver::set_max_stable_dx()
 fdtd_solver* fdtd_solver::set_min_stable_dt()
 {
   if (phase_velocity_ > 0.f) {
-    dt_ = dx_ / VELOCITY_RATIO / phase_velocity_;
+    dt_ = VELOCITY_RATIO * dx_ / std::sqrt(3.0) / phase_velocity_;
+  }
+  return this;
+}
+
+fdtd_solver* fdtd_solver::set_grid_size(uint32_t x, uint32_t y, uint32_t z)
+{
+  if (x == 0 || y == 0 || z == 0)
+    throw std::runtime_error("fdtd_solver : grid size should be positive");
+  size_x_ = x; size_y_ = y; size_z_ = z;
+  padding_ = static_cast<size_t>(x) * y;
+
+  const auto size = padding_ + get_cell_count();
+  for (auto* field : { &pressure_, &velocity_x_, &velocity_y_, &velocity_z_, &pressure_x_, &pressure_y_, &pressure_z_ })
+    field->assign(size, 0.f);
+  open_.assign(size, 1.f);
+  step_count_ = 0;
+  return this;
+}
+
+void fdtd_solver::reset()
+{
+  for (auto* field : { &pressure_, &velocity_x_, &velocity_y_, &velocity_z_, &pressure_x_, &pressure_y_, &pressure_z_ })
+    std::fill(field->begin(), field->end(), 0.f);
+  step_count_ = 0;
+}
+
+bool fdtd_solver::is_pml_cell(uint32_t x, uint32_t y, uint32_t z) const
+{
+  const auto l = pml_thickness_;
+  return x < l || y < l || z < l || x + l >= size_x_ || y + l >= size_y_ || z + l >= size_z_;
+}
+
+void fdtd_solver::update_pml_coefficients()
+{
+  const double c  = get_phase_velocity();
+  const double l  = pml_thickness_;
+  const double sigma_max = l > 0 ? 3.0 * c * std::log(1.0 / PML_REFLECTION) / (2.0 * l * dx_) : 0.0;
+  const double velocity_coefficient = dt_ / (density_ * dx_);
+  const double pressure_coefficient = density_ * c * c * dt_ / dx_;
+
+  // pos is in cells from the minimum corner of the axis
+  auto fill = [&](std::vector<float>& a, std::vector<float>& b, uint32_t n, double offset, double coefficient) {
+    a.resize(n); b.resize(n);
+    for (uint32_t i = 0; i < n; i++) {
+      const double pos   = i + offset;
+      const double depth = l > 0 ? std::max({ l - pos, pos - (n - l), 0.0 }) / l : 0.0;
+      const double sigma = sigma_max * depth * depth;
+      const double denom = 1.0 + 0.5 * sigma * dt_;
+      a[i] = static_cast<float>((1.0 - 0.5 * sigma * dt_) / denom);
+      b[i] = static_cast<float>(coefficient / denom);
+    }
+  };
+  const std::array<uint32_t, 3> sizes = { size_x_, size_y_, size_z_ };
+  for (int axis = 0; axis < 3; axis++) {
+    // velocity is on the face between cell i and i + 1
+    fill(velocity_a_[axis], velocity_b_[axis], sizes[axis], 1.0, velocity_coefficient);
+    fill(pressure_a_[axis], pressure_b_[axis], sizes[axis], 0.5, pressure_coefficient);
+  }
+}
+
+// ------------------------------------------------------------------------------------------
+// obstacles
+
+fdtd_solver* fdtd_solver::set_obstacle(uint32_t x, uint32_t y, uint32_t z, bool is_obstacle)
+{
+  open_[index(x, y, z)] = is_obstacle ? 0.f : 1.f;
+  return this;
+}
+
+fdtd_solver* fdtd_solver::add_obstacle(const geometry::mesh_model& mesh)
+{
+  std::vector<float> positions;
+  std::vector<uint32_t> indices;
+  positions.reserve(mesh.get_face_count() * 9);
+  for (const auto& kv : mesh.get_face_map()) {
+    auto he = kv.second->half_edge_;
+    for (int k = 0; k < 3; k++) {
+      const auto& p = he->get_vertex()->position_;
+      indices.push_back(static_cast<uint32_t>(positions.size() / 3));
+      positions.insert(positions.end(), { float(p.x()), float(p.y()), float(p.z()) });
+      he = he->get_next();
+    }
+  }
+  return add_obstacle(geometry::position_span{ positions, 3 }, indices);
+}
+
+fdtd_solver* fdtd_solver::add_obstacle(const geometry::position_span& positions, const std::vector<uint32_t>& indices)
+{
+  if (get_cell_count() == 0)
+    throw std::runtime_error("fdtd_solver : set_grid_size() should be called before add_obstacle()");
+
+  const std::array<int, 3> sizes = { int(size_x_), int(size_y_), int(size_z_) };
+  auto to_grid = [&](uint32_t id) {
+    auto p = positions[id];
+    return vec3d((vec3d(p[0], p[1], p[2]) - origin_) / dx_);
+  };
+  auto mark = [&](const vec3d& u) {
+    const int x = int(std::floor(u.x())), y = int(std::floor(u.y())), z = int(std::floor(u.z()));
+    if (x >= 0 && y >= 0 && z >= 0 && x < sizes[0] && y < sizes[1] && z < sizes[2])
+      open_[index(x, y, z)] = 0.f;
+  };
+
+  // hits of the rays along +x through the centers of each (y, z) row
+  std::vector<std::vector<double>> row_hits(static_cast<size_t>(size_y_) * size_z_);
+
+  for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+    const vec3d a = to_grid(indices[t]), b = to_grid(indices[t + 1]), c = to_grid(indices[t + 2]);
+
+    // surface : samples at most half a cell apart
+    const double longest = std::max({ (b - a).norm(), (c - b).norm(), (a - c).norm() });
+    const int n = static_cast<int>(std::ceil(longest * 2.0)) + 1;
+    for (int i = 0; i <= n; i++)
+      for (int j = 0; i + j <= n; j++)
+        mark(a + (b - a) * (double(i) / n) + (c - a) * (double(j) / n));
+
+    // rows whose center is covered by the projection of the triangle onto the yz plane
+    const double det = (b.y() - a.y()) * (c.z() - a.z()) - (c.y() - a.y()) * (b.z() - a.z());
+    if (std::abs(det) < 1e-12) continue;
+    const int y0 = std::max(int(std::ceil (std::min({ a.y(), b.y(), c.y() }) - 0.5)), 0);
+    const int y1 = std::min(int(std::floor(std::max({ a.y(), b.y(), c.y() }) - 0.5)), sizes[1] - 1);
+    const int z0 = std::max(int(std::ceil (std::min({ a.z(), b.z(), c.z() }) - 0.5)), 0);
+    const int z1 = std::min(int(std::floor(std::max({ a.z(), b.z(), c.z() }) - 0.5)), sizes[2] - 1);
+    for (int z = z0; z <= z1; z++) {
+      for (int y = y0; y <= y1; y++) {
+        // slightly off the center so that the rays don't go through shared edges
+        const double py = y + 0.5 + 1.3e-7, pz = z + 0.5 + 1.7e-7;
+        const double u = ((py - a.y()) * (c.z() - a.z()) - (c.y() - a.y()) * (pz - a.z())) / det;
+        const double v = ((b.y() - a.y()) * (pz - a.z()) - (py - a.y()) * (b.z() - a.z())) / det;
+        if (u < 0.0 || v < 0.0 || u + v > 1.0) continue;
+        row_hits[static_cast<size_t>(z) * size_y_ + y].push_back(a.x() + u * (b.x() - a.x()) + v * (c.x() - a.x()));
+      }
+    }
+  }
+
+  // fill between the pairs of hits. rows with odd hits cross an open surface and are skipped
+  for (uint32_t z = 0; z < size_z_; z++) {
+    for (uint32_t y = 0; y < size_y_; y++) {
+      auto& hits = row_hits[static_cast<size_t>(z) * size_y_ + y];
+      if (hits.empty() || hits.size() % 2 != 0) continue;
+      std::sort(hits.begin(), hits.end());
+      for (size_t h = 0; h < hits.size(); h += 2) {
+        const int x0 = std::max(int(std::ceil (hits[h]     - 0.5)), 0);
+        const int x1 = std::min(int(std::floor(hits[h + 1] - 0.5)), sizes[0] - 1);
+        for (int x = x0; x <= x1; x++)
+          open_[index(x, y, z)] = 0.f;
+      }
+    }
   }
   return this;
 }
-} // namespace hnll::physics
\ No newline at end of file
+
+// ------------------------------------------------------------------------------------------
+// simulation
+
+void fdtd_solver::add_pressure(uint32_t x, uint32_t y, uint32_t z, double value)
+{
+  const auto i = index(x, y, z);
+  // keeps p == p_x + p_y + p_z in the pml
+  if (is_pml_cell(x, y, z))
+    pressure_x_[i] += static_cast<float>(value);
+  pressure_[i] += static_cast<float>(value);
+}
+
+void fdtd_solver::solve(const std::vector<double>& _input, double _duration)
+{
+  const auto count = static_cast<uint32_t>(std::max(_duration / dt_, 0.0));
+  output_.clear();
+  output_.reserve(count);
+
+  if (!_input.empty())
+    add_pressure(source_[0], source_[1], source_[2], _input[0]);
+  const auto first_step = step_count_;
+  run(count, [&](uint64_t step) {
+    output_.push_back(get_pressure(listener_[0], listener_[1], listener_[2]));
+    const auto next = step + 1 - first_step;
+    if (next < _input.size())
+      add_pressure(source_[0], source_[1], source_[2], _input[next]);
+  });
+}
+
+void fdtd_solver::step(uint32_t count)
+{
+  run(count, [](uint64_t) {});
+}
+
+void fdtd_solver::run(uint32_t count, const std::function<void(uint64_t)>& on_step)
+{
+  if (get_cell_count() == 0)
+    throw std::runtime_error("fdtd_solver : set_grid_size() should be called before solving");
+  if (get_courant_number() >= 1.0 / std::sqrt(3.0))
+    throw std::runtime_error("fdtd_solver : unstable. c * dt / dx should be less than 1 / sqrt(3)");
+  if (count == 0)
+    return;
+
+  update_pml_coefficients();
+
+  // slab decomposition along z. the last velocity plane of each slab reads the first pressure
+  // plane of the next slab, so it is updated for every slab before the rest of the slabs
+  const auto slab_count = decide_slab_count(size_z_, get_cell_count(), jobs_);
+  if (slab_count == 1) {
+    for (uint32_t s = 0; s < count; s++) {
+      update_slab(0, size_z_, size_z_);
+      on_step(step_count_++);
+    }
+    return;
+  }
+
+  auto z_begin_of = [this, slab_count](size_t slab)
+  { return static_cast<uint32_t>(uint64_t(size_z_) * slab / slab_count); };
+  for (uint32_t s = 0; s < count; s++) {
+    jobs_->parallel_for(0, slab_count, 1, [&](size_t begin, size_t end) {
+      for (auto slab = begin; slab < end; slab++)
+        for (uint32_t y = 0; y < size_y_; y++)
+          update_velocity_row(y, z_begin_of(slab + 1) - 1);
+    }, "fdtd_solver");
+    jobs_->parallel_for(0, slab_count, 1, [&](size_t begin, size_t end) {
+      for (auto slab = begin; slab < end; slab++)
+        update_slab(z_begin_of(slab), z_begin_of(slab + 1), z_begin_of(slab + 1) - 1);
+    }, "fdtd_solver");
+    on_step(step_count_++);
+  }
+}
+
+void fdtd_solver::update_slab(uint32_t z_begin, uint32_t z_end, uint32_t z_velocity_end)
+{
+  // a pressure cell is read only by the velocities of itself and its negative neighbors,
+  // so the pressure of a row can be updated right after its velocity in a single pass
+  const uint32_t block_rows = static_cast<uint32_t>(std::max<size_t>(BLOCK_CELL_COUNT / size_x_, 1));
+  for (uint32_t y_begin = 0; y_begin < size_y_; y_begin += block_rows) {
+    const auto y_end = std::min(y_begin + block_rows, size_y_);
+    for (uint32_t z = z_begin; z < z_end; z++) {
+      for (uint32_t y = y_begin; y < y_end; y++) {
+        if (z < z_velocity_end)
+          update_velocity_row(y, z);
+        update_pressure_row(y, z);
+      }
+    }
+  }
+}
+
+void fdtd_solver::update_velocity_row(uint32_t y, uint32_t z)
+{
+  const size_t nx = size_x_;
+  const auto row = index(0, y, z);
+  const float* p    = pressure_.data() + row;
+  const float* open = open_.data() + row;
+  // the last face of each axis is the rigid boundary, and is never updated
+  velocity_row<true>(velocity_x_.data() + row, p, open, 1, velocity_a_[0].data(), velocity_b_[0].data(), nx - 1);
+  if (y + 1 < size_y_)
+    velocity_row<false>(velocity_y_.data() + row, p, open, nx, &velocity_a_[1][y], &velocity_b_[1][y], nx);
+  if (z + 1 < size_z_)
+    velocity_row<false>(velocity_z_.data() + row, p, open, padding_, &velocity_a_[2][z], &velocity_b_[2][z], nx);
+}
+
+void fdtd_solver::update_pressure_row(uint32_t y, uint32_t z)
+{
+  const size_t nx = size_x_, stride_y = nx, stride_z = padding_;
+  const uint32_t l = pml_thickness_;
+  const auto row = index(0, y, z);
+  float* p = pressure_.data() + row;
+  const float* vx = velocity_x_.data() + row;
+  const float* vy = velocity_y_.data() + row;
+  const float* vz = velocity_z_.data() + row;
+
+  if (l == 0) {
+    pressure_row(p, vx, vy, vz, stride_y, stride_z, pressure_b_[0][0], 0, nx);
+    return;
+  }
+
+  split_row r{
+    p, pressure_x_.data() + row, pressure_y_.data() + row, pressure_z_.data() + row,
+    vx, vy, vz, pressure_a_[0].data(), pressure_b_[0].data(),
+    pressure_a_[1][y], pressure_b_[1][y], pressure_a_[2][z], pressure_b_[2][z]
+  };
+  if (y < l || z < l || y + l >= size_y_ || z + l >= size_z_) {
+    pressure_split_row(r, stride_y, stride_z, 0, nx);
+    return;
+  }
+  // the interior of the row is [l, nx - l)
+  const size_t interior_begin = std::min<size_t>(l, nx);
+  const size_t interior_end   = std::max<size_t>(nx > l ? nx - l : 0, interior_begin);
+  pressure_split_row(r, stride_y, stride_z, 0, interior_begin);
+  if (interior_begin < interior_end)
+    pressure_row(p, vx, vy, vz, stride_y, stride_z, pressure_b_[0][interior_begin], interior_begin, interior_end);
+  pressure_split_row(r, stride_y, stride_z, interior_end, nx);
+}
+
+} // namespace hnll::physics
@@ -0,0 +1,112 @@
+// hnll
+#include <physics/fdtd_stream.hpp>
+#include <physics/fdtd_solver.hpp>
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+namespace hnll::physics {
+
+namespace {
+
+// sleep of the worker while the rings are full enough
+constexpr auto IDLE_SLEEP = std::chrono::microseconds(500);
+
+} // anonymous namespace
+
+fdtd_stream::fdtd_stream(u_ptr<fdtd_solver>&& solver, size_t ring_capacity)
+  : solver_(std::move(solver)), ring_capacity_(ring_capacity), input_(ring_capacity)
+{
+  if (solver_ == nullptr)
+    throw std::runtime_error("fdtd_stream : solver is null");
+  set_target_latency(DEFAULT_TARGET_LATENCY);
+}
+
+fdtd_stream::~fdtd_stream()
+{
+  stop();
+}
+
+uint32_t fdtd_stream::add_receiver(uint32_t x, uint32_t y, uint32_t z)
+{
+  if (running_)
+    throw std::runtime_error("fdtd_stream : receivers should be added while stopped");
+  receiver_cells_.push_back({ x, y, z });
+  outputs_.emplace_back(std::make_unique<utils::spsc_ring<float>>(ring_capacity_));
+  return static_cast<uint32_t>(outputs_.size() - 1);
+}
+
+double fdtd_stream::get_sampling_rate() const
+{
+  return 1.0 / solver_->get_dt();
+}
+
+void fdtd_stream::set_target_latency(size_t samples)
+{
+  target_latency_ = std::clamp<size_t>(samples, 1, input_.capacity());
+}
+
+void fdtd_stream::start()
+{
+  if (running_) return;
+  running_ = true;
+  worker_ = std::thread([this] { work(); });
+}
+
+void fdtd_stream::stop()
+{
+  if (!running_) return;
+  running_ = false;
+  worker_.join();
+}
+
+size_t fdtd_stream::get_min_buffered_count() const
+{
+  size_t res = target_latency_;
+  for (const auto& output : outputs_)
+    res = std::min(res, output->size());
+  return res;
+}
+
+void fdtd_stream::work()
+{
+  const auto& source = solver_->get_source();
+  // the excitation of the next step, same as fdtd_solver::solve()
+  auto inject = [this, &source] {
+    float excitation;
+    if (input_.pop(excitation))
+      solver_->add_pressure(source[0], source[1], source[2], excitation);
+  };
+  if (step_count_ == 0)
+    inject();
+
+  // the first batches fill the rings, so they are not late
+  bool is_primed = false;
+
+  while (running_) {
+    const size_t target   = target_latency_;
+    const size_t buffered = get_min_buffered_count();
+    if (buffered >= target) {
+      is_primed = true;
+      std::this_thread::sleep_for(IDLE_SLEEP);
+      continue;
+    }
+    if (is_primed && buffered < target / 4)
+      late_batch_count_++;
+
+    const auto count = static_cast<uint32_t>(std::min<size_t>(batch_step_count_, target - buffered));
+    solver_->step(count, [this, &inject](uint64_t) {
+      for (size_t r = 0; r < outputs_.size(); r++) {
+        const auto& cell = receiver_cells_[r];
+        if (!outputs_[r]->push(static_cast<float>(solver_->get_pressure(cell[0], cell[1], cell[2]))))
+          dropped_sample_count_++;
+      }
+      inject();
+    });
+    step_count_ += count;
+  }
+}
+
+} // namespace hnll::physics
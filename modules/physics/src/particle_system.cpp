@@ -0,0 +1,208 @@
+// hnll
+#include <physics/particle_system.hpp>
+#include <utils/job_system.hpp>
+
+// std
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <immintrin.h>
+#define HNLL_PARTICLE_USE_SSE
+#endif
+
+namespace hnll::physics {
+
+namespace {
+
+// a multiple of 4 so that every simd lane but the last chunk's is full
+constexpr size_t PARTICLES_PER_CHUNK = 1 << 13;
+
+// calls func(begin, end) for each chunk, on the jobs if jobs isn't nullptr
+template <typename Func>
+void for_each_chunk(size_t count, utils::job_system* jobs, Func&& func)
+{
+  if (jobs == nullptr)
+    func(0, count);
+  else
+    jobs->parallel_for(0, count, PARTICLES_PER_CHUNK, func, "particle_system");
+}
+
+} // anonymous namespace
+
+particle_system::particle_system(size_t capacity)
+{
+  reserve(capacity);
+}
+
+uint32_t particle_system::add_particle(const vec3& position, const vec3& velocity, float mass)
+{
+  for (int c = 0; c < 3; c++) {
+    position_[c].push_back(position[c]);
+    velocity_[c].push_back(velocity[c]);
+    force_[c].push_back(0.f);
+    previous_position_[c].push_back(position[c] - velocity[c] * last_dt_);
+  }
+  inv_mass_.push_back(mass > 0.f ? 1.f / mass : 0.f);
+  return static_cast<uint32_t>(inv_mass_.size() - 1);
+}
+
+void particle_system::clear()
+{
+  for (auto* arrays : { &position_, &velocity_, &force_, &previous_position_ })
+    for (auto& array : *arrays)
+      array.clear();
+  inv_mass_.clear();
+}
+
+void particle_system::reserve(size_t capacity)
+{
+  for (auto* arrays : { &position_, &velocity_, &force_, &previous_position_ })
+    for (auto& array : *arrays)
+      array.reserve(capacity);
+  inv_mass_.reserve(capacity);
+}
+
+void particle_system::set_position(uint32_t id, const vec3& p)
+{
+  for (int c = 0; c < 3; c++) {
+    previous_position_[c][id] += p[c] - position_[c][id];
+    position_[c][id] = p[c];
+  }
+}
+
+void particle_system::set_velocity(uint32_t id, const vec3& v)
+{
+  for (int c = 0; c < 3; c++) {
+    velocity_[c][id] = v[c];
+    previous_position_[c][id] = position_[c][id] - v[c] * last_dt_;
+  }
+}
+
+void particle_system::update(float dt)
+{
+  if (inv_mass_.empty() || dt <= 0.f) return;
+
+  if (interaction_stiffness_ > 0.f && interaction_radius_ > 0.f)
+    apply_interaction_forces();
+  integrate(dt);
+}
+
+void particle_system::apply_interaction_forces()
+{
+  const float* x = position_[0].data();
+  const float* y = position_[1].data();
+  const float* z = position_[2].data();
+  const auto count = inv_mass_.size();
+  spatial_hash_.build(x, y, z, count, interaction_radius_);
+
+  const auto& order = spatial_hash_.get_sorted_ids();
+  for (int c = 0; c < 3; c++)
+    sorted_position_[c].resize(count);
+  float* sx = sorted_position_[0].data();
+  float* sy = sorted_position_[1].data();
+  float* sz = sorted_position_[2].data();
+  for_each_chunk(count, jobs_, [&](size_t begin, size_t end) {
+    for (size_t k = begin; k < end; k++) {
+      const auto i = order[k];
+      sx[k] = x[i]; sy[k] = y[i]; sz[k] = z[i];
+    }
+  });
+
+  const float radius = interaction_radius_, radius2 = radius * radius, stiffness = interaction_stiffness_;
+  // each chunk gathers the forces of its own particles, so no synchronization is needed
+  for_each_chunk(count, jobs_, [&](size_t begin, size_t end) {
+    for (size_t k = begin; k < end; k++) {
+      const float xi = sx[k], yi = sy[k], zi = sz[k];
+      float fx = 0.f, fy = 0.f, fz = 0.f;
+      spatial_hash_.for_each_candidate(xi, yi, zi, [&](uint32_t slot) {
+        const float dx = xi - sx[slot], dy = yi - sy[slot], dz = zi - sz[slot];
+        const float d2 = dx * dx + dy * dy + dz * dz;
+        if (d2 >= radius2 || d2 == 0.f) return;
+        const float d = std::sqrt(d2);
+        const float s = stiffness * (radius - d) / d;
+        fx += s * dx; fy += s * dy; fz += s * dz;
+      });
+      const auto i = order[k];
+      force_[0][i] += fx;
+      force_[1][i] += fy;
+      force_[2][i] += fz;
+    }
+  });
+}
+
+void particle_system::integrate(float dt)
+{
+  const float damp  = 1.f / (1.f + drag_ * dt);
+  const bool verlet = integrator_ == integrator::VERLET;
+  // keeps verlet consistent when dt changes
+  const float ratio = verlet && last_dt_ > 0.f ? dt / last_dt_ : 1.f;
+  const float inv_dt = 1.f / dt, dt2 = dt * dt;
+
+  // the first verlet step takes the initial velocities
+  if (verlet && last_dt_ == 0.f)
+    for (int c = 0; c < 3; c++)
+      for (size_t i = 0; i < inv_mass_.size(); i++)
+        previous_position_[c][i] = position_[c][i] - velocity_[c][i] * dt;
+
+  for_each_chunk(inv_mass_.size(), jobs_, [&](size_t begin, size_t end) {
+    const float* im = inv_mass_.data();
+    for (int c = 0; c < 3; c++) {
+      float* p  = position_[c].data();
+      float* v  = velocity_[c].data();
+      float* f  = force_[c].data();
+      float* pp = previous_position_[c].data();
+      const float g = gravity_[c];
+      size_t i = begin;
+
+      if (!verlet) {
+        // v += a dt, x += v dt
+#ifdef HNLL_PARTICLE_USE_SSE
+        const __m128 vdt = _mm_set1_ps(dt), vg = _mm_set1_ps(g), vdamp = _mm_set1_ps(damp), zero = _mm_setzero_ps();
+        for (; i + 4 <= end; i += 4) {
+          __m128 a   = _mm_add_ps(vg, _mm_mul_ps(_mm_loadu_ps(f + i), _mm_loadu_ps(im + i)));
+          __m128 vel = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(v + i), _mm_mul_ps(a, vdt)), vdamp);
+          _mm_storeu_ps(v + i, vel);
+          _mm_storeu_ps(p + i, _mm_add_ps(_mm_loadu_ps(p + i), _mm_mul_ps(vel, vdt)));
+          _mm_storeu_ps(f + i, zero);
+        }
+#endif
+        for (; i < end; i++) {
+          const float a = g + f[i] * im[i];
+          v[i] = (v[i] + a * dt) * damp;
+          p[i] += v[i] * dt;
+          f[i] = 0.f;
+        }
+      }
+      else {
+        // x' = x + (x - x_prev) + a dt^2
+#ifdef HNLL_PARTICLE_USE_SSE
+        const __m128 vdt2 = _mm_set1_ps(dt2), vg = _mm_set1_ps(g), vinertia = _mm_set1_ps(ratio * damp),
+                     vinv_dt = _mm_set1_ps(inv_dt), zero = _mm_setzero_ps();
+        for (; i + 4 <= end; i += 4) {
+          __m128 a    = _mm_add_ps(vg, _mm_mul_ps(_mm_loadu_ps(f + i), _mm_loadu_ps(im + i)));
+          __m128 cur  = _mm_loadu_ps(p + i);
+          __m128 next = _mm_add_ps(cur, _mm_add_ps(_mm_mul_ps(_mm_sub_ps(cur, _mm_loadu_ps(pp + i)), vinertia), _mm_mul_ps(a, vdt2)));
+          _mm_storeu_ps(pp + i, cur);
+          _mm_storeu_ps(p + i, next);
+          _mm_storeu_ps(v + i, _mm_mul_ps(_mm_sub_ps(next, cur), vinv_dt));
+          _mm_storeu_ps(f + i, zero);
+        }
+#endif
+        for (; i < end; i++) {
+          const float a = g + f[i] * im[i];
+          const float cur = p[i];
+          const float next = cur + ((cur - pp[i]) * (ratio * damp) + a * dt2);
+          pp[i] = cur;
+          p[i]  = next;
+          v[i]  = (next - cur) * inv_dt;
+          f[i]  = 0.f;
+        }
+      }
+    }
+  });
+
+  last_dt_ = dt;
+}
+
+} // namespace hnll::physics
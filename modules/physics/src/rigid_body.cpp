@@ -0,0 +1,71 @@
+// hnll
+#include <physics/rigid_body.hpp>
+#include <geometry/bounding_volume.hpp>
+#include <geometry/convex_hull.hpp>
+
+// std
+#include <algorithm>
+#include <cmath>
+
+namespace hnll::physics {
+
+Eigen::Matrix3d rigid_body::get_inv_inertia_world() const
+{
+  const auto rotation = orientation.toRotationMatrix();
+  return rotation * inv_inertia_local.asDiagonal() * rotation.transpose();
+}
+
+void rigid_body::set_mass(double mass, const geometry::bounding_volume& shape, const vec3d& scale)
+{
+  if (mass <= 0.0) {
+    inv_mass = 0.0;
+    inv_inertia_local.setZero();
+    return;
+  }
+  inv_mass = 1.0 / mass;
+
+  vec3d half_extents;
+  if (shape.is_sphere() || shape.is_sphere_tree()) {
+    // solid sphere : 2/5 m r^2
+    const double r = shape.get_sphere_radius() * scale.cwiseAbs().maxCoeff();
+    inv_inertia_local.setConstant(1.0 / (0.4 * mass * r * r));
+    return;
+  }
+  if (shape.is_convex_hull())
+    half_extents = (shape.get_convex_hull()->get_max() - shape.get_convex_hull()->get_min()) * 0.5;
+  else
+    half_extents = shape.get_aabb_radius();
+  half_extents = half_extents.cwiseProduct(scale.cwiseAbs());
+
+  // solid box : m (h^2 + d^2) / 3 with half extents
+  const vec3d sq = half_extents.cwiseProduct(half_extents);
+  const vec3d inertia = vec3d(sq.y() + sq.z(), sq.z() + sq.x(), sq.x() + sq.y()) * (mass / 3.0);
+  inv_inertia_local = inertia.cwiseMax(1e-12).cwiseInverse();
+}
+
+void rigid_body::read_transform(const utils::transform& tf, double dt)
+{
+  const vec3d new_position = { tf.translation.x, tf.translation.y, tf.translation.z };
+  if (is_kinematic() && dt > 0.0)
+    linear_velocity = (new_position - position) / dt;
+  position = new_position;
+
+  auto unscaled = tf;
+  unscaled.scale = { 1.f, 1.f, 1.f };
+  orientation = Eigen::Quaterniond(unscaled.rotate_mat3());
+  save_previous_pose();
+}
+
+void rigid_body::write_transform(utils::transform& tf, double alpha) const
+{
+  const vec3d p = alpha >= 1.0 ? position : vec3d(previous_position + (position - previous_position) * alpha);
+  tf.translation = { float(p.x()), float(p.y()), float(p.z()) };
+
+  // inverse of utils::transform::rotate_mat3
+  const auto r = (alpha >= 1.0 ? orientation : previous_orientation.slerp(alpha, orientation)).toRotationMatrix();
+  tf.rotation.x = float(std::asin(std::clamp(-r(1, 2), -1.0, 1.0)));
+  tf.rotation.y = float(std::atan2(r(0, 2), r(2, 2)));
+  tf.rotation.z = float(std::atan2(r(1, 0), r(1, 1)));
+}
+
+} // namespace hnll::physics
@@ -0,0 +1,39 @@
+// hnll
+#include <physics/spatial_hash.hpp>
+
+// std
+#include <algorithm>
+#include <stdexcept>
+
+namespace hnll::physics {
+
+void spatial_hash::build(const float* x, const float* y, const float* z, size_t count, float cell_size)
+{
+  if (cell_size <= 0.f)
+    throw std::runtime_error("spatial_hash : cell size should be positive");
+  cell_size_     = cell_size;
+  inv_cell_size_ = 1.f / cell_size;
+
+  // about two buckets per particle keeps the collisions rare
+  uint32_t table_size = 1;
+  while (table_size < std::max<size_t>(count * 2, 1))
+    table_size <<= 1;
+  table_mask_ = table_size - 1;
+
+  // counting sort by bucket
+  particle_buckets_.resize(count);
+  bucket_start_.assign(table_size + 1, 0);
+  for (size_t i = 0; i < count; i++) {
+    particle_buckets_[i] = hash(cell_coord(x[i]), cell_coord(y[i]), cell_coord(z[i]));
+    bucket_start_[particle_buckets_[i] + 1]++;
+  }
+  for (uint32_t b = 0; b < table_size; b++)
+    bucket_start_[b + 1] += bucket_start_[b];
+
+  sorted_ids_.resize(count);
+  std::vector<uint32_t> cursor(bucket_start_.begin(), bucket_start_.end() - 1);
+  for (size_t i = 0; i < count; i++)
+    sorted_ids_[cursor[particle_buckets_[i]]++] = static_cast<uint32_t>(i);
+}
+
+} // namespace hnll::physics
@@ -0,0 +1,187 @@
+// hnll
+#include <utils/asset_package.hpp>
+#include <utils/vfs.hpp>
+
+// std
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace hnll::utils {
+
+constexpr size_t CHUNK_ALIGNMENT = 16;
+
+namespace {
+
+// little endian on every supported platform, written as is
+template <typename T>
+void write_value(std::ofstream& out, const T& value)
+{ out.write(reinterpret_cast<const char*>(&value), sizeof(T)); }
+
+void write_string(std::ofstream& out, const std::string& str)
+{
+  write_value(out, static_cast<uint32_t>(str.size()));
+  out.write(str.data(), static_cast<std::streamsize>(str.size()));
+}
+
+class reader
+{
+  public:
+    reader(std::span<const std::byte> bytes, const std::string& path) : bytes_(bytes), path_(path) {}
+
+    template <typename T>
+    T read_value()
+    {
+      T value;
+      std::memcpy(&value, take(sizeof(T)).data(), sizeof(T));
+      return value;
+    }
+    std::string read_string()
+    {
+      auto size = read_value<uint32_t>();
+      auto bytes = take(size);
+      return std::string(reinterpret_cast<const char*>(bytes.data()), size);
+    }
+    std::span<const std::byte> take(size_t size)
+    {
+      if (position_ + size > bytes_.size())
+        throw std::runtime_error("asset_package : " + path_ + " is truncated.");
+      auto res = bytes_.subspan(position_, size);
+      position_ += size;
+      return res;
+    }
+    size_t get_position() const { return position_; }
+
+  private:
+    std::span<const std::byte> bytes_;
+    const std::string& path_;
+    size_t position_ = 0;
+};
+
+} // anonymous namespace
+
+asset_dependency asset_dependency::stat(const std::string& path)
+{
+  std::error_code error;
+  const auto time = std::filesystem::last_write_time(path, error);
+  if (error)
+    return { path, -1, 0 };
+  const auto size = std::filesystem::file_size(path, error);
+  return { path, static_cast<int64_t>(time.time_since_epoch().count()), error ? 0 : size };
+}
+
+void asset_package::add_chunk(const std::string& name, const void* data, size_t size)
+{
+  if (has_chunk(name))
+    throw std::runtime_error("asset_package : chunk " + name + " already exists.");
+  const auto offset = (data_.size() + CHUNK_ALIGNMENT - 1) / CHUNK_ALIGNMENT * CHUNK_ALIGNMENT;
+  data_.resize(offset + size);
+  if (size > 0)
+    std::memcpy(data_.data() + offset, data, size);
+  chunks_.push_back({ name, offset, size });
+}
+
+void asset_package::save(const std::string& path) const
+{
+  const auto temp_path = path + ".tmp";
+  {
+    std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+    if (!out)
+      throw std::runtime_error("asset_package : failed to open " + temp_path);
+
+    write_value(out, MAGIC);
+    write_value(out, VERSION);
+    write_value(out, static_cast<uint32_t>(dependencies_.size()));
+    write_value(out, static_cast<uint32_t>(chunks_.size()));
+    for (const auto& dep : dependencies_) {
+      write_string(out, dep.path);
+      write_value(out, dep.write_time);
+      write_value(out, dep.size);
+    }
+    for (const auto& c : chunks_) {
+      write_string(out, c.name);
+      write_value(out, c.offset);
+      write_value(out, c.size);
+    }
+    write_value(out, static_cast<uint64_t>(data_.size()));
+    out.write(reinterpret_cast<const char*>(data_.data()), static_cast<std::streamsize>(data_.size()));
+    if (!out)
+      throw std::runtime_error("asset_package : failed to write " + temp_path);
+  }
+  std::filesystem::rename(temp_path, path);
+}
+
+std::unique_ptr<asset_package> asset_package::load(const std::string& path)
+{
+  // read in place, only the chunk data is copied
+  auto mapping = mapped_file::open(path);
+  if (mapping == nullptr)
+    return nullptr;
+
+  reader r(mapping->get_bytes(), path);
+  if (r.read_value<uint32_t>() != MAGIC)
+    throw std::runtime_error("asset_package : " + path + " is not a package.");
+  // stale layout, the asset should be cooked again
+  if (r.read_value<uint32_t>() != VERSION)
+    return nullptr;
+
+  auto package = create();
+  const auto dependency_count = r.read_value<uint32_t>();
+  const auto chunk_count      = r.read_value<uint32_t>();
+  for (uint32_t i = 0; i < dependency_count; i++) {
+    asset_dependency dep;
+    dep.path       = r.read_string();
+    dep.write_time = r.read_value<int64_t>();
+    dep.size       = r.read_value<uint64_t>();
+    package->dependencies_.emplace_back(std::move(dep));
+  }
+  for (uint32_t i = 0; i < chunk_count; i++) {
+    chunk c;
+    c.name   = r.read_string();
+    c.offset = r.read_value<uint64_t>();
+    c.size   = r.read_value<uint64_t>();
+    package->chunks_.emplace_back(std::move(c));
+  }
+  const auto data_size = r.read_value<uint64_t>();
+  auto data = r.take(data_size);
+  package->data_.assign(data.begin(), data.end());
+  for (const auto& c : package->chunks_)
+    if (c.offset + c.size > data_size)
+      throw std::runtime_error("asset_package : " + path + " has a broken chunk " + c.name);
+  return package;
+}
+
+std::unique_ptr<asset_package> asset_package::load_if_fresh(const std::string& path)
+{
+  auto package = load(path);
+  if (package == nullptr || !package->is_fresh())
+    return nullptr;
+  return package;
+}
+
+bool asset_package::is_fresh() const
+{
+  for (const auto& dep : dependencies_)
+    if (asset_dependency::stat(dep.path) != dep)
+      return false;
+  return true;
+}
+
+const asset_package::chunk* asset_package::find_chunk(const std::string& name) const
+{
+  for (const auto& c : chunks_)
+    if (c.name == name)
+      return &c;
+  return nullptr;
+}
+
+std::span<const std::byte> asset_package::get_chunk_bytes(const std::string& name) const
+{
+  auto* c = find_chunk(name);
+  if (c == nullptr)
+    throw std::runtime_error("asset_package : chunk " + name + " doesn't exist.");
+  return std::span<const std::byte>(data_).subspan(c->offset, c->size);
+}
+
+} // namespace hnll::utils
@@ -0,0 +1,245 @@
+// hnll
+#include <utils/ecs_world.hpp>
+
+// std
+#include <deque>
+#include <mutex>
+
+namespace hnll::utils {
+
+namespace {
+
+// chunks start at a cache line
+constexpr size_t CHUNK_ALIGNMENT = 64;
+
+size_t align_up(size_t value, size_t alignment)
+{ return (value + alignment - 1) / alignment * alignment; }
+
+// deque keeps the references valid while the other types register
+std::mutex                      type_mutex;
+std::deque<component_type_info> type_infos;
+
+} // anonymous namespace
+
+namespace ecs_detail {
+
+component_type_id register_component_type(const component_type_info& info)
+{
+  std::lock_guard<std::mutex> lock(type_mutex);
+  type_infos.push_back(info);
+  return static_cast<component_type_id>(type_infos.size() - 1);
+}
+
+const component_type_info& get_component_type_info(component_type_id id)
+{
+  std::lock_guard<std::mutex> lock(type_mutex);
+  return type_infos[id];
+}
+
+} // namespace ecs_detail
+
+// ------------------------------- ecs_archetype
+ecs_archetype::ecs_archetype(std::vector<component_type_id> signature) : signature_(std::move(signature))
+{
+  size_t row_size = sizeof(entity);
+  for (auto type : signature_) {
+    column_info_.push_back(ecs_detail::get_component_type_info(type));
+    row_size += column_info_.back().size;
+  }
+
+  // the largest capacity whose arrays fit in a chunk, at least one row
+  auto layout = [this](uint32_t capacity) {
+    column_offsets_.clear();
+    size_t offset = sizeof(entity) * capacity;
+    for (const auto& info : column_info_) {
+      offset = align_up(offset, info.alignment);
+      column_offsets_.push_back(offset);
+      offset += info.size * capacity;
+    }
+    return offset;
+  };
+  chunk_capacity_ = static_cast<uint32_t>(std::max<size_t>(CHUNK_SIZE / row_size, 1));
+  while (chunk_capacity_ > 1 && layout(chunk_capacity_) > CHUNK_SIZE)
+    chunk_capacity_--;
+  chunk_bytes_ = std::max(layout(chunk_capacity_), CHUNK_SIZE);
+}
+
+ecs_archetype::~ecs_archetype()
+{
+  for (uint32_t row = 0; row < row_count_; row++)
+    for (int c = 0; c < static_cast<int>(signature_.size()); c++)
+      column_info_[c].destroy(get_component(c, row));
+  for (auto* chunk : chunks_)
+    ::operator delete(chunk, std::align_val_t(CHUNK_ALIGNMENT));
+}
+
+uint32_t ecs_archetype::allocate(entity e)
+{
+  if (row_count_ == chunks_.size() * chunk_capacity_)
+    chunks_.push_back(static_cast<std::byte*>(::operator new(chunk_bytes_, std::align_val_t(CHUNK_ALIGNMENT))));
+  const auto row = row_count_++;
+  get_entities(row / chunk_capacity_)[row % chunk_capacity_] = e;
+  return row;
+}
+
+entity ecs_archetype::remove(uint32_t row)
+{
+  for (int c = 0; c < static_cast<int>(signature_.size()); c++)
+    column_info_[c].destroy(get_component(c, row));
+  return remove_relocated(row);
+}
+
+entity ecs_archetype::remove_relocated(uint32_t row)
+{
+  const auto last = --row_count_;
+  entity moved;
+  if (row != last) {
+    for (int c = 0; c < static_cast<int>(signature_.size()); c++)
+      column_info_[c].relocate(get_component(c, row), get_component(c, last));
+    moved = get_entities(last / chunk_capacity_)[last % chunk_capacity_];
+    get_entities(row / chunk_capacity_)[row % chunk_capacity_] = moved;
+  }
+
+  // keeps one spare chunk to avoid reallocating at the boundary
+  while (chunks_.size() > get_chunk_count() + 1) {
+    ::operator delete(chunks_.back(), std::align_val_t(CHUNK_ALIGNMENT));
+    chunks_.pop_back();
+  }
+  return moved;
+}
+
+int ecs_archetype::column_of(component_type_id type) const
+{
+  auto it = std::lower_bound(signature_.begin(), signature_.end(), type);
+  if (it == signature_.end() || *it != type)
+    return NO_COLUMN;
+  return static_cast<int>(it - signature_.begin());
+}
+
+// ------------------------------- ecs_world
+ecs_world::ecs_world()
+{
+  // entities without components
+  find_or_create_archetype({});
+}
+
+ecs_world::~ecs_world() = default;
+
+entity ecs_world::create_entity()
+{
+  check_structural_change();
+  return allocate_entity(0);
+}
+
+entity ecs_world::allocate_entity(uint32_t archetype)
+{
+  uint32_t index;
+  if (!free_indices_.empty()) {
+    index = free_indices_.back();
+    free_indices_.pop_back();
+  }
+  else {
+    index = static_cast<uint32_t>(records_.size());
+    records_.emplace_back();
+  }
+
+  auto& record = records_[index];
+  const entity e{ index, record.generation };
+  record.archetype = archetype;
+  record.row = archetypes_[archetype]->allocate(e);
+  entity_count_++;
+  return e;
+}
+
+void ecs_world::destroy_entity(entity e)
+{
+  if (!is_alive(e))
+    return;
+  check_structural_change();
+
+  auto& record = records_[e.index];
+  const auto moved = archetypes_[record.archetype]->remove(record.row);
+  if (!moved.is_null())
+    records_[moved.index].row = record.row;
+
+  record.archetype = NO_ARCHETYPE;
+  record.generation++;
+  free_indices_.push_back(e.index);
+  entity_count_--;
+}
+
+bool ecs_world::find_columns(const ecs_archetype& a, const component_type_id* types, int* columns, size_t count)
+{
+  for (size_t i = 0; i < count; i++) {
+    columns[i] = a.column_of(types[i]);
+    if (columns[i] == ecs_archetype::NO_COLUMN)
+      return false;
+  }
+  return true;
+}
+
+uint32_t ecs_world::find_or_create_archetype(const std::vector<component_type_id>& signature)
+{
+  if (auto it = archetype_map_.find(signature); it != archetype_map_.end())
+    return it->second;
+  const auto index = static_cast<uint32_t>(archetypes_.size());
+  archetypes_.emplace_back(std::make_unique<ecs_archetype>(signature));
+  archetype_map_.emplace(signature, index);
+  return index;
+}
+
+uint32_t ecs_world::get_add_target(uint32_t archetype, component_type_id type)
+{
+  for (const auto& edge : archetypes_[archetype]->add_edges)
+    if (edge.first == type)
+      return edge.second;
+
+  auto signature = archetypes_[archetype]->get_signature();
+  signature.insert(std::lower_bound(signature.begin(), signature.end(), type), type);
+  const auto target = find_or_create_archetype(signature);
+  archetypes_[archetype]->add_edges.emplace_back(type, target);
+  archetypes_[target]->remove_edges.emplace_back(type, archetype);
+  return target;
+}
+
+uint32_t ecs_world::get_remove_target(uint32_t archetype, component_type_id type)
+{
+  for (const auto& edge : archetypes_[archetype]->remove_edges)
+    if (edge.first == type)
+      return edge.second;
+
+  auto signature = archetypes_[archetype]->get_signature();
+  signature.erase(std::lower_bound(signature.begin(), signature.end(), type));
+  const auto target = find_or_create_archetype(signature);
+  archetypes_[archetype]->remove_edges.emplace_back(type, target);
+  archetypes_[target]->add_edges.emplace_back(type, archetype);
+  return target;
+}
+
+void ecs_world::move_entity(entity e, uint32_t target)
+{
+  auto& record = records_[e.index];
+  auto& src = *archetypes_[record.archetype];
+  auto& dst = *archetypes_[target];
+  const auto row = dst.allocate(e);
+
+  // both signatures are sorted
+  const auto& src_signature = src.get_signature();
+  const auto& dst_signature = dst.get_signature();
+  for (int c = 0, d = 0; c < static_cast<int>(src_signature.size()); c++) {
+    while (d < static_cast<int>(dst_signature.size()) && dst_signature[d] < src_signature[c]) d++;
+    auto* component = src.get_component(c, record.row);
+    if (d < static_cast<int>(dst_signature.size()) && dst_signature[d] == src_signature[c])
+      src.get_column_info(c).relocate(dst.get_component(d, row), component);
+    else
+      src.get_column_info(c).destroy(component);
+  }
+
+  const auto moved = src.remove_relocated(record.row);
+  if (!moved.is_null())
+    records_[moved.index].row = record.row;
+  record.archetype = target;
+  record.row = row;
+}
+
+} // namespace hnll::utils
@@ -0,0 +1,28 @@
+// hnll
+#include <utils/fixed_timestep.hpp>
+
+// std
+#include <algorithm>
+
+namespace hnll::utils {
+
+int fixed_timestep::advance(double frame_dt)
+{
+  accumulator_ += std::max(frame_dt, 0.0);
+
+  int steps = static_cast<int>(accumulator_ / step_);
+  if (steps > max_steps_per_frame_) {
+    // keep the fraction so that the interpolation stays continuous
+    const double dropped = (steps - max_steps_per_frame_) * step_;
+    dropped_time_ += dropped;
+    accumulator_  -= dropped;
+    steps = max_steps_per_frame_;
+  }
+  accumulator_ -= steps * step_;
+  // floating point error
+  accumulator_ = std::max(accumulator_, 0.0);
+  step_count_ += steps;
+  return steps;
+}
+
+} // namespace hnll::utils
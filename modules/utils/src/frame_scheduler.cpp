@@ -0,0 +1,137 @@
+// hnll
+#include <utils/frame_scheduler.hpp>
+
+// std
+#include <algorithm>
+#include <chrono>
+
+namespace hnll::utils {
+
+frame_scheduler::frame_scheduler(clock_func clock) : clock_(std::move(clock))
+{
+  if (!clock_)
+    clock_ = [] {
+      return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    };
+}
+
+frame_scheduler::~frame_scheduler()
+{
+  for (auto& entry : tasks_)   destroy(entry);
+  for (auto& entry : spawned_) destroy(entry);
+}
+
+void frame_scheduler::destroy(task_entry& entry)
+{
+  if (entry.handle)
+    entry.handle.destroy();
+  entry.handle = {};
+}
+
+frame_task_id frame_scheduler::spawn(frame_task&& task, int priority, uint64_t deadline_frames, const char* name)
+{
+  const auto deadline = deadline_frames == NO_DEADLINE ? NO_DEADLINE : stats_.frame_count + deadline_frames;
+  task_entry entry{ task.release(), next_id_++, priority, deadline, name };
+  // the running frame iterates tasks_
+  if (is_running_) spawned_.push_back(entry);
+  else             tasks_.push_back(entry);
+  return entry.id;
+}
+
+bool frame_scheduler::cancel(frame_task_id id)
+{
+  for (auto* list : { &tasks_, &spawned_ }) {
+    auto it = std::find_if(list->begin(), list->end(), [id](const task_entry& e) { return e.id == id && !e.cancelled; });
+    if (it == list->end())
+      continue;
+    // a task can't be destroyed while it runs : the frame removes it after its slice
+    if (!is_running_) {
+      destroy(*it);
+      list->erase(it);
+    }
+    else
+      it->cancelled = true;
+    return true;
+  }
+  return false;
+}
+
+bool frame_scheduler::is_done(frame_task_id id) const
+{
+  if (id >= next_id_) return false;
+  for (const auto* list : { &tasks_, &spawned_ })
+    for (const auto& e : *list)
+      if (e.id == id && !e.cancelled)
+        return false;
+  return true;
+}
+
+bool frame_scheduler::is_budget_spent() const
+{ return clock_() >= frame_end_ms_; }
+
+void frame_scheduler::run_frame(double budget_ms)
+{
+  const auto frame = stats_.frame_count++;
+  const auto start = clock_();
+  frame_end_ms_ = start + budget_ms;
+
+  tasks_.insert(tasks_.end(), spawned_.begin(), spawned_.end());
+  spawned_.clear();
+
+  for (auto& entry : tasks_) {
+    if (!entry.missed_deadline && entry.deadline_frame < frame) {
+      entry.missed_deadline = true;
+      stats_.deadline_miss_count++;
+    }
+  }
+  // the tasks due in this frame come first
+  std::stable_sort(tasks_.begin(), tasks_.end(), [frame](const task_entry& a, const task_entry& b) {
+    const bool a_due = a.deadline_frame <= frame, b_due = b.deadline_frame <= frame;
+    if (a_due != b_due)                         return a_due;
+    if (a.priority != b.priority)               return a.priority > b.priority;
+    if (a.deadline_frame != b.deadline_frame)   return a.deadline_frame < b.deadline_frame;
+    return a.id < b.id;
+  });
+
+  std::exception_ptr error;
+  is_running_ = true;
+  for (auto& entry : tasks_) {
+    if (entry.cancelled || error)
+      continue;
+    const auto now = clock_();
+    if (now >= frame_end_ms_ && entry.deadline_frame > frame)
+      continue;
+
+    entry.handle.resume();
+
+    const auto slice_end = clock_();
+    if (slice_end > frame_end_ms_ && overrun_hook_)
+      overrun_hook_(entry.name, slice_end - std::max(now, frame_end_ms_));
+    if (entry.handle.done()) {
+      error = entry.handle.promise().error;
+      if (!error) stats_.completed_task_count++;
+      entry.cancelled = true;
+    }
+  }
+  is_running_ = false;
+
+  // done and cancelled tasks
+  for (auto& entry : tasks_)
+    if (entry.cancelled)
+      destroy(entry);
+  std::erase_if(tasks_, [](const task_entry& e) { return !e.handle; });
+
+  const auto end = clock_();
+  stats_.last_frame_ms = end - start;
+  if (end > frame_end_ms_) {
+    const auto overrun = end - frame_end_ms_;
+    stats_.overrun_frame_count++;
+    stats_.total_overrun_ms += overrun;
+    stats_.max_overrun_ms = std::max(stats_.max_overrun_ms, overrun);
+  }
+
+  if (error)
+    std::rethrow_exception(error);
+}
+
+} // namespace hnll::utils
@@ -0,0 +1,330 @@
+// hnll
+#include <utils/job_system.hpp>
+
+namespace hnll::utils {
+
+struct job
+{
+  std::function<void()> func;
+  job_counter*  counter;
+  job_affinity  affinity;
+  const char*   name;
+};
+
+namespace {
+
+// tries before a thread without work falls asleep
+constexpr uint32_t IDLE_SPIN_COUNT = 64;
+
+thread_local const job_system* current_system = nullptr;
+thread_local uint32_t          current_index  = job_system::NO_THREAD_INDEX;
+thread_local uint64_t          random_state   = 0x9e3779b97f4a7c15ull;
+
+uint64_t next_random()
+{
+  // xorshift64
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 7;
+  random_state ^= random_state << 17;
+  return random_state;
+}
+
+} // anonymous namespace
+
+bool job_counter::is_done() const
+{
+  if (value_.load(std::memory_order_acquire) != 0)
+    return false;
+  // waits for the last decrement to release the counter
+  std::lock_guard<std::mutex> lock(mutex_);
+  return value_.load(std::memory_order_relaxed) == 0;
+}
+
+job_system::job_system(unsigned worker_count, job_hooks hooks) : hooks_(std::move(hooks))
+{
+  if (worker_count == 0)
+    worker_count = std::max(std::thread::hardware_concurrency(), 1u) - 1;
+  worker_count_ = worker_count;
+
+  threads_.reserve(worker_count + 1);
+  for (unsigned i = 0; i < worker_count + 1; i++)
+    threads_.emplace_back(std::make_unique<thread_state>());
+
+  current_system = this;
+  current_index  = worker_count;
+
+  workers_.reserve(worker_count);
+  for (unsigned i = 0; i < worker_count; i++)
+    workers_.emplace_back([this, i] { worker_loop(i); });
+}
+
+job_system::~job_system()
+{
+  is_running_.store(false, std::memory_order_seq_cst);
+  notify_all();
+  for (auto& worker : workers_)
+    worker.join();
+
+  // jobs which nobody waited for
+  for (auto& state : threads_)
+    while (auto* j = state->deque.pop())
+      delete j;
+  for (auto* j : shared_queue_) delete j;
+  for (auto* j : main_queue_)   delete j;
+
+  if (current_system == this) {
+    current_system = nullptr;
+    current_index  = NO_THREAD_INDEX;
+  }
+}
+
+uint32_t job_system::get_thread_index() const
+{ return current_system == this ? current_index : NO_THREAD_INDEX; }
+
+void job_system::run(std::function<void()>&& func, job_counter* counter, job_affinity affinity, const char* name)
+{ submit(std::move(func), counter, affinity, name, true); }
+
+void job_system::run_after(
+  job_counter& dependency,
+  std::function<void()>&& func,
+  job_counter* counter,
+  job_affinity affinity,
+  const char* name)
+{
+  if (counter != nullptr)
+    counter->value_.fetch_add(1, std::memory_order_acq_rel);
+  auto* j = new job{ std::move(func), counter, affinity, name };
+  {
+    std::lock_guard<std::mutex> lock(dependency.mutex_);
+    if (dependency.value_.load(std::memory_order_acquire) != 0) {
+      dependency.continuations_.push_back(j);
+      return;
+    }
+  }
+  schedule(j, true);
+}
+
+void job_system::submit(std::function<void()>&& func, job_counter* counter, job_affinity affinity, const char* name, bool notify)
+{
+  if (counter != nullptr)
+    counter->value_.fetch_add(1, std::memory_order_acq_rel);
+  schedule(new job{ std::move(func), counter, affinity, name }, notify);
+}
+
+void job_system::schedule(job* j, bool notify)
+{
+  if (j->affinity == job_affinity::MAIN_THREAD) {
+    {
+      std::lock_guard<std::mutex> lock(main_mutex_);
+      main_queue_.push_back(j);
+      main_count_.fetch_add(1, std::memory_order_release);
+    }
+    // the main thread may sleep among the workers
+    notify_all();
+    return;
+  }
+
+  const auto index = get_thread_index();
+  if (index != NO_THREAD_INDEX)
+    threads_[index]->deque.push(j);
+  else {
+    std::lock_guard<std::mutex> lock(shared_mutex_);
+    shared_queue_.push_back(j);
+    shared_count_.fetch_add(1, std::memory_order_release);
+  }
+
+  if (notify) {
+    epoch_.fetch_add(1, std::memory_order_seq_cst);
+    if (sleeper_count_.load(std::memory_order_seq_cst) > 0)
+      epoch_.notify_one();
+  }
+}
+
+void job_system::notify_all()
+{
+  epoch_.fetch_add(1, std::memory_order_seq_cst);
+  if (sleeper_count_.load(std::memory_order_seq_cst) > 0)
+    epoch_.notify_all();
+}
+
+job* job_system::find_job(uint32_t index)
+{
+  if (index != NO_THREAD_INDEX)
+    if (auto* j = threads_[index]->deque.pop())
+      return j;
+
+  if (index == get_worker_count() && main_count_.load(std::memory_order_acquire) > 0) {
+    std::lock_guard<std::mutex> lock(main_mutex_);
+    if (!main_queue_.empty()) {
+      auto* j = main_queue_.front();
+      main_queue_.pop_front();
+      main_count_.fetch_sub(1, std::memory_order_relaxed);
+      return j;
+    }
+  }
+
+  if (shared_count_.load(std::memory_order_acquire) > 0) {
+    std::lock_guard<std::mutex> lock(shared_mutex_);
+    if (!shared_queue_.empty()) {
+      auto* j = shared_queue_.front();
+      shared_queue_.pop_front();
+      shared_count_.fetch_sub(1, std::memory_order_relaxed);
+      return j;
+    }
+  }
+
+  // steal from a random victim first, so that the thieves spread over the deques
+  const auto count = static_cast<uint32_t>(threads_.size());
+  const auto start = static_cast<uint32_t>(next_random() % count);
+  for (uint32_t i = 0; i < count; i++) {
+    const auto victim = (start + i) % count;
+    if (victim == index) continue;
+    if (auto* j = threads_[victim]->deque.steal()) {
+      if (index != NO_THREAD_INDEX)
+        threads_[index]->stolen.fetch_add(1, std::memory_order_relaxed);
+      if (hooks_.on_steal) hooks_.on_steal(index, victim);
+      return j;
+    }
+  }
+  return nullptr;
+}
+
+void job_system::execute(job* j, uint32_t index)
+{
+  if (hooks_.on_job_begin) hooks_.on_job_begin(index, j->name);
+  try {
+    j->func();
+  }
+  catch (...) {
+    std::lock_guard<std::mutex> lock(error_mutex_);
+    if (!error_) error_ = std::current_exception();
+  }
+  if (hooks_.on_job_end) hooks_.on_job_end(index, j->name);
+
+  auto* counter = j->counter;
+  delete j;
+  if (index != NO_THREAD_INDEX)
+    threads_[index]->executed.fetch_add(1, std::memory_order_relaxed);
+  if (counter != nullptr)
+    finish(*counter);
+}
+
+void job_system::finish(job_counter& counter)
+{
+  // not the last job : the counter can't be released by this decrement
+  auto value = counter.value_.load(std::memory_order_relaxed);
+  while (value > 1)
+    if (counter.value_.compare_exchange_weak(value, value - 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+      return;
+
+  // the last one holds the lock until it doesn't touch the counter anymore
+  std::vector<job*> continuations;
+  bool has_waiters;
+  {
+    std::lock_guard<std::mutex> lock(counter.mutex_);
+    if (counter.value_.fetch_sub(1, std::memory_order_seq_cst) == 1)
+      continuations.swap(counter.continuations_);
+    has_waiters = counter.waiters_.load(std::memory_order_seq_cst) > 0;
+  }
+
+  for (auto* j : continuations)
+    schedule(j, false);
+  if (has_waiters || !continuations.empty())
+    notify_all();
+}
+
+void job_system::sleep(uint32_t index, uint32_t epoch)
+{
+  if (hooks_.on_sleep) hooks_.on_sleep(index);
+  sleeper_count_.fetch_add(1, std::memory_order_seq_cst);
+  // a job submitted after the epoch was read has changed it
+  if (epoch_.load(std::memory_order_seq_cst) == epoch)
+    epoch_.wait(epoch, std::memory_order_seq_cst);
+  sleeper_count_.fetch_sub(1, std::memory_order_seq_cst);
+  if (hooks_.on_wake) hooks_.on_wake(index);
+}
+
+void job_system::worker_loop(uint32_t index)
+{
+  current_system = this;
+  current_index  = index;
+  random_state  += index + 1;
+
+  uint32_t idle_count = 0;
+  while (true) {
+    const auto epoch = epoch_.load(std::memory_order_seq_cst);
+    if (auto* j = find_job(index)) {
+      execute(j, index);
+      idle_count = 0;
+      continue;
+    }
+    if (!is_running_.load(std::memory_order_seq_cst))
+      break;
+    if (++idle_count < IDLE_SPIN_COUNT) {
+      std::this_thread::yield();
+      continue;
+    }
+    sleep(index, epoch);
+    idle_count = 0;
+  }
+}
+
+void job_system::wait(const job_counter& counter)
+{
+  const auto index = get_thread_index();
+  auto& waited = const_cast<job_counter&>(counter);
+  uint32_t idle_count = 0;
+  while (true) {
+    const auto epoch = epoch_.load(std::memory_order_seq_cst);
+    if (counter.is_done())
+      break;
+    if (auto* j = find_job(index)) {
+      execute(j, index);
+      idle_count = 0;
+      continue;
+    }
+    if (++idle_count < IDLE_SPIN_COUNT) {
+      std::this_thread::yield();
+      continue;
+    }
+    // the last job of the counter notifies if it sees a waiter
+    waited.waiters_.fetch_add(1, std::memory_order_seq_cst);
+    if (!counter.is_done())
+      sleep(index, epoch);
+    waited.waiters_.fetch_sub(1, std::memory_order_seq_cst);
+    idle_count = 0;
+  }
+  rethrow_error();
+}
+
+size_t job_system::process_main_thread_jobs()
+{
+  size_t res = 0;
+  while (main_count_.load(std::memory_order_acquire) > 0) {
+    job* j;
+    {
+      std::lock_guard<std::mutex> lock(main_mutex_);
+      if (main_queue_.empty()) break;
+      j = main_queue_.front();
+      main_queue_.pop_front();
+      main_count_.fetch_sub(1, std::memory_order_relaxed);
+    }
+    execute(j, get_thread_index());
+    res++;
+  }
+  rethrow_error();
+  return res;
+}
+
+void job_system::rethrow_error()
+{
+  std::exception_ptr error;
+  {
+    std::lock_guard<std::mutex> lock(error_mutex_);
+    std::swap(error, error_);
+  }
+  if (error)
+    std::rethrow_exception(error);
+}
+
+} // namespace hnll::utils
@@ -0,0 +1,495 @@
+// hnll
+#include <utils/obj_parser.hpp>
+#include <utils/job_system.hpp>
+#include <utils/vfs.hpp>
+
+// std
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace hnll::utils {
+
+namespace {
+
+// bytes of text per parse job
+constexpr size_t CHUNK_SIZE = 1 << 20;
+// elements per weld job
+constexpr size_t BLOCK_SIZE = 1 << 16;
+constexpr uint32_t RADIX_BITS = 11;
+constexpr uint32_t RADIX_SIZE = 1u << RADIX_BITS;
+
+// relative index flags of a corner
+constexpr uint8_t RELATIVE_POSITION = 1;
+constexpr uint8_t RELATIVE_TEXCOORD = 2;
+constexpr uint8_t RELATIVE_NORMAL   = 4;
+
+constexpr double POW10[] = {
+  1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+struct parsed_chunk
+{
+  std::vector<float> positions, colors, normals, texcoords;
+  // triangulated, the indices are absolute unless they are listed in relatives
+  std::vector<obj_index> corners;
+  // (corner, flags) : the negative indices, relative to the start of the chunk
+  std::vector<std::pair<uint32_t, uint8_t>> relatives;
+};
+
+// hash of the sorted corner
+struct weld_key
+{
+  uint32_t hash;
+  uint32_t corner;
+};
+
+size_t get_job_count(job_system* jobs, size_t size, size_t job_size)
+{
+  if (jobs == nullptr)
+    return 1;
+  return std::clamp<size_t>(size / job_size, 1, 4 * jobs->get_thread_count());
+}
+
+// calls func(job_index) for each job, in parallel if jobs isn't nullptr
+template <typename Func>
+void for_each_job(job_system* jobs, size_t job_count, Func&& func)
+{
+  auto run = [&func](size_t begin, size_t end) { for (size_t i = begin; i < end; i++) func(i); };
+  if (jobs != nullptr) jobs->parallel_for(0, job_count, 1, run, "obj parser");
+  else                 run(0, job_count);
+}
+
+bool is_space(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+const char* skip_spaces(const char* p, const char* end)
+{
+  while (p < end && is_space(*p)) p++;
+  return p;
+}
+
+bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+const char* parse_int(const char* p, const char* end, int64_t& value)
+{
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+'))
+    negative = *p++ == '-';
+  if (p == end || !is_digit(*p))
+    return nullptr;
+  int64_t res = 0;
+  for (; p < end && is_digit(*p); p++) {
+    res = res * 10 + (*p - '0');
+    if (res > std::numeric_limits<int32_t>::max())
+      throw std::runtime_error("obj_parser : too large index.");
+  }
+  value = negative ? -res : res;
+  return p;
+}
+
+// skips the spaces before the number
+const char* read_float(const char* p, const char* end, float& value)
+{ return parse_float(skip_spaces(p, end), end, value); }
+
+void read_floats(const char* p, const char* end, float* values, int count, const char* tag)
+{
+  for (int i = 0; i < count; i++)
+    if ((p = read_float(p, end, values[i])) == nullptr)
+      throw std::runtime_error(std::string("obj_parser : invalid ") + tag + " line.");
+}
+
+// v, v/vt, v//vn, v/vt/vn
+const char* parse_corner(const char* p, const char* end, const parsed_chunk& chunk, obj_index& corner, uint8_t& relative)
+{
+  auto resolve = [&relative](int64_t raw, size_t local_count, int32_t& index, uint8_t flag) {
+    if (raw > 0)
+      index = static_cast<int32_t>(raw - 1);
+    else if (raw < 0) {
+      // fixed when the chunk offsets are known
+      index = static_cast<int32_t>(static_cast<int64_t>(local_count) + raw);
+      relative |= flag;
+    }
+    else
+      throw std::runtime_error("obj_parser : index 0 in a face.");
+  };
+
+  int64_t raw;
+  relative = 0;
+  corner = {};
+  if ((p = parse_int(p, end, raw)) == nullptr)
+    throw std::runtime_error("obj_parser : invalid face line.");
+  resolve(raw, chunk.positions.size() / 3, corner.position, RELATIVE_POSITION);
+  if (p < end && *p == '/') {
+    if (++p < end && *p != '/') {
+      if ((p = parse_int(p, end, raw)) == nullptr)
+        throw std::runtime_error("obj_parser : invalid face line.");
+      resolve(raw, chunk.texcoords.size() / 2, corner.texcoord, RELATIVE_TEXCOORD);
+    }
+    if (p < end && *p == '/') {
+      if ((p = parse_int(p + 1, end, raw)) == nullptr)
+        throw std::runtime_error("obj_parser : invalid face line.");
+      resolve(raw, chunk.normals.size() / 3, corner.normal, RELATIVE_NORMAL);
+    }
+  }
+  if (p < end && !is_space(*p))
+    throw std::runtime_error("obj_parser : invalid face line.");
+  return p;
+}
+
+void parse_chunk(const char* begin, const char* end, parsed_chunk& chunk)
+{
+  // reused by the faces
+  std::vector<obj_index> polygon;
+  std::vector<uint8_t>   polygon_relatives;
+
+  auto add_corner = [&chunk](const obj_index& corner, uint8_t relative) {
+    if (relative != 0)
+      chunk.relatives.emplace_back(static_cast<uint32_t>(chunk.corners.size()), relative);
+    chunk.corners.push_back(corner);
+  };
+
+  for (const char* line = begin; line < end;) {
+    auto* line_end = static_cast<const char*>(std::memchr(line, '\n', end - line));
+    if (line_end == nullptr)
+      line_end = end;
+    const char* p = skip_spaces(line, line_end);
+    line = line_end + 1;
+
+    auto is_tag = [p, line_end](std::string_view tag) {
+      return static_cast<size_t>(line_end - p) > tag.size() && std::memcmp(p, tag.data(), tag.size()) == 0
+        && is_space(p[tag.size()]);
+    };
+
+    if (is_tag("v")) {
+      // "v x y z r g b", w is ignored
+      float values[6];
+      const char* q = p + 1;
+      int count = 0;
+      while (count < 6 && (q = read_float(q, line_end, values[count])) != nullptr) count++;
+      if (count < 3)
+        throw std::runtime_error("obj_parser : invalid v line.");
+      chunk.positions.insert(chunk.positions.end(), values, values + 3);
+      if (count == 6) chunk.colors.insert(chunk.colors.end(), values + 3, values + 6);
+      else            chunk.colors.insert(chunk.colors.end(), { 1.f, 1.f, 1.f });
+    }
+    else if (is_tag("vn")) {
+      float values[3];
+      read_floats(p + 2, line_end, values, 3, "vn");
+      chunk.normals.insert(chunk.normals.end(), values, values + 3);
+    }
+    else if (is_tag("vt")) {
+      // v is optional
+      float values[2] = { 0.f, 0.f };
+      const char* q = read_float(p + 2, line_end, values[0]);
+      if (q == nullptr)
+        throw std::runtime_error("obj_parser : invalid vt line.");
+      read_float(q, line_end, values[1]);
+      chunk.texcoords.insert(chunk.texcoords.end(), values, values + 2);
+    }
+    else if (is_tag("f")) {
+      polygon.clear();
+      polygon_relatives.clear();
+      for (const char* q = skip_spaces(p + 1, line_end); q < line_end && *q != '#'; q = skip_spaces(q, line_end)) {
+        obj_index corner;
+        uint8_t relative;
+        q = parse_corner(q, line_end, chunk, corner, relative);
+        polygon.push_back(corner);
+        polygon_relatives.push_back(relative);
+      }
+      // fan
+      for (size_t i = 2; i < polygon.size(); i++) {
+        add_corner(polygon[0], polygon_relatives[0]);
+        add_corner(polygon[i - 1], polygon_relatives[i - 1]);
+        add_corner(polygon[i], polygon_relatives[i]);
+      }
+    }
+    // comments, groups, materials and the others are ignored
+  }
+}
+
+// the values of a vertex
+std::array<float, 11> get_vertex_values(const obj_data& data, const obj_index& index)
+{
+  std::array<float, 11> res{};
+  std::memcpy(&res[0], &data.positions[3 * index.position], 3 * sizeof(float));
+  std::memcpy(&res[3], &data.colors[3 * index.position], 3 * sizeof(float));
+  if (index.normal >= 0)
+    std::memcpy(&res[6], &data.normals[3 * index.normal], 3 * sizeof(float));
+  if (index.texcoord >= 0)
+    std::memcpy(&res[9], &data.texcoords[2 * index.texcoord], 2 * sizeof(float));
+  return res;
+}
+
+// equal values have the same hash
+uint32_t hash_vertex_values(const std::array<float, 11>& values)
+{
+  uint64_t hash = 0;
+  for (float value : values) {
+    uint32_t bits = 0;
+    // -0 == 0
+    if (value != 0.f)
+      std::memcpy(&bits, &value, sizeof(bits));
+    hash = (hash ^ bits) * 0x9e3779b97f4a7c15ull;
+    hash ^= hash >> 29;
+  }
+  return static_cast<uint32_t>(hash ^ (hash >> 32));
+}
+
+bool has_same_values(const obj_data& data, const obj_index& a, const obj_index& b)
+{
+  if (a.position == b.position && a.texcoord == b.texcoord && a.normal == b.normal)
+    return true;
+  return get_vertex_values(data, a) == get_vertex_values(data, b);
+}
+
+// stable lsd radix sort of the keys by hash
+void sort_weld_keys(std::vector<weld_key>& keys, job_system* jobs)
+{
+  const size_t count = keys.size();
+  const size_t block_count = get_job_count(jobs, count, BLOCK_SIZE);
+  auto block_begin = [count, block_count](size_t block) { return block * count / block_count; };
+
+  std::vector<weld_key> sorted(count);
+  std::vector<uint32_t> offsets(block_count * RADIX_SIZE);
+  for (uint32_t shift = 0; shift < 32; shift += RADIX_BITS) {
+    std::fill(offsets.begin(), offsets.end(), 0);
+    for_each_job(jobs, block_count, [&](size_t block) {
+      auto* histogram = &offsets[block * RADIX_SIZE];
+      for (size_t i = block_begin(block); i < block_begin(block + 1); i++)
+        histogram[(keys[i].hash >> shift) & (RADIX_SIZE - 1)]++;
+    });
+    // the digits in order, and the blocks in order within a digit
+    uint32_t sum = 0;
+    for (uint32_t digit = 0; digit < RADIX_SIZE; digit++) {
+      for (size_t block = 0; block < block_count; block++) {
+        auto& offset = offsets[block * RADIX_SIZE + digit];
+        const auto block_digit_count = offset;
+        offset = sum;
+        sum += block_digit_count;
+      }
+    }
+    for_each_job(jobs, block_count, [&](size_t block) {
+      auto* offset = &offsets[block * RADIX_SIZE];
+      for (size_t i = block_begin(block); i < block_begin(block + 1); i++)
+        sorted[offset[(keys[i].hash >> shift) & (RADIX_SIZE - 1)]++] = keys[i];
+    });
+    keys.swap(sorted);
+  }
+}
+
+// fills data.vertices and data.indices
+void weld(obj_data& data, const std::vector<obj_index>& corners, job_system* jobs)
+{
+  const size_t count = corners.size();
+  if (count > std::numeric_limits<uint32_t>::max())
+    throw std::runtime_error("obj_parser : too many vertices.");
+  if (count == 0)
+    return;
+
+  const size_t block_count = get_job_count(jobs, count, BLOCK_SIZE);
+  auto block_begin = [count, block_count](size_t block) { return block * count / block_count; };
+
+  // the corners of the same values are adjacent after the sort, in their order
+  std::vector<weld_key> keys(count);
+  for_each_job(jobs, block_count, [&](size_t block) {
+    for (size_t i = block_begin(block); i < block_begin(block + 1); i++)
+      keys[i] = { hash_vertex_values(get_vertex_values(data, corners[i])), static_cast<uint32_t>(i) };
+  });
+  sort_weld_keys(keys, jobs);
+
+  // the first corner of the same values, a run of a hash isn't split between the blocks
+  std::vector<size_t> run_blocks(block_count + 1, count);
+  for (size_t block = 0; block < block_count; block++) {
+    auto begin = std::max(block_begin(block), block == 0 ? 0 : run_blocks[block - 1]);
+    while (begin > 0 && begin < count && keys[begin].hash == keys[begin - 1].hash) begin++;
+    run_blocks[block] = begin;
+  }
+  std::vector<uint32_t> firsts(count);
+  for_each_job(jobs, block_count, [&](size_t block) {
+    // distinct values of a run, usually one
+    std::vector<uint32_t> run_firsts;
+    for (size_t i = run_blocks[block]; i < run_blocks[block + 1]; i++) {
+      if (i == run_blocks[block] || keys[i].hash != keys[i - 1].hash)
+        run_firsts.clear();
+      const auto corner = keys[i].corner;
+      auto it = std::find_if(run_firsts.begin(), run_firsts.end(), [&](uint32_t first) {
+        return has_same_values(data, corners[first], corners[corner]);
+      });
+      if (it == run_firsts.end()) {
+        run_firsts.push_back(corner);
+        firsts[corner] = corner;
+      }
+      else
+        firsts[corner] = *it;
+    }
+  });
+
+  // vertex ids in the order of the first appearances
+  std::vector<uint32_t> block_vertex_counts(block_count + 1, 0);
+  for_each_job(jobs, block_count, [&](size_t block) {
+    for (size_t i = block_begin(block); i < block_begin(block + 1); i++)
+      block_vertex_counts[block + 1] += firsts[i] == i;
+  });
+  for (size_t block = 0; block < block_count; block++)
+    block_vertex_counts[block + 1] += block_vertex_counts[block];
+
+  data.vertices.resize(block_vertex_counts[block_count]);
+  data.indices.resize(count);
+  for_each_job(jobs, block_count, [&](size_t block) {
+    auto id = block_vertex_counts[block];
+    for (size_t i = block_begin(block); i < block_begin(block + 1); i++) {
+      if (firsts[i] != i)
+        continue;
+      data.vertices[id] = corners[i];
+      data.indices[i] = id++;
+    }
+  });
+  // the first corner precedes the others
+  for_each_job(jobs, block_count, [&](size_t block) {
+    for (size_t i = block_begin(block); i < block_begin(block + 1); i++)
+      if (firsts[i] != i)
+        data.indices[i] = data.indices[firsts[i]];
+  });
+}
+
+} // anonymous namespace
+
+const char* parse_float(const char* first, const char* last, float& value)
+{
+  const char* p = first;
+  bool negative = false;
+  if (p < last && (*p == '-' || *p == '+'))
+    negative = *p++ == '-';
+  const char* number = p;
+
+  uint64_t mantissa = 0;
+  int significant_digits = 0;
+  int exponent = 0;
+  bool has_digits = false, is_truncated = false;
+  auto add_digit = [&](char c) {
+    if (significant_digits < 19) {
+      mantissa = mantissa * 10 + (c - '0');
+      if (mantissa != 0) significant_digits++;
+      return true;
+    }
+    is_truncated |= c != '0';
+    return false;
+  };
+  for (; p < last && is_digit(*p); p++) {
+    has_digits = true;
+    if (!add_digit(*p)) exponent++;
+  }
+  if (p < last && *p == '.') {
+    for (p++; p < last && is_digit(*p); p++) {
+      has_digits = true;
+      if (add_digit(*p)) exponent--;
+    }
+  }
+  if (!has_digits)
+    return nullptr;
+  if (p < last && (*p == 'e' || *p == 'E')) {
+    int64_t exponent_value;
+    if (auto* q = parse_int(p + 1, last, exponent_value)) {
+      p = q;
+      exponent += static_cast<int>(std::clamp<int64_t>(exponent_value, -10000, 10000));
+    }
+  }
+
+  // exact : both of the mantissa and the power of 10 are exact doubles
+  if (!is_truncated && mantissa <= (uint64_t(1) << 53) && exponent >= -22 && exponent <= 22) {
+    double res = static_cast<double>(mantissa);
+    res = exponent < 0 ? res / POW10[-exponent] : res * POW10[exponent];
+    value = static_cast<float>(negative ? -res : res);
+    return p;
+  }
+  double res;
+  auto [end, error] = std::from_chars(number, p, res);
+  if (error != std::errc() && error != std::errc::result_out_of_range)
+    return nullptr;
+  value = static_cast<float>(negative ? -res : res);
+  return p;
+}
+
+obj_data parse_obj(std::string_view text, job_system* jobs)
+{
+  // line aligned chunks
+  const size_t chunk_count = get_job_count(jobs, text.size(), CHUNK_SIZE);
+  std::vector<size_t> chunk_begins(chunk_count + 1, text.size());
+  chunk_begins[0] = 0;
+  for (size_t i = 1; i < chunk_count; i++) {
+    auto begin = std::max(i * text.size() / chunk_count, chunk_begins[i - 1]);
+    auto* line_end = begin == 0 ? nullptr : std::memchr(text.data() + begin - 1, '\n', text.size() - begin + 1);
+    chunk_begins[i] = line_end ? static_cast<const char*>(line_end) - text.data() + 1 : text.size();
+  }
+
+  std::vector<parsed_chunk> chunks(chunk_count);
+  for_each_job(jobs, chunk_count, [&](size_t i) {
+    parse_chunk(text.data() + chunk_begins[i], text.data() + chunk_begins[i + 1], chunks[i]);
+  });
+
+  // offsets of the chunks
+  struct chunk_offset { size_t positions = 0, normals = 0, texcoords = 0, corners = 0; };
+  std::vector<chunk_offset> offsets(chunk_count + 1);
+  for (size_t i = 0; i < chunk_count; i++) {
+    offsets[i + 1].positions = offsets[i].positions + chunks[i].positions.size() / 3;
+    offsets[i + 1].normals   = offsets[i].normals   + chunks[i].normals.size()   / 3;
+    offsets[i + 1].texcoords = offsets[i].texcoords + chunks[i].texcoords.size() / 2;
+    offsets[i + 1].corners   = offsets[i].corners   + chunks[i].corners.size();
+  }
+  const auto& total = offsets[chunk_count];
+  if (total.positions > std::numeric_limits<int32_t>::max())
+    throw std::runtime_error("obj_parser : too many positions.");
+
+  obj_data data;
+  data.positions.resize(total.positions * 3);
+  data.colors.resize(total.positions * 3);
+  data.normals.resize(total.normals * 3);
+  data.texcoords.resize(total.texcoords * 2);
+  std::vector<obj_index> corners(total.corners);
+  for_each_job(jobs, chunk_count, [&](size_t i) {
+    auto& chunk = chunks[i];
+    const auto& offset = offsets[i];
+    std::copy(chunk.positions.begin(), chunk.positions.end(), data.positions.begin() + offset.positions * 3);
+    std::copy(chunk.colors.begin(),    chunk.colors.end(),    data.colors.begin()    + offset.positions * 3);
+    std::copy(chunk.normals.begin(),   chunk.normals.end(),   data.normals.begin()   + offset.normals * 3);
+    std::copy(chunk.texcoords.begin(), chunk.texcoords.end(), data.texcoords.begin() + offset.texcoords * 2);
+
+    auto* chunk_corners = corners.data() + offset.corners;
+    std::copy(chunk.corners.begin(), chunk.corners.end(), chunk_corners);
+    for (const auto& [corner, flags] : chunk.relatives) {
+      auto& index = chunk_corners[corner];
+      if (flags & RELATIVE_POSITION) index.position += static_cast<int32_t>(offset.positions);
+      if (flags & RELATIVE_TEXCOORD) index.texcoord += static_cast<int32_t>(offset.texcoords);
+      if (flags & RELATIVE_NORMAL)   index.normal   += static_cast<int32_t>(offset.normals);
+      // -1 is not absent here
+      if (index.position < 0 || ((flags & RELATIVE_TEXCOORD) && index.texcoord < 0) || ((flags & RELATIVE_NORMAL) && index.normal < 0))
+        throw std::runtime_error("obj_parser : index out of range in a face.");
+    }
+    for (size_t j = 0; j < chunk.corners.size(); j++) {
+      const auto& corner = chunk_corners[j];
+      if (corner.position < 0 || static_cast<size_t>(corner.position) >= total.positions
+        || corner.texcoord < -1 || (corner.texcoord >= 0 && static_cast<size_t>(corner.texcoord) >= total.texcoords)
+        || corner.normal < -1 || (corner.normal >= 0 && static_cast<size_t>(corner.normal) >= total.normals))
+        throw std::runtime_error("obj_parser : index out of range in a face.");
+    }
+    // not needed anymore
+    chunk = {};
+  });
+
+  weld(data, corners, jobs);
+  return data;
+}
+
+obj_data load_obj(const std::string& path, job_system* jobs)
+{
+  auto file = mapped_file::open(path);
+  if (file == nullptr)
+    throw std::runtime_error("obj_parser : failed to open " + path);
+  const auto bytes = file->get_bytes();
+  return parse_obj({ reinterpret_cast<const char*>(bytes.data()), bytes.size() }, jobs);
+}
+
+} // namespace hnll::utils
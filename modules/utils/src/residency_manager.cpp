@@ -0,0 +1,165 @@
+// hnll
+#include <utils/residency_manager.hpp>
+
+// std
+#include <algorithm>
+#include <vector>
+
+namespace hnll::utils {
+
+residency_id residency_manager::add(std::string name, size_t bytes, int priority, std::function<void()>&& evict)
+{
+  reload_hook hook;
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (evicted_names_.erase(name) > 0) {
+    stats_.reload_count++;
+    hook = reload_hook_;
+  }
+  stats_.resident_bytes += bytes;
+  stats_.peak_resident_bytes = std::max(stats_.peak_resident_bytes, stats_.resident_bytes);
+  auto id = entries_.emplace(entry{ name, bytes, priority, 0, frame_count_, false, std::move(evict) });
+  lock.unlock();
+
+  if (hook) hook(name);
+  return id;
+}
+
+void residency_manager::remove(residency_id id)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (auto* e = entries_.get(id)) {
+    stats_.resident_bytes -= e->bytes;
+    entries_.erase(id);
+  }
+}
+
+void residency_manager::clear()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+  stats_.resident_bytes = 0;
+}
+
+void residency_manager::acquire(residency_id id)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (auto* e = entries_.get(id)) {
+    e->ref_count++;
+    e->last_use_frame = frame_count_;
+  }
+}
+
+void residency_manager::release(residency_id id)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (auto* e = entries_.get(id)) {
+    if (e->ref_count > 0) e->ref_count--;
+    e->last_use_frame = frame_count_;
+  }
+}
+
+void residency_manager::touch(residency_id id)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (auto* e = entries_.get(id))
+    e->last_use_frame = frame_count_;
+}
+
+void residency_manager::pin(residency_id id)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (auto* e = entries_.get(id))
+    e->is_pinned = true;
+}
+
+void residency_manager::set_priority(residency_id id, int priority)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (auto* e = entries_.get(id))
+    e->priority = priority;
+}
+
+void residency_manager::next_frame()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  frame_count_++;
+}
+
+size_t residency_manager::trim()
+{
+  std::vector<entry> victims;
+  eviction_hook hook;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stats_.resident_bytes <= budget_bytes_)
+      return 0;
+
+    std::vector<residency_id> candidates;
+    for (size_t i = 0; i < entries_.size(); i++)
+      if (entries_.get_values()[i].ref_count == 0 && !entries_.get_values()[i].is_pinned)
+        candidates.push_back(entries_.get_handle(i));
+    std::sort(candidates.begin(), candidates.end(), [this](residency_id a, residency_id b) {
+      const auto& ea = *entries_.get(a);
+      const auto& eb = *entries_.get(b);
+      if (ea.priority != eb.priority) return ea.priority < eb.priority;
+      return ea.last_use_frame < eb.last_use_frame;
+    });
+
+    for (auto id : candidates) {
+      if (stats_.resident_bytes <= budget_bytes_)
+        break;
+      auto* e = entries_.get(id);
+      stats_.resident_bytes -= e->bytes;
+      stats_.evicted_bytes  += e->bytes;
+      stats_.eviction_count++;
+      evicted_names_.insert(e->name);
+      victims.emplace_back(std::move(*e));
+      entries_.erase(id);
+    }
+    if (stats_.resident_bytes > budget_bytes_)
+      stats_.over_budget_count++;
+    hook = eviction_hook_;
+  }
+
+  // the callbacks may use the manager
+  size_t evicted = 0;
+  for (auto& victim : victims) {
+    if (victim.evict) victim.evict();
+    if (hook)         hook(victim.name, victim.bytes);
+    evicted += victim.bytes;
+  }
+  return evicted;
+}
+
+bool residency_manager::contains(residency_id id) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.contains(id);
+}
+
+uint32_t residency_manager::get_ref_count(residency_id id) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto* e = entries_.get(id);
+  return e != nullptr ? e->ref_count : 0;
+}
+
+size_t residency_manager::get_resident_bytes() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_.resident_bytes;
+}
+
+size_t residency_manager::get_resource_count() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+residency_stats residency_manager::get_stats() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+} // namespace hnll::utils
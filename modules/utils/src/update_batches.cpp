@@ -0,0 +1,107 @@
+// hnll
+#include <utils/update_batches.hpp>
+
+// std
+#include <algorithm>
+
+namespace hnll::utils {
+
+namespace {
+
+void insert_sorted(std::vector<resource_id>& ids, resource_id id)
+{
+  auto it = std::lower_bound(ids.begin(), ids.end(), id);
+  if (it == ids.end() || *it != id)
+    ids.insert(it, id);
+}
+
+void erase_sorted(std::vector<resource_id>& ids, resource_id id)
+{
+  auto it = std::lower_bound(ids.begin(), ids.end(), id);
+  if (it != ids.end() && *it == id)
+    ids.erase(it);
+}
+
+bool intersects(const std::vector<resource_id>& a, const std::vector<resource_id>& b)
+{
+  auto i = a.begin();
+  auto j = b.begin();
+  while (i != a.end() && j != b.end()) {
+    if (*i == *j) return true;
+    if (*i < *j) i++;
+    else         j++;
+  }
+  return false;
+}
+
+} // anonymous namespace
+
+// ------------------------------- access_list
+access_list& access_list::read(resource_id id)
+{
+  if (!std::binary_search(writes_.begin(), writes_.end(), id))
+    insert_sorted(reads_, id);
+  return *this;
+}
+
+access_list& access_list::write(resource_id id)
+{
+  erase_sorted(reads_, id);
+  insert_sorted(writes_, id);
+  return *this;
+}
+
+void access_list::merge(const access_list& other)
+{
+  is_exclusive_ |= other.is_exclusive_;
+  for (auto id : other.writes_) write(id);
+  for (auto id : other.reads_)  read(id);
+}
+
+void access_list::clear()
+{
+  reads_.clear();
+  writes_.clear();
+  is_exclusive_ = false;
+}
+
+bool access_list::conflicts_with(const access_list& other) const
+{
+  if (is_exclusive_ || other.is_exclusive_)
+    return true;
+  return intersects(writes_, other.writes_)
+    || intersects(writes_, other.reads_)
+    || intersects(reads_, other.writes_);
+}
+
+// ------------------------------- update_batches
+void update_batches::clear()
+{
+  batches_.clear();
+  batch_access_.clear();
+  task_count_ = 0;
+}
+
+uint32_t update_batches::add(const access_list& access)
+{
+  // right after the last batch it conflicts with
+  size_t level = 0;
+  for (size_t b = batches_.size(); b-- > 0;) {
+    if (batch_access_[b].conflicts_with(access)) {
+      level = b + 1;
+      break;
+    }
+  }
+  if (access.is_exclusive())
+    level = batches_.size();
+
+  if (level == batches_.size()) {
+    batches_.emplace_back();
+    batch_access_.emplace_back();
+  }
+  batches_[level].push_back(task_count_);
+  batch_access_[level].merge(access);
+  return task_count_++;
+}
+
+} // namespace hnll::utils
@@ -1,15 +1,60 @@
 // hnll
 #include <utils/utils.hpp>
+#include <utils/vfs.hpp>
 
 // std
+#include <cerrno>
 #include <filesystem>
+#include <mutex>
 #include <sys/stat.h>
 #include <dirent.h>
 
 namespace hnll::utils {
 
+namespace {
+
+std::vector<std::string> default_packs;
+std::mutex               default_packs_mutex;
+bool                     is_default_vfs_created = false;
+
+} // anonymous namespace
+
+void add_default_pack(const std::string& pack_path)
+{
+  std::lock_guard<std::mutex> lock(default_packs_mutex);
+  if (is_default_vfs_created)
+    throw std::runtime_error("add_default_pack : the default vfs is already indexed");
+  default_packs.push_back(pack_path);
+}
+
+vfs& get_default_vfs()
+{
+  static std::unique_ptr<vfs> default_vfs;
+  static std::once_flag flag;
+  std::call_once(flag, [] {
+    std::lock_guard<std::mutex> lock(default_packs_mutex);
+    is_default_vfs_created = true;
+    default_vfs = vfs::create();
+    for (const auto& pack : default_packs)
+      default_vfs->mount_pack(pack);
+    for (const auto& directory : utils::loading_directories)
+      if (std::filesystem::is_directory(directory))
+        default_vfs->mount_directory(directory);
+  });
+  return *default_vfs;
+}
+
 std::string get_full_path(const std::string& _filename)
 {
+  // a hash lookup instead of a stat per directory
+  const auto& fs = get_default_vfs();
+  if (auto real_path = fs.get_real_path(_filename))
+    return *real_path;
+  // a packed file shadows the directories, as in the other lookups, and has no path
+  if (fs.exists(_filename))
+    return "";
+
+  // the files made after the indexing, e.g. the caches
   std::string filepath = "";
   for (const auto& directory : utils::loading_directories) {
     if (std::filesystem::exists(directory + "/" + _filename)) {
@@ -30,7 +75,8 @@ void mkdir_p(const std::string& _dir_name)
   if (stat(_dir_name.c_str(), &buffer) == 0)
     return;
   else {
-    if (mkdir(_dir_name.c_str(), 0777) != 0)
+    // another thread may have made it meanwhile
+    if (mkdir(_dir_name.c_str(), 0777) != 0 && errno != EEXIST)
       throw std::runtime_error("failed to make directory : " + _dir_name);
   }
 }
@@ -52,6 +98,11 @@ std::string create_sub_cache_directory(const std::string& _dir_name)
   return cache_directory;
 }
 
+std::string get_cooked_path(const std::string& _asset_name, const std::string& _kind)
+{
+  return create_sub_cache_directory("cooked") + "/" + _asset_name + "." + _kind + ".hpk";
+}
+
 Eigen::Matrix4d transform::mat4() const
 {
   const float c3 = std::cos(rotation.z), s3 = std::sin(rotation.z), c2 = std::cos(rotation.x),
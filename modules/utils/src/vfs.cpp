@@ -0,0 +1,272 @@
+// hnll
+#include <utils/vfs.hpp>
+
+// std
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace hnll::utils {
+
+namespace {
+
+struct pack_header
+{
+  uint32_t magic;
+  uint32_t version;
+  // power of two, at least twice the file count
+  uint32_t slot_count;
+  uint32_t file_count;
+  uint64_t reserved[2];
+};
+
+// empty if path_size is 0
+struct pack_slot
+{
+  uint64_t hash;
+  uint64_t data_offset;
+  uint64_t data_size;
+  uint32_t path_offset;
+  uint32_t path_size;
+};
+
+static_assert(sizeof(pack_header) == 32 && sizeof(pack_slot) == 32);
+
+constexpr size_t PACK_DATA_ALIGNMENT = 16;
+
+size_t align_up(size_t value, size_t alignment)
+{ return (value + alignment - 1) / alignment * alignment; }
+
+} // anonymous namespace
+
+uint64_t hash_path(std::string_view path)
+{
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (char c : path) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 0x100000001b3ull;
+  }
+  return hash;
+}
+
+// mapped_file -------------------------------------------------------------------------
+
+std::shared_ptr<const mapped_file> mapped_file::open(const std::string& path)
+{
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return nullptr;
+  struct stat info;
+  if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+    ::close(fd);
+    return nullptr;
+  }
+
+  const auto size = static_cast<size_t>(info.st_size);
+  void* data = nullptr;
+  // an empty file can't be mapped
+  if (size > 0) {
+    data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      ::close(fd);
+      return nullptr;
+    }
+  }
+  // the mapping outlives the descriptor
+  ::close(fd);
+  return std::make_shared<const mapped_file>(data, size);
+}
+
+mapped_file::~mapped_file()
+{
+  if (data_ != nullptr)
+    munmap(const_cast<void*>(data_), size_);
+}
+
+// vfs ---------------------------------------------------------------------------------
+
+void vfs::mount_directory(const std::string& directory)
+{
+  if (!std::filesystem::is_directory(directory))
+    throw std::runtime_error("vfs : " + directory + " is not a directory.");
+
+  mount m;
+  for (const auto& entry : std::filesystem::recursive_directory_iterator(directory)) {
+    if (!entry.is_regular_file())
+      continue;
+    auto relative = std::filesystem::relative(entry.path(), directory).generic_string();
+    m.files.emplace(std::move(relative), entry.path().string());
+  }
+  mounts_.emplace_back(std::move(m));
+}
+
+void vfs::mount_pack(const std::string& pack_path)
+{
+  auto pack = mapped_file::open(pack_path);
+  if (pack == nullptr)
+    throw std::runtime_error("vfs : failed to open " + pack_path);
+
+  const auto bytes = pack->get_bytes();
+  pack_header header;
+  if (bytes.size() < sizeof(header))
+    throw std::runtime_error("vfs : " + pack_path + " is not a pack.");
+  std::memcpy(&header, bytes.data(), sizeof(header));
+  if (header.magic != PACK_MAGIC)
+    throw std::runtime_error("vfs : " + pack_path + " is not a pack.");
+  if (header.version != PACK_VERSION)
+    throw std::runtime_error("vfs : " + pack_path + " is of another version.");
+  const bool is_pow2 = header.slot_count > 0 && (header.slot_count & (header.slot_count - 1)) == 0;
+  if (!is_pow2 || sizeof(header) + size_t(header.slot_count) * sizeof(pack_slot) > bytes.size())
+    throw std::runtime_error("vfs : " + pack_path + " has a broken table.");
+
+  mount m;
+  m.pack = std::move(pack);
+  mounts_.emplace_back(std::move(m));
+}
+
+void vfs::write_pack(const std::string& directory, const std::string& pack_path)
+{
+  std::vector<std::pair<std::string, std::string>> files;
+  for (const auto& entry : std::filesystem::recursive_directory_iterator(directory))
+    if (entry.is_regular_file())
+      files.emplace_back(std::filesystem::relative(entry.path(), directory).generic_string(), entry.path().string());
+  // the same pack for the same files
+  std::sort(files.begin(), files.end());
+
+  uint32_t slot_count = 2;
+  while (slot_count < files.size() * 2) slot_count *= 2;
+
+  std::vector<pack_slot> slots(slot_count);
+  std::string paths;
+  const size_t table_end = sizeof(pack_header) + slot_count * sizeof(pack_slot);
+  for (const auto& file : files)
+    paths += file.first;
+  size_t data_offset = align_up(table_end + paths.size(), PACK_DATA_ALIGNMENT);
+
+  std::ofstream out(pack_path, std::ios::binary | std::ios::trunc);
+  if (!out)
+    throw std::runtime_error("vfs : failed to open " + pack_path);
+  // the table is written after the data offsets are known
+  out.seekp(static_cast<std::streamoff>(data_offset));
+
+  uint32_t path_offset = static_cast<uint32_t>(table_end);
+  std::vector<char> contents;
+  for (const auto& [relative, real_path] : files) {
+    std::ifstream in(real_path, std::ios::binary | std::ios::ate);
+    if (!in)
+      throw std::runtime_error("vfs : failed to read " + real_path);
+    contents.resize(static_cast<size_t>(in.tellg()));
+    in.seekg(0);
+    in.read(contents.data(), static_cast<std::streamsize>(contents.size()));
+
+    pack_slot slot{ hash_path(relative), data_offset, contents.size(), path_offset, static_cast<uint32_t>(relative.size()) };
+    // linear probing
+    auto index = slot.hash & (slot_count - 1);
+    while (slots[index].path_size != 0)
+      index = (index + 1) & (slot_count - 1);
+    slots[index] = slot;
+
+    out.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+    const auto next = align_up(data_offset + contents.size(), PACK_DATA_ALIGNMENT);
+    for (auto i = data_offset + contents.size(); i < next; i++)
+      out.put(0);
+    data_offset = next;
+    path_offset += static_cast<uint32_t>(relative.size());
+  }
+
+  pack_header header{ PACK_MAGIC, PACK_VERSION, slot_count, static_cast<uint32_t>(files.size()), {} };
+  out.seekp(0);
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  out.write(reinterpret_cast<const char*>(slots.data()), static_cast<std::streamsize>(slots.size() * sizeof(pack_slot)));
+  out.write(paths.data(), static_cast<std::streamsize>(paths.size()));
+  if (!out)
+    throw std::runtime_error("vfs : failed to write " + pack_path);
+}
+
+const std::string* vfs::find_directory_file(const mount& m, std::string_view path) const
+{
+  auto it = m.files.find(path);
+  if (it == m.files.end())
+    return nullptr;
+  if (!checks_stale_files_)
+    return &it->second;
+  // the index may be stale : the removed files fall through to the later mounts
+  std::error_code error;
+  return std::filesystem::is_regular_file(it->second, error) ? &it->second : nullptr;
+}
+
+std::optional<std::span<const std::byte>> vfs::find_packed_file(const mapped_file& pack, std::string_view path)
+{
+  const auto bytes = pack.get_bytes();
+  pack_header header;
+  std::memcpy(&header, bytes.data(), sizeof(header));
+
+  const auto hash = hash_path(path);
+  auto index = hash & (header.slot_count - 1);
+  for (uint32_t probe = 0; probe < header.slot_count; probe++) {
+    pack_slot slot;
+    std::memcpy(&slot, bytes.data() + sizeof(header) + index * sizeof(pack_slot), sizeof(slot));
+    if (slot.path_size == 0)
+      return std::nullopt;
+    if (slot.hash == hash && size_t(slot.path_offset) + slot.path_size <= bytes.size()) {
+      std::string_view slot_path(reinterpret_cast<const char*>(bytes.data()) + slot.path_offset, slot.path_size);
+      if (slot_path == path) {
+        if (slot.data_offset + slot.data_size > bytes.size())
+          throw std::runtime_error("vfs : the pack has a broken entry " + std::string(path));
+        return bytes.subspan(slot.data_offset, slot.data_size);
+      }
+    }
+    index = (index + 1) & (header.slot_count - 1);
+  }
+  return std::nullopt;
+}
+
+bool vfs::exists(std::string_view path) const
+{
+  for (const auto& m : mounts_) {
+    if (m.pack ? find_packed_file(*m.pack, path).has_value() : find_directory_file(m, path) != nullptr)
+      return true;
+  }
+  return false;
+}
+
+vfs_file vfs::open(std::string_view path) const
+{
+  for (const auto& m : mounts_) {
+    if (m.pack) {
+      if (auto bytes = find_packed_file(*m.pack, path))
+        return { m.pack, *bytes };
+    }
+    else if (auto* real_path = find_directory_file(m, path)) {
+      auto mapping = mapped_file::open(*real_path);
+      // removed since the check
+      if (mapping == nullptr)
+        continue;
+      auto bytes = mapping->get_bytes();
+      return { std::move(mapping), bytes };
+    }
+  }
+  return {};
+}
+
+std::optional<std::string> vfs::get_real_path(std::string_view path) const
+{
+  for (const auto& m : mounts_) {
+    if (m.pack) {
+      // shadows the later mounts
+      if (find_packed_file(*m.pack, path))
+        return std::nullopt;
+    }
+    else if (auto* real_path = find_directory_file(m, path))
+      return *real_path;
+  }
+  return std::nullopt;
+}
+
+} // namespace hnll::utils
@@ -0,0 +1,65 @@
+// hnll
+#include <audio/audio_thread.hpp>
+
+// lib
+#include <gtest/gtest.h>
+
+// std
+#include <stdexcept>
+
+using namespace hnll::audio;
+
+namespace {
+
+u_ptr<audio_thread> create_loopback_thread(size_t command_capacity = audio_thread::DEFAULT_COMMAND_CAPACITY)
+{
+  try { return audio_thread::create(device_type::LOOPBACK, command_capacity); }
+  catch (const std::runtime_error&) { return nullptr; }
+}
+
+} // anonymous namespace
+
+TEST(audio_thread, loopback_playback)
+{
+  auto audio = create_loopback_thread();
+  if (!audio) GTEST_SKIP() << "ALC_SOFT_loopback is not available";
+
+  auto buffer = audio->create_buffer();
+  auto uploaded = audio->upload(buffer, std::vector<ALshort>(44100, 16384));
+  auto source = audio->create_source();
+  audio->bind(source, buffer);
+  audio->set_looping(source, true);
+  audio->play(source);
+
+  // render() waits for every previous command
+  std::vector<float> samples(2 * 512, 0.f);
+  audio->render(samples);
+  EXPECT_TRUE(audio->is_complete(uploaded));
+  EXPECT_EQ(audio->get_failed_source_count(), 0);
+
+  float peak = 0.f;
+  for (auto sample : samples)
+    peak = std::max(peak, std::abs(sample));
+  EXPECT_GT(peak, 0.1f);
+}
+
+TEST(audio_thread, ordering_and_backpressure)
+{
+  // a tiny ring, so the game thread has to wait for the audio thread
+  auto audio = create_loopback_thread(8);
+  if (!audio) GTEST_SKIP() << "ALC_SOFT_loopback is not available";
+
+  std::vector<command_ticket> tickets;
+  for (int i = 0; i < 200; i++) {
+    auto buffer = audio->create_buffer();
+    tickets.push_back(audio->upload(buffer, std::vector<ALshort>(256, ALshort(i))));
+    audio->delete_buffer(buffer);
+  }
+  // the tickets complete in order
+  audio->wait(tickets[100]);
+  for (int i = 0; i <= 100; i++)
+    EXPECT_TRUE(audio->is_complete(tickets[i]));
+
+  audio->flush();
+  EXPECT_TRUE(audio->is_complete(tickets.back()));
+}
@@ -0,0 +1,152 @@
+// hnll
+#include <audio/fft.hpp>
+#include <audio/convolver.hpp>
+#include <audio/hrtf_set.hpp>
+#include <audio/spatial_mixer.hpp>
+
+// lib
+#include <gtest/gtest.h>
+
+// std
+#include <cmath>
+#include <random>
+
+using namespace hnll::audio;
+
+namespace {
+
+std::vector<float> create_noise(size_t count, uint32_t seed)
+{
+  std::mt19937 engine(seed);
+  std::uniform_real_distribution<float> dist(-1.f, 1.f);
+  std::vector<float> res(count);
+  for (auto& sample : res) sample = dist(engine);
+  return res;
+}
+
+float energy(std::span<const float> samples, size_t offset, size_t stride)
+{
+  float res = 0.f;
+  for (size_t i = offset; i < samples.size(); i += stride)
+    res += samples[i] * samples[i];
+  return res;
+}
+
+} // anonymous namespace
+
+TEST(fft, against_dft)
+{
+  for (size_t size : { 4, 16, 512 }) {
+    fft transform(size);
+    auto input = create_noise(size, 1);
+    std::vector<float> re(transform.get_bin_count()), im(transform.get_bin_count()), output(size);
+    transform.forward(input.data(), re.data(), im.data());
+
+    for (size_t k = 0; k < transform.get_bin_count(); k++) {
+      double expected_re = 0.0, expected_im = 0.0;
+      for (size_t n = 0; n < size; n++) {
+        expected_re += input[n] * std::cos(2.0 * M_PI * double(k * n) / size);
+        expected_im -= input[n] * std::sin(2.0 * M_PI * double(k * n) / size);
+      }
+      EXPECT_NEAR(re[k], expected_re, 1e-3);
+      EXPECT_NEAR(im[k], expected_im, 1e-3);
+    }
+
+    transform.inverse(re.data(), im.data(), output.data());
+    for (size_t n = 0; n < size; n++)
+      EXPECT_NEAR(output[n], input[n], 1e-5);
+  }
+}
+
+TEST(convolver, against_direct_convolution)
+{
+  // an impulse response of several partitions, not a multiple of the block size
+  const size_t block_size = 64;
+  auto impulse_response = create_noise(1000, 2);
+  auto input = create_noise(block_size * 40, 3);
+
+  auto filter = partitioned_filter::create(impulse_response, block_size);
+  EXPECT_EQ(filter->get_partition_count(), 16);
+  convolver conv(block_size, filter->get_partition_count());
+  std::vector<float> output(input.size());
+  conv.process(input, *filter, output);
+
+  for (size_t n = 0; n < input.size(); n++) {
+    double expected = 0.0;
+    for (size_t m = 0; m < impulse_response.size() && m <= n; m++)
+      expected += impulse_response[m] * input[n - m];
+    EXPECT_NEAR(output[n], expected, 2e-3);
+  }
+}
+
+TEST(hrtf_set, spherical_head)
+{
+  const size_t block_size = 128;
+  auto hrtfs = hrtf_set::create_spherical_head(48000.0, block_size);
+  EXPECT_EQ(hrtfs->get_entry_count(), 3 * 24 + 2);
+  EXPECT_EQ(hrtfs->get_max_partition_count(), 1);
+
+  // a source on the right is louder and earlier on the right ear
+  const auto& right = hrtfs->get_entry(hrtfs->find_nearest({ 1.0, 0.0, 0.0 }));
+  EXPECT_NEAR(right.direction.x(), 1.0, 1e-9);
+
+  convolver conv(block_size, 1);
+  std::vector<float> impulse(block_size, 0.f), left_ear(block_size), right_ear(block_size);
+  impulse[0] = 1.f;
+  conv.push(impulse);
+  conv.convolve(*right.left, left_ear);
+  conv.convolve(*right.right, right_ear);
+
+  auto onset = [](const std::vector<float>& samples) {
+    return std::find_if(samples.begin(), samples.end(), [](float s) { return std::abs(s) > 1e-3f; }) - samples.begin();
+  };
+  EXPECT_GT(energy(right_ear, 0, 1), 2.f * energy(left_ear, 0, 1));
+  EXPECT_GT(onset(left_ear), onset(right_ear) + 20);
+}
+
+TEST(spatial_mixer, crossfade_and_reverb)
+{
+  const size_t block_size = 128;
+  s_ptr<hrtf_set> hrtfs = hrtf_set::create_spherical_head(48000.0, block_size);
+  // one second of decaying noise
+  auto reverb = create_noise(48000, 4);
+  for (size_t i = 0; i < reverb.size(); i++)
+    reverb[i] *= 0.01f * std::exp(-6.f * float(i) / 48000.f);
+
+  // the same voice in two mixers. only the first one moves
+  spatial_mixer mixer(hrtfs, reverb), still(hrtfs, reverb);
+  auto id = mixer.add_voice();
+  still.add_voice();
+  for (auto* m : { &mixer, &still }) {
+    m->set_direction(id, { 1.0, 0.0, 0.0 });
+    m->set_reverb_send(id, 0.5f);
+  }
+
+  std::vector<float> tone(block_size), stereo(2 * block_size), still_stereo(2 * block_size);
+  size_t n = 0;
+  auto next_block = [&] {
+    for (auto& sample : tone) sample = std::sin(2.f * float(M_PI) * 4000.f * float(n++) / 48000.f);
+    mixer.process_voice(id, tone);
+    mixer.render(stereo);
+    still.process_voice(id, tone);
+    still.render(still_stereo);
+  };
+
+  for (int i = 0; i < 4; i++) next_block();
+  EXPECT_GT(energy(stereo, 1, 2), 1.5f * energy(stereo, 0, 2));
+
+  // the voice moves to the left. the crossfade starts from the old filter
+  mixer.set_direction(id, { -1.0, 0.0, 0.0 });
+  next_block();
+  EXPECT_NEAR(stereo[0], still_stereo[0], 1e-6);
+  EXPECT_NEAR(stereo[1], still_stereo[1], 1e-6);
+  for (int i = 0; i < 4; i++) next_block();
+  EXPECT_GT(energy(stereo, 0, 2), 1.5f * energy(stereo, 1, 2));
+
+  // the reverb tail outlives the voice
+  mixer.remove_voice(id);
+  mixer.render(stereo);
+  EXPECT_GT(energy(stereo, 0, 2), 0.f);
+  EXPECT_EQ(mixer.get_voice_count(), 0);
+  EXPECT_THROW(mixer.set_gain(spatial_mixer::DEFAULT_MAX_VOICE_COUNT, 0.5f), std::runtime_error);
+}
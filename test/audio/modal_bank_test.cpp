@@ -0,0 +1,84 @@
+// hnll
+#include <audio/modal_bank.hpp>
+
+// lib
+#include <gtest/gtest.h>
+
+// std
+#include <cmath>
+
+using hnll::audio::modal_bank;
+using hnll::audio::modal_mode;
+
+TEST(modal_bank, damped_sine)
+{
+  const double rate = 48000.0;
+  modal_bank bank(rate);
+  const modal_mode mode = { 440.f, 6.f, 0.5f };
+  auto id = bank.add_material(std::span<const modal_mode>(&mode, 1));
+  bank.excite(id, 2.f);
+
+  // rendered in uneven blocks
+  std::vector<float> output(5000, 0.f);
+  bank.render(std::span<float>(output.data(), 700));
+  bank.render(std::span<float>(output.data() + 700, output.size() - 700));
+
+  for (size_t n = 0; n < output.size(); n++) {
+    const double t = double(n + 1) / rate;
+    const double expected = 1.0 * std::exp(-6.0 * t) * std::sin(2.0 * M_PI * 440.0 * t);
+    EXPECT_NEAR(output[n], expected, 1e-4);
+  }
+}
+
+TEST(modal_bank, superposition)
+{
+  const double rate = 44100.0;
+  const float ratios[] = { 1.f, 2.756f, 5.404f, 8.933f, 13.344f };
+  const auto modes = modal_bank::create_rayleigh_modes(300.f, ratios, 5.f, 1e-7f);
+
+  // many hits at once equal the sum of the hits
+  modal_bank bank(rate);
+  auto id = bank.add_material(modes);
+  const int hit_count = 300;
+  for (int i = 0; i < hit_count; i++)
+    bank.excite(id, 0.01f);
+  EXPECT_EQ(bank.get_active_mode_count(), hit_count * modes.size());
+
+  modal_bank single(rate);
+  single.add_material(modes);
+  single.excite(0, 0.01f * hit_count);
+
+  std::vector<float> many_output(2048, 0.f), single_output(2048, 0.f);
+  bank.render(many_output);
+  single.render(single_output);
+  for (size_t n = 0; n < many_output.size(); n++)
+    EXPECT_NEAR(many_output[n], single_output[n], 1e-3);
+}
+
+TEST(modal_bank, retires_silent_modes)
+{
+  const double rate = 44100.0;
+  modal_bank bank(rate, 8);
+  const modal_mode modes[] = { { 100.f, 200.f, 1.f }, { 25000.f, 1.f, 1.f }, { 1000.f, 1.f, 1.f } };
+  // the mode above nyquist is discarded
+  auto id = bank.add_material(modes);
+  bank.excite(id, 1.f);
+  EXPECT_EQ(bank.get_active_mode_count(), 2);
+
+  // the bank is full
+  for (int i = 0; i < 4; i++)
+    bank.excite(id, 1.f);
+  EXPECT_EQ(bank.get_active_mode_count(), 8);
+  EXPECT_EQ(bank.get_dropped_mode_count(), 2);
+
+  // the fast mode decays below the threshold in 0.1 s
+  std::vector<float> output(static_cast<size_t>(rate * 0.1), 0.f);
+  bank.render(output);
+  EXPECT_EQ(bank.get_active_mode_count(), 4);
+
+  bank.clear();
+  std::fill(output.begin(), output.end(), 0.f);
+  bank.render(output);
+  for (auto sample : output)
+    EXPECT_EQ(sample, 0.f);
+}
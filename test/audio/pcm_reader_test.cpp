@@ -0,0 +1,140 @@
+// hnll
+#include <audio/pcm_reader.hpp>
+#include <audio/streaming_source.hpp>
+#include <audio/engine.hpp>
+
+// lib
+#include <gtest/gtest.h>
+
+// std
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+using namespace hnll::audio;
+
+namespace {
+
+void append_u32(std::vector<char>& bytes, uint32_t value)
+{ for (int i = 0; i < 4; i++) bytes.push_back(static_cast<char>(value >> (8 * i))); }
+
+void append_u16(std::vector<char>& bytes, uint16_t value)
+{ for (int i = 0; i < 2; i++) bytes.push_back(static_cast<char>(value >> (8 * i))); }
+
+void append_tag(std::vector<char>& bytes, const char* tag)
+{ bytes.insert(bytes.end(), tag, tag + 4); }
+
+// writes a PCM WAV file with an extra chunk before the data
+std::string write_wav(const std::string& name, uint16_t channel_count, uint16_t bits_per_sample, uint32_t rate, const std::vector<char>& data)
+{
+  std::vector<char> bytes;
+  append_tag(bytes, "RIFF");
+  append_u32(bytes, 0);
+  append_tag(bytes, "WAVE");
+  append_tag(bytes, "fmt ");
+  append_u32(bytes, 16);
+  append_u16(bytes, 1);
+  append_u16(bytes, channel_count);
+  append_u32(bytes, rate);
+  append_u32(bytes, rate * channel_count * bits_per_sample / 8);
+  append_u16(bytes, static_cast<uint16_t>(channel_count * bits_per_sample / 8));
+  append_u16(bytes, bits_per_sample);
+  // odd sized chunk, padded
+  append_tag(bytes, "LIST");
+  append_u32(bytes, 3);
+  bytes.insert(bytes.end(), { 'a', 'b', 'c', 0 });
+  append_tag(bytes, "data");
+  append_u32(bytes, static_cast<uint32_t>(data.size()));
+  bytes.insert(bytes.end(), data.begin(), data.end());
+
+  auto path = (std::filesystem::temp_directory_path() / name).string();
+  std::ofstream(path, std::ios::binary).write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+  return path;
+}
+
+std::vector<char> to_bytes(const std::vector<ALshort>& samples)
+{
+  std::vector<char> res(samples.size() * sizeof(ALshort));
+  std::memcpy(res.data(), samples.data(), res.size());
+  return res;
+}
+
+} // anonymous namespace
+
+TEST(pcm_reader, wav_mono16)
+{
+  std::vector<ALshort> samples(10000);
+  for (size_t i = 0; i < samples.size(); i++)
+    samples[i] = static_cast<ALshort>(i * 7 - 30000);
+  auto path = write_wav("hnll_mono16.wav", 1, 16, 22050, to_bytes(samples));
+
+  auto reader = pcm_reader::create_from_wav(path);
+  EXPECT_EQ(reader->get_format(), AL_FORMAT_MONO16);
+  EXPECT_EQ(reader->get_sampling_rate(), 22050);
+  EXPECT_EQ(reader->get_frame_count(), samples.size());
+
+  // uneven chunks
+  std::vector<ALshort> chunk(777), result;
+  while (auto count = reader->read(chunk))
+    result.insert(result.end(), chunk.begin(), chunk.begin() + count);
+  EXPECT_TRUE(reader->is_end());
+  EXPECT_EQ(result, samples);
+
+  reader->seek(9000);
+  EXPECT_EQ(reader->read(chunk), 777);
+  EXPECT_EQ(chunk[0], samples[9000]);
+  std::filesystem::remove(path);
+}
+
+TEST(pcm_reader, wav_stereo8_and_raw)
+{
+  std::vector<char> data = { char(0), char(128), char(255), char(64) };
+  auto path = write_wav("hnll_stereo8.wav", 2, 8, 8000, data);
+  auto reader = pcm_reader::create_from_wav(path);
+  EXPECT_EQ(reader->get_format(), AL_FORMAT_STEREO16);
+  EXPECT_EQ(reader->get_frame_count(), 2);
+
+  // whole frames only, widened to 16 bit
+  std::vector<ALshort> chunk(3);
+  EXPECT_EQ(reader->read(chunk), 2);
+  EXPECT_EQ(chunk[0], -32768);
+  EXPECT_EQ(chunk[1], 0);
+  EXPECT_EQ(reader->read(chunk), 2);
+  EXPECT_EQ(chunk[0], 127 << 8);
+  EXPECT_EQ(chunk[1], -64 << 8);
+  EXPECT_EQ(reader->read(chunk), 0);
+  std::filesystem::remove(path);
+
+  auto raw_path = (std::filesystem::temp_directory_path() / "hnll_raw.pcm").string();
+  std::vector<ALshort> samples = { 1, -2, 3, -4, 5 };
+  auto bytes = to_bytes(samples);
+  std::ofstream(raw_path, std::ios::binary).write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+  auto raw = pcm_reader::create_from_raw(raw_path, 1, 44100);
+  std::vector<ALshort> result(8);
+  EXPECT_EQ(raw->read(result), 5);
+  EXPECT_TRUE(std::equal(samples.begin(), samples.end(), result.begin()));
+  std::filesystem::remove(raw_path);
+
+  EXPECT_THROW(pcm_reader::create_from_wav(raw_path), std::runtime_error);
+}
+
+TEST(pcm_reader, streaming_source_memory)
+{
+  if (engine::start_loopback_context() == result::FAILURE)
+    GTEST_SKIP() << "ALC_SOFT_loopback is not available";
+  {
+    // 20 s of 44.1 kHz stereo, about 3.5 MB decoded
+    std::vector<ALshort> samples(44100 * 2 * 20, 1000);
+    auto path = write_wav("hnll_long.wav", 2, 16, 44100, to_bytes(samples));
+
+    auto stream = streaming_source::create_from_file(path);
+    EXPECT_EQ(stream->get_format(), AL_FORMAT_STEREO16);
+    EXPECT_LT(stream->get_memory_size(), 200 * 1024);
+    stream->play();
+    stream->update();
+    EXPECT_EQ(stream->get_starved_buffer_count(), 0);
+    stream.reset();
+    std::filesystem::remove(path);
+  }
+  engine::kill_hae_context();
+}
@@ -0,0 +1,73 @@
+// hnll
+#include <audio/resampler.hpp>
+
+// lib
+#include <gtest/gtest.h>
+
+// std
+#include <cmath>
+
+using hnll::audio::resampler;
+
+namespace {
+
+std::vector<float> create_sine(double frequency, double rate, size_t count)
+{
+  std::vector<float> res(count);
+  for (size_t i = 0; i < count; i++)
+    res[i] = static_cast<float>(std::sin(2.0 * M_PI * frequency * i / rate));
+  return res;
+}
+
+} // anonymous namespace
+
+TEST(resampler, dc_gain)
+{
+  resampler r(48000.0, 44100.0);
+  std::vector<float> input(4800, 0.5f), output(8000);
+  r.push(input);
+  const auto count = r.pull(output);
+  EXPECT_NEAR(double(count), 4800 * 44100.0 / 48000.0, r.get_tap_count());
+  // after the leading edge of the filter
+  for (size_t i = r.get_tap_count(); i < count; i++)
+    EXPECT_NEAR(output[i], 0.5f, 1e-4);
+}
+
+TEST(resampler, sine)
+{
+  // any ratio, pushed and pulled in uneven chunks
+  for (auto [input_rate, output_rate] : { std::pair{ 48000.0, 44100.0 }, { 30000.0, 48000.0 }, { 62500.0, 44100.0 } }) {
+    resampler r(input_rate, output_rate);
+    const double frequency = 1000.0;
+    const auto input = create_sine(frequency, input_rate, size_t(input_rate / 10));
+
+    std::vector<float> output;
+    std::vector<float> chunk(333);
+    for (size_t i = 0; i < input.size(); i += 517) {
+      r.push(std::span<const float>(input).subspan(i, std::min<size_t>(517, input.size() - i)));
+      while (auto count = r.pull(chunk))
+        output.insert(output.end(), chunk.begin(), chunk.begin() + count);
+    }
+
+    // the first output is centered on the first input, so the output is the sine at the output rate
+    double max_error = 0.0;
+    for (size_t n = r.get_tap_count() * 2; n < output.size(); n++)
+      max_error = std::max(max_error, std::abs(output[n] - std::sin(2.0 * M_PI * frequency * n / output_rate)));
+    EXPECT_LT(max_error, 5e-3) << input_rate << " -> " << output_rate;
+    EXPECT_NEAR(double(output.size()), input.size() / r.get_step(), r.get_tap_count());
+  }
+}
+
+TEST(resampler, anti_aliasing)
+{
+  // 20 kHz is above the nyquist frequency of 32 kHz
+  resampler r(96000.0, 32000.0);
+  const auto input = create_sine(20000.0, 96000.0, 9600);
+  std::vector<float> output(4000);
+  r.push(input);
+  const auto count = r.pull(output);
+  double peak = 0.0;
+  for (size_t i = r.get_tap_count(); i < count; i++)
+    peak = std::max(peak, double(std::abs(output[i])));
+  EXPECT_LT(peak, 0.05);
+}
@@ -0,0 +1,101 @@
+// hnll
+#include <audio/voice_manager.hpp>
+#include <audio/audio_data.hpp>
+#include <audio/engine.hpp>
+
+// lib
+#include <gtest/gtest.h>
+
+using namespace hnll::audio;
+
+namespace {
+
+// one second of silence
+audio_data create_audio()
+{
+  audio_data data(AL_FORMAT_MONO16, 44100);
+  data.set_data(std::vector<ALshort>(44100, 0));
+  engine::bind_audio_to_buffer(data);
+  return data;
+}
+
+} // anonymous namespace
+
+TEST(voice_manager, virtualization)
+{
+  engine::start_hae_context();
+  {
+    auto data = create_audio();
+    voice_manager voices(8);
+    EXPECT_EQ(voices.get_max_real_count(), 8);
+
+    // 200 emitters on a line
+    std::vector<voice_id> ids;
+    for (int i = 0; i < 200; i++) {
+      voice_params params;
+      params.position = { double(i), 0.0, 0.0 };
+      params.is_looping = true;
+      ids.push_back(voices.play(data, params));
+    }
+    voices.update(0.01f, Eigen::Vector3d::Zero());
+    EXPECT_EQ(voices.get_voice_count(), 200);
+    EXPECT_EQ(voices.get_real_voice_count(), 8);
+    EXPECT_EQ(voices.get_virtual_voice_count(), 192);
+    for (int i = 0; i < 200; i++)
+      EXPECT_EQ(voices.is_real(ids[i]), i < 8);
+
+    // the listener moves to the other end
+    voices.update(0.01f, Eigen::Vector3d(199.0, 0.0, 0.0));
+    for (int i = 0; i < 200; i++)
+      EXPECT_EQ(voices.is_real(ids[i]), i >= 192);
+    EXPECT_EQ(voices.get_stolen_count(), 8);
+
+    // priority wins over distance
+    voices.set_priority(ids[0], 1000.f);
+    voices.update(0.01f, Eigen::Vector3d(199.0, 0.0, 0.0));
+    EXPECT_TRUE(voices.is_real(ids[0]));
+    EXPECT_EQ(voices.get_real_voice_count(), 8);
+  }
+  // every source is back to the engine
+  EXPECT_EQ(engine::remaining_pending_sources_count(), SOURCE_COUNT);
+  engine::kill_hae_context();
+}
+
+TEST(voice_manager, lifetime)
+{
+  engine::start_hae_context();
+  {
+    auto data = create_audio();
+    voice_manager voices(4);
+
+    // an inaudible voice is never bound, even if sources are free
+    voice_params silent;
+    silent.gain = 0.f;
+    auto silent_id = voices.play(data, silent);
+    voice_params looping;
+    looping.is_looping = true;
+    auto looping_id = voices.play(data, looping);
+    auto one_shot_id = voices.play(data);
+
+    voices.update(0.5f, Eigen::Vector3d::Zero());
+    EXPECT_FALSE(voices.is_real(silent_id));
+    EXPECT_TRUE(voices.is_real(looping_id));
+    EXPECT_TRUE(voices.is_real(one_shot_id));
+
+    // the one-shots end after their duration, virtual or not
+    voices.update(0.6f, Eigen::Vector3d::Zero());
+    EXPECT_FALSE(voices.is_alive(silent_id));
+    EXPECT_FALSE(voices.is_alive(one_shot_id));
+    EXPECT_TRUE(voices.is_alive(looping_id));
+    EXPECT_EQ(voices.get_real_voice_count(), 1);
+
+    // a stale handle doesn't reach the voice reusing its slot
+    voices.stop(looping_id);
+    auto new_id = voices.play(data);
+    EXPECT_FALSE(voices.is_alive(looping_id));
+    EXPECT_TRUE(voices.is_alive(new_id));
+    voices.stop(looping_id);
+    EXPECT_TRUE(voices.is_alive(new_id));
+  }
+  engine::kill_hae_context();
+}
@@ -1,6 +1,7 @@
 // hnll
 #include <geometry/bounding_volume.hpp>
 #include <geometry/intersection.hpp>
+#include <utils/job_system.hpp>
 // lib
 #include <gtest/gtest.h>
 
@@ -61,4 +62,80 @@ TEST(bounding_sphere, ritter_ctor){
   auto sphere = bounding_volume::ritter_ctor(sample_vertices);
   EXPECT_EQ(sphere->get_sphere_radius(), 1.f);
   EXPECT_EQ(sphere->get_local_center_point(), Eigen::Vector3d(0.f, 1.f, 0.f));
-}
\ No newline at end of file
+}
+// padded like graphics::vertex::position
+std::vector<float> padded_cube {
+   1.f,  1.f,  1.f, 0.f,
+   1.f,  1.f, -1.f, 0.f,
+   1.f, -1.f,  1.f, 0.f,
+   1.f, -1.f, -1.f, 0.f,
+  -1.f,  1.f,  1.f, 0.f,
+  -1.f,  1.f, -1.f, 0.f,
+  -1.f, -1.f,  1.f, 0.f,
+  -1.f, -1.f, -1.f, 0.f,
+};
+
+TEST(bounding_volume, aabb_from_span){
+  auto aabb = bounding_volume::create_aabb(position_span{padded_cube, 4});
+  EXPECT_EQ(aabb->get_local_center_point(), Eigen::Vector3d(0.f, 0.f, 0.f));
+  EXPECT_EQ(aabb->get_aabb_radius(), Eigen::Vector3d(1.f, 1.f, 1.f));
+
+  // tightly packed
+  std::vector<float> packed;
+  for (const auto& v : sample_vertices)
+    packed.insert(packed.end(), {float(v.x()), float(v.y()), float(v.z())});
+  auto packed_aabb = bounding_volume::create_aabb(position_span{packed, 3});
+  auto vector_aabb = bounding_volume::create_aabb(sample_vertices);
+  EXPECT_EQ(packed_aabb->get_local_center_point(), vector_aabb->get_local_center_point());
+  EXPECT_EQ(packed_aabb->get_aabb_radius(), vector_aabb->get_aabb_radius());
+}
+
+TEST(bounding_volume, sphere_from_span){
+  std::vector<float> padded;
+  for (const auto& v : sample_vertices)
+    padded.insert(padded.end(), {float(v.x()), float(v.y()), float(v.z()), 0.f});
+  auto sphere = bounding_volume::ritter_ctor(position_span{padded, 4});
+  EXPECT_DOUBLE_EQ(sphere->get_sphere_radius(), 1.f);
+  EXPECT_EQ(sphere->get_local_center_point(), Eigen::Vector3d(0.f, 1.f, 0.f));
+}
+
+TEST(bounding_volume, multithreaded_span_ctor){
+  // points on a helix, large enough to be split into chunks
+  std::vector<float> positions;
+  const int count = 1 << 18;
+  for (int i = 0; i < count; i++) {
+    double t = 0.001 * i;
+    positions.insert(positions.end(), {float(std::cos(t)), float(0.0001 * i), float(std::sin(t)), 0.f});
+  }
+  position_span span{positions, 4};
+
+  auto jobs = hnll::utils::job_system::create(3);
+  auto single = bounding_volume::create_aabb(span);
+  auto multi  = bounding_volume::create_aabb(span, jobs.get());
+  EXPECT_EQ(single->get_local_center_point(), multi->get_local_center_point());
+  EXPECT_EQ(single->get_aabb_radius(), multi->get_aabb_radius());
+
+  // every point should be enclosed
+  auto sphere = bounding_volume::create_bounding_sphere(bv_ctor_type::RITTER, span, jobs.get());
+  double max_dist = 0;
+  for (size_t i = 0; i < span.size(); i++) {
+    Eigen::Vector3d p = {span[i][0], span[i][1], span[i][2]};
+    max_dist = std::max(max_dist, (p - sphere->get_local_center_point()).norm());
+  }
+  EXPECT_LE(max_dist, sphere->get_sphere_radius() + 1e-9);
+}
+
+TEST(bounding_volume, sphere_far_from_origin){
+  // coordinates large relative to the radius, where a float pre-test drops the points slightly outside
+  std::vector<float> positions;
+  for (int i = 0; i < 4096; i++) {
+    double t = 0.37 * i;
+    positions.insert(positions.end(), {float(1e5 + 0.01 * std::cos(t)), float(-2e5 + 0.01 * std::sin(t)), float(3e5 + 1e-4 * i), 0.f});
+  }
+  position_span span{positions, 4};
+  auto sphere = bounding_volume::ritter_ctor(span);
+  for (size_t i = 0; i < span.size(); i++) {
+    Eigen::Vector3d p = {span[i][0], span[i][1], span[i][2]};
+    EXPECT_LE((p - sphere->get_local_center_point()).norm(), sphere->get_sphere_radius() * (1 + 1e-12));
+  }
+}
@@ -0,0 +1,109 @@
+// hnll
+#include <geometry/convex_hull.hpp>
+#include <geometry/bounding_volume.hpp>
+#include <geometry/intersection.hpp>
+#include <geometry/gjk.hpp>
+
+// lib
+#include <gtest/gtest.h>
+
+// std
+#include <random>
+
+using namespace hnll::geometry;
+using vec3d = Eigen::Vector3d;
+
+std::vector<vec3d> create_cube_with_inner_points()
+{
+  std::vector<vec3d> points;
+  for (int x = -1; x <= 1; x += 2)
+    for (int y = -1; y <= 1; y += 2)
+      for (int z = -1; z <= 1; z += 2)
+        points.emplace_back(x, y, z);
+  // inner and on-face points should be dropped
+  std::mt19937 engine(0);
+  std::uniform_real_distribution<double> dist(-0.99, 0.99);
+  for (int i = 0; i < 500; i++)
+    points.emplace_back(dist(engine), dist(engine), dist(engine));
+  points.emplace_back(0.0, 0.0, 1.0);
+  return points;
+}
+
+TEST(convex_hull, cube)
+{
+  auto hull = convex_hull::create(create_cube_with_inner_points());
+  EXPECT_EQ(hull->get_vertex_count(), 8);
+  // two triangles for each face
+  EXPECT_EQ(hull->get_face_count(), 12);
+  EXPECT_EQ(hull->get_min(), vec3d(-1, -1, -1));
+  EXPECT_EQ(hull->get_max(), vec3d(1, 1, 1));
+  EXPECT_EQ(hull->support(vec3d(1, 2, 3)), vec3d(1, 1, 1));
+}
+
+TEST(convex_hull, every_point_is_inside)
+{
+  std::mt19937 engine(1);
+  std::normal_distribution<double> dist(0.0, 1.0);
+  std::vector<vec3d> points(2000);
+  for (auto& p : points)
+    p = vec3d(dist(engine), dist(engine), dist(engine));
+
+  auto hull = convex_hull::create(points);
+  ASSERT_FALSE(hull->is_degenerate());
+  // euler characteristic of a closed triangle mesh
+  EXPECT_EQ(hull->get_vertex_count() * 2 - 4, hull->get_face_count());
+
+  const auto& v = hull->get_vertices();
+  for (const auto& face : hull->get_faces()) {
+    vec3d normal = (v[face[1]] - v[face[0]]).cross(v[face[2]] - v[face[0]]).normalized();
+    for (const auto& p : points)
+      EXPECT_LE(normal.dot(p - v[face[0]]), 1e-9);
+  }
+}
+
+TEST(convex_hull, degenerate)
+{
+  std::vector<vec3d> plane = { {0, 0, 0}, {1, 0, 0}, {0, 0, 1}, {1, 0, 1} };
+  auto hull = convex_hull::create(plane);
+  EXPECT_TRUE(hull->is_degenerate());
+  EXPECT_EQ(hull->support(vec3d(1, 0, 1)), vec3d(1, 0, 1));
+}
+
+TEST(gjk, convex_convex)
+{
+  auto hull = convex_hull::create(create_cube_with_inner_points());
+  auto a = bounding_volume::create_convex_hull(hull);
+  auto b = bounding_volume::create_convex_hull(hull);
+  auto transform_a = std::make_shared<hnll::utils::transform>();
+  auto transform_b = std::make_shared<hnll::utils::transform>();
+  a->set_transform(transform_a);
+  b->set_transform(transform_b);
+
+  // overlapping by 0.5 along x
+  transform_b->translation = {1.5f, 0.2f, 0.f};
+  contact res;
+  gjk_cache cache;
+  EXPECT_NEAR(intersection::test_convex_convex(*a, *b, &cache, &res), 0.5, 1e-6);
+  EXPECT_NEAR(res.normal.x(), 1.0, 1e-6);
+
+  // separated
+  transform_b->translation = {2.5f, 0.f, 0.f};
+  EXPECT_EQ(intersection::test_convex_convex(*a, *b, &cache, &res), 0.0);
+  EXPECT_TRUE(cache.is_valid);
+
+  // rotated by 45 degrees around y, its corner reaches sqrt(2)
+  transform_b->translation = {2.3f, 0.f, 0.f};
+  transform_b->rotation = {0.f, float(M_PI / 4.0), 0.f};
+  EXPECT_NEAR(intersection::test_convex_convex(*a, *b, &cache, &res), std::sqrt(2.0) - 1.3, 1e-5);
+}
+
+TEST(gjk, convex_sphere)
+{
+  auto hull = convex_hull::create(create_cube_with_inner_points());
+  auto cube = bounding_volume::create_convex_hull(hull);
+  auto sphere = bounding_volume(vec3d(0.f, 1.8f, 0.f), 1.0);
+
+  EXPECT_NEAR(intersection::test_bounding_volumes(*cube, sphere), 0.2, 1e-5);
+  sphere.set_center_point({0.f, 2.1f, 0.f});
+  EXPECT_EQ(intersection::test_bounding_volumes(*cube, sphere), 0.0);
+}
@@ -0,0 +1,123 @@
+// hnll
+#include <geometry/sphere_tree.hpp>
+#include <geometry/bounding_volume.hpp>
+#include <geometry/intersection.hpp>
+#include <geometry/gjk.hpp>
+
+// lib
+#include <gtest/gtest.h>
+
+// std
+#include <filesystem>
+
+using namespace hnll::geometry;
+using vec3d = Eigen::Vector3d;
+
+// L-shaped mesh : a floor (y = 0) and a wall (x = 0), both 2 x 2 and finely tessellated
+struct l_shape
+{
+  l_shape(int division = 16)
+  {
+    auto add_grid = [&](auto&& point) {
+      auto offset = static_cast<uint32_t>(positions.size() / 4);
+      for (int i = 0; i <= division; i++)
+        for (int j = 0; j <= division; j++) {
+          vec3d p = point(2.0 * i / division, 2.0 * j / division);
+          positions.insert(positions.end(), { float(p.x()), float(p.y()), float(p.z()), 0.f });
+        }
+      for (uint32_t i = 0; i < division; i++)
+        for (uint32_t j = 0; j < division; j++) {
+          uint32_t v0 = offset + i * (division + 1) + j, v1 = v0 + 1, v2 = v0 + division + 1, v3 = v2 + 1;
+          indices.insert(indices.end(), { v0, v1, v2, v1, v3, v2 });
+        }
+    };
+    add_grid([](double u, double v) { return vec3d(u, 0.0, v); });
+    add_grid([](double u, double v) { return vec3d(0.0, u, v); });
+  }
+
+  position_span span() const { return { positions, 4 }; }
+
+  std::vector<float>    positions;
+  std::vector<uint32_t> indices;
+};
+
+TEST(sphere_tree, build)
+{
+  l_shape shape;
+  auto tree = sphere_tree::create(shape.span(), shape.indices, 2);
+  ASSERT_GT(tree->get_node_count(), 1);
+
+  // every vertex should be enclosed by the root and some leaf
+  const auto& root = tree->get_root();
+  auto span = shape.span();
+  for (size_t i = 0; i < span.size(); i++) {
+    vec3d p = { span[i][0], span[i][1], span[i][2] };
+    EXPECT_LE((p - root.center).norm(), root.radius + 1e-9);
+    bool enclosed = false;
+    for (const auto& node : tree->get_nodes())
+      if (node.is_leaf() && (p - node.center).norm() <= node.radius + 1e-9)
+        enclosed = true;
+    EXPECT_TRUE(enclosed);
+  }
+}
+
+TEST(sphere_tree, concave_collision)
+{
+  l_shape shape;
+  auto tree = sphere_tree::create(shape.span(), shape.indices, 2);
+  auto l_bv = bounding_volume::create_sphere_tree(tree);
+
+  // in the hollow of the L : inside the root sphere, but away from both planes
+  auto ball = bounding_volume(vec3d(1.f, 1.f, 1.f), 0.5);
+  EXPECT_EQ(intersection::test_bounding_volumes(*l_bv, ball), 0.0);
+
+  // touching the floor
+  ball.set_center_point({1.f, 0.3f, 1.f});
+  contact res;
+  auto depth = intersection::test_sphere_tree(*l_bv, ball, &res);
+  EXPECT_GT(depth, 0.0);
+  EXPECT_GT(res.normal.y(), 0.9);
+  EXPECT_GT(intersection::test_bounding_volumes(ball, *l_bv), 0.0);
+}
+
+TEST(sphere_tree, tree_tree)
+{
+  l_shape shape;
+  auto tree = sphere_tree::create(shape.span(), shape.indices, 2);
+  auto a = bounding_volume::create_sphere_tree(tree);
+  auto b = bounding_volume::create_sphere_tree(tree);
+  auto transform_b = std::make_shared<hnll::utils::transform>();
+  b->set_transform(transform_b);
+
+  // b's wall stands in a's hollow
+  transform_b->translation = {1.f, 0.5f, 0.f};
+  EXPECT_EQ(intersection::test_bounding_volumes(*a, *b), 0.0);
+  // b's floor sinks into a's wall
+  transform_b->translation = {-0.5f, 0.5f, 0.f};
+  EXPECT_GT(intersection::test_bounding_volumes(*a, *b), 0.0);
+}
+
+TEST(sphere_tree, cache)
+{
+  l_shape shape;
+  const std::string name = "sphere_tree_test_l_shape";
+  auto tree = sphere_tree::create(shape.span(), shape.indices);
+  const auto source_hash = sphere_tree::hash_source(shape.span(), shape.indices);
+  sphere_tree::write_cache(*tree, name, source_hash);
+
+  auto loaded = sphere_tree::load_cache(name, source_hash);
+  ASSERT_NE(loaded, nullptr);
+  ASSERT_EQ(loaded->get_node_count(), tree->get_node_count());
+  for (uint32_t i = 0; i < tree->get_node_count(); i++) {
+    EXPECT_EQ(loaded->get_node(i).center, tree->get_node(i).center);
+    EXPECT_EQ(loaded->get_node(i).radius, tree->get_node(i).radius);
+    EXPECT_EQ(loaded->get_node(i).first_child, tree->get_node(i).first_child);
+  }
+  // outdated cache : a mesh edited with the same counts
+  auto edited = shape;
+  edited.positions[0] += 0.5f;
+  EXPECT_NE(sphere_tree::hash_source(edited.span(), edited.indices), source_hash);
+  EXPECT_EQ(sphere_tree::load_cache(name, sphere_tree::hash_source(edited.span(), edited.indices)), nullptr);
+
+  std::filesystem::remove(std::string(getenv("HNLL_ENGN")) + "/cache/sphere_trees/" + name + ".st");
+}
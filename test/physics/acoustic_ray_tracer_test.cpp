@@ -0,0 +1,148 @@
+// hnll
+#include <physics/acoustic_ray_tracer.hpp>
+#include <geometry/bounding_volume.hpp>
+#include <utils/job_system.hpp>
+
+// lib
+#include <gtest/gtest.h>
+
+// std
+#include <cmath>
+#include <numeric>
+
+using hnll::physics::acoustic_ray_tracer;
+using hnll::physics::acoustic_material;
+using hnll::vec3d;
+
+namespace {
+
+// axis aligned box of 12 triangles
+void add_box(acoustic_ray_tracer& tracer, const vec3d& min, const vec3d& max, uint32_t material = 0)
+{
+  std::vector<float> positions;
+  for (int i = 0; i < 8; i++) {
+    positions.push_back(float(i & 1 ? max.x() : min.x()));
+    positions.push_back(float(i & 2 ? max.y() : min.y()));
+    positions.push_back(float(i & 4 ? max.z() : min.z()));
+  }
+  std::vector<uint32_t> indices = {
+    0, 1, 3,  0, 3, 2,  4, 5, 7,  4, 7, 6,
+    0, 1, 5,  0, 5, 4,  2, 3, 7,  2, 7, 6,
+    0, 2, 6,  0, 6, 4,  1, 3, 7,  1, 7, 5,
+  };
+  tracer.add_obstacle(hnll::geometry::position_span{ positions, 3 }, indices, material);
+}
+
+void add_quad(acoustic_ray_tracer& tracer, const std::vector<vec3d>& corners, uint32_t material = 0)
+{
+  std::vector<float> positions;
+  for (const auto& c : corners)
+    positions.insert(positions.end(), { float(c.x()), float(c.y()), float(c.z()) });
+  tracer.add_obstacle(hnll::geometry::position_span{ positions, 3 }, { 0, 1, 2, 0, 2, 3 }, material);
+}
+
+} // anonymous namespace
+
+TEST(acoustic_ray_tracer, occlusion)
+{
+  auto tracer = acoustic_ray_tracer::create();
+  auto source   = tracer->add_source({ 0.0, 0.0, 0.0 });
+  auto receiver = tracer->add_receiver({ 4.0, 0.0, 0.0 }, 0.25);
+  tracer->set_ray_count(1024)->trace();
+  EXPECT_DOUBLE_EQ(tracer->get_direct_energy(source, receiver), 1.0 / 16.0);
+  EXPECT_NEAR(tracer->get_direct_delay(source, receiver), 4.0 / 343.0, 1e-12);
+
+  // a wall in between
+  add_quad(*tracer, { { 2.0, -1.0, -1.0 }, { 2.0, 1.0, -1.0 }, { 2.0, 1.0, 1.0 }, { 2.0, -1.0, 1.0 } });
+  EXPECT_NEAR(tracer->cast_ray({ 0.0, 0.0, 0.0 }, { 1.0, 0.0, 0.0 }), 2.0, 1e-9);
+  EXPECT_EQ(tracer->cast_ray({ 0.0, 0.0, 0.0 }, { -1.0, 0.0, 0.0 }), 0.0);
+  tracer->trace();
+  EXPECT_EQ(tracer->get_direct_energy(source, receiver), 0.0);
+}
+
+TEST(acoustic_ray_tracer, image_source)
+{
+  // a specular floor : the only reflection comes from the image of the source
+  auto tracer = acoustic_ray_tracer::create();
+  auto floor = tracer->add_material({ 0.3, 0.0 });
+  add_quad(*tracer, { { -50.0, 0.0, -50.0 }, { 50.0, 0.0, -50.0 }, { 50.0, 0.0, 50.0 }, { -50.0, 0.0, 50.0 } }, floor);
+  auto source   = tracer->add_source({ 0.0, 1.5, 0.0 });
+  auto receiver = tracer->add_receiver({ 4.0, 1.5, 0.0 }, 0.5);
+  tracer->set_ray_count(1 << 17)->trace();
+
+  const auto& histogram = tracer->get_histogram(source, receiver);
+  const double energy = std::accumulate(histogram.begin(), histogram.end(), 0.0);
+  EXPECT_NEAR(energy, 0.7 / 25.0, 0.15 * 0.7 / 25.0);
+
+  // the reflection arrives after the direct sound, as the image source at 5 m
+  size_t peak = std::max_element(histogram.begin(), histogram.end()) - histogram.begin();
+  EXPECT_NEAR(double(peak) * tracer->get_bin_width(), 5.0 / 343.0, 2e-3);
+}
+
+TEST(acoustic_ray_tracer, reverberation_time)
+{
+  // 10 x 8 x 4 m room : eyring's formula gives t60 = 0.161 v / (-s ln(1 - a))
+  auto tracer = acoustic_ray_tracer::create();
+  auto wall = tracer->add_material({ 0.2, 0.3 });
+  add_box(*tracer, { 0.0, 0.0, 0.0 }, { 10.0, 4.0, 8.0 }, wall);
+  EXPECT_EQ(tracer->get_triangle_count(), 12);
+
+  auto source   = tracer->add_source({ 2.0, 1.5, 2.0 });
+  auto receiver = tracer->add_receiver({ 7.0, 1.7, 5.0 }, 0.5);
+  tracer->set_ray_count(1 << 14)->set_bin_width(5e-3)->trace();
+  EXPECT_GT(tracer->get_direct_energy(source, receiver), 0.0);
+
+  // schroeder's backward integration, the decay from -5 dB to -25 dB
+  const auto& histogram = tracer->get_histogram(source, receiver);
+  std::vector<double> decay(histogram.size() + 1, 0.0);
+  for (size_t i = histogram.size(); i-- > 0;)
+    decay[i] = decay[i + 1] + histogram[i];
+  auto time_of = [&](double db) {
+    size_t i = 0;
+    while (i < histogram.size() && 10.0 * std::log10(decay[i] / decay[0]) > db) i++;
+    return double(i) * tracer->get_bin_width();
+  };
+  const double t60 = 3.0 * (time_of(-25.0) - time_of(-5.0));
+  const double eyring = 0.161 * 320.0 / (-304.0 * std::log(0.8));
+  EXPECT_NEAR(t60, eyring, 0.2 * eyring);
+
+  // the impulse response keeps the energy of the histogram
+  auto impulse_response = tracer->create_impulse_response(source, receiver, 48000.0);
+  double ir_energy = 0.0;
+  for (auto sample : impulse_response) ir_energy += double(sample) * sample;
+  const double expected = decay[0] + tracer->get_direct_energy(source, receiver);
+  EXPECT_NEAR(ir_energy, expected, 0.05 * expected);
+}
+
+TEST(acoustic_ray_tracer, moving_receiver)
+{
+  // a moved receiver re-collects the cached paths, as if it was traced there from scratch
+  auto jobs = hnll::utils::job_system::create(2);
+  auto create = [&jobs](const vec3d& receiver_position) {
+    auto tracer = acoustic_ray_tracer::create();
+    add_box(*tracer, { 0.0, 0.0, 0.0 }, { 6.0, 3.0, 5.0 });
+    add_box(*tracer, { 2.5, 0.0, 2.0 }, { 3.5, 3.0, 3.0 });
+    tracer->add_source({ 1.0, 1.5, 2.5 });
+    tracer->add_receiver(receiver_position, 0.4);
+    tracer->set_ray_count(4096)->set_job_system(jobs.get())->trace();
+    return tracer;
+  };
+  auto moving = create({ 1.0, 1.5, 4.0 });
+  EXPECT_GT(moving->get_direct_energy(0, 0), 0.0);
+  const auto segment_count = moving->get_segment_count();
+
+  // behind the pillar
+  const vec3d position = { 5.0, 1.5, 2.5 };
+  moving->set_receiver_position(0, position);
+  moving->trace();
+  EXPECT_EQ(moving->get_segment_count(), segment_count);
+  EXPECT_EQ(moving->get_direct_energy(0, 0), 0.0);
+
+  auto fresh = create(position);
+  const auto& a = moving->get_histogram(0, 0);
+  const auto& b = fresh->get_histogram(0, 0);
+  ASSERT_EQ(a.size(), b.size());
+  for (size_t i = 0; i < a.size(); i++)
+    EXPECT_DOUBLE_EQ(a[i], b[i]);
+  EXPECT_GT(std::accumulate(a.begin(), a.end(), 0.0), 0.0);
+}
@@ -0,0 +1,169 @@
+// hnll
+#include <physics/contact_solver.hpp>
+#include <physics/contact_manager.hpp>
+#include <physics/rigid_body.hpp>
+#include <geometry/bounding_volume.hpp>
+#include <geometry/convex_hull.hpp>
+#include <geometry/intersection.hpp>
+#include <geometry/gjk.hpp>
+#include <utils/job_system.hpp>
+
+// lib
+#include <gtest/gtest.h>
+
+using hnll::vec3d;
+using hnll::utils::transform;
+using namespace hnll::physics;
+using hnll::geometry::bounding_volume;
+namespace geometry = hnll::geometry;
+
+// boxes on a static floor. gravity is +y, so the boxes are stacked towards -y
+struct box_scene
+{
+  struct box
+  {
+    std::shared_ptr<transform> tf = std::make_shared<transform>();
+    std::unique_ptr<bounding_volume> shape;
+    rigid_body               body;
+  };
+
+  box& add_box(const vec3d& center, const vec3d& half_extents, double mass)
+  {
+    std::vector<vec3d> corners;
+    for (int i = 0; i < 8; i++)
+      corners.emplace_back(i & 1 ? half_extents.x() : -half_extents.x(), i & 2 ? half_extents.y() : -half_extents.y(), i & 4 ? half_extents.z() : -half_extents.z());
+
+    auto& b = *boxes.emplace_back(std::make_unique<box>());
+    b.tf->translation = { float(center.x()), float(center.y()), float(center.z()) };
+    b.shape = bounding_volume::create_convex_hull(geometry::convex_hull::create(corners));
+    b.shape->set_transform(b.tf);
+    b.body.id = static_cast<uint32_t>(boxes.size() - 1);
+    b.body.type = mass > 0.0 ? motion_type::DYNAMIC : motion_type::STATIC;
+    b.body.set_mass(mass, *b.shape);
+    b.body.read_transform(*b.tf);
+    return b;
+  }
+
+  void add_stack(const vec3d& base, int count)
+  {
+    for (int i = 0; i < count; i++)
+      add_box(base - vec3d(0.0, 0.5 + i * 1.0, 0.0), vec3d(0.5, 0.5, 0.5), 1.0);
+  }
+
+  void step(contact_solver& solver, double dt = 1.0 / 60.0, hnll::utils::job_system* jobs = nullptr)
+  {
+    contacts.begin_frame();
+    for (size_t i = 0; i < boxes.size(); i++) {
+      for (size_t j = i + 1; j < boxes.size(); j++) {
+        auto& a = *boxes[i];
+        auto& b = *boxes[j];
+        if (!a.body.is_awake() && !b.body.is_awake()) continue;
+        geometry::contact c;
+        if (geometry::intersection::test_convex_convex(*a.shape, *b.shape, nullptr, &c) > 0.0)
+          contacts.update_manifold(a.body, b.body, geometry::intersection::create_contact_manifold(*a.shape, *b.shape, c));
+      }
+    }
+    contacts.end_frame();
+
+    std::vector<rigid_body*> bodies;
+    for (auto& b : boxes) bodies.push_back(&b->body);
+    solver.step(bodies, contacts, dt, jobs);
+    for (auto& b : boxes)
+      if (b->body.is_dynamic()) b->body.write_transform(*b->tf);
+  }
+
+  std::vector<std::unique_ptr<box>> boxes;
+  contact_manager contacts;
+};
+
+TEST(contact_solver, resting_stack_falls_asleep)
+{
+  box_scene scene;
+  scene.add_box({ 0.0, 0.5, 0.0 }, { 5.0, 0.5, 5.0 }, 0.0);
+  scene.add_stack({ 0.0, 0.0, 0.0 }, 4);
+
+  auto solver = contact_solver::create();
+  for (int i = 0; i < 300; i++)
+    scene.step(*solver);
+
+  for (size_t i = 1; i < scene.boxes.size(); i++) {
+    const auto& body = scene.boxes[i]->body;
+    EXPECT_NEAR(body.position.x(), 0.0, 0.01);
+    EXPECT_NEAR(body.position.z(), 0.0, 0.01);
+    EXPECT_NEAR(body.position.y(), -0.5 - (i - 1) * 1.0, 0.05);
+    EXPECT_TRUE(body.is_sleeping);
+  }
+  // sleeping pairs keep their manifolds
+  EXPECT_EQ(scene.contacts.get_manifold_count(), 4);
+  EXPECT_EQ(solver->get_island_count(), 0);
+}
+
+TEST(contact_solver, new_contact_wakes_island)
+{
+  box_scene scene;
+  scene.add_box({ 0.0, 0.5, 0.0 }, { 5.0, 0.5, 5.0 }, 0.0);
+  scene.add_stack({ 0.0, 0.0, 0.0 }, 2);
+
+  auto solver = contact_solver::create();
+  for (int i = 0; i < 300; i++)
+    scene.step(*solver);
+  ASSERT_TRUE(scene.boxes[1]->body.is_sleeping);
+
+  // drop a box onto the sleeping stack
+  auto& falling = scene.add_box({ 0.0, -4.0, 0.0 }, { 0.5, 0.5, 0.5 }, 1.0);
+  bool woken = false;
+  for (int i = 0; i < 120; i++) {
+    scene.step(*solver);
+    woken |= !scene.boxes[1]->body.is_sleeping;
+  }
+  EXPECT_TRUE(woken);
+  EXPECT_NEAR(falling.body.position.y(), -2.5, 0.05);
+}
+
+TEST(contact_solver, parallel_islands)
+{
+  // the islands are independent, so the job system doesn't change the result
+  box_scene serial, parallel;
+  for (auto* scene : { &serial, &parallel }) {
+    scene->add_box({ 0.0, 0.5, 0.0 }, { 20.0, 0.5, 20.0 }, 0.0);
+    // enough contacts to be solved by the jobs
+    for (int i = 0; i < 16; i++)
+      scene->add_stack({ -9.0 + (i % 4) * 6.0, 0.0, -9.0 + (i / 4) * 6.0 }, 4);
+  }
+
+  auto serial_solver   = contact_solver::create();
+  auto parallel_solver = contact_solver::create();
+  auto jobs = hnll::utils::job_system::create(3);
+
+  for (int i = 0; i < 10; i++) {
+    serial.step(*serial_solver);
+    parallel.step(*parallel_solver, 1.0 / 60.0, jobs.get());
+  }
+  EXPECT_EQ(parallel_solver->get_island_count(), 16);
+
+  for (int i = 0; i < 50; i++) {
+    serial.step(*serial_solver);
+    parallel.step(*parallel_solver, 1.0 / 60.0, jobs.get());
+  }
+  for (size_t i = 0; i < serial.boxes.size(); i++) {
+    EXPECT_EQ(serial.boxes[i]->body.position, parallel.boxes[i]->body.position);
+    EXPECT_EQ(serial.boxes[i]->body.linear_velocity, parallel.boxes[i]->body.linear_velocity);
+  }
+}
+
+TEST(rigid_body, transform_roundtrip)
+{
+  transform tf;
+  tf.translation = { 1.f, 2.f, 3.f };
+  tf.rotation    = { 0.3f, -1.2f, 0.7f };
+  tf.scale       = { 2.f, 2.f, 2.f };
+
+  rigid_body body;
+  body.read_transform(tf);
+  transform res;
+  body.write_transform(res);
+  EXPECT_NEAR(res.rotation.x, tf.rotation.x, 1e-5);
+  EXPECT_NEAR(res.rotation.y, tf.rotation.y, 1e-5);
+  EXPECT_NEAR(res.rotation.z, tf.rotation.z, 1e-5);
+  EXPECT_EQ(res.translation.y, tf.translation.y);
+}
@@ -0,0 +1,178 @@
+// hnll
+#include <physics/fdtd_solver.hpp>
+#include <physics/fdtd_stream.hpp>
+#include <geometry/bounding_volume.hpp>
+#include <utils/job_system.hpp>
+
+// lib
+#include <gtest/gtest.h>
+
+// std
+#include <thread>
+
+using hnll::physics::fdtd_solver;
+using hnll::physics::fdtd_stream;
+
+namespace {
+
+// 1 cm cells, c = 343 m/s
+std::unique_ptr<fdtd_solver> create_solver(uint32_t size, uint32_t pml, hnll::utils::job_system* jobs = nullptr)
+{
+  auto solver = fdtd_solver::create();
+  solver->set_dx(0.01)
+        ->set_phase_velocity(343.0)
+        ->set_min_stable_dt()
+        ->set_grid_size(size, size, size)
+        ->set_pml_thickness(pml)
+        ->set_job_system(jobs);
+  return solver;
+}
+
+double total_energy(const fdtd_solver& solver)
+{
+  double res = 0.0;
+  for (uint32_t z = 0; z < solver.get_size_z(); z++)
+    for (uint32_t y = 0; y < solver.get_size_y(); y++)
+      for (uint32_t x = 0; x < solver.get_size_x(); x++)
+        res += solver.get_pressure(x, y, z) * solver.get_pressure(x, y, z);
+  return res;
+}
+
+} // anonymous namespace
+
+TEST(fdtd_solver, stability)
+{
+  auto solver = create_solver(8, 0);
+  solver->set_dt(solver->get_dx() / solver->get_phase_velocity());
+  EXPECT_THROW(solver->step(), std::runtime_error);
+  solver->set_min_stable_dt();
+  EXPECT_LT(solver->get_courant_number(), 1.0 / std::sqrt(3.0));
+  EXPECT_NO_THROW(solver->step());
+}
+
+TEST(fdtd_solver, propagation)
+{
+  // 37 : the simd lanes and the scalar tails are both used
+  const uint32_t n = 37, c = n / 2;
+  auto solver = create_solver(n, 0);
+  solver->add_pressure(c, c, c, 1.0);
+  solver->step(10);
+
+  // symmetric impulse response
+  for (uint32_t d = 1; d < 8; d++) {
+    const auto p = solver->get_pressure(c + d, c, c);
+    EXPECT_NEAR(solver->get_pressure(c - d, c, c), p, 1e-7);
+    EXPECT_NEAR(solver->get_pressure(c, c + d, c), p, 1e-7);
+    EXPECT_NEAR(solver->get_pressure(c, c, c - d), p, 1e-7);
+  }
+
+  // the wave has reached c * t, and the stencil can't carry it farther than a cell per step
+  const double radius = solver->get_phase_velocity() * solver->get_dt() * 10 / solver->get_dx();
+  EXPECT_NE(solver->get_pressure(c + uint32_t(radius), c, c), 0.0);
+  EXPECT_EQ(solver->get_pressure(c + 11, c, c), 0.0);
+}
+
+TEST(fdtd_solver, pml)
+{
+  // a rigid box keeps the energy, the pml absorbs it
+  // a smooth pulse : grid scale waves travel too slowly to leave the box
+  const int n = 40, c = n / 2;
+  auto rigid = create_solver(n, 0);
+  auto open  = create_solver(n, 10);
+  for (auto* solver : { rigid.get(), open.get() }) {
+    for (int z = c - 6; z <= c + 6; z++)
+      for (int y = c - 6; y <= c + 6; y++)
+        for (int x = c - 6; x <= c + 6; x++)
+          solver->add_pressure(x, y, z, std::exp(-((x - c) * (x - c) + (y - c) * (y - c) + (z - c) * (z - c)) / 8.0));
+  }
+  const auto initial = total_energy(*rigid);
+  EXPECT_EQ(total_energy(*open), initial);
+
+  for (auto* solver : { rigid.get(), open.get() })
+    solver->step(400);
+  EXPECT_GT(total_energy(*rigid), initial * 0.1);
+  EXPECT_LT(total_energy(*open),  initial * 1e-4);
+}
+
+TEST(fdtd_solver, obstacle)
+{
+  // closed cube of [10, 20]^3 cells
+  const std::vector<float> positions = {
+    0.1f, 0.1f, 0.1f,  0.2f, 0.1f, 0.1f,  0.2f, 0.2f, 0.1f,  0.1f, 0.2f, 0.1f,
+    0.1f, 0.1f, 0.2f,  0.2f, 0.1f, 0.2f,  0.2f, 0.2f, 0.2f,  0.1f, 0.2f, 0.2f,
+  };
+  const std::vector<uint32_t> indices = {
+    0, 2, 1,  0, 3, 2,  4, 5, 6,  4, 6, 7,  0, 1, 5,  0, 5, 4,
+    2, 3, 7,  2, 7, 6,  1, 2, 6,  1, 6, 5,  0, 4, 7,  0, 7, 3,
+  };
+  auto solver = create_solver(32, 0);
+  solver->add_obstacle(hnll::geometry::position_span{ positions, 3 }, indices);
+
+  EXPECT_TRUE (solver->is_obstacle(15, 15, 15));
+  EXPECT_TRUE (solver->is_obstacle(10, 12, 19));
+  EXPECT_FALSE(solver->is_obstacle(5, 15, 15));
+  EXPECT_FALSE(solver->is_obstacle(15, 21, 15));
+
+  // the cube shadows the cells behind it
+  auto free = create_solver(32, 0);
+  for (auto* s : { solver.get(), free.get() }) {
+    s->set_source(3, 15, 15)->set_listener(25, 15, 15);
+    s->solve({ 1.0 }, s->get_dt() * 60);
+  }
+  double shadowed = 0.0, direct = 0.0;
+  for (size_t i = 0; i < free->get_output().size(); i++) {
+    shadowed = std::max(shadowed, std::abs(solver->get_output()[i]));
+    direct   = std::max(direct,   std::abs(free->get_output()[i]));
+  }
+  EXPECT_EQ(free->get_output().size(), 60);
+  EXPECT_LT(shadowed, direct * 0.5);
+  // obstacle cells stay silent
+  EXPECT_EQ(solver->get_pressure(15, 15, 15), 0.0);
+}
+
+TEST(fdtd_solver, job_independence)
+{
+  const uint32_t n = 48;
+  auto jobs     = hnll::utils::job_system::create(3);
+  auto serial   = create_solver(n, 6);
+  auto parallel = create_solver(n, 6, jobs.get());
+  for (auto* solver : { serial.get(), parallel.get() }) {
+    solver->set_source(10, 20, 30)->set_listener(30, 25, 12);
+    solver->solve({ 1.0, 0.5, -0.5, -1.0 }, solver->get_dt() * 50);
+  }
+  EXPECT_EQ(serial->get_output(), parallel->get_output());
+  EXPECT_EQ(serial->get_step_count(), parallel->get_step_count());
+}
+
+TEST(fdtd_stream, keeps_ahead)
+{
+  auto solver = create_solver(16, 0);
+  solver->set_source(4, 8, 8);
+  auto reference = create_solver(16, 0);
+  reference->set_source(4, 8, 8)->set_listener(12, 8, 8);
+
+  auto stream = fdtd_stream::create(std::move(solver), 4096);
+  const auto receiver = stream->add_receiver(12, 8, 8);
+  stream->set_target_latency(512);
+  const std::vector<float> input = { 1.f, -1.f, 0.5f };
+  stream->push_input(input);
+  stream->start();
+
+  // the worker fills the ring up to the target latency and waits for the consumer
+  std::vector<float> output;
+  std::vector<float> chunk(100);
+  while (output.size() < 2000) {
+    auto count = stream->pop_output(receiver, chunk);
+    output.insert(output.end(), chunk.begin(), chunk.begin() + count);
+    if (count == 0) std::this_thread::yield();
+  }
+  stream->stop();
+  EXPECT_LE(stream->get_buffered_count(receiver), 512);
+  EXPECT_EQ(stream->get_dropped_sample_count(), 0);
+  EXPECT_EQ(stream->get_step_count(), output.size() + stream->get_buffered_count(receiver));
+
+  // same samples as the synchronous solver
+  reference->solve({ 1.0, -1.0, 0.5 }, reference->get_dt() * 2000);
+  for (size_t i = 0; i < 2000; i++)
+    ASSERT_FLOAT_EQ(output[i], float(reference->get_output()[i])) << i;
+}
@@ -0,0 +1,104 @@
+// hnll
+#include <physics/particle_system.hpp>
+#include <physics/spatial_hash.hpp>
+#include <utils/job_system.hpp>
+
+// lib
+#include <gtest/gtest.h>
+
+// std
+#include <random>
+#include <set>
+
+using hnll::physics::particle_system;
+using hnll::physics::spatial_hash;
+
+namespace {
+
+std::vector<vec3> random_points(size_t count, float extent, unsigned seed = 0)
+{
+  std::mt19937 engine(seed);
+  std::uniform_real_distribution<float> dist(-extent, extent);
+  std::vector<vec3> res(count);
+  for (auto& p : res) p = { dist(engine), dist(engine), dist(engine) };
+  return res;
+}
+
+} // anonymous namespace
+
+TEST(particle_system, free_fall)
+{
+  // 7 particles : simd lanes and the scalar tail should agree
+  for (auto type : { particle_system::integrator::SYMPLECTIC_EULER, particle_system::integrator::VERLET }) {
+    auto system = particle_system::create();
+    system->set_integrator(type);
+    for (int i = 0; i < 7; i++)
+      system->add_particle({ float(i), 0.f, 0.f });
+
+    const float dt = 0.01f;
+    const int n = 100;
+    for (int i = 0; i < n; i++)
+      system->update(dt);
+
+    // both integrators give x_n = g dt^2 n (n + 1) / 2 from rest
+    const float expected = 9.8f * dt * dt * n * (n + 1) / 2.f;
+    for (uint32_t i = 0; i < 7; i++) {
+      EXPECT_NEAR(system->get_position(i).y(), expected, 1e-3);
+      EXPECT_EQ(system->get_position(i).x(), float(i));
+      EXPECT_NEAR(system->get_velocity(i).y(), 9.8f * dt * n, 1e-3);
+    }
+  }
+}
+
+TEST(particle_system, spatial_hash_candidates)
+{
+  const auto points = random_points(2000, 5.f);
+  std::vector<float> x, y, z;
+  for (const auto& p : points) { x.push_back(p.x()); y.push_back(p.y()); z.push_back(p.z()); }
+
+  spatial_hash hash;
+  const float radius = 0.7f;
+  hash.build(x.data(), y.data(), z.data(), points.size(), radius);
+
+  for (size_t i = 0; i < points.size(); i += 37) {
+    std::multiset<uint32_t> candidates;
+    hash.for_each_candidate(x[i], y[i], z[i], [&](uint32_t slot) { candidates.insert(hash.get_sorted_ids()[slot]); });
+    for (uint32_t j = 0; j < points.size(); j++) {
+      if ((points[i] - points[j]).norm() < radius)
+        EXPECT_EQ(candidates.count(j), 1);
+    }
+  }
+}
+
+TEST(particle_system, repulsion)
+{
+  auto system = particle_system::create();
+  system->set_gravity(vec3::Zero());
+  system->set_interaction(1.f, 10.f);
+  system->add_particle({ 0.f, 0.f, 0.f });
+  system->add_particle({ 0.5f, 0.f, 0.f });
+  system->update(0.01f);
+
+  // pushed apart with the same magnitude
+  EXPECT_LT(system->get_velocity(0).x(), 0.f);
+  EXPECT_GT(system->get_velocity(1).x(), 0.f);
+  EXPECT_FLOAT_EQ(system->get_velocity(0).x(), -system->get_velocity(1).x());
+}
+
+TEST(particle_system, job_independence)
+{
+  std::array<u_ptr<particle_system>, 2> systems = { particle_system::create(), particle_system::create() };
+  const auto points = random_points(30001, 20.f, 1);
+  auto jobs = hnll::utils::job_system::create(3);
+  for (int k = 0; k < 2; k++) {
+    systems[k]->set_job_system(k == 0 ? nullptr : jobs.get());
+    systems[k]->set_interaction(0.5f, 50.f);
+    systems[k]->set_drag(0.1f);
+    for (const auto& p : points)
+      systems[k]->add_particle(p);
+    for (int i = 0; i < 5; i++)
+      systems[k]->update(1.f / 60.f);
+  }
+  for (uint32_t i = 0; i < points.size(); i++)
+    EXPECT_EQ(systems[0]->get_position(i), systems[1]->get_position(i));
+}
@@ -0,0 +1,69 @@
+// hnll
+#include <utils/asset_package.hpp>
+
+// lib
+#include <gtest/gtest.h>
+
+// std
+#include <filesystem>
+#include <fstream>
+
+using namespace hnll::utils;
+
+namespace {
+struct item
+{
+  float    position[3];
+  uint32_t id;
+};
+
+std::string write_file(const std::filesystem::path& path, const std::string& contents)
+{
+  std::ofstream(path) << contents;
+  return path.string();
+}
+} // anonymous namespace
+
+TEST(asset_package, round_trip_and_freshness)
+{
+  const auto dir = std::filesystem::temp_directory_path() / "hnll_asset_package_test";
+  std::filesystem::create_directories(dir);
+  const auto source  = write_file(dir / "model.obj", "v 0 0 0\n");
+  const auto package_path = (dir / "model.obj.mesh.hpk").string();
+
+  std::vector<item> items = { { { 1.f, 2.f, 3.f }, 7 }, { { 4.f, 5.f, 6.f }, 8 } };
+  std::vector<uint32_t> indices = { 0, 1, 1, 0, 2 };
+  {
+    auto package = asset_package::create();
+    package->add_dependency(source);
+    package->add_chunk("items", items);
+    package->add_chunk("indices", indices);
+    package->add_chunk("empty", std::vector<uint32_t>{});
+    EXPECT_THROW(package->add_chunk("items", items), std::runtime_error);
+    package->save(package_path);
+  }
+
+  auto loaded = asset_package::load_if_fresh(package_path);
+  ASSERT_NE(loaded, nullptr);
+  EXPECT_EQ(loaded->get_chunk_count(), 3);
+  auto loaded_items = loaded->get_chunk<item>("items");
+  ASSERT_EQ(loaded_items.size(), 2);
+  EXPECT_EQ(loaded_items[1].id, 8);
+  EXPECT_FLOAT_EQ(loaded_items[1].position[2], 6.f);
+  EXPECT_EQ(loaded->get_chunk<uint32_t>("indices"), indices);
+  EXPECT_TRUE(loaded->get_chunk<uint32_t>("empty").empty());
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(loaded->get_chunk_bytes("indices").data()) % 16, 0);
+  EXPECT_THROW(loaded->get_chunk_bytes("missing"), std::runtime_error);
+
+  // a changed source makes the package stale
+  write_file(dir / "model.obj", "v 0 0 0\nv 1 0 0\n");
+  EXPECT_FALSE(loaded->is_fresh());
+  EXPECT_EQ(asset_package::load_if_fresh(package_path), nullptr);
+  EXPECT_EQ(asset_package::load((dir / "missing.hpk").string()), nullptr);
+
+  // not a package
+  write_file(dir / "broken.hpk", "definitely not a package");
+  EXPECT_THROW(asset_package::load((dir / "broken.hpk").string()), std::runtime_error);
+
+  std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,153 @@
+// hnll
+#include <utils/ecs_world.hpp>
+
+// lib
+#include <gtest/gtest.h>
+
+// std
+#include <random>
+#include <memory>
+#include <unordered_map>
+
+using namespace hnll::utils;
+
+namespace {
+struct position { float x, y, z; };
+struct velocity { float x, y, z; };
+struct tag {};
+// counts the live instances to check relocations and destructions
+struct tracked
+{
+  static inline int live_count = 0;
+  explicit tracked(int v = 0) : value(std::make_shared<int>(v)) { live_count++; }
+  tracked(tracked&& other) noexcept : value(std::move(other.value)) { live_count++; }
+  tracked& operator=(tracked&& other) noexcept { value = std::move(other.value); return *this; }
+  ~tracked() { live_count--; }
+  std::shared_ptr<int> value;
+};
+} // anonymous namespace
+
+TEST(ecs_world, handles)
+{
+  ecs_world world;
+  auto a = world.create_entity();
+  auto b = world.create_entity(position{ 1, 2, 3 });
+  EXPECT_TRUE(world.is_alive(a));
+  EXPECT_EQ(world.get_entity_count(), 2);
+  EXPECT_EQ(world.get<position>(b)->y, 2);
+  EXPECT_EQ(world.get<position>(a), nullptr);
+
+  world.destroy_entity(a);
+  EXPECT_FALSE(world.is_alive(a));
+  // the index is reused with a new generation, the stale handle stays dead
+  auto c = world.create_entity();
+  EXPECT_EQ(c.index, a.index);
+  EXPECT_NE(c.generation, a.generation);
+  EXPECT_FALSE(world.is_alive(a));
+  world.destroy_entity(a);
+  EXPECT_TRUE(world.is_alive(c));
+  EXPECT_THROW(world.add<tag>(a), std::runtime_error);
+}
+
+TEST(ecs_world, add_remove)
+{
+  tracked::live_count = 0;
+  {
+    ecs_world world;
+    std::vector<entity> entities;
+    for (int i = 0; i < 1000; i++)
+      entities.push_back(world.create_entity(tracked(i), position{ float(i), 0, 0 }));
+    EXPECT_EQ(tracked::live_count, 1000);
+
+    // moves every other entity to another archetype, and back for a third of them
+    for (int i = 0; i < 1000; i += 2) world.add<velocity>(entities[i], velocity{ 0, float(i), 0 });
+    for (int i = 0; i < 1000; i += 6) world.remove<velocity>(entities[i]);
+    for (int i = 1; i < 1000; i += 4) world.remove<tracked>(entities[i]);
+    for (int i = 3; i < 1000; i += 8) world.destroy_entity(entities[i]);
+
+    for (int i = 0; i < 1000; i++) {
+      auto e = entities[i];
+      if (i % 8 == 3) {
+        EXPECT_FALSE(world.is_alive(e));
+        continue;
+      }
+      ASSERT_EQ(world.get<position>(e)->x, float(i));
+      EXPECT_EQ(world.has<velocity>(e), i % 2 == 0 && i % 6 != 0);
+      if (world.has<velocity>(e)) {
+        EXPECT_EQ(world.get<velocity>(e)->y, float(i));
+      }
+      if (i % 4 == 1) {
+        EXPECT_FALSE(world.has<tracked>(e));
+      }
+      else {
+        EXPECT_EQ(*world.get<tracked>(e)->value, i);
+      }
+    }
+    EXPECT_EQ(tracked::live_count, 1000 - 250 - 125);
+  }
+  // the world destroys the remaining components
+  EXPECT_EQ(tracked::live_count, 0);
+}
+
+TEST(ecs_world, query)
+{
+  ecs_world world;
+  std::mt19937 engine(5);
+  std::unordered_map<uint32_t, float> expected;
+  // several archetypes with position and velocity, spanning several chunks
+  for (int i = 0; i < 5000; i++) {
+    entity e;
+    switch (engine() % 4) {
+      case 0 : e = world.create_entity(position{ 0, 0, 0 }); break;
+      case 1 : e = world.create_entity(position{ 0, 0, 0 }, velocity{ 1, 0, 0 }); break;
+      case 2 : e = world.create_entity(velocity{ 1, 0, 0 }, tag{}, position{ 0, 0, 0 }); break;
+      default: e = world.create_entity(velocity{ 1, 0, 0 }); break;
+    }
+    if (world.has<position>(e))
+      expected[e.index] = world.has<velocity>(e) ? 2.f : 0.f;
+  }
+  EXPECT_EQ(world.get_archetype_count(), 5);
+
+  world.each<position, velocity>([](position& p, const velocity& v) { p.x += v.x; });
+  job_system jobs(3);
+  world.each_parallel<position, velocity>(jobs, [](position& p, const velocity& v) { p.x += v.x; });
+
+  size_t count = 0;
+  world.each<position>([&](entity e, position& p) {
+    EXPECT_EQ(p.x, expected[e.index]);
+    count++;
+  });
+  EXPECT_EQ(count, expected.size());
+
+  // chunk arrays are contiguous
+  size_t chunk_rows = 0;
+  world.each_chunk<position, velocity>([&](const entity* entities, position* p, velocity*, size_t rows) {
+    for (size_t i = 0; i < rows; i++)
+      EXPECT_EQ(world.get<position>(entities[i]), p + i);
+    chunk_rows += rows;
+  });
+  EXPECT_GT(chunk_rows, 0);
+
+  // structural changes during an iteration
+  EXPECT_THROW(world.each<position>([&](entity e, position&) { world.remove<position>(e); }), std::runtime_error);
+  {
+    ecs_world::structure_lock lock(world);
+    EXPECT_THROW(world.create_entity(), std::runtime_error);
+  }
+  EXPECT_FALSE(world.create_entity().is_null());
+}
+
+TEST(ecs_world, scoped_entity)
+{
+  ecs_world world;
+  scoped_entity a(world, world.create_entity(position{}));
+  {
+    scoped_entity b(world, world.create_entity());
+    a = std::move(b);
+    EXPECT_TRUE(b.is_null());
+  }
+  // the first entity was destroyed by the assignment, the second one by a
+  EXPECT_EQ(world.get_entity_count(), 1);
+  a.reset();
+  EXPECT_EQ(world.get_entity_count(), 0);
+}
@@ -0,0 +1,35 @@
+// hnll
+#include <utils/fixed_timestep.hpp>
+
+// lib
+#include <gtest/gtest.h>
+
+using hnll::utils::fixed_timestep;
+
+TEST(fixed_timestep, independent_of_frame_rate)
+{
+  // one second at different frame rates runs the same number of steps
+  for (double fps : { 30.0, 60.0, 144.0, 240.0 }) {
+    fixed_timestep timestep(1.0 / 60.0);
+    int steps = 0;
+    for (int i = 0; i < static_cast<int>(fps); i++) {
+      steps += timestep.advance(1.0 / fps);
+      EXPECT_GE(timestep.get_alpha(), 0.0);
+      EXPECT_LT(timestep.get_alpha(), 1.0);
+    }
+    EXPECT_NEAR(steps, 60, 1);
+  }
+}
+
+TEST(fixed_timestep, catch_up_budget)
+{
+  fixed_timestep timestep(1.0 / 60.0, 4);
+  // hitch of one second
+  EXPECT_EQ(timestep.advance(1.0), 4);
+  EXPECT_NEAR(timestep.get_dropped_time(), 1.0 - 4.0 / 60.0, 1.0 / 60.0);
+  EXPECT_LT(timestep.get_alpha(), 1.0);
+  // back to normal
+  auto steps = timestep.advance(1.0 / 60.0);
+  EXPECT_LE(steps, 2);
+  EXPECT_EQ(timestep.get_step_count(), 4 + steps);
+}
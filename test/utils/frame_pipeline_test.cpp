@@ -0,0 +1,88 @@
+// hnll
+#include <utils/frame_pipeline.hpp>
+
+// lib
+#include <gtest/gtest.h>
+
+// std
+#include <atomic>
+#include <thread>
+
+using namespace hnll::utils;
+
+namespace {
+struct frame
+{
+  uint64_t number;
+  std::vector<int> values;
+};
+} // anonymous namespace
+
+TEST(frame_pipeline, order_and_contents)
+{
+  frame_pipeline<frame> pipeline(2);
+  const uint64_t frame_count = 2000;
+  std::atomic<uint64_t> max_lead = 0;
+
+  std::thread consumer([&] {
+    uint64_t expected = 0;
+    while (auto* f = pipeline.begin_read()) {
+      EXPECT_EQ(f->number, expected);
+      for (auto v : f->values) EXPECT_EQ(v, static_cast<int>(expected));
+      expected++;
+      pipeline.end_read();
+    }
+    EXPECT_EQ(expected, frame_count);
+  });
+
+  for (uint64_t i = 0; i < frame_count; i++) {
+    auto* f = pipeline.begin_write();
+    ASSERT_NE(f, nullptr);
+    // the frames are reused
+    f->number = i;
+    f->values.assign(64, static_cast<int>(i));
+    pipeline.end_write();
+    const auto lead = pipeline.get_write_count() - pipeline.get_release_count();
+    max_lead = std::max(max_lead.load(), lead);
+  }
+  pipeline.close();
+  consumer.join();
+
+  // the written frames which are not released never exceed the frames of the pipeline
+  EXPECT_LE(max_lead, pipeline.get_latency() + 1);
+  EXPECT_EQ(pipeline.get_release_count(), frame_count);
+}
+
+TEST(frame_pipeline, back_pressure)
+{
+  frame_pipeline<frame> pipeline(1);
+  // two frames fit without a consumer
+  ASSERT_NE(pipeline.begin_write(), nullptr); pipeline.end_write();
+  ASSERT_NE(pipeline.begin_write(), nullptr); pipeline.end_write();
+
+  std::atomic<bool> third_written = false;
+  std::thread producer([&] {
+    if (pipeline.begin_write() != nullptr) {
+      third_written = true;
+      pipeline.end_write();
+    }
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_FALSE(third_written);
+
+  // releasing a frame unblocks the producer
+  ASSERT_NE(pipeline.begin_read(), nullptr);
+  pipeline.end_read();
+  producer.join();
+  EXPECT_TRUE(third_written);
+  EXPECT_GT(pipeline.get_write_wait().count(), 0);
+
+  // close wakes a blocked producer, and the written frames can still be read
+  pipeline.close();
+  EXPECT_EQ(pipeline.begin_write(), nullptr);
+  EXPECT_NE(pipeline.begin_read(), nullptr);
+  pipeline.end_read();
+  EXPECT_NE(pipeline.begin_read(), nullptr);
+  pipeline.end_read();
+  EXPECT_EQ(pipeline.begin_read(), nullptr);
+}
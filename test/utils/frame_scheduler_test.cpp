@@ -0,0 +1,113 @@
+// hnll
+#include <utils/frame_scheduler.hpp>
+
+// lib
+#include <gtest/gtest.h>
+
+// std
+#include <string>
+#include <vector>
+
+using namespace hnll::utils;
+
+namespace {
+// each step of a task advances the fake clock by a millisecond
+struct fake_clock
+{
+  double now = 0.0;
+  frame_scheduler::clock_func get() { return [this] { return now; }; }
+};
+
+frame_task count_steps(frame_scheduler& scheduler, fake_clock& clock, int step_count, int& done_steps)
+{
+  for (int i = 0; i < step_count; i++) {
+    clock.now += 1.0;
+    done_steps++;
+    co_await scheduler.yield();
+  }
+}
+
+frame_task record(frame_scheduler& scheduler, fake_clock& clock, std::vector<std::string>& order, std::string name)
+{
+  clock.now += 1.0;
+  order.push_back(name);
+  co_await scheduler.next_frame();
+  order.push_back(name);
+}
+} // anonymous namespace
+
+TEST(frame_scheduler, budget_slicing)
+{
+  fake_clock clock;
+  frame_scheduler scheduler(clock.get());
+  int done_steps = 0;
+  auto id = scheduler.spawn(count_steps(scheduler, clock, 10, done_steps));
+
+  // 3 ms per frame : 3 steps per frame
+  scheduler.run_frame(3.0);
+  EXPECT_EQ(done_steps, 3);
+  EXPECT_FALSE(scheduler.is_done(id));
+  scheduler.run_frame(3.0);
+  scheduler.run_frame(3.0);
+  EXPECT_EQ(done_steps, 9);
+  scheduler.run_frame(3.0);
+  EXPECT_EQ(done_steps, 10);
+  EXPECT_TRUE(scheduler.is_done(id));
+  EXPECT_EQ(scheduler.get_task_count(), 0);
+  EXPECT_EQ(scheduler.get_stats().completed_task_count, 1);
+  EXPECT_EQ(scheduler.get_stats().overrun_frame_count, 0);
+}
+
+TEST(frame_scheduler, priority_and_deadline)
+{
+  fake_clock clock;
+  frame_scheduler scheduler(clock.get());
+  std::vector<std::string> order;
+  scheduler.spawn(record(scheduler, clock, order, "low"), 0);
+  scheduler.spawn(record(scheduler, clock, order, "high"), 10);
+  // the budget fits one task per frame
+  scheduler.run_frame(1.0);
+  ASSERT_EQ(order.size(), 1);
+  EXPECT_EQ(order[0], "high");
+
+  // the due task runs first, and even without budget
+  scheduler.spawn(record(scheduler, clock, order, "urgent"), -10, 0);
+  scheduler.run_frame(0.0);
+  EXPECT_EQ(scheduler.get_stats().deadline_miss_count, 0);
+  scheduler.run_frame(0.0);
+  EXPECT_EQ(scheduler.get_stats().deadline_miss_count, 1);
+  ASSERT_EQ(order.size(), 3);
+  EXPECT_EQ(order[1], "urgent");
+  EXPECT_EQ(order[2], "urgent");
+}
+
+TEST(frame_scheduler, overrun_cancel_and_error)
+{
+  fake_clock clock;
+  frame_scheduler scheduler(clock.get());
+  std::string overrun_name;
+  double overrun_ms = 0.0;
+  scheduler.set_overrun_hook([&](const char* name, double ms) { overrun_name = name; overrun_ms = ms; });
+
+  // a slice which doesn't yield in time
+  auto slow = [&]() -> frame_task { clock.now += 5.0; co_return; };
+  scheduler.spawn(slow(), 0, frame_scheduler::NO_DEADLINE, "slow");
+  scheduler.run_frame(2.0);
+  EXPECT_EQ(overrun_name, "slow");
+  EXPECT_DOUBLE_EQ(overrun_ms, 3.0);
+  EXPECT_EQ(scheduler.get_stats().overrun_frame_count, 1);
+
+  int done_steps = 0;
+  auto id = scheduler.spawn(count_steps(scheduler, clock, 100, done_steps));
+  scheduler.run_frame(2.0);
+  EXPECT_TRUE(scheduler.cancel(id));
+  EXPECT_TRUE(scheduler.is_done(id));
+  EXPECT_FALSE(scheduler.cancel(id));
+  scheduler.run_frame(2.0);
+  EXPECT_EQ(done_steps, 2);
+
+  auto failing = [&]() -> frame_task { throw std::runtime_error("failing task"); co_return; };
+  scheduler.spawn(failing());
+  EXPECT_THROW(scheduler.run_frame(2.0), std::runtime_error);
+  EXPECT_EQ(scheduler.get_task_count(), 0);
+}
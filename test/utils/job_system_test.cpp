@@ -0,0 +1,227 @@
+// hnll
+#include <utils/job_system.hpp>
+
+// lib
+#include <gtest/gtest.h>
+
+// std
+#include <numeric>
+#include <stdexcept>
+
+using namespace hnll::utils;
+
+TEST(work_stealing_deque, owner)
+{
+  work_stealing_deque<int> deque(2);
+  std::vector<int> values(100);
+  std::iota(values.begin(), values.end(), 0);
+  for (auto& value : values) deque.push(&value);
+  EXPECT_GE(deque.capacity(), 100);
+  EXPECT_EQ(deque.size(), 100);
+
+  // lifo for the owner, fifo for the thieves
+  EXPECT_EQ(*deque.pop(), 99);
+  EXPECT_EQ(*deque.steal(), 0);
+  EXPECT_EQ(*deque.steal(), 1);
+  EXPECT_EQ(*deque.pop(), 98);
+  while (deque.pop() != nullptr);
+  EXPECT_TRUE(deque.empty());
+  EXPECT_EQ(deque.steal(), nullptr);
+}
+
+TEST(work_stealing_deque, thieves)
+{
+  // every element is taken exactly once, by the owner or by one of the thieves
+  const int count = 200000;
+  work_stealing_deque<int> deque(16);
+  std::vector<int> values(count);
+  std::iota(values.begin(), values.end(), 0);
+  std::vector<std::atomic<int>> taken(count);
+  std::atomic<bool> is_done = false;
+
+  std::vector<std::thread> thieves;
+  for (int t = 0; t < 3; t++)
+    thieves.emplace_back([&] {
+      while (!is_done.load()) {
+        if (auto* value = deque.steal())
+          taken[*value]++;
+      }
+    });
+
+  for (int i = 0; i < count; i++) {
+    deque.push(&values[i]);
+    // the owner pops some of its elements back, racing for the last one
+    if (i % 3 == 0)
+      if (auto* value = deque.pop())
+        taken[*value]++;
+  }
+  while (auto* value = deque.pop())
+    taken[*value]++;
+  is_done = true;
+  for (auto& thief : thieves) thief.join();
+
+  for (int i = 0; i < count; i++)
+    ASSERT_EQ(taken[i].load(), 1) << i;
+}
+
+TEST(job_system, counter)
+{
+  job_system jobs(3);
+  EXPECT_EQ(jobs.get_worker_count(), 3);
+  EXPECT_TRUE(jobs.is_main_thread());
+
+  std::atomic<int> sum = 0;
+  job_counter counter;
+  for (int i = 1; i <= 1000; i++)
+    jobs.run([&sum, i] { sum += i; }, &counter);
+  jobs.wait(counter);
+  EXPECT_TRUE(counter.is_done());
+  EXPECT_EQ(sum.load(), 500500);
+
+  uint64_t executed = 0;
+  for (uint32_t i = 0; i < jobs.get_thread_count(); i++)
+    executed += jobs.get_executed_count(i);
+  EXPECT_EQ(executed, 1000);
+}
+
+TEST(job_system, dependencies)
+{
+  job_system jobs(3);
+  std::vector<int> order;
+  std::mutex mutex;
+  auto record = [&](int stage) {
+    std::lock_guard<std::mutex> lock(mutex);
+    order.push_back(stage);
+  };
+
+  // 8 jobs of stage 0, then 8 of stage 1, then one of stage 2
+  job_counter first, second, last;
+  for (int i = 0; i < 8; i++)
+    jobs.run([&] { record(0); }, &first);
+  for (int i = 0; i < 8; i++)
+    jobs.run_after(first, [&] { record(1); }, &second);
+  jobs.run_after(second, [&] { record(2); }, &last);
+  jobs.wait(last);
+
+  ASSERT_EQ(order.size(), 17);
+  EXPECT_TRUE(std::is_sorted(order.begin(), order.end()));
+
+  // a finished dependency starts the job immediately
+  std::atomic<bool> is_run = false;
+  jobs.run_after(first, [&] { is_run = true; }, &last);
+  jobs.wait(last);
+  EXPECT_TRUE(is_run.load());
+}
+
+TEST(job_system, parallel_for)
+{
+  job_system jobs(3);
+  const size_t count = 1 << 20;
+  std::vector<uint8_t> visited(count, 0);
+  for (size_t grain : { size_t(0), size_t(1000), size_t(4096), count }) {
+    std::fill(visited.begin(), visited.end(), 0);
+    jobs.parallel_for(0, count, grain, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) visited[i]++;
+    });
+    EXPECT_EQ(std::count(visited.begin(), visited.end(), 1), count) << grain;
+  }
+
+  // no worker : runs inline
+  job_system single(1);
+  std::atomic<size_t> sum = 0;
+  single.parallel_for(10, 20, 3, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) sum += i;
+  });
+  EXPECT_EQ(sum.load(), 145);
+}
+
+TEST(job_system, nested_wait)
+{
+  // jobs which spawn and wait for jobs : the waiting threads execute the others instead of blocking
+  job_system jobs(2);
+  std::function<uint64_t(uint32_t)> fibonacci = [&](uint32_t n) -> uint64_t {
+    if (n < 2) return n;
+    uint64_t a = 0;
+    job_counter counter;
+    jobs.run([&] { a = fibonacci(n - 1); }, &counter);
+    const auto b = fibonacci(n - 2);
+    jobs.wait(counter);
+    return a + b;
+  };
+  EXPECT_EQ(fibonacci(20), 6765);
+}
+
+TEST(job_system, stress)
+{
+  // many short jobs from several threads, with and without the workers sleeping in between
+  job_system jobs(4);
+  std::atomic<uint64_t> sum = 0;
+  for (int round = 0; round < 20; round++) {
+    job_counter counter;
+    std::vector<std::thread> producers;
+    // external threads submit through the shared queue
+    for (int p = 0; p < 2; p++)
+      producers.emplace_back([&] {
+        EXPECT_EQ(jobs.get_thread_index(), job_system::NO_THREAD_INDEX);
+        for (int i = 0; i < 500; i++)
+          jobs.run([&] { sum++; }, &counter);
+      });
+    jobs.parallel_for(0, 1000, 7, [&](size_t begin, size_t end) {
+      // jobs submitted from the workers go to their own deques
+      for (size_t i = begin; i < end; i++)
+        jobs.run([&] { sum++; }, &counter);
+    });
+    for (auto& producer : producers) producer.join();
+    jobs.wait(counter);
+    if (round % 5 == 0)
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+  EXPECT_EQ(sum.load(), 20 * 2000);
+}
+
+TEST(job_system, main_thread_affinity)
+{
+  job_system jobs(2);
+  const auto main_id = std::this_thread::get_id();
+  std::atomic<int> on_main = 0, elsewhere = 0;
+  job_counter counter;
+
+  // submitted from the workers, executed by the main thread
+  jobs.parallel_for(0, 8, 1, [&](size_t, size_t) {
+    jobs.run([&] { (std::this_thread::get_id() == main_id ? on_main : elsewhere)++; },
+      &counter, job_affinity::MAIN_THREAD);
+  });
+  jobs.wait(counter);
+  EXPECT_EQ(on_main.load(), 8);
+  EXPECT_EQ(elsewhere.load(), 0);
+
+  jobs.run([&] { on_main++; }, nullptr, job_affinity::MAIN_THREAD);
+  EXPECT_EQ(jobs.process_main_thread_jobs(), 1);
+  EXPECT_EQ(on_main.load(), 9);
+}
+
+TEST(job_system, hooks_and_errors)
+{
+  std::atomic<int> begin_count = 0, end_count = 0, named_count = 0;
+  job_hooks hooks;
+  hooks.on_job_begin = [&](uint32_t, const char* name) {
+    begin_count++;
+    if (name != nullptr && std::string(name) == "named") named_count++;
+  };
+  hooks.on_job_end = [&](uint32_t, const char*) { end_count++; };
+  job_system jobs(2, std::move(hooks));
+
+  job_counter counter;
+  for (int i = 0; i < 10; i++)
+    jobs.run([] {}, &counter, job_affinity::ANY, "named");
+  jobs.run([] { throw std::runtime_error("job : failure"); }, &counter);
+  EXPECT_THROW(jobs.wait(counter), std::runtime_error);
+  EXPECT_TRUE(counter.is_done());
+  EXPECT_EQ(begin_count.load(), 11);
+  EXPECT_EQ(end_count.load(), 11);
+  EXPECT_EQ(named_count.load(), 10);
+
+  // the error is reported once
+  jobs.run([] {}, &counter);
+  EXPECT_NO_THROW(jobs.wait(counter));
+}
@@ -0,0 +1,150 @@
+// hnll
+#include <utils/obj_parser.hpp>
+#include <utils/job_system.hpp>
+
+// lib
+#include <gtest/gtest.h>
+
+// std
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <sstream>
+
+using namespace hnll::utils;
+
+namespace {
+using vertex_values = std::array<float, 11>;
+
+vertex_values get_values(const obj_data& data, const obj_index& index)
+{
+  vertex_values res{};
+  for (int i = 0; i < 3; i++) {
+    res[i]     = data.positions[3 * index.position + i];
+    res[3 + i] = data.colors[3 * index.position + i];
+    if (index.normal >= 0) res[6 + i] = data.normals[3 * index.normal + i];
+  }
+  if (index.texcoord >= 0) {
+    res[9]  = data.texcoords[2 * index.texcoord];
+    res[10] = data.texcoords[2 * index.texcoord + 1];
+  }
+  return res;
+}
+
+// the welded vertices should be the distinct values in the order of their first appearances
+void expect_welded(const obj_data& data)
+{
+  std::map<vertex_values, uint32_t> ids;
+  for (uint32_t i = 0; i < data.indices.size(); i++) {
+    ASSERT_LT(data.indices[i], data.vertices.size());
+    auto values = get_values(data, data.vertices[data.indices[i]]);
+    auto [it, inserted] = ids.emplace(values, static_cast<uint32_t>(ids.size()));
+    EXPECT_EQ(it->second, data.indices[i]);
+  }
+  EXPECT_EQ(ids.size(), data.vertices.size());
+}
+} // anonymous namespace
+
+TEST(obj_parser, parse_float)
+{
+  for (const char* text : { "0", "-1", "+2.5", "0.000001", "123456.789", "-3.25e-3", "1E10", ".5", "7.",
+                            "3.14159265358979323846", "1e-40", "1e39", "0.1000000000000000000001" }) {
+    float value = -42.f;
+    auto* end = parse_float(text, text + std::strlen(text), value);
+    ASSERT_EQ(end, text + std::strlen(text)) << text;
+    EXPECT_EQ(value, std::strtof(text, nullptr)) << text;
+  }
+  // the number ends at the first other character
+  const std::string text = "1.5/2";
+  float value;
+  EXPECT_EQ(parse_float(text.data(), text.data() + text.size(), value), text.data() + 3);
+  EXPECT_EQ(value, 1.5f);
+  for (std::string invalid : { "", "-", ".", "x1", "e5" })
+    EXPECT_EQ(parse_float(invalid.data(), invalid.data() + invalid.size(), value), nullptr) << invalid;
+}
+
+TEST(obj_parser, parse)
+{
+  const std::string text =
+    "# quad\r\n"
+    "mtllib quad.mtl\n"
+    "o quad\n"
+    "v 0 0 0 1 0 0\n"
+    "v 1 0 0\n"
+    "v 1 1 0\n"
+    "  v 0 1 0\n"
+    "v 0 0 0 1 0 0\n"
+    "vt 0 0\nvt 1 0\nvt 1 1\nvt 0.5\n"
+    "vn 0 0 1\n"
+    "s off\n"
+    "f 1/1/1 2/2/1 3/3/1 4/4/1\n"
+    // 5/1/1 has the same values as 1/1/1, -3/-2/-1 is 3/3/1
+    "f 5/1/1 -3/-2/-1 3/3/1 # comment\n"
+    "f 1 2 3\n";
+
+  auto data = parse_obj(text);
+  EXPECT_EQ(data.positions.size(), 15);
+  EXPECT_EQ(data.colors[0], 1.f);
+  EXPECT_EQ(data.colors[1], 0.f);
+  EXPECT_EQ(data.colors[3], 1.f);
+  EXPECT_EQ(data.texcoords[7], 0.f);
+  // 2 triangles of the quad, 2 triangles
+  ASSERT_EQ(data.indices.size(), 12);
+  EXPECT_EQ(data.indices, (std::vector<uint32_t>{ 0, 1, 2, 0, 2, 3, 0, 2, 2, 4, 5, 6 }));
+  ASSERT_EQ(data.vertices.size(), 7);
+  EXPECT_EQ(data.vertices[3].texcoord, 3);
+  EXPECT_EQ(data.vertices[4].texcoord, -1);
+  EXPECT_EQ(data.vertices[4].normal, -1);
+  expect_welded(data);
+
+  EXPECT_THROW(parse_obj("v 0 0 0\nf 1 2 3\n"), std::runtime_error);
+  EXPECT_THROW(parse_obj("v 0 0 0\nf 1 -2 1\n"), std::runtime_error);
+  EXPECT_THROW(parse_obj("v 0 0\n"), std::runtime_error);
+  EXPECT_THROW(parse_obj("v 0 0 0\nf 1 1 x\n"), std::runtime_error);
+  EXPECT_TRUE(parse_obj("").indices.empty());
+  EXPECT_THROW(load_obj("/nonexistent/model.obj"), std::runtime_error);
+}
+
+TEST(obj_parser, parallel)
+{
+  // a grid of several chunks and weld blocks, with relative indices and duplicated positions
+  std::ostringstream text;
+  constexpr int size = 300;
+  for (int y = 0; y <= size; y++) {
+    for (int x = 0; x <= size; x++) {
+      text << "v " << x * 0.01 << ' ' << y * 0.01 << ' ' << (x * y % 7) * 0.125 << '\n';
+      text << "vt " << x / double(size) << ' ' << y / double(size) << '\n';
+    }
+  }
+  text << "vn 0 0 1\n";
+  for (int x = 0; x <= size; x++)
+    text << "v " << x * 0.01 << " 0 0\n";
+  for (int y = 0; y < size; y++) {
+    for (int x = 0; x < size; x++) {
+      const int i = y * (size + 1) + x + 1;
+      const int j = i + size + 1;
+      if ((x + y) % 3 == 0)
+        text << "f " << i << '/' << i << "/1 " << i + 1 << '/' << i + 1 << "/1 " << j + 1 << '/' << j + 1 << "/1 " << j << '/' << j << "/1\n";
+      else
+        text << "f " << i << "//1 " << i + 1 << "//-1 " << j + 1 << "//1\n";
+    }
+  }
+  // the duplicated positions
+  for (int x = 0; x < size; x++)
+    text << "f " << x - size - 1 << ' ' << x - size << " 1\n";
+  const auto str = text.str();
+  ASSERT_GT(str.size(), 4u << 20);
+
+  auto serial = parse_obj(str);
+  expect_welded(serial);
+
+  auto jobs = job_system::create(4);
+  auto parallel = parse_obj(str, jobs.get());
+  EXPECT_EQ(parallel.positions, serial.positions);
+  EXPECT_EQ(parallel.texcoords, serial.texcoords);
+  EXPECT_EQ(parallel.indices, serial.indices);
+  ASSERT_EQ(parallel.vertices.size(), serial.vertices.size());
+  for (size_t i = 0; i < serial.vertices.size(); i++)
+    EXPECT_EQ(get_values(parallel, parallel.vertices[i]), get_values(serial, serial.vertices[i]));
+}
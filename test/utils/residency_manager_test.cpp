@@ -0,0 +1,94 @@
+// hnll
+#include <utils/residency_manager.hpp>
+
+// lib
+#include <gtest/gtest.h>
+
+// std
+#include <string>
+#include <vector>
+
+using namespace hnll::utils;
+
+TEST(residency_manager, lru_and_priority)
+{
+  residency_manager manager(250);
+  std::vector<std::string> evicted;
+  auto add = [&](const std::string& name, int priority) {
+    return manager.add(name, 100, priority, [&evicted, name] { evicted.push_back(name); });
+  };
+
+  auto a = add("a", 0);
+  manager.next_frame();
+  auto b = add("b", 0);
+  manager.next_frame();
+  auto c = add("c", 1);
+  // a is drawn after b, through a handle as the shading systems do
+  manager.next_frame();
+  {
+    int model = 0;
+    resident_handle<int>(&model, residency_ref(manager, a)).touch();
+  }
+  EXPECT_EQ(manager.get_resident_bytes(), 300);
+
+  // b is the least recently used of the lowest priority
+  EXPECT_EQ(manager.trim(), 100);
+  ASSERT_EQ(evicted.size(), 1);
+  EXPECT_EQ(evicted[0], "b");
+  EXPECT_FALSE(manager.contains(b));
+  EXPECT_EQ(manager.trim(), 0);
+  // the stale ids are ignored
+  manager.set_priority(b, 2);
+
+  // the referenced resources are kept even over the budget
+  manager.set_budget(0);
+  {
+    residency_ref ref(manager, c);
+    auto copy = ref;
+    EXPECT_EQ(manager.get_ref_count(c), 2);
+    manager.trim();
+    ASSERT_EQ(evicted.size(), 2);
+    EXPECT_EQ(evicted[1], "a");
+    EXPECT_TRUE(manager.contains(c));
+    EXPECT_EQ(manager.get_stats().over_budget_count, 1);
+  }
+  EXPECT_EQ(manager.get_ref_count(c), 0);
+  manager.trim();
+  EXPECT_EQ(evicted.size(), 3);
+  EXPECT_EQ(manager.get_resident_bytes(), 0);
+  EXPECT_EQ(manager.get_stats().eviction_count, 3);
+  EXPECT_EQ(manager.get_stats().evicted_bytes, 300);
+}
+
+TEST(residency_manager, reload_and_stale_refs)
+{
+  residency_manager manager(0);
+  std::string hooked;
+  manager.set_eviction_hook([&](const std::string& name, size_t bytes) { hooked = name + std::to_string(bytes); });
+  int reloads = 0;
+  manager.set_reload_hook([&](const std::string&) { reloads++; });
+
+  auto id = manager.add("model", 64, 0, {});
+  resident_handle<int> handle;
+  {
+    int value = 3;
+    handle = resident_handle<int>(&value, residency_ref(manager, id));
+    EXPECT_EQ(*handle, 3);
+    handle.reset();
+  }
+  manager.trim();
+  EXPECT_EQ(hooked, "model64");
+
+  // a reference to an evicted resource does nothing
+  residency_ref stale(manager, id);
+  stale.touch();
+  stale.reset();
+
+  auto pinned = manager.add("model", 64, 0, {});
+  EXPECT_EQ(reloads, 1);
+  EXPECT_EQ(manager.get_stats().reload_count, 1);
+  EXPECT_EQ(manager.get_stats().peak_resident_bytes, 64);
+  manager.pin(pinned);
+  EXPECT_EQ(manager.trim(), 0);
+  EXPECT_TRUE(manager.contains(pinned));
+}
@@ -0,0 +1,72 @@
+// hnll
+#include <utils/slot_map.hpp>
+
+// lib
+#include <gtest/gtest.h>
+
+// std
+#include <memory>
+#include <random>
+
+using namespace hnll::utils;
+
+TEST(slot_map, handles)
+{
+  slot_map<std::unique_ptr<int>> map;
+  auto a = map.emplace(std::make_unique<int>(1));
+  auto b = map.emplace(std::make_unique<int>(2));
+  auto c = map.emplace(std::make_unique<int>(3));
+  EXPECT_EQ(**map.get(b), 2);
+
+  // the last element fills the hole, and stays reachable by its handle
+  EXPECT_TRUE(map.erase(a));
+  EXPECT_EQ(map.size(), 2);
+  EXPECT_EQ(map.get(a), nullptr);
+  EXPECT_EQ(*map[c], 3);
+  EXPECT_FALSE(map.erase(a));
+
+  // the slot is reused with a new generation
+  auto d = map.emplace(std::make_unique<int>(4));
+  EXPECT_EQ(d.index, a.index);
+  EXPECT_FALSE(map.contains(a));
+  EXPECT_EQ(**map.get(d), 4);
+
+  map.clear();
+  EXPECT_FALSE(map.contains(b));
+  EXPECT_FALSE(map.contains(d));
+  EXPECT_EQ(map.get(slot_handle{}), nullptr);
+}
+
+TEST(slot_map, random_operations)
+{
+  // compared with the handles and values kept aside
+  slot_map<int> map;
+  std::vector<std::pair<slot_handle, int>> live;
+  std::vector<slot_handle> dead;
+  std::mt19937 engine(11);
+  for (int i = 0; i < 20000; i++) {
+    if (live.empty() || engine() % 3 != 0) {
+      live.emplace_back(map.insert(i), i);
+      continue;
+    }
+    auto pick = engine() % live.size();
+    EXPECT_TRUE(map.erase(live[pick].first));
+    dead.push_back(live[pick].first);
+    live[pick] = live.back();
+    live.pop_back();
+  }
+
+  ASSERT_EQ(map.size(), live.size());
+  for (const auto& [handle, value] : live)
+    ASSERT_EQ(*map.get(handle), value);
+  for (const auto& handle : dead)
+    ASSERT_FALSE(map.contains(handle));
+
+  // the dense order matches the handles
+  long long sum = 0, expected = 0;
+  for (size_t i = 0; i < map.size(); i++)
+    EXPECT_EQ(map[map.get_handle(i)], map.get_values()[i]);
+  for (auto value : map) sum += value;
+  for (const auto& kv : live) expected += kv.second;
+  EXPECT_EQ(sum, expected);
+}
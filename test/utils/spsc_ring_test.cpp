@@ -0,0 +1,59 @@
+// hnll
+#include <utils/spsc_ring.hpp>
+
+// lib
+#include <gtest/gtest.h>
+
+// std
+#include <thread>
+
+using hnll::utils::spsc_ring;
+
+TEST(spsc_ring, capacity)
+{
+  spsc_ring<int> ring(5);
+  EXPECT_EQ(ring.capacity(), 8);
+  const std::vector<int> values = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+  EXPECT_EQ(ring.push(values.data(), values.size()), 8);
+  EXPECT_FALSE(ring.push(10));
+
+  std::vector<int> popped(3);
+  EXPECT_EQ(ring.pop(popped.data(), 3), 3);
+  EXPECT_EQ(popped, std::vector<int>({ 0, 1, 2 }));
+  // wraps around
+  EXPECT_EQ(ring.push(values.data(), values.size()), 3);
+  EXPECT_EQ(ring.size(), 8);
+
+  popped.resize(10);
+  EXPECT_EQ(ring.pop(popped.data(), 10), 8);
+  EXPECT_EQ(popped[4], 7);
+  EXPECT_EQ(popped[5], 0);
+  EXPECT_TRUE(ring.empty());
+}
+
+TEST(spsc_ring, threads)
+{
+  spsc_ring<uint64_t> ring(64);
+  const uint64_t count = 200000;
+
+  std::thread producer([&] {
+    for (uint64_t i = 0; i < count;) {
+      if (ring.push(i)) i++;
+      else std::this_thread::yield();
+    }
+  });
+
+  // the consumer sees every value exactly once and in order
+  uint64_t expected = 0;
+  bool in_order = true;
+  while (expected < count) {
+    uint64_t values[16];
+    auto popped = ring.pop(values, 16);
+    if (popped == 0) std::this_thread::yield();
+    for (size_t i = 0; i < popped; i++)
+      in_order &= values[i] == expected++;
+  }
+  producer.join();
+  EXPECT_TRUE(in_order);
+  EXPECT_TRUE(ring.empty());
+}
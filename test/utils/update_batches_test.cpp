@@ -0,0 +1,108 @@
+// hnll
+#include <utils/update_batches.hpp>
+
+// lib
+#include <gtest/gtest.h>
+
+// std
+#include <mutex>
+#include <random>
+
+using namespace hnll::utils;
+
+namespace {
+struct transform_pool {};
+struct input_state {};
+} // anonymous namespace
+
+TEST(access_list, conflicts)
+{
+  access_list reader, writer, other;
+  reader.read<transform_pool>().read<input_state>();
+  writer.write<transform_pool>();
+  other.write<input_state>().read<input_state>();
+
+  EXPECT_FALSE(reader.conflicts_with(reader));
+  EXPECT_TRUE (reader.conflicts_with(writer));
+  EXPECT_TRUE (writer.conflicts_with(reader));
+  EXPECT_TRUE (writer.conflicts_with(writer));
+  EXPECT_FALSE(writer.conflicts_with(other));
+  // written resources are not listed as read
+  EXPECT_TRUE (other.get_reads().empty());
+  EXPECT_EQ   (other.get_writes().size(), 1);
+
+  // objects by address
+  int a = 0, b = 0;
+  access_list write_a, write_b;
+  write_a.write(&a);
+  write_b.write(&b);
+  EXPECT_FALSE(write_a.conflicts_with(write_b));
+
+  access_list nothing, exclusive;
+  exclusive.exclusive();
+  EXPECT_FALSE(nothing.conflicts_with(nothing));
+  EXPECT_TRUE (nothing.conflicts_with(exclusive));
+}
+
+TEST(update_batches, placement)
+{
+  update_batches batches;
+  access_list local, read_pool, write_pool, exclusive;
+  read_pool.read<transform_pool>();
+  write_pool.write<transform_pool>();
+  exclusive.exclusive();
+
+  batches.add(local);      // 0
+  batches.add(read_pool);  // 0
+  batches.add(write_pool); // 1, after the reader
+  batches.add(read_pool);  // 2, after the writer
+  batches.add(local);      // 0
+  batches.add(exclusive);  // 3, alone
+  batches.add(local);      // 4, after the exclusive task
+  ASSERT_EQ(batches.get_batch_count(), 5);
+  EXPECT_EQ(batches.get_batch(0), std::vector<uint32_t>({ 0, 1, 4 }));
+  EXPECT_EQ(batches.get_batch(1), std::vector<uint32_t>({ 2 }));
+  EXPECT_EQ(batches.get_batch(2), std::vector<uint32_t>({ 3 }));
+  EXPECT_EQ(batches.get_batch(3), std::vector<uint32_t>({ 5 }));
+  EXPECT_EQ(batches.get_batch(4), std::vector<uint32_t>({ 6 }));
+}
+
+TEST(update_batches, same_as_serial)
+{
+  // every task appends its index to the logs it writes, and reads the size of the others
+  // the parallel run keeps the order of every log, and sees the same sizes as the serial one
+  const uint32_t task_count = 2000, log_count = 16;
+  std::mt19937 engine(3);
+  std::uniform_int_distribution<uint32_t> pick(0, log_count - 1);
+
+  std::vector<std::vector<uint32_t>> task_writes(task_count), task_reads(task_count);
+  std::vector<std::vector<uint32_t>> logs(log_count);
+  update_batches batches;
+  for (uint32_t t = 0; t < task_count; t++) {
+    access_list access;
+    // mostly independent tasks
+    if (t % 10 == 0) task_writes[t].push_back(pick(engine));
+    if (t % 4 == 0)  task_reads[t].push_back(pick(engine));
+    for (auto log : task_writes[t]) access.write(&logs[log]);
+    for (auto log : task_reads[t])  access.read(&logs[log]);
+    batches.add(access);
+  }
+  EXPECT_LT(batches.get_batch_count(), task_count / 10);
+
+  auto run = [&](job_system* jobs) {
+    for (auto& log : logs) log.clear();
+    std::vector<size_t> seen(task_count, 0);
+    batches.run(jobs, [&](uint32_t t) {
+      for (auto log : task_reads[t])  seen[t] += logs[log].size();
+      for (auto log : task_writes[t]) logs[log].push_back(t);
+    }, 8);
+    return std::make_pair(logs, seen);
+  };
+
+  const auto serial = run(nullptr);
+  job_system jobs(3);
+  for (int round = 0; round < 5; round++)
+    EXPECT_TRUE(run(&jobs) == serial);
+  for (const auto& log : serial.first)
+    EXPECT_TRUE(std::is_sorted(log.begin(), log.end()));
+}
@@ -0,0 +1,105 @@
+// hnll
+#include <utils/vfs.hpp>
+
+// lib
+#include <gtest/gtest.h>
+
+// std
+#include <filesystem>
+#include <fstream>
+
+using namespace hnll::utils;
+
+namespace {
+void write_file(const std::filesystem::path& path, const std::string& contents)
+{
+  std::filesystem::create_directories(path.parent_path());
+  std::ofstream(path, std::ios::binary) << contents;
+}
+} // anonymous namespace
+
+TEST(vfs, directory_mounts)
+{
+  const auto dir = std::filesystem::temp_directory_path() / "hnll_vfs_directory_test";
+  std::filesystem::remove_all(dir);
+  write_file(dir / "first/models/bunny.obj", "v 0 0 0\n");
+  write_file(dir / "first/empty.txt", "");
+  write_file(dir / "second/models/bunny.obj", "shadowed");
+  write_file(dir / "second/shaders/simple.vert.spv", "spirv");
+
+  auto fs = vfs::create();
+  fs->mount_directory((dir / "first").string());
+  fs->mount_directory((dir / "second").string());
+  EXPECT_EQ(fs->get_mount_count(), 2);
+
+  // the first mount wins
+  EXPECT_EQ(fs->open("models/bunny.obj").get_text(), "v 0 0 0\n");
+  EXPECT_EQ(fs->open("shaders/simple.vert.spv").get_text(), "spirv");
+  EXPECT_EQ(fs->get_real_path("models/bunny.obj"), (dir / "first/models/bunny.obj").string());
+
+  auto empty = fs->open("empty.txt");
+  EXPECT_TRUE(empty);
+  EXPECT_EQ(empty.get_size(), 0);
+
+  EXPECT_FALSE(fs->exists("missing.obj"));
+  EXPECT_FALSE(fs->open("missing.obj"));
+  EXPECT_FALSE(fs->get_real_path("missing.obj").has_value());
+  EXPECT_THROW(fs->mount_directory((dir / "missing").string()), std::runtime_error);
+
+  // open() skips the removed files even without the check
+  std::filesystem::remove(dir / "first/models/bunny.obj");
+  EXPECT_EQ(fs->open("models/bunny.obj").get_text(), "shadowed");
+  EXPECT_TRUE(fs->get_real_path("models/bunny.obj").has_value());
+
+  // the removed files of a stale index fall through to the later mounts
+  fs->set_stale_check(true);
+  EXPECT_EQ(fs->get_real_path("models/bunny.obj"), (dir / "second/models/bunny.obj").string());
+  std::filesystem::remove(dir / "second/models/bunny.obj");
+  EXPECT_FALSE(fs->exists("models/bunny.obj"));
+  EXPECT_FALSE(fs->open("models/bunny.obj"));
+
+  std::filesystem::remove_all(dir);
+}
+
+TEST(vfs, pack_round_trip)
+{
+  const auto dir = std::filesystem::temp_directory_path() / "hnll_vfs_pack_test";
+  std::filesystem::remove_all(dir);
+  std::string large(100000, 'x');
+  large.back() = 'y';
+  for (int i = 0; i < 40; i++)
+    write_file(dir / "assets" / ("models/model_" + std::to_string(i) + ".obj"), "model " + std::to_string(i));
+  write_file(dir / "assets/large.bin", large);
+  write_file(dir / "assets/empty.txt", "");
+  write_file(dir / "loose/models/model_0.obj", "loose");
+  const auto pack_path = (dir / "assets.pack").string();
+
+  vfs::write_pack((dir / "assets").string(), pack_path);
+
+  auto fs = vfs::create();
+  fs->mount_pack(pack_path);
+  fs->mount_directory((dir / "loose").string());
+  for (int i = 0; i < 40; i++) {
+    auto file = fs->open("models/model_" + std::to_string(i) + ".obj");
+    ASSERT_TRUE(file);
+    EXPECT_EQ(file.get_text(), "model " + std::to_string(i));
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(file.get_bytes().data()) % 16, 0);
+  }
+  EXPECT_EQ(fs->open("large.bin").get_text(), large);
+  EXPECT_TRUE(fs->exists("empty.txt"));
+  EXPECT_EQ(fs->open("empty.txt").get_size(), 0);
+  // packed files have no real path, and shadow the later mounts
+  EXPECT_FALSE(fs->get_real_path("models/model_0.obj").has_value());
+  EXPECT_FALSE(fs->exists("models/model_40.obj"));
+
+  // the file keeps the pack mapped
+  auto kept = fs->open("models/model_1.obj");
+  fs.reset();
+  EXPECT_EQ(kept.get_text(), "model 1");
+
+  write_file(dir / "broken.pack", "definitely not a pack");
+  EXPECT_THROW(vfs::create()->mount_pack((dir / "broken.pack").string()), std::runtime_error);
+  EXPECT_THROW(vfs::create()->mount_pack((dir / "missing.pack").string()), std::runtime_error);
+
+  std::filesystem::remove_all(dir);
+}
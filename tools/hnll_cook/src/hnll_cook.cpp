@@ -0,0 +1,134 @@
+// cooks the models of utils::loading_directories into the packages the engine loads without processing
+// usage : hnll_cook [--force] [directories...]
+
+// hnll
+#include <graphics/utils.hpp>
+#include <graphics/meshlet_model.hpp>
+#include <geometry/mesh_model.hpp>
+#include <geometry/mesh_separation.hpp>
+#include <utils/asset_package.hpp>
+#include <utils/job_system.hpp>
+#include <utils/utils.hpp>
+
+// std
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace hnll;
+
+namespace {
+
+struct cook_task
+{
+  // the key of the engine's model maps
+  std::string asset_name;
+  std::string source_path;
+  // "mesh", "meshlet"
+  const char* kind;
+  std::function<void(const std::string& source_path, const std::string& asset_name, utils::asset_package&, utils::job_system&)> cook;
+};
+
+void cook_mesh(const std::string& source_path, const std::string&, utils::asset_package& package, utils::job_system& jobs)
+{
+  graphics::mesh_builder builder;
+  // a large scan is parsed by all the workers
+  builder.load_model(source_path, &jobs);
+  builder.write_package(package);
+}
+
+void cook_meshlet(const std::string& source_path, const std::string& asset_name, utils::asset_package& package, utils::job_system&)
+{
+  graphics::meshlet_model_data data;
+  auto geometry_model = geometry::mesh_model::create_from_obj_file(source_path);
+  data.meshlets     = geometry::mesh_separation::separate(geometry_model, asset_name);
+  data.raw_vertices = geometry_model->move_raw_vertices();
+  data.write_package(package);
+}
+
+// the first directory wins for the duplicated names, as in utils::get_full_path()
+std::vector<cook_task> scan(const std::vector<std::string>& directories)
+{
+  std::vector<cook_task> tasks;
+  std::set<std::string> names;
+  for (const auto& directory : directories) {
+    if (!std::filesystem::is_directory(directory)) {
+      std::cerr << directory << " is not a directory." << std::endl;
+      continue;
+    }
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(directory)) {
+      if (!entry.is_regular_file() || entry.path().extension() != ".obj")
+        continue;
+      auto name = entry.path().filename().string();
+      if (!names.insert(name).second)
+        continue;
+      tasks.push_back({ name, entry.path().string(), "mesh", cook_mesh });
+      tasks.push_back({ name, entry.path().string(), "meshlet", cook_meshlet });
+    }
+  }
+  return tasks;
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+  bool force = false;
+  std::vector<std::string> directories;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--force") force = true;
+    else                  directories.push_back(arg);
+  }
+  if (directories.empty())
+    directories = utils::loading_directories;
+
+  const auto start = std::chrono::steady_clock::now();
+  // made once, before the workers
+  utils::create_sub_cache_directory("cooked");
+  utils::create_sub_cache_directory("meshlets");
+
+  auto tasks = scan(directories);
+  std::atomic<size_t> cooked_count = 0, fresh_count = 0, failed_count = 0;
+  std::mutex log_mutex;
+
+  auto jobs = utils::job_system::create();
+  // one task per chunk : the assets differ a lot in size
+  jobs->parallel_for(0, tasks.size(), 1, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      const auto& task = tasks[i];
+      const auto package_path = utils::get_cooked_path(task.asset_name, task.kind);
+      // the package records its sources, so only the changed ones are cooked again
+      if (!force && utils::asset_package::load_if_fresh(package_path) != nullptr) {
+        fresh_count++;
+        continue;
+      }
+      try {
+        auto package = utils::asset_package::create();
+        package->add_dependency(task.source_path);
+        task.cook(task.source_path, task.asset_name, *package, *jobs);
+        package->save(package_path);
+        cooked_count++;
+        std::lock_guard<std::mutex> lock(log_mutex);
+        std::cout << "cooked " << task.asset_name << " (" << task.kind << ")" << std::endl;
+      }
+      catch (const std::exception& e) {
+        failed_count++;
+        std::lock_guard<std::mutex> lock(log_mutex);
+        std::cerr << "failed to cook " << task.asset_name << " (" << task.kind << ") : " << e.what() << std::endl;
+      }
+    }
+  }, "cook");
+
+  const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::cout << cooked_count << " cooked, " << fresh_count << " up to date, " << failed_count << " failed in "
+            << seconds << " s" << std::endl;
+  return failed_count > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}